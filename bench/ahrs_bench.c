@@ -0,0 +1,372 @@
+/**
+ * @file ahrs_bench.c
+ * @brief 姿态解算主机验证：合成轨迹对比真值，或 RCAP 录制中的 HI91 原始数据对比 IMU 自带四元数
+ *
+ * @details 两种用法：
+ *          - ahrs_bench
+ *              合成 60 秒、1kHz 的三轴机动（真值按每步精确旋转积分），生成带零偏和噪声的
+ *              gyr / acc / mag，分别用 Mahony、Madgwick 的 9 轴和 6 轴模式解算，
+ *              跳过前 5 秒后统计倾角误差和航向误差，并测每次更新耗时
+ *          - ahrs_bench <录制.rcap>
+ *              录制来自 test/imu_sd_logger.cpp（IMU 输出 HI91）。用每帧的 acc / gyr / mag 解算，
+ *              与同一帧的 quat 比较：倾角误差直接比较重力方向；航向先减去两者的平均偏差
+ *              （IMU 的航向零点和磁偏角设置与本模块不同），再统计残差
+ *
+ *          PlatformIO：pio run -e native_ahrs && .pio/build/native_ahrs/program [录制.rcap]
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ahrs.h"
+#include "hipnuc_dec.h"
+#include "rs485_capture.h"
+
+#define SIM_HZ 1000
+#define SIM_SECONDS 60
+#define SIM_N (SIM_HZ * SIM_SECONDS)
+#define SETTLE_S 5.0
+
+typedef struct
+{
+    float gyr[3], acc[3], mag[3];
+    float q_true[4];
+} sample_t;
+
+typedef struct
+{
+    const char *name;
+    ahrs_algo_t algo;
+    int use_mag;
+} config_t;
+
+static const config_t configs[] = {
+    {"Mahony 9轴", AHRS_MAHONY, 1},
+    {"Madgwick 9轴", AHRS_MADGWICK, 1},
+    {"Mahony 6轴", AHRS_MAHONY, 0},
+    {"Madgwick 6轴", AHRS_MADGWICK, 0},
+};
+#define N_CONFIGS (sizeof(configs) / sizeof(configs[0]))
+
+typedef struct
+{
+    double tilt_sq, tilt_max;
+    double yaw_sq, yaw_max;
+    double yaw_off_s, yaw_off_c; // 航向差的单位向量和（圆周平均）
+    uint32_t n;
+} err_t;
+
+static uint32_t rng_state = 0x2545F491u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double gauss(void)
+{
+    double u1 = ((rng() >> 8) + 1.0) / 16777217.0;
+    double u2 = (rng() >> 8) / 16777216.0;
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 机体系中的导航轴方向：R 的第 row 行（R 为机体 → 导航） */
+static void nav_axis_in_body(const double q[4], int row, double out[3])
+{
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+
+    if (row == 0)
+    {
+        out[0] = 1 - 2 * (y * y + z * z);
+        out[1] = 2 * (x * y - w * z);
+        out[2] = 2 * (x * z + w * y);
+    }
+    else
+    {
+        out[0] = 2 * (x * z - w * y);
+        out[1] = 2 * (y * z + w * x);
+        out[2] = 1 - 2 * (x * x + y * y);
+    }
+}
+
+static void to_double(const float in[4], double out[4])
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        out[i] = in[i];
+}
+
+static double wrap180(double d)
+{
+    while (d > 180.0)
+        d -= 360.0;
+    while (d < -180.0)
+        d += 360.0;
+    return d;
+}
+
+/* 倾角误差：两个姿态的重力方向夹角 */
+static double tilt_error(const float qe[4], const float qt[4])
+{
+    double a[4], b[4], ua[3], ub[3], d;
+
+    to_double(qe, a);
+    to_double(qt, b);
+    nav_axis_in_body(a, 2, ua);
+    nav_axis_in_body(b, 2, ub);
+    d = ua[0] * ub[0] + ua[1] * ub[1] + ua[2] * ub[2];
+    if (d > 1)
+        d = 1;
+    return acos(d) * 57.29577951308232;
+}
+
+static void err_add(err_t *e, double tilt, double dyaw)
+{
+    e->tilt_sq += tilt * tilt;
+    if (tilt > e->tilt_max)
+        e->tilt_max = tilt;
+    e->yaw_sq += dyaw * dyaw;
+    if (fabs(dyaw) > e->yaw_max)
+        e->yaw_max = fabs(dyaw);
+    e->n++;
+}
+
+/* ==================== 合成轨迹 ==================== */
+
+static sample_t sim[SIM_N];
+
+static void simulate(void)
+{
+    const double dt = 1.0 / SIM_HZ;
+    const double bias[3] = {0.8, -0.5, 0.3};                   // °/s
+    const double incl = 50.0 * 3.141592653589793 / 180.0;       // 磁倾角
+    const double m_nav[3] = {50 * cos(incl), 0, -50 * sin(incl)}; // uT，北-西-天
+    double q[4] = {0.9238795, 0.0, 0.3826834, 0.0};            // 初始俯仰 45°
+    int k, i;
+
+    for (k = 0; k < SIM_N; k++)
+    {
+        double t = k * dt;
+        double w[3], r0[3], r1[3], r2[3], n, h, s, c, dq[4], nq[4];
+
+        // 三轴正弦组合机动，峰值约 ±100°/s
+        w[0] = 60 * sin(2 * 3.14159 * 0.31 * t) + 30 * sin(2 * 3.14159 * 1.7 * t);
+        w[1] = 50 * sin(2 * 3.14159 * 0.23 * t + 1.0);
+        w[2] = 80 * sin(2 * 3.14159 * 0.11 * t + 2.0) + 20 * sin(2 * 3.14159 * 2.3 * t);
+
+        nav_axis_in_body(q, 0, r0);
+        nav_axis_in_body(q, 2, r2);
+        // 第二行（西向）= 天 × 北
+        r1[0] = r2[1] * r0[2] - r2[2] * r0[1];
+        r1[1] = r2[2] * r0[0] - r2[0] * r0[2];
+        r1[2] = r2[0] * r0[1] - r2[1] * r0[0];
+        for (i = 0; i < 3; i++)
+        {
+            sim[k].gyr[i] = (float)(w[i] + bias[i] + 0.1 * gauss());
+            sim[k].acc[i] = (float)(r2[i] + 0.01 * gauss());
+            sim[k].mag[i] = (float)(r0[i] * m_nav[0] + r1[i] * m_nav[1] + r2[i] * m_nav[2] + 0.5 * gauss());
+        }
+        for (i = 0; i < 4; i++)
+            sim[k].q_true[i] = (float)q[i];
+
+        // q ← q ⊗ exp(½ ω dt)
+        n = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * 3.141592653589793 / 180.0;
+        h = 0.5 * n * dt;
+        c = cos(h);
+        s = n > 0 ? sin(h) / n * 3.141592653589793 / 180.0 : 0;
+        dq[0] = c;
+        dq[1] = w[0] * s;
+        dq[2] = w[1] * s;
+        dq[3] = w[2] * s;
+        nq[0] = q[0] * dq[0] - q[1] * dq[1] - q[2] * dq[2] - q[3] * dq[3];
+        nq[1] = q[0] * dq[1] + q[1] * dq[0] + q[2] * dq[3] - q[3] * dq[2];
+        nq[2] = q[0] * dq[2] - q[1] * dq[3] + q[2] * dq[0] + q[3] * dq[1];
+        nq[3] = q[0] * dq[3] + q[1] * dq[2] - q[2] * dq[1] + q[3] * dq[0];
+        memcpy(q, nq, sizeof(q));
+    }
+}
+
+static void run_sim(const config_t *cfg)
+{
+    static float est[SIM_N][4];
+    ahrs_t a;
+    err_t e;
+    uint64_t t0, dt;
+    float rpy_e[3], rpy_t[3];
+    int k;
+
+    ahrs_init(&a, cfg->algo);
+    t0 = now_ns();
+    for (k = 0; k < SIM_N; k++)
+    {
+        ahrs_update(&a, sim[k].gyr, sim[k].acc, cfg->use_mag ? sim[k].mag : NULL, 1.0f / SIM_HZ);
+        memcpy(est[k], a.q, sizeof(a.q));
+    }
+    dt = now_ns() - t0;
+
+    memset(&e, 0, sizeof(e));
+    for (k = (int)(SETTLE_S * SIM_HZ); k < SIM_N; k++)
+    {
+        ahrs_quat_to_euler(est[k], rpy_e);
+        ahrs_quat_to_euler(sim[k].q_true, rpy_t);
+        err_add(&e, tilt_error(est[k], sim[k].q_true), wrap180(rpy_e[2] - rpy_t[2]));
+    }
+    printf("%-14s 倾角 RMS %.3f° max %.3f° | 航向 RMS %7.3f° max %7.3f° | %.1f ns/次\n", cfg->name,
+           sqrt(e.tilt_sq / e.n), e.tilt_max, sqrt(e.yaw_sq / e.n), e.yaw_max, (double)dt / SIM_N);
+}
+
+/* ==================== 录制对比 ==================== */
+
+static uint8_t *load_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long n;
+
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = (uint8_t *)malloc(n > 0 ? (size_t)n : 1);
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+static int run_capture(const char *path)
+{
+    static hipnuc_raw_t raw;
+    ahrs_t a[N_CONFIGS];
+    err_t e[N_CONFIGS];
+    float (*yaw_diff)[N_CONFIGS] = NULL;
+    float (*tilt)[N_CONFIGS] = NULL;
+    size_t size, cap_frames = 0, frames = 0;
+    rcap_reader_t rd;
+    const uint8_t *data;
+    uint32_t t_us, last_ms = 0, first_ms = 0;
+    uint16_t len;
+    uint8_t *buf = load_file(path, &size);
+    float dt = 0.01f;
+    size_t c, k;
+    int i;
+
+    if (!buf || !rcap_reader_init(&rd, buf, size))
+    {
+        printf("无法读取录制: %s\n", path);
+        free(buf);
+        return 1;
+    }
+    for (c = 0; c < N_CONFIGS; c++)
+        ahrs_init(&a[c], configs[c].algo);
+    memset(e, 0, sizeof(e));
+
+    while (rcap_reader_next(&rd, &t_us, &data, &len) == 1)
+    {
+        for (i = 0; i < len; i++)
+        {
+            float rpy_e[3], rpy_t[3], q_dev[4], gyr[3], acc[3], mag[3];
+
+            if (hipnuc_input(&raw, data[i]) <= 0 || raw.hi91.tag != 0x91)
+                continue;
+            if (frames > 0)
+            {
+                uint32_t d = raw.hi91.system_time - last_ms;
+                if (d > 0 && d < 200)
+                    dt = d * 0.001f;
+            }
+            else
+                first_ms = raw.hi91.system_time;
+            last_ms = raw.hi91.system_time;
+
+            if (frames == cap_frames)
+            {
+                cap_frames = cap_frames ? cap_frames * 2 : 4096;
+                yaw_diff = realloc(yaw_diff, cap_frames * sizeof(*yaw_diff));
+                tilt = realloc(tilt, cap_frames * sizeof(*tilt));
+                if (!yaw_diff || !tilt)
+                    return 1;
+            }
+            // hi91_t 为紧凑结构，先复制到对齐的数组
+            memcpy(q_dev, raw.hi91.quat, sizeof(q_dev));
+            memcpy(gyr, raw.hi91.gyr, sizeof(gyr));
+            memcpy(acc, raw.hi91.acc, sizeof(acc));
+            memcpy(mag, raw.hi91.mag, sizeof(mag));
+            ahrs_quat_to_euler(q_dev, rpy_t);
+            for (c = 0; c < N_CONFIGS; c++)
+            {
+                ahrs_update(&a[c], gyr, acc, configs[c].use_mag ? mag : NULL, dt);
+                ahrs_quat_to_euler(a[c].q, rpy_e);
+                yaw_diff[frames][c] = (float)wrap180(rpy_e[2] - rpy_t[2]);
+                tilt[frames][c] = (float)tilt_error(a[c].q, q_dev);
+            }
+            frames++;
+        }
+    }
+
+    printf("录制 %s: %zu 帧 HI91，%.1f 秒\n", path, frames, (last_ms - first_ms) / 1000.0);
+    for (c = 0; c < N_CONFIGS; c++)
+    {
+        double off;
+        size_t start = 0;
+
+        // 跳过前 SETTLE_S 秒（按帧数比例）
+        if (last_ms > first_ms)
+            start = (size_t)(frames * (SETTLE_S * 1000.0 / (last_ms - first_ms)));
+        if (start >= frames)
+            start = 0;
+        for (k = start; k < frames; k++)
+        {
+            e[c].yaw_off_s += sin(yaw_diff[k][c] / 57.29577951308232);
+            e[c].yaw_off_c += cos(yaw_diff[k][c] / 57.29577951308232);
+        }
+        off = atan2(e[c].yaw_off_s, e[c].yaw_off_c) * 57.29577951308232;
+        for (k = start; k < frames; k++)
+            err_add(&e[c], tilt[k][c], wrap180(yaw_diff[k][c] - off));
+        if (e[c].n == 0)
+            continue;
+        printf("%-14s 倾角 RMS %.3f° max %.3f° | 航向（扣除偏差 %.1f°）RMS %7.3f° max %7.3f°\n", configs[c].name,
+               sqrt(e[c].tilt_sq / e[c].n), e[c].tilt_max, off, sqrt(e[c].yaw_sq / e[c].n), e[c].yaw_max);
+    }
+    free(yaw_diff);
+    free(tilt);
+    free(buf);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t c;
+
+    if (argc > 1)
+        return run_capture(argv[1]);
+
+    printf("合成轨迹：%d 秒 @ %dHz，陀螺零偏 (0.8, -0.5, 0.3)°/s，噪声 0.1°/s / 0.01G / 0.5uT\n", SIM_SECONDS,
+           SIM_HZ);
+    printf("快速平方根倒数: %s\n\n", AHRS_FAST_INV_SQRT ? "开" : "关（1/sqrtf）");
+    simulate();
+    for (c = 0; c < N_CONFIGS; c++)
+        run_sim(&configs[c]);
+    return 0;
+}
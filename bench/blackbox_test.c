@@ -0,0 +1,353 @@
+/**
+ * @file blackbox_test.c
+ * @brief 黑匣子主机测试：环形缓冲回绕与淘汰、触发前后窗口、导出期间继续记录、高 g 检测，以及追加耗时
+ *
+ * @details 场景（随机种子固定）：
+ *          - 回绕：随机长度记录写满容量非整数倍的缓冲，冻结后随机分块导出，检查序号连续且以最新记录结尾
+ *          - 窗口：400Hz IMU + 10Hz 气压，高 g 尖峰触发，快照须覆盖 [触发 - pre, 触发 + post) 且无缺帧
+ *          - 慢速导出：模拟 SD 每 10ms 写 256 字节，采集不停；空间足够时不丢记录，
+ *                      导出期间的记录成为下一次快照的历史
+ *          - 无人导出：冻结后一直不导出，新记录丢弃，快照保持完整
+ *          - 触发逻辑：非 ARMED 时忽略，单样本尖峰不触发，holdoff 内不重复触发
+ *
+ *          PlatformIO：
+ *              pio run -e native_blackbox && .pio/build/native_blackbox/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/blackbox_test.c src/blackbox.c -lm -o blackbox_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "blackbox.h"
+
+#define IMU_DT_US 2500  // 400Hz
+#define BARO_DT_US 100000 // 10Hz
+#define PRE_US 2000000
+#define POST_US 1000000
+#define BB_CAP 32768
+
+static uint8_t ring[BB_CAP];
+static uint8_t dump[4 * BB_CAP];
+static uint32_t rng_state = 0x1B873593u;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void check(const char *what, int ok)
+{
+    printf("    %-40s %s\n", what, ok ? "OK" : "FAIL");
+    if (!ok)
+        failures++;
+}
+
+/* 导出整个快照（分块大小随机），返回字节数 */
+static size_t drain_all(blackbox_t *bb, uint8_t *out, size_t max)
+{
+    size_t n = 0, got;
+
+    while ((got = blackbox_drain(bb, out + n, BLACKBOX_MAX_REC + rng() % 512)) > 0)
+    {
+        n += got;
+        if (n + BLACKBOX_MAX_REC + 512 > max)
+            break;
+    }
+    return n;
+}
+
+static void test_wrap(void)
+{
+    static blackbox_t bb;
+    uint8_t payload[64];
+    uint32_t seq, first = 0, expect, count = 0, last_seq = 0;
+    const uint8_t *p;
+    size_t n, off = 0, len;
+    uint8_t type, plen;
+    uint32_t t;
+    int ok = 1, saw_trigger = 0;
+
+    printf("  回绕与淘汰（容量 1000 字节，记录 10~46 字节）\n");
+    blackbox_init(&bb, ring, 1000, 0xFFFFFFF0u / 2, 0);
+    for (seq = 1; seq <= 5000; seq++)
+    {
+        uint8_t l = (uint8_t)(4 + rng() % 37);
+        memcpy(payload, &seq, 4);
+        memset(payload + 4, (int)seq, l - 4);
+        blackbox_put(&bb, BB_REC_ENCODER, seq, payload, l);
+        ok &= bb.used <= bb.cap && (bb.stats.evicted == 0 || bb.used + 46 > bb.cap);
+    }
+    check("占用不超过容量且接近写满", ok);
+    blackbox_trigger(&bb, BB_TRIG_COMMAND, 5001);
+    n = drain_all(&bb, dump, sizeof(dump));
+    check("导出后回到 ARMED、缓冲为空", bb.state == BB_ARMED && bb.used == 0);
+
+    ok = 1;
+    while ((len = blackbox_parse(dump + off, n - off, &type, &t, &p, &plen)) > 0)
+    {
+        off += len;
+        if (type == BB_REC_TRIGGER)
+        {
+            saw_trigger = t == 5001 && plen == 1 && p[0] == BB_TRIG_COMMAND;
+            continue;
+        }
+        memcpy(&seq, p, 4);
+        if (count == 0)
+            first = seq;
+        expect = first + count;
+        ok &= seq == expect && t == seq && (plen <= 4 || p[plen - 1] == (uint8_t)seq);
+        last_seq = seq;
+        count++;
+    }
+    check("记录完整解析", off == n);
+    check("序号连续、内容正确", ok && count > 20);
+    check("以最新记录结尾，末尾为触发记录", last_seq == 5000 && saw_trigger);
+    printf("    保留 %lu 条（淘汰 %lu）\n", (unsigned long)count, (unsigned long)bb.stats.evicted);
+}
+
+/* 按时间推进采集：IMU 400Hz，气压 10Hz；spike_at 附近产生高 g */
+typedef struct
+{
+    uint32_t t;
+    uint32_t next_baro;
+    blackbox_highg_t hg;
+} sim_t;
+
+static void sim_step(blackbox_t *bb, sim_t *s, uint32_t spike_at)
+{
+    float acc[3] = {0.01f, -0.02f, 1.0f}, gyr[3] = {0.5f, -0.3f, 0.1f}, rpy[3] = {1.0f, 2.0f, 90.0f};
+
+    if (s->t >= spike_at && s->t < spike_at + 3 * IMU_DT_US)
+        acc[0] = 7.5f;
+    blackbox_put_imu(bb, s->t, acc, gyr, rpy);
+    if (blackbox_highg_update(&s->hg, acc, s->t))
+        blackbox_trigger(bb, BB_TRIG_HIGH_G, s->t);
+    if (s->t >= s->next_baro)
+    {
+        blackbox_put_baro(bb, s->t, 101325.0f, 25.0f);
+        s->next_baro += BARO_DT_US;
+    }
+    s->t += IMU_DT_US;
+}
+
+typedef struct
+{
+    uint32_t imu, baro, trig;
+    uint32_t first_t, last_t, trig_t;
+    int imu_gap;
+} summary_t;
+
+static summary_t summarize(const uint8_t *buf, size_t n)
+{
+    summary_t s;
+    size_t off = 0, len;
+    const uint8_t *p;
+    uint8_t type, plen;
+    uint32_t t, prev_imu = 0;
+
+    memset(&s, 0, sizeof(s));
+    while ((len = blackbox_parse(buf + off, n - off, &type, &t, &p, &plen)) > 0)
+    {
+        if (off == 0)
+            s.first_t = t;
+        s.last_t = t;
+        off += len;
+        if (type == BB_REC_IMU)
+        {
+            if (s.imu > 0 && t - prev_imu != IMU_DT_US)
+                s.imu_gap++;
+            prev_imu = t;
+            s.imu++;
+        }
+        else if (type == BB_REC_BARO)
+            s.baro++;
+        else if (type == BB_REC_TRIGGER)
+        {
+            s.trig++;
+            s.trig_t = t;
+        }
+    }
+    return s;
+}
+
+static void test_window(void)
+{
+    static blackbox_t bb;
+    sim_t sim;
+    uint8_t hdr[BLACKBOX_FILE_HDR_SIZE];
+    uint32_t spike = 5000000, bytes, first_hit;
+    summary_t s;
+    size_t n;
+
+    printf("  触发窗口（400Hz IMU + 10Hz 气压，pre %.1f s，post %.1f s，容量 %d 字节）\n", PRE_US / 1e6,
+           POST_US / 1e6, BB_CAP);
+    memset(&sim, 0, sizeof(sim));
+    sim.t = 1000;
+    blackbox_highg_init(&sim.hg, 4.0f, 2, 1000000);
+    blackbox_init(&bb, ring, BB_CAP, PRE_US, POST_US);
+    while (bb.state != BB_FROZEN)
+        sim_step(&bb, &sim, spike);
+
+    blackbox_file_header(&bb, hdr);
+    memcpy(&bytes, hdr + 12, 4);
+    check("文件头：BBOX、触发原因", memcmp(hdr, "BBOX", 4) == 0 && hdr[6] == BB_TRIG_HIGH_G);
+    n = drain_all(&bb, dump, sizeof(dump));
+    s = summarize(dump, n);
+    printf("    快照 %lu 字节：IMU %lu 帧，气压 %lu，触发于 %.4f s，覆盖 %.4f ~ %.4f s，峰值 %.1f G\n",
+           (unsigned long)n, (unsigned long)s.imu, (unsigned long)s.baro, s.trig_t / 1e6, s.first_t / 1e6,
+           s.last_t / 1e6, (double)sim.hg.peak);
+    check("文件头字节数与导出一致", bytes == n);
+    first_hit = 1000 + (spike - 1000 + IMU_DT_US - 1) / IMU_DT_US * IMU_DT_US;
+    check("触发记录一条，位于尖峰第 2 个样本", s.trig == 1 && s.trig_t == first_hit + IMU_DT_US);
+    check("起点在触发前 pre 以内一帧", s.first_t >= s.trig_t - PRE_US && s.first_t < s.trig_t - PRE_US + IMU_DT_US);
+    check("终点在触发后 post 以内一帧", s.last_t < s.trig_t + POST_US && s.last_t + IMU_DT_US >= s.trig_t + POST_US);
+    check("IMU 无缺帧", s.imu_gap == 0 && s.imu == (PRE_US + POST_US) / IMU_DT_US);
+    check("气压 10Hz", s.baro >= 29 && s.baro <= 31);
+}
+
+static void test_slow_drain(void)
+{
+    static blackbox_t bb;
+    static uint8_t file2[4 * BB_CAP];
+    sim_t sim;
+    uint8_t chunk[256 + BLACKBOX_MAX_REC];
+    size_t n1 = 0, n2 = 0, got;
+    uint32_t next_write, drain_start, drain_end = 0;
+    summary_t s1, s2;
+
+    printf("  慢速导出（每 10ms 写 256 字节，采集不停）\n");
+    memset(&sim, 0, sizeof(sim));
+    sim.t = 1000;
+    blackbox_highg_init(&sim.hg, 4.0f, 2, 1000000);
+    blackbox_init(&bb, ring, BB_CAP, PRE_US, POST_US);
+    while (bb.state != BB_FROZEN)
+        sim_step(&bb, &sim, 5000000);
+
+    drain_start = sim.t;
+    next_write = sim.t;
+    while (bb.state == BB_FROZEN)
+    {
+        sim_step(&bb, &sim, 0xFFFFFFFFu);
+        if (sim.t >= next_write)
+        {
+            got = blackbox_drain(&bb, chunk, 256 + BLACKBOX_MAX_REC);
+            memcpy(dump + n1, chunk, got);
+            n1 += got;
+            next_write += 10000;
+            drain_end = sim.t;
+        }
+    }
+    printf("    导出耗时 %.2f s，期间丢弃 %lu 条\n", (drain_end - drain_start) / 1e6, (unsigned long)bb.stats.dropped);
+    s1 = summarize(dump, n1);
+    check("第一份快照完整", s1.imu_gap == 0 && s1.trig == 1);
+    check("空间足够时不丢记录", bb.stats.dropped == 0);
+
+    // 导出结束后立即再次触发：历史应覆盖导出期间
+    blackbox_trigger(&bb, BB_TRIG_COMMAND, sim.t);
+    while (bb.state != BB_FROZEN)
+        sim_step(&bb, &sim, 0xFFFFFFFFu);
+    while ((got = blackbox_drain(&bb, file2 + n2, sizeof(file2) - n2)) > 0)
+        n2 += got;
+    s2 = summarize(file2, n2);
+    check("第二份快照包含导出期间的记录", s2.first_t <= drain_start && s2.imu_gap == 0);
+    check("两份快照首尾衔接（无缺帧）", s2.first_t <= s1.last_t + IMU_DT_US);
+}
+
+static void test_stalled(void)
+{
+    static blackbox_t bb;
+    sim_t sim;
+    summary_t s;
+    size_t n;
+    uint32_t snap;
+    int i;
+
+    printf("  无人导出（冻结后继续采集 10 s）\n");
+    memset(&sim, 0, sizeof(sim));
+    sim.t = 1000;
+    blackbox_highg_init(&sim.hg, 4.0f, 2, 1000000);
+    blackbox_init(&bb, ring, BB_CAP, PRE_US, POST_US);
+    while (bb.state != BB_FROZEN)
+        sim_step(&bb, &sim, 3000000);
+    snap = bb.snap_left;
+    for (i = 0; i < 4000; i++)
+        sim_step(&bb, &sim, 8000000);
+    check("新记录丢弃并计数", bb.stats.dropped > 3000);
+    check("第二次高 g 被忽略", bb.stats.ignored == 1 && bb.stats.triggers == 1);
+    check("快照未被覆盖", bb.snap_left == snap && bb.used <= bb.cap);
+    n = drain_all(&bb, dump, sizeof(dump));
+    s = summarize(dump, n);
+    check("快照内容完整", n == snap && s.imu_gap == 0 && s.trig == 1);
+}
+
+static void test_trigger_logic(void)
+{
+    blackbox_highg_t hg;
+    float quiet[3] = {0.0f, 0.0f, 1.0f}, hit[3] = {3.0f, 3.0f, 1.0f}; // |hit| ≈ 4.36 G
+    int fired = 0, i;
+    uint32_t t = 0;
+
+    printf("  高 g 检测（阈值 4 G，连续 2 个样本，holdoff 1 s）\n");
+    blackbox_highg_init(&hg, 4.0f, 2, 1000000);
+    for (i = 0; i < 100; i++, t += IMU_DT_US)
+        fired += blackbox_highg_update(&hg, (i % 10 == 5) ? hit : quiet, t);
+    check("单样本尖峰不触发", fired == 0);
+    fired = blackbox_highg_update(&hg, hit, t);
+    fired += blackbox_highg_update(&hg, hit, t += IMU_DT_US);
+    check("连续 2 个样本触发一次", fired == 1 && hg.peak > 4.3f);
+    fired = 0;
+    for (i = 0; i < 100; i++)
+        fired += blackbox_highg_update(&hg, hit, t += IMU_DT_US);
+    check("holdoff 内不重复触发", fired == 0);
+    t += 1000000;
+    fired = blackbox_highg_update(&hg, hit, t) + blackbox_highg_update(&hg, hit, t + IMU_DT_US);
+    check("holdoff 后可再次触发", fired == 1);
+}
+
+static void test_speed(void)
+{
+    static blackbox_t bb;
+    float acc[3] = {0.1f, 0.2f, 1.0f}, gyr[3] = {1, 2, 3}, rpy[3] = {4, 5, 6};
+    uint64_t t0;
+    uint32_t i;
+    const uint32_t n = 2000000;
+    char line[256];
+
+    blackbox_init(&bb, ring, BB_CAP, PRE_US, POST_US);
+    t0 = now_ns();
+    for (i = 0; i < n; i++)
+        blackbox_put_imu(&bb, i * IMU_DT_US, acc, gyr, rpy);
+    printf("\n耗时（主机）\n  blackbox_put_imu  %.1f ns/条（缓冲已满，含淘汰）\n", (double)(now_ns() - t0) / n);
+    blackbox_format(&bb, line, sizeof(line));
+    printf("  %s", line);
+}
+
+int main(void)
+{
+    printf("黑匣子测试\n");
+    test_wrap();
+    test_window();
+    test_slow_drain();
+    test_stalled();
+    test_trigger_logic();
+    test_speed();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,403 @@
+/**
+ * @file button_input_test.c
+ * @brief 按键输入引擎主机测试：用合成的边沿序列验证消抖、单击 / 双击 / 长按和波轮解码
+ *
+ * @details 场景（时间均为边沿时间戳，单位 us）：
+ *          - 单击：松开后超过双击间隔才产生，时间为松开时刻 + 双击间隔
+ *          - 抖动：按下 / 松开各带多次抖动，仍只产生一次单击，抖动计入 glitches；短于消抖时间的毛刺不产生事件
+ *          - 长按：按住达到长按时间立即产生 LONG_PRESS，松开产生 LONG_RELEASE
+ *          - 双击：间隔内再次按下并松开产生 DOUBLE_CLICK；间隔外再次按下则先单击再开始新一轮；
+ *            第二次按下后一直按住为单击 + 长按
+ *          - 调用时机无关：同一边沿序列逐个边沿处理、每 7ms 处理、全部攒到最后一次处理，事件完全相同
+ *          - 波轮：正交编码（每格 4 个跳变，触点带抖动）正反转各一格；拨动式上拨 / 下拨
+ *          - 随机轨迹：随机生成带抖动的单击、双击、长按和毛刺序列（跨越 micros() 回绕），
+ *            按随机间隔调用 process，事件类型和时间与生成时的期望逐一相同
+ *
+ *          PlatformIO：
+ *              pio run -e native_button && .pio/build/native_button/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/button_input_test.c src/button_input.c -o button_input_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "button_input.h"
+
+#define BTN 1      // 被测按键线路（低电平按下）
+#define ROT_A 4    // 波轮 A 触点
+#define ROT_B 5    // 波轮 B 触点
+#define MAX_EDGES 8192
+#define MAX_EVENTS 1024
+
+#define MS 1000u
+#define DEBOUNCE BTN_DEFAULT_DEBOUNCE_US
+#define LONG BTN_DEFAULT_LONG_US
+#define GAP BTN_DEFAULT_DOUBLE_GAP_US
+
+typedef struct
+{
+    btn_edge_t e[MAX_EDGES];
+    int n;
+} trace_t;
+
+typedef struct
+{
+    btn_event_t ev[MAX_EVENTS];
+    int n;
+} events_t;
+
+static uint32_t rng_state = 0x9E3779B9u;
+static int failures = 0;
+static trace_t trace;
+static events_t expect, got, got2;
+static uint32_t ring_overflows;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+/* ==================== 轨迹与回放 ==================== */
+
+static void edge(uint8_t line, uint8_t level, uint32_t t)
+{
+    if (trace.n < MAX_EDGES)
+    {
+        trace.e[trace.n].line = line;
+        trace.e[trace.n].level = level;
+        trace.e[trace.n].t_us = t;
+        trace.n++;
+    }
+}
+
+/* 跳变到 level，前面带 bounces 次来回抖动（间隔远小于消抖时间）；返回最后一个边沿的时刻 */
+static uint32_t transition(uint8_t line, uint8_t level, uint32_t t, int bounces)
+{
+    int i;
+
+    for (i = 0; i < bounces; i++)
+    {
+        edge(line, level, t);
+        t += rng_range(100, 1500);
+        edge(line, (uint8_t)!level, t);
+        t += rng_range(100, 1500);
+    }
+    edge(line, level, t);
+    return t;
+}
+
+static void expect_event(uint8_t type, int8_t dir, uint32_t t)
+{
+    if (expect.n < MAX_EVENTS)
+    {
+        expect.ev[expect.n].type = type;
+        expect.ev[expect.n].line = dir ? ROT_A : BTN;
+        expect.ev[expect.n].dir = dir;
+        expect.ev[expect.n].t_us = t;
+        expect.n++;
+    }
+}
+
+static void init_engine(btn_engine_t *e, int rotary_steps)
+{
+    btn_engine_init(e);
+    btn_engine_add_button(e, BTN, 1, 1);
+    btn_engine_add_rotary(e, ROT_A, ROT_B, 1, 1, (uint8_t)rotary_steps);
+}
+
+static void drain(btn_engine_t *e, events_t *out)
+{
+    btn_event_t ev;
+
+    while (btn_engine_pop(e, &ev))
+    {
+        if (out->n < MAX_EVENTS)
+            out->ev[out->n++] = ev;
+    }
+}
+
+/*
+ * 按时间回放轨迹：主循环每 step_us 调用一次 process（step_us 为 0 时每个边沿后立即调用，
+ * 为负时每次随机 1~40ms），最后一次调用在 end_us
+ */
+static void replay(btn_engine_t *e, int rotary_steps, uint32_t start_us, uint32_t end_us, int32_t step_us,
+                   events_t *out)
+{
+    static btn_ring_t ring;
+    uint32_t now = start_us;
+    int i = 0;
+
+    memset(&ring, 0, sizeof(ring));
+    init_engine(e, rotary_steps);
+    out->n = 0;
+
+    while ((int32_t)(end_us - now) > 0)
+    {
+        if (step_us == 0)
+            now = i < trace.n ? trace.e[i].t_us : end_us;
+        else
+            now += step_us > 0 ? (uint32_t)step_us : rng_range(1 * MS, 40 * MS);
+        if ((int32_t)(now - end_us) > 0)
+            now = end_us;
+        for (; i < trace.n && (int32_t)(now - trace.e[i].t_us) >= 0; i++)
+            btn_ring_push(&ring, trace.e[i].line, trace.e[i].level, trace.e[i].t_us);
+        btn_engine_process(e, &ring, now);
+        drain(e, out);
+    }
+    ring_overflows += ring.overflow;
+}
+
+static int same_events(const events_t *a, const events_t *b)
+{
+    int i;
+
+    if (a->n != b->n)
+        return 0;
+    for (i = 0; i < a->n; i++)
+    {
+        const btn_event_t *x = &a->ev[i], *y = &b->ev[i];
+        if (x->type != y->type || x->line != y->line || x->dir != y->dir || x->t_us != y->t_us)
+            return 0;
+    }
+    return 1;
+}
+
+static void reset_trace(void)
+{
+    trace.n = 0;
+    expect.n = 0;
+}
+
+/* ==================== 固定场景 ==================== */
+
+static void test_click(void)
+{
+    btn_engine_t e;
+    uint32_t r;
+
+    printf("  单击与抖动\n");
+    reset_trace();
+    transition(BTN, 0, 10 * MS, 0);
+    r = transition(BTN, 1, 110 * MS, 0);
+    expect_event(BTN_EV_CLICK, 0, r + GAP);
+    replay(&e, 4, 0, r + GAP - 1, 0, &got);
+    check("双击间隔内不产生单击", got.n != 0);
+    replay(&e, 4, 0, r + GAP, 0, &got);
+    check("单击", !same_events(&got, &expect));
+
+    reset_trace();
+    transition(BTN, 0, 10 * MS, 3);
+    r = transition(BTN, 1, 120 * MS, 4);
+    expect_event(BTN_EV_CLICK, 0, r + GAP);
+    replay(&e, 4, 0, r + GAP + 50 * MS, 0, &got);
+    check("抖动只产生一次单击", !same_events(&got, &expect));
+    check("抖动计入 glitches", e.stats.glitches != 7 || e.stats.edges != 2 + 2 * 7);
+
+    // 短于消抖时间的毛刺
+    reset_trace();
+    edge(BTN, 0, 10 * MS);
+    edge(BTN, 1, 10 * MS + DEBOUNCE - 1);
+    replay(&e, 4, 0, 2000 * MS, 0, &got);
+    check("毛刺不产生事件", got.n != 0 || e.stats.glitches != 1 || btn_engine_pressed(&e, BTN));
+}
+
+static void test_long(void)
+{
+    btn_engine_t e;
+    uint32_t p, r;
+
+    printf("  长按\n");
+    reset_trace();
+    p = transition(BTN, 0, 10 * MS, 2);
+    r = transition(BTN, 1, p + 1500 * MS, 2);
+    expect_event(BTN_EV_LONG_PRESS, 0, p + LONG);
+    expect_event(BTN_EV_LONG_RELEASE, 0, r);
+    replay(&e, 4, 0, p + LONG - 1, 0, &got);
+    check("未到长按时间", got.n != 0 || !btn_engine_pressed(&e, BTN));
+    replay(&e, 4, 0, p + LONG, 0, &got);
+    check("到达长按时间立即产生", got.n != 1 || got.ev[0].type != BTN_EV_LONG_PRESS || got.ev[0].t_us != p + LONG);
+    replay(&e, 4, 0, r + GAP + 10 * MS, 0, &got);
+    check("长按 + 松开", !same_events(&got, &expect));
+}
+
+static void test_double(void)
+{
+    btn_engine_t e;
+    uint32_t p2, r1, r2;
+
+    printf("  双击\n");
+    reset_trace();
+    transition(BTN, 0, 10 * MS, 1);
+    r1 = transition(BTN, 1, 90 * MS, 2);
+    transition(BTN, 0, r1 + GAP - 10 * MS, 2);
+    r2 = transition(BTN, 1, r1 + GAP + 60 * MS, 1);
+    expect_event(BTN_EV_DOUBLE_CLICK, 0, r2);
+    replay(&e, 4, 0, r2 + GAP + 10 * MS, 0, &got);
+    check("间隔内再次按下", !same_events(&got, &expect));
+
+    // 第二次按下晚于双击间隔：先单击，再开始新一轮单击
+    reset_trace();
+    transition(BTN, 0, 10 * MS, 0);
+    r1 = transition(BTN, 1, 90 * MS, 0);
+    transition(BTN, 0, r1 + GAP + 20 * MS, 0);
+    r2 = transition(BTN, 1, r1 + GAP + 100 * MS, 0);
+    expect_event(BTN_EV_CLICK, 0, r1 + GAP);
+    expect_event(BTN_EV_CLICK, 0, r2 + GAP);
+    replay(&e, 4, 0, r2 + GAP + 10 * MS, 0, &got);
+    check("间隔外再次按下", !same_events(&got, &expect));
+
+    // 第二次按下后一直按住：单击（时间为第二次按下）+ 长按
+    reset_trace();
+    transition(BTN, 0, 10 * MS, 0);
+    r1 = transition(BTN, 1, 90 * MS, 0);
+    p2 = transition(BTN, 0, r1 + 100 * MS, 2);
+    r2 = transition(BTN, 1, p2 + 1200 * MS, 0);
+    expect_event(BTN_EV_CLICK, 0, p2);
+    expect_event(BTN_EV_LONG_PRESS, 0, p2 + LONG);
+    expect_event(BTN_EV_LONG_RELEASE, 0, r2);
+    replay(&e, 4, 0, r2 + GAP + 10 * MS, 0, &got);
+    check("双击第二下按住", !same_events(&got, &expect));
+}
+
+static void test_timing(void)
+{
+    btn_engine_t e;
+    uint32_t t = 10 * MS, r;
+
+    printf("  调用时机无关\n");
+    reset_trace();
+    transition(BTN, 0, t, 2);
+    r = transition(BTN, 1, t + 70 * MS, 2);
+    transition(BTN, 0, r + 150 * MS, 3);
+    r = transition(BTN, 1, r + 230 * MS, 1);
+    t = transition(BTN, 0, r + 400 * MS, 1);
+    transition(BTN, 1, t + 900 * MS, 2);
+
+    replay(&e, 4, 0, t + 2000 * MS, 0, &got);
+    replay(&e, 4, 0, t + 2000 * MS, 7 * MS, &got2);
+    check("逐边沿 vs 每 7ms", !same_events(&got, &got2) || got.n != 3);
+    replay(&e, 4, 0, t + 2000 * MS, (int32_t)(t + 2000 * MS), &got2);
+    check("逐边沿 vs 一次处理", !same_events(&got, &got2));
+}
+
+static void test_rotary(void)
+{
+    // A 先动作：11 → 01 → 00 → 10 → 11 为 +1 格；反向为 -1 格
+    static const uint8_t cw[4][2] = {{0, 1}, {0, 0}, {1, 0}, {1, 1}};
+    btn_engine_t e;
+    uint32_t t = 10 * MS, t_cw = 0, t_ccw = 0;
+    int i;
+
+    printf("  波轮\n");
+    reset_trace();
+    for (i = 0; i < 4; i++, t += 20 * MS)
+        t_cw = transition(i & 1 ? ROT_B : ROT_A, cw[i][i & 1], t, 2); // 偶数步 A 变化，奇数步 B 变化
+    for (i = 3; i >= 0; i--, t += 20 * MS)
+        t_ccw = transition(i & 1 ? ROT_B : ROT_A, cw[(i + 3) & 3][i & 1], t, 1);
+    replay(&e, 4, 0, t + 100 * MS, 0, &got);
+    check("正交解码 +1 / -1", got.n != 2 || got.ev[0].dir != 1 || got.ev[1].dir != -1 ||
+                                     got.ev[0].type != BTN_EV_ROTATE || got.ev[0].line != ROT_A);
+    check("事件时间为最后一次跳变", got.n != 2 || got.ev[0].t_us != t_cw || got.ev[1].t_us != t_ccw);
+    check("只有波轮事件", e.stats.events != 2);
+
+    // 拨动式：A 接通 +1，B 接通 -1，松开不产生事件
+    reset_trace();
+    transition(ROT_A, 0, 10 * MS, 2);
+    transition(ROT_A, 1, 100 * MS, 2);
+    transition(ROT_B, 0, 200 * MS, 0);
+    transition(ROT_B, 1, 300 * MS, 0);
+    replay(&e, BTN_ROTARY_TOGGLE, 0, 400 * MS, 0, &got);
+    check("拨动式", got.n != 2 || got.ev[0].dir != 1 || got.ev[1].dir != -1 || got.ev[1].t_us != 200 * MS);
+}
+
+/* ==================== 随机轨迹 ==================== */
+
+static void test_random(void)
+{
+    btn_engine_t e;
+    uint32_t start = 0xFFFFFFFFu - 20000000u; // 20 秒后 micros() 回绕
+    uint32_t t = start + 50 * MS;
+    int counts[5] = {0, 0, 0, 0, 0};
+    int g;
+
+    printf("  随机轨迹（跨越 micros() 回绕）\n");
+    reset_trace();
+    for (g = 0; g < 300; g++)
+    {
+        int kind = (int)(rng() % 4);
+        uint32_t p, r, r1;
+
+        counts[kind]++;
+        switch (kind)
+        {
+        case 0: // 单击
+            p = transition(BTN, 0, t, (int)(rng() % 4));
+            r = transition(BTN, 1, p + rng_range(30 * MS, LONG - 200 * MS), (int)(rng() % 4));
+            expect_event(BTN_EV_CLICK, 0, r + GAP);
+            t = r + GAP + rng_range(20 * MS, 300 * MS);
+            break;
+        case 1: // 双击
+            p = transition(BTN, 0, t, (int)(rng() % 4));
+            r1 = transition(BTN, 1, p + rng_range(30 * MS, 200 * MS), (int)(rng() % 4));
+            p = transition(BTN, 0, r1 + rng_range(30 * MS, GAP - 50 * MS), (int)(rng() % 4));
+            r = transition(BTN, 1, p + rng_range(30 * MS, 300 * MS), (int)(rng() % 4));
+            expect_event(BTN_EV_DOUBLE_CLICK, 0, r);
+            t = r + rng_range(20 * MS, 300 * MS);
+            break;
+        case 2: // 长按
+            p = transition(BTN, 0, t, (int)(rng() % 4));
+            r = transition(BTN, 1, p + rng_range(LONG + 50 * MS, 3 * LONG), (int)(rng() % 4));
+            expect_event(BTN_EV_LONG_PRESS, 0, p + LONG);
+            expect_event(BTN_EV_LONG_RELEASE, 0, r);
+            t = r + rng_range(20 * MS, 300 * MS);
+            break;
+        default: // 毛刺：短于消抖时间
+            edge(BTN, 0, t);
+            edge(BTN, 1, t + rng_range(100, DEBOUNCE - 100));
+            t += rng_range(20 * MS, 300 * MS);
+            break;
+        }
+    }
+
+    replay(&e, 4, start, t + GAP + 10 * MS, -1, &got);
+    printf("    单击 %d，双击 %d，长按 %d，毛刺 %d，边沿 %lu，glitches %lu\n", counts[0], counts[1], counts[2],
+           counts[3], (unsigned long)e.stats.edges, (unsigned long)e.stats.glitches);
+    check("事件类型与时间", !same_events(&got, &expect));
+    check("无事件丢弃", e.stats.dropped != 0);
+    replay(&e, 4, start, t + GAP + 10 * MS, 0, &got2);
+    check("与逐边沿处理一致", !same_events(&got, &got2));
+    check("边沿缓冲无溢出（全部场景）", ring_overflows != 0);
+}
+
+int main(void)
+{
+    printf("按键输入引擎\n");
+    test_click();
+    test_long();
+    test_double();
+    test_timing();
+    test_rotary();
+    test_random();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
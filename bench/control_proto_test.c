@@ -0,0 +1,426 @@
+/**
+ * @file control_proto_test.c
+ * @brief 控制协议主机测试：两个端点经模拟信道（丢包、重复、随机延迟乱序）通信，核对交付语义与统计
+ *
+ * @details 基站端点以 1~2ms 间隔下发 CTRL_FLAG_LATEST 设定值，并穿插普通命令（负载带唯一编号）；
+ *          机器人端点交付时记录编号。每条命令在发送端的结局（确认 / 失败 / 被取代）由槽位变化判定。
+ *          场景（随机种子固定）：
+ *          - 乱序无丢包：普通命令恰好交付一次、全部确认、无重传；迟到的旧设定值被丢弃，交付的设定值严格递增
+ *          - 丢包 25% + 重复 5% + 延迟超过 RTO：任何命令不重复交付，确认的命令都已交付；
+ *            每条命令在 (重试次数 + 1) × RTO 内有结局，重传次数有上界
+ *          - 基站反复重启（新会话号，旧会话报文仍在信道中）：重启后第一条急停命令一次发送即交付，
+ *            新会话开始后不再交付旧会话的命令，旧会话的应答不会确认新命令
+ *          各场景都检查 RTT 统计：直方图总数、最小值不低于两倍最小单程延迟、Karn 算法下最大值小于 RTO。
+ *
+ *          PlatformIO：
+ *              pio run -e native_ctrl && .pio/build/native_ctrl/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/control_proto_test.c src/control_proto.c -o control_proto_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "control_proto.h"
+
+#define STEP_US 100
+#define MAX_PKT 1024
+#define MAX_IDS 65536
+
+enum
+{
+    PENDING = 0,
+    ACKED,
+    FAILED,
+    SUPERSEDED,
+    REJECTED,
+    REBOOTED
+};
+
+typedef struct
+{
+    uint32_t at;
+    uint8_t dst;
+    uint8_t len;
+    uint8_t data[64];
+} pkt_t;
+
+typedef struct
+{
+    uint32_t loss_pct;
+    uint32_t dup_pct;
+    uint32_t dmin_us, dmax_us; // 单程延迟范围（均匀分布，范围大于报文间隔时乱序）
+} link_cfg_t;
+
+static pkt_t chan[MAX_PKT];
+static int chan_n;
+static link_cfg_t link;
+static uint32_t sim_now;
+static ctrl_endpoint_t ep[2]; // 0 = 基站（发送命令），1 = 机器人（交付命令）
+
+static uint16_t seq_id[65536]; // 当前会话的序号 → 命令编号
+static uint8_t is_sp[MAX_IDS], outcome[MAX_IDS], deliv[MAX_IDS];
+static uint32_t sub_us[MAX_IDS], res_us[MAX_IDS], deliv_us[MAX_IDS];
+static uint32_t next_id, last_sp_id, stale_delivered, boot_id, old_after_new, chan_drops;
+static uint8_t new_seen;
+
+static uint32_t rng_state = 0x27D4EB2Fu;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+/* ==================== 模拟信道 ==================== */
+
+static void enqueue(uint8_t dst, const uint8_t *buf, size_t len)
+{
+    pkt_t *p;
+
+    if (chan_n >= MAX_PKT || len > sizeof(p->data))
+    {
+        chan_drops++;
+        return;
+    }
+    p = &chan[chan_n++];
+    p->at = sim_now + link.dmin_us + rng() % (link.dmax_us - link.dmin_us + 1);
+    p->dst = dst;
+    p->len = (uint8_t)len;
+    memcpy(p->data, buf, len);
+}
+
+static int chan_send(void *ctx, const uint8_t *buf, size_t len)
+{
+    uint8_t dst = (uint8_t)(uintptr_t)ctx;
+
+    if (rng() % 100 < link.loss_pct)
+        return 0; // 空口丢失，发送端不知情
+    enqueue(dst, buf, len);
+    if (rng() % 100 < link.dup_pct)
+        enqueue(dst, buf, len);
+    return 0;
+}
+
+static void robot_deliver(void *ctx, uint8_t cmd_id, const uint8_t *payload, uint8_t len)
+{
+    uint32_t id;
+
+    (void)ctx;
+    if (cmd_id == CTRL_CMD_SETPOINT && len == sizeof(ctrl_setpoint_t))
+        id = ((const ctrl_setpoint_t *)payload)->t_ms;
+    else if (len == 4)
+        memcpy(&id, payload, 4);
+    else
+        return;
+    if (id >= MAX_IDS)
+        return;
+
+    deliv[id]++;
+    deliv_us[id] = sim_now;
+    if (is_sp[id])
+    {
+        if (id <= last_sp_id)
+            stale_delivered++;
+        last_sp_id = id;
+    }
+    if (id >= boot_id)
+        new_seen = 1;
+    else if (new_seen)
+        old_after_new++;
+}
+
+/* ==================== 发送端结局判定 ==================== */
+
+typedef struct
+{
+    uint8_t used[CTRL_WINDOW];
+    uint16_t seq[CTRL_WINDOW];
+} slot_snap_t;
+
+static void snap(slot_snap_t *s)
+{
+    int i;
+    for (i = 0; i < CTRL_WINDOW; i++)
+    {
+        s->used[i] = ep[0].slots[i].in_use;
+        s->seq[i] = ep[0].slots[i].seq;
+    }
+}
+
+/* 快照中在途、现在已释放（或换成其他序号）的槽：结局为 how */
+static void resolve(const slot_snap_t *s, uint8_t how)
+{
+    int i;
+    for (i = 0; i < CTRL_WINDOW; i++)
+    {
+        if (!s->used[i] || (ep[0].slots[i].in_use && ep[0].slots[i].seq == s->seq[i]))
+            continue;
+        outcome[seq_id[s->seq[i]]] = how;
+        res_us[seq_id[s->seq[i]]] = sim_now;
+    }
+}
+
+static void submit(uint8_t cmd_id)
+{
+    uint32_t id = next_id++;
+    slot_snap_t s;
+    int seq;
+
+    if (id >= MAX_IDS)
+        return;
+    snap(&s);
+    is_sp[id] = cmd_id == CTRL_CMD_SETPOINT;
+    sub_us[id] = sim_now;
+    if (is_sp[id])
+    {
+        ctrl_setpoint_t sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.value[0] = (float)id;
+        sp.t_ms = id;
+        seq = ctrl_submit(&ep[0], cmd_id, CTRL_FLAG_LATEST, &sp, sizeof(sp), sim_now);
+    }
+    else
+    {
+        seq = ctrl_submit(&ep[0], cmd_id, 0, &id, 4, sim_now);
+    }
+    resolve(&s, SUPERSEDED);
+    if (seq < 0)
+    {
+        outcome[id] = REJECTED;
+        return;
+    }
+    seq_id[seq] = (uint16_t)id;
+}
+
+static void step(void)
+{
+    slot_snap_t s;
+    int i = 0;
+
+    sim_now += STEP_US;
+    while (i < chan_n)
+    {
+        pkt_t p;
+        if ((int32_t)(sim_now - chan[i].at) < 0)
+        {
+            i++;
+            continue;
+        }
+        p = chan[i];
+        chan[i] = chan[--chan_n];
+        if (p.dst == 0)
+        {
+            snap(&s);
+            ctrl_on_receive(&ep[0], p.data, p.len, sim_now);
+            resolve(&s, ACKED);
+        }
+        else
+        {
+            ctrl_on_receive(&ep[1], p.data, p.len, sim_now);
+        }
+    }
+    snap(&s);
+    ctrl_poll(&ep[0], sim_now);
+    resolve(&s, FAILED);
+    ctrl_poll(&ep[1], sim_now);
+}
+
+static void reset_sim(const link_cfg_t *cfg, uint8_t base_session)
+{
+    link = *cfg;
+    chan_n = 0;
+    sim_now = 0;
+    next_id = 1;
+    last_sp_id = stale_delivered = old_after_new = chan_drops = 0;
+    boot_id = 1;
+    new_seen = 0;
+    memset(seq_id, 0, sizeof(seq_id));
+    memset(is_sp, 0, sizeof(is_sp));
+    memset(outcome, 0, sizeof(outcome));
+    memset(deliv, 0, sizeof(deliv));
+    ctrl_init(&ep[0], chan_send, NULL, (void *)(uintptr_t)1, base_session);
+    ctrl_init(&ep[1], chan_send, robot_deliver, (void *)(uintptr_t)0, 0x5A);
+}
+
+/* 运行 dur_us：每 sp_us 一条设定值，每 cmd_us 一条普通命令（0 表示不发），之后不再提交直至排空 */
+static void run_traffic(uint32_t dur_us, uint32_t sp_us, uint32_t cmd_us)
+{
+    uint32_t end = sim_now + dur_us, next_sp = sim_now, next_cmd = sim_now + 350;
+
+    while ((int32_t)(sim_now - end) < 0)
+    {
+        if (sp_us && (int32_t)(sim_now - next_sp) >= 0)
+        {
+            submit(CTRL_CMD_SETPOINT);
+            next_sp += sp_us;
+        }
+        if (cmd_us && (int32_t)(sim_now - next_cmd) >= 0)
+        {
+            submit(CTRL_CMD_SET_PARAM);
+            next_cmd += cmd_us;
+        }
+        step();
+    }
+}
+
+static void drain(void)
+{
+    uint32_t i;
+    for (i = 0; i < 200; i++) // 20ms：超过最长结局时间与最大单程延迟
+        step();
+}
+
+/* 通用检查：恰好一次、确认即已交付、结局时间与重传次数有上界、RTT 统计 */
+static void verify(int lossless)
+{
+    const ctrl_stats_t *st = &ep[0].stats;
+    uint32_t id, dup = 0, unacked = 0, lost = 0, late = 0, pending = 0, cmds = 0, cmd_deliv = 0;
+    uint32_t bound = (ep[0].max_retries + 1u) * ep[0].rto_us + STEP_US, hist = 0;
+    int i;
+
+    for (id = 1; id < next_id && id < MAX_IDS; id++)
+    {
+        if (deliv[id] > 1)
+            dup++;
+        if (outcome[id] == PENDING)
+            pending++;
+        if (!is_sp[id] && outcome[id] == ACKED && deliv[id] == 0)
+            unacked++;
+        if ((outcome[id] == ACKED || outcome[id] == FAILED) && res_us[id] - sub_us[id] > bound)
+            late++;
+        if (!is_sp[id] && outcome[id] != REBOOTED)
+        {
+            cmds++;
+            cmd_deliv += deliv[id] > 0;
+            if (lossless && (outcome[id] != ACKED || deliv[id] != 1))
+                lost++;
+        }
+    }
+    for (i = 0; i < CTRL_RTT_BINS; i++)
+        hist += st->rtt_hist[i];
+
+    printf("    普通命令 %lu 条交付 %lu 条 | 设定值丢弃过时 %lu | 发送 %lu 次（重传 %lu）确认 %lu 失败 %lu 取代 %lu\n",
+           (unsigned long)cmds, (unsigned long)cmd_deliv, (unsigned long)ep[1].stats.stale, (unsigned long)st->sent,
+           (unsigned long)st->retransmits, (unsigned long)st->acked, (unsigned long)st->failed,
+           (unsigned long)st->superseded);
+    if (st->rtt_count > 0)
+        printf("    RTT %lu 个样本：最小 %lu us，平均 %lu us，最大 %lu us，P50 ≤ %lu us，P99 ≤ %lu us\n",
+               (unsigned long)st->rtt_count, (unsigned long)st->rtt_min,
+               (unsigned long)(st->rtt_sum / st->rtt_count), (unsigned long)st->rtt_max,
+               (unsigned long)ctrl_rtt_percentile(st, 50), (unsigned long)ctrl_rtt_percentile(st, 99));
+
+    check("不重复交付", dup);
+    check("确认的命令都已交付", unacked);
+    check("过时设定值不交付", stale_delivered);
+    if (lossless)
+        check("普通命令恰好交付一次", lost);
+    check("结局时间 ≤ (重试 + 1) × RTO", late + pending + (uint32_t)ctrl_in_flight(&ep[0]));
+    check("重传次数有上界", st->retransmits > st->submitted * ep[0].max_retries ||
+                                st->sent != st->submitted + st->retransmits);
+    check("RTT 直方图与样本数一致", hist != st->rtt_count || st->rtt_count > st->acked);
+    check("RTT 范围（Karn）", st->rtt_count > 0 && (st->rtt_min < 2 * link.dmin_us || st->rtt_max >= ep[0].rto_us + STEP_US ||
+                                                      ctrl_rtt_percentile(st, 50) > ctrl_rtt_percentile(st, 99)));
+    check("信道队列未溢出", chan_drops);
+}
+
+/* ==================== 场景 ==================== */
+
+static void test_reorder(void)
+{
+    static const link_cfg_t cfg = {0, 0, 200, 1800}; // RTT < RTO：不应重传
+
+    printf("  乱序、无丢包（设定值 1ms，普通命令 7ms，5 秒）\n");
+    reset_sim(&cfg, 0x11);
+    run_traffic(5000000, 1000, 7000);
+    drain();
+    verify(1);
+    check("无重传", ep[0].stats.retransmits);
+    check("乱序的旧设定值被丢弃", ep[1].stats.stale == 0);
+    check("最大 RTT ≤ 2 × 最大单程延迟", ep[0].stats.rtt_max > 2 * cfg.dmax_us + STEP_US);
+}
+
+static void test_lossy(void)
+{
+    static const link_cfg_t cfg = {25, 5, 200, 6000}; // 延迟可能超过 RTO：伪重传 + 乱序
+
+    printf("  丢包 25%%、重复 5%%、延迟 0.2~6ms（设定值 2ms，普通命令 5ms，20 秒）\n");
+    reset_sim(&cfg, 0x22);
+    run_traffic(20000000, 2000, 5000);
+    drain();
+    verify(0);
+    check("重复报文被抑制", ep[1].stats.duplicates == 0);
+}
+
+static void test_reboot(void)
+{
+    static const link_cfg_t cfg = {0, 0, 200, 3000};
+    uint32_t r, first_bad = 0, slow = 0, reboots = 20;
+    uint8_t session = 0x33;
+
+    printf("  基站重启 %lu 次（旧会话报文仍在信道中）\n", (unsigned long)reboots);
+    reset_sim(&cfg, session);
+    for (r = 0; r < reboots; r++)
+    {
+        ctrl_stats_t keep;
+        uint32_t estop;
+        int i;
+
+        run_traffic(200000 + rng() % 300000, 1000, 3000);
+
+        // 重启：在途命令随之消失，序号从 0 开始；新会话号与前两次都不同（相同的情况见 ctrl_init 说明）
+        for (i = 0; i < CTRL_WINDOW; i++)
+            if (ep[0].slots[i].in_use)
+                outcome[seq_id[ep[0].slots[i].seq]] = REBOOTED;
+        do
+            session = (uint8_t)rng();
+        while (session == ep[1].rx_session || session == ep[1].rx_old_session);
+        keep = ep[0].stats; // 统计跨重启累计
+        ctrl_init(&ep[0], chan_send, NULL, (void *)(uintptr_t)1, session);
+        ep[0].stats = keep;
+        memset(seq_id, 0, sizeof(seq_id));
+        boot_id = next_id;
+        new_seen = 0;
+
+        estop = next_id;
+        submit(CTRL_CMD_ESTOP);
+        for (i = 0; i < (int)(cfg.dmax_us / STEP_US) + 1; i++)
+            step();
+        if (deliv[estop] != 1)
+            first_bad++;
+        else if (deliv_us[estop] - sub_us[estop] > cfg.dmax_us + STEP_US)
+            slow++;
+    }
+    drain();
+    verify(0);
+    printf("    机器人重新同步 %lu 次，丢弃旧会话报文 %lu 条；基站丢弃旧会话应答 %lu 条\n",
+           (unsigned long)ep[1].stats.resyncs, (unsigned long)ep[1].stats.old_session,
+           (unsigned long)ep[0].stats.old_session);
+    check("重启后急停一次发送即交付", first_bad + slow);
+    check("新会话后不交付旧命令", old_after_new);
+    check("每次重启重新同步一次", ep[1].stats.resyncs != reboots);
+}
+
+int main(void)
+{
+    printf("控制协议（窗口 %d，RTO %d us，最多重试 %d 次）\n", CTRL_WINDOW, CTRL_DEFAULT_RTO_US, CTRL_DEFAULT_RETRIES);
+    test_reorder();
+    test_lossy();
+    test_reboot();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
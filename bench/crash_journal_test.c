@@ -0,0 +1,277 @@
+/**
+ * @file crash_journal_test.c
+ * @brief 崩溃日志主机测试：模拟上电随机内容、复位、提交到一半被复位和位翻转，并测热路径耗时
+ *
+ * @details 同一块内存在“复位”前后分别由 crash_journal_start/commit 写入、crash_journal_open/next 读出：
+ *          - 上电：随机内容须被识别为无效并重新初始化
+ *          - 复位：回绕多圈后只剩最近 SLOTS 条，序号连续、从旧到新，阶段标记为复位时所在阶段
+ *          - 写入中途复位：新记录只写入前 k 字节（k 随机），该条被丢弃，其余记录仍连续
+ *          - 位翻转：随机翻转一位，所在记录被丢弃，其余记录不受影响
+ *
+ *          PlatformIO：
+ *              pio run -e native_journal && .pio/build/native_journal/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/crash_journal_test.c src/crash_journal.c -o crash_journal_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "crash_journal.h"
+
+#define N_ROUNDS 2000
+
+static crash_journal_t journal; // 相当于 RTC_NOINIT_ATTR 变量
+static crash_journal_t before;
+static uint32_t rng_state = 0x9E3779B9u;
+static int failures = 0;
+
+static const char *const stage_names[CRASH_JOURNAL_STAGES] = {
+    "loop", "imu_decode", "dps_read", "lcd_update", "serial_out", "buttons", "command", NULL};
+static const char *const value_names[CRASH_JOURNAL_VALUES] = {"Pa", "°C", "|acc|G", "|gyr|°/s"};
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-28s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+/* 一个 100ms 周期：若干次 loop()，阶段耗时与记录序号相关，便于复位后核对 */
+static void run_period(crash_journal_t *j, uint32_t n)
+{
+    float v[CRASH_JOURNAL_VALUES] = {101325.0f + n, 25.0f, 1.0f, 0.1f * (n % 10)};
+    int k, s;
+
+    for (k = 0; k < 3; k++)
+    {
+        crash_journal_enter(j, 0);
+        for (s = 1; s < 7; s++)
+        {
+            crash_journal_enter(j, (uint8_t)s);
+            crash_journal_leave(j, (uint8_t)s, 240u * (n % 1000 + s));
+        }
+        crash_journal_leave(j, 0, 240u * 5000);
+    }
+    crash_journal_commit(j, n * 100, (uint16_t)(40 + n % 3), v);
+}
+
+/*
+ * 复位后按序遍历，检查序号从 lo 到 hi 连续（跳过 skip 个损坏的序号）
+ * @return 不符合的项数
+ */
+static uint32_t verify(crash_journal_t *j, uint32_t lo, uint32_t hi, uint32_t skip)
+{
+    const crash_journal_entry_t *e;
+    uint32_t bad = 0, expect = lo, count = 0;
+    int pos = 0;
+
+    while ((e = crash_journal_next(j, &pos)) != NULL)
+    {
+        if (e->seq == skip)
+            bad++; // 损坏的记录不应通过校验
+        while (expect == skip)
+            expect++;
+        if (e->seq != expect || e->stage_max_us[1] != e->seq % 1000 + 1 || e->value[0] != 101325.0f + e->seq ||
+            e->loops != 3)
+            bad++;
+        expect++;
+        count++;
+    }
+    if (count != hi - lo + 1 - (skip >= lo && skip <= hi))
+        bad++;
+    return bad;
+}
+
+static void test_power_on(void)
+{
+    uint32_t i, bad = 0;
+
+    printf("  上电（随机内容）\n");
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+        uint8_t *p = (uint8_t *)&journal;
+        size_t k;
+        for (k = 0; k < sizeof(journal); k++)
+            p[k] = (uint8_t)rng();
+        if (crash_journal_open(&journal) != -1 || journal.boots != 1)
+            bad++;
+    }
+    check("识别为无效并重新初始化", bad);
+}
+
+static void test_reset(void)
+{
+    char line[256];
+    uint32_t n, first, bad = 0, stage_bad = 0;
+    int valid;
+
+    printf("  复位（回绕 3 圈）\n");
+    memset(&journal, 0, sizeof(journal));
+    crash_journal_open(&journal);
+    crash_journal_start(&journal, 240);
+    for (n = 1; n <= 3 * CRASH_JOURNAL_SLOTS + 5; n++)
+        run_period(&journal, n);
+    crash_journal_enter(&journal, 0);
+    crash_journal_enter(&journal, 3); // 卡在 lcd_update 时看门狗复位
+
+    valid = crash_journal_open(&journal);
+    n--;
+    if (valid != CRASH_JOURNAL_SLOTS || journal.boots != 2 || journal.seq != n)
+        bad++;
+    if (journal.reset_stage != 3)
+        stage_bad++;
+    bad += verify(&journal, n - CRASH_JOURNAL_SLOTS + 1, n, 0);
+    check("最近 SLOTS 条、连续、从旧到新", bad);
+    check("复位时阶段", stage_bad);
+
+    crash_journal_format_summary(&journal, stage_names, line, sizeof(line));
+    printf("    %s", line);
+    {
+        int pos = 0;
+        crash_journal_format_entry(crash_journal_next(&journal, &pos), stage_names, value_names, line,
+                                   sizeof(line));
+        printf("    %s", line);
+    }
+
+    // 新的一次运行：序号接着上次，少于 SLOTS 条时从第一条开始
+    crash_journal_start(&journal, 240);
+    first = journal.seq + 1;
+    for (n = first; n < first + 10; n++)
+        run_period(&journal, n);
+    n--;
+    valid = crash_journal_open(&journal);
+    check("第二次运行（未满）", valid != 10 || verify(&journal, n - 9, n, 0) != 0);
+}
+
+static void test_torn(void)
+{
+    uint32_t i, bad = 0;
+
+    printf("  写入中途复位（%d 次）\n", N_ROUNDS);
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+        uint32_t periods = 1 + rng() % (2 * CRASH_JOURNAL_SLOTS), n, last;
+        uint16_t slot;
+        size_t k;
+
+        memset(&journal, 0, sizeof(journal));
+        crash_journal_open(&journal);
+        crash_journal_start(&journal, 240);
+        for (n = 1; n <= periods; n++)
+            run_period(&journal, n);
+
+        // 第 periods + 1 条只写入前 k 字节，head 与 seq 未更新
+        before = journal;
+        slot = journal.head;
+        run_period(&journal, periods + 1);
+        k = 1 + rng() % (sizeof(crash_journal_entry_t) - 1);
+        memcpy((uint8_t *)&journal.ring[slot] + k, (uint8_t *)&before.ring[slot] + k,
+               sizeof(crash_journal_entry_t) - k);
+        journal.head = before.head;
+        journal.seq = before.seq;
+        journal.valid = before.valid;
+        journal.first = before.first;
+
+        crash_journal_open(&journal);
+        last = periods;
+        // 被部分写入的槽原来是 periods + 1 - SLOTS 号记录（若存在），现在两条都无效
+        {
+            uint32_t lo = periods >= CRASH_JOURNAL_SLOTS ? periods - CRASH_JOURNAL_SLOTS + 2 : 1;
+            if (journal.seq != last || verify(&journal, lo, last, periods + 1) != 0)
+                bad++;
+        }
+    }
+    check("部分写入的记录被丢弃", bad);
+}
+
+static void test_bitflip(void)
+{
+    uint32_t i, bad = 0;
+
+    printf("  位翻转（%d 次）\n", N_ROUNDS);
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+        uint32_t n, periods = CRASH_JOURNAL_SLOTS + rng() % CRASH_JOURNAL_SLOTS;
+        uint16_t slot;
+        size_t bit;
+        uint32_t seq;
+
+        memset(&journal, 0, sizeof(journal));
+        crash_journal_open(&journal);
+        crash_journal_start(&journal, 240);
+        for (n = 1; n <= periods; n++)
+            run_period(&journal, n);
+        slot = (uint16_t)(rng() % CRASH_JOURNAL_SLOTS);
+        seq = journal.ring[slot].seq;
+        bit = rng() % (8 * sizeof(crash_journal_entry_t));
+        ((uint8_t *)&journal.ring[slot])[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+
+        if (crash_journal_open(&journal) != CRASH_JOURNAL_SLOTS - 1)
+            bad++;
+        // 被翻转的是最旧或最新一条时，有效范围相应缩小
+        else if (seq == periods - CRASH_JOURNAL_SLOTS + 1)
+            bad += verify(&journal, seq + 1, periods, 0);
+        else if (seq == periods)
+            bad += verify(&journal, periods - CRASH_JOURNAL_SLOTS + 1, periods - 1, 0);
+        else
+            bad += verify(&journal, periods - CRASH_JOURNAL_SLOTS + 1, periods, seq);
+    }
+    check("损坏的记录被丢弃，其余连续", bad);
+}
+
+static void test_speed(void)
+{
+    const uint32_t n = 10000000;
+    float v[CRASH_JOURNAL_VALUES] = {101325.0f, 25.0f, 1.0f, 0.1f};
+    uint64_t t0;
+    uint32_t i;
+
+    crash_journal_start(&journal, 240);
+    t0 = now_ns();
+    for (i = 0; i < n; i++)
+    {
+        crash_journal_enter(&journal, (uint8_t)(i & 7));
+        crash_journal_leave(&journal, (uint8_t)(i & 7), i);
+    }
+    printf("\n耗时（主机）\n  enter + leave      %6.2f ns/次\n", (double)(now_ns() - t0) / n);
+
+    t0 = now_ns();
+    for (i = 0; i < n / 10; i++)
+        crash_journal_commit(&journal, i, 40, v);
+    printf("  commit             %6.2f ns/条（%u 字节记录，含 CRC-32）\n", (double)(now_ns() - t0) / (n / 10),
+           (unsigned)sizeof(crash_journal_entry_t));
+}
+
+int main(void)
+{
+    printf("崩溃日志（%d 条 × %u 字节，共 %u 字节）\n", CRASH_JOURNAL_SLOTS, (unsigned)sizeof(crash_journal_entry_t),
+           (unsigned)sizeof(crash_journal_t));
+    test_power_on();
+    test_reset();
+    test_torn();
+    test_bitflip();
+    test_speed();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file flash_log_test.c
+ * @brief Flash 环形日志主机测试：模拟 NOR Flash 映像上的回绕、重启恢复、写入中途断电和磨损均衡
+ *
+ * @details 模拟 Flash：擦除置 0xFF，编程只能把 1 变为 0（对已编程位置写入 1 计为违规），
+ *          统计每个扇区的擦除次数和读取次数。场景（随机种子固定）：
+ *          - 回绕：随机长度记录写满多圈，随机时刻“重启”（重新 open），写入位置须与重启前一致，
+ *                  遍历结果序号连续、以最新记录结尾、内容与序号对应
+ *          - 断电：随机剩余编程字节数，写入到一半中止（记录头、payload 或扇区头），重启后
+ *                  断电前完整写入的记录全部保留，断电的那条被丢弃，后续写入不对已编程位置重复编程
+ *          - 恢复开销：无映射时统计启动恢复读取的扇区头数（应为 O(log 扇区数)），并测映射模式的耗时
+ *          - 预擦除：写入间隙随机调用 flash_log_reserve，已预擦除时追加不再擦除；跨圈边界随机重启，
+ *                    恢复出的已擦除扇区数与重启前一致，遍历结果仍连续
+ *          - 磨损：多圈后各扇区擦除次数相差不超过 1
+ *
+ *          PlatformIO：
+ *              pio run -e native_flashlog && .pio/build/native_flashlog/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/flash_log_test.c src/flash_log.c -o flash_log_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "flash_log.h"
+
+#define SIM_SECTORS 352 // 与 partitions.csv 中 datalog 分区相同（1408KB）
+#define SIM_SIZE (SIM_SECTORS * FLASH_LOG_SECTOR)
+
+typedef struct
+{
+    uint8_t img[SIM_SIZE];
+    uint32_t erase_count[SIM_SECTORS];
+    uint32_t violations; // 对已编程的 0 写 1
+    int32_t budget;      // 剩余可编程字节数，< 0 表示不限
+    uint32_t reads;
+} sim_flash_t;
+
+static sim_flash_t sim;
+static uint32_t rng_state = 0x85EBCA6Bu;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+static int sim_read(void *ctx, uint32_t addr, void *buf, uint32_t len)
+{
+    sim_flash_t *f = (sim_flash_t *)ctx;
+    if (addr + len > SIM_SIZE)
+        return -1;
+    memcpy(buf, f->img + addr, len);
+    f->reads++;
+    return 0;
+}
+
+static int sim_write(void *ctx, uint32_t addr, const void *buf, uint32_t len)
+{
+    sim_flash_t *f = (sim_flash_t *)ctx;
+    const uint8_t *p = (const uint8_t *)buf;
+    uint32_t i;
+
+    if (addr + len > SIM_SIZE)
+        return -1;
+    for (i = 0; i < len; i++)
+    {
+        if (f->budget == 0)
+            return -1; // 断电：其余字节保持原样
+        if (f->budget > 0)
+            f->budget--;
+        if ((f->img[addr + i] & p[i]) != p[i])
+            f->violations++;
+        f->img[addr + i] &= p[i];
+    }
+    return 0;
+}
+
+static int sim_erase(void *ctx, uint32_t addr)
+{
+    sim_flash_t *f = (sim_flash_t *)ctx;
+    if (addr % FLASH_LOG_SECTOR || addr >= SIM_SIZE || f->budget == 0)
+        return -1;
+    memset(f->img + addr, 0xFF, FLASH_LOG_SECTOR);
+    f->erase_count[addr / FLASH_LOG_SECTOR]++;
+    return 0;
+}
+
+static const flash_log_ops_t sim_ops = {sim_read, sim_write, sim_erase};
+
+/* payload 由序号决定，便于遍历时核对 */
+static uint16_t payload_len(uint32_t seq)
+{
+    uint32_t h = seq * 2654435761u;
+    return (uint16_t)((h >> 8) % 4 == 0 ? (h >> 12) % 1024 : (h >> 12) % 96);
+}
+
+static void make_payload(uint32_t seq, uint8_t *p, uint16_t len)
+{
+    uint16_t i;
+    for (i = 0; i < len; i++)
+        p[i] = (uint8_t)(seq * 31 + i);
+}
+
+#define MAX_SEQ (1u << 18)
+static uint8_t skipped[MAX_SEQ]; // 断电丢失的序号
+
+/* 序号 a 与 b 之间（不含两端）的序号全部因断电丢失 */
+static int gap_ok(uint32_t a, uint32_t b)
+{
+    for (a++; a < b; a++)
+        if (a >= MAX_SEQ || !skipped[a])
+            return 0;
+    return 1;
+}
+
+/*
+ * 遍历并核对：序号严格递增；空缺只能是断电丢失的序号；内容正确；最后一条为 last
+ * @return 不符合的项数；*first 为最旧一条的序号
+ */
+static uint32_t verify(flash_log_t *log, uint32_t last, uint32_t *first, uint32_t *count)
+{
+    static uint8_t buf[FLASH_LOG_MAX_PAYLOAD], want[FLASH_LOG_MAX_PAYLOAD];
+    flash_log_cursor_t c;
+    flash_log_rec_t r;
+    uint32_t bad = 0, n = 0, prev = 0;
+
+    flash_log_rewind(log, &c);
+    while (flash_log_next(log, &c, &r, buf))
+    {
+        if (n == 0)
+            *first = r.seq;
+        else if (r.seq <= prev || !gap_ok(prev, r.seq))
+            bad++;
+        make_payload(r.seq, want, r.len);
+        if (r.len != payload_len(r.seq) || r.type != (uint8_t)r.seq || memcmp(r.data, want, r.len) != 0)
+            bad++;
+        prev = r.seq;
+        n++;
+    }
+    if (n > 0 && prev != last)
+        bad++;
+    *count = n;
+    return bad;
+}
+
+static int append_seq(flash_log_t *log)
+{
+    static uint8_t p[FLASH_LOG_MAX_PAYLOAD];
+    uint32_t seq = log->rec_seq;
+    uint16_t len = payload_len(seq);
+
+    make_payload(seq, p, len);
+    return flash_log_append(log, (uint8_t)seq, p, len);
+}
+
+static void test_wrap(void)
+{
+    flash_log_t log, reopened;
+    uint32_t i, bad = 0, head_bad = 0, first, count, reboots = 0;
+    uint32_t total = 3 * SIM_SIZE / 300; // 约 3 圈
+
+    printf("  回绕 + 随机重启（%lu 条记录）\n", (unsigned long)total);
+    memset(&sim, 0xFF, sizeof(sim.img));
+    sim.budget = -1;
+    flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    for (i = 0; i < total; i++)
+    {
+        if (!append_seq(&log))
+            bad++;
+        if (rng() % 500 == 0 || i == total - 1)
+        {
+            flash_log_open(&reopened, &sim_ops, &sim, (rng() & 1) ? sim.img : NULL, SIM_SIZE);
+            if (reopened.head != log.head || reopened.head_seq != log.head_seq ||
+                reopened.head_off != log.head_off || reopened.rec_seq != log.rec_seq)
+                head_bad++;
+            bad += verify(&reopened, log.rec_seq - 1, &first, &count);
+            log = reopened;
+            reboots++;
+        }
+    }
+    printf("    重启 %lu 次，保留 %lu 条（#%lu 起），占用 %lu B\n", (unsigned long)reboots, (unsigned long)count,
+           (unsigned long)first, (unsigned long)flash_log_used(&log));
+    check("重启后写入位置一致", head_bad);
+    check("遍历连续、内容正确", bad);
+    check("无重复编程", sim.violations);
+}
+
+static void test_preerase(void)
+{
+    flash_log_t log, reopened;
+    uint32_t i, bad = 0, head_bad = 0, burst_erases = 0, first, count, reserved = 0;
+    uint32_t total = 3 * SIM_SIZE / 300;
+
+    printf("  预擦除 + 随机重启（%lu 条记录）\n", (unsigned long)total);
+    memset(&sim, 0xFF, sizeof(sim.img));
+    sim.violations = 0;
+    sim.budget = -1;
+    flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    for (i = 0; i < total; i++)
+    {
+        uint32_t k, erases = 0, had;
+
+        if (rng() % 40 == 0)
+        {
+            // 空闲：预擦除随机个扇区（每次调用最多一个）
+            uint32_t n = rng() % (FLASH_LOG_PREERASE_MAX + 4);
+            while (flash_log_reserve(&log, n) == 1)
+                reserved++;
+        }
+        for (k = 0; k < SIM_SECTORS; k++)
+            erases += sim.erase_count[k];
+        had = log.erased;
+        if (!append_seq(&log))
+            bad++;
+        for (k = 0; k < SIM_SECTORS; k++)
+            erases -= sim.erase_count[k];
+        if (had > 0 && erases != 0)
+            burst_erases++;
+        if (rng() % 300 == 0 || i == total - 1)
+        {
+            flash_log_open(&reopened, &sim_ops, &sim, (rng() & 1) ? sim.img : NULL, SIM_SIZE);
+            // 首圈时前方的空白扇区同样计为已擦除，之后应与重启前完全一致
+            if (reopened.head != log.head || reopened.head_seq != log.head_seq || reopened.rec_seq != log.rec_seq ||
+                reopened.erased < log.erased || (log.head_seq >= SIM_SECTORS && reopened.erased != log.erased))
+                head_bad++;
+            bad += verify(&reopened, log.rec_seq - 1, &first, &count);
+            log = reopened;
+        }
+    }
+    printf("    预擦除 %lu 扇区，保留 %lu 条（#%lu 起）\n", (unsigned long)reserved, (unsigned long)count,
+           (unsigned long)first);
+    check("已预擦除时追加不擦除", burst_erases);
+    check("重启后已擦除扇区数一致", head_bad);
+    check("遍历连续、内容正确", bad);
+    check("无重复编程", sim.violations);
+}
+
+static void test_power_loss(void)
+{
+    flash_log_t log;
+    uint32_t round, bad = 0, lost_bad = 0, first, count, last_ok = 0;
+    uint32_t rounds = 3000;
+
+    printf("  写入中途断电（%lu 次）\n", (unsigned long)rounds);
+    memset(&sim, 0xFF, sizeof(sim.img));
+    sim.violations = 0;
+    sim.budget = -1;
+    flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    for (round = 0; round < rounds; round++)
+    {
+        uint32_t lost;
+
+        // 随机剩余编程字节数，写到断电为止；last_ok 为最后一条完整写入的记录（本轮一条都没写成时沿用上一轮）
+        sim.budget = (int32_t)(rng() % 8192);
+        while (append_seq(&log))
+            last_ok = log.rec_seq - 1;
+        lost = log.rec_seq - 1; // 写入失败的那一条（扇区头失败时序号未分配，lost 为上一条）
+
+        sim.budget = -1;
+        flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+        // 断电的记录头已写出长度时被跳过（序号空缺），否则序号重用；写入位置都在已编程的字节之后
+        if (log.rec_seq == lost + 1 && lost != last_ok && lost < MAX_SEQ)
+            skipped[lost] = 1;
+        else if (log.rec_seq != lost + 1 && (lost == last_ok || log.rec_seq != lost))
+            lost_bad++;
+        bad += verify(&log, last_ok, &first, &count);
+    }
+    check("断电前的记录完整保留", bad);
+    check("断电的记录被跳过", lost_bad);
+    check("无重复编程", sim.violations);
+}
+
+static void test_open_cost(void)
+{
+    flash_log_t log;
+    uint32_t i, k, max_reads = 0, limit = 2;
+    uint64_t t0, dt;
+
+    for (k = SIM_SECTORS; k > 1; k >>= 1)
+        limit++;
+    printf("  启动恢复开销（%d 扇区）\n", SIM_SECTORS);
+    // 写入位置遍布各扇区；从空分区连续写 2 圈，擦除计数供 test_wear 检查
+    memset(&sim, 0xFF, sizeof(sim.img));
+    memset(sim.erase_count, 0, sizeof(sim.erase_count));
+    sim.budget = -1;
+    flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    for (i = 0; i < 2 * SIM_SECTORS * 12; i++)
+    {
+        append_seq(&log);
+        if (i % 7 == 0)
+        {
+            flash_log_t r;
+            flash_log_open(&r, &sim_ops, &sim, NULL, SIM_SIZE);
+            if (r.stats.open_reads > max_reads)
+                max_reads = r.stats.open_reads;
+        }
+    }
+    printf("    读取扇区头最多 %lu 次（上限 %lu）\n", (unsigned long)max_reads, (unsigned long)limit);
+    check("O(log 扇区数) 次扇区头读取", max_reads > limit);
+
+    t0 = now_ns();
+    for (i = 0; i < 10000; i++)
+        flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    dt = now_ns() - t0;
+    printf("    flash_log_open（映射）%.2f us/次（主机）\n", dt / 10000.0 / 1000.0);
+}
+
+static void test_wear(void)
+{
+    uint32_t k, lo = 0xFFFFFFFFu, hi = 0;
+
+    for (k = 0; k < SIM_SECTORS; k++)
+    {
+        if (sim.erase_count[k] < lo)
+            lo = sim.erase_count[k];
+        if (sim.erase_count[k] > hi)
+            hi = sim.erase_count[k];
+    }
+    printf("  磨损：各扇区擦除 %lu ~ %lu 次\n", (unsigned long)lo, (unsigned long)hi);
+    check("擦除次数相差不超过 1", hi - lo > 1);
+}
+
+static void test_speed(void)
+{
+    flash_log_t log;
+    flash_log_cursor_t c;
+    flash_log_rec_t r;
+    uint8_t p[512];
+    uint32_t i, n = 0;
+    uint64_t t0, dt;
+
+    memset(&sim, 0xFF, sizeof(sim.img));
+    sim.budget = -1;
+    flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+    memset(p, 0x5A, sizeof(p));
+    t0 = now_ns();
+    for (i = 0; i < 20000; i++)
+        flash_log_append(&log, 2, p, sizeof(p));
+    dt = now_ns() - t0;
+    printf("\n耗时（主机，不含 Flash 编程 / 擦除时间）\n  flash_log_append 512B   %6.2f us/条\n", dt / 20000.0 / 1000.0);
+
+    t0 = now_ns();
+    flash_log_rewind(&log, &c);
+    while (flash_log_next(&log, &c, &r, NULL))
+        n++;
+    dt = now_ns() - t0;
+    printf("  遍历（映射，含 CRC）     %6.1f MB/s（%lu 条）\n", (double)flash_log_used(&log) / (dt / 1000.0),
+           (unsigned long)n);
+}
+
+int main(void)
+{
+    char line[512];
+
+    printf("Flash 环形日志（模拟 %d 扇区 × %d B）\n", SIM_SECTORS, FLASH_LOG_SECTOR);
+    test_wrap();
+    test_preerase();
+    test_power_loss();
+    test_open_cost();
+    test_wear();
+    test_speed();
+    {
+        flash_log_t log;
+        flash_log_open(&log, &sim_ops, &sim, sim.img, SIM_SIZE);
+        flash_log_format(&log, line, sizeof(line));
+        printf("  %s", line);
+    }
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
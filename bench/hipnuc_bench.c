@@ -0,0 +1,180 @@
+/**
+ * @file hipnuc_bench.c
+ * @brief HiPNUC 解码器主机基准：hipnuc_input / hipnuc_crc16 / parse_data / hipnuc_dump_packet
+ *
+ * @details 用 hipnuc_synth 生成 HI91 / HI81 / HI83 帧，每项测试重复运行至少 min_ms 毫秒，
+ *          输出每帧耗时（ns/frame）、每秒帧数和吞吐量（MB/s，按帧字节数计）。
+ *
+ *          hipnuc_crc16() 与 parse_data() 在 hipnuc_dec.c 中为 static，
+ *          这里直接包含该源文件进行测试（厂商文件保持不变，native 环境不再单独编译它）。
+ *
+ *          PlatformIO：
+ *              pio run -e native && .pio/build/native/program [min_ms] [过滤词]
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/hipnuc_bench.c src/hipnuc_synth.c -o hipnuc_bench
+ *
+ * @note 主机 CPU 的绝对数值与 ESP32 不可比，用于对比同一台机器上修改前后的回归
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/hipnuc_dec.c"
+#include "hipnuc_synth.h"
+
+#define FRAME_CAP HIPNUC_MAX_RAW_SIZE
+#define BATCH 256 // 每批调用次数，摊薄计时开销
+
+typedef struct
+{
+    const char *name;
+    uint8_t frame[FRAME_CAP];
+    int len;
+} bench_frame_t;
+
+static bench_frame_t frames[4];
+static hipnuc_raw_t raw;
+static char dump_buf[1024];
+static volatile uint32_t sink; // 防止结果被优化掉
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ==================== 被测操作（每次处理一帧） ==================== */
+
+static void op_input(const bench_frame_t *f)
+{
+    int i;
+    int r = 0;
+
+    for (i = 0; i < f->len; i++)
+        r += hipnuc_input(&raw, f->frame[i]);
+    sink += (uint32_t)r;
+}
+
+static void op_crc16(const bench_frame_t *f)
+{
+    uint16_t crc = 0;
+
+    hipnuc_crc16(&crc, f->frame, CH_HDR_SIZE - 2);
+    hipnuc_crc16(&crc, f->frame + CH_HDR_SIZE, (uint32_t)(f->len - CH_HDR_SIZE));
+    sink += crc;
+}
+
+static void op_parse(const bench_frame_t *f)
+{
+    (void)f; // 帧已预先载入 raw.buf
+    sink += (uint32_t)parse_data(&raw);
+}
+
+static void op_dump(const bench_frame_t *f)
+{
+    (void)f; // 解码结果已在 raw 中
+    sink += (uint32_t)hipnuc_dump_packet(&raw, dump_buf, sizeof(dump_buf));
+}
+
+/* ==================== 测试框架 ==================== */
+
+static void load_frame(const bench_frame_t *f)
+{
+    memset(&raw, 0, sizeof(raw));
+    memcpy(raw.buf, f->frame, (size_t)f->len);
+    raw.len = f->len - CH_HDR_SIZE;
+}
+
+static void run(const char *op_name, void (*op)(const bench_frame_t *), const bench_frame_t *f,
+                uint32_t min_ms, const char *filter)
+{
+    char name[48];
+    uint64_t calls = 0;
+    uint64_t t0, elapsed;
+    double ns;
+    int i;
+
+    snprintf(name, sizeof(name), "%s/%s", op_name, f->name);
+    if (filter && !strstr(name, filter))
+        return;
+
+    // 准备解码器状态：parse/dump 需要已载入并解码的帧
+    load_frame(f);
+    parse_data(&raw);
+    raw.nbyte = 0;
+
+    // 预热
+    for (i = 0; i < BATCH; i++)
+        op(f);
+
+    t0 = now_ns();
+    do
+    {
+        for (i = 0; i < BATCH; i++)
+            op(f);
+        calls += BATCH;
+        elapsed = now_ns() - t0;
+    } while (elapsed < (uint64_t)min_ms * 1000000ULL);
+
+    ns = (double)elapsed / (double)calls;
+    printf("  %-22s %6d %12.1f %12.0f %10.2f\n",
+           name, f->len, ns, 1e9 / ns, f->len * 1e3 / ns);
+}
+
+/* 核对合成帧能被解码器正确接收，避免测到的是错误路径 */
+static int verify_frames(void)
+{
+    int k, i, ok = 1;
+
+    for (k = 0; k < 4; k++)
+    {
+        int got = 0;
+        memset(&raw, 0, sizeof(raw));
+        for (i = 0; i < frames[k].len; i++)
+            got += hipnuc_input(&raw, frames[k].frame[i]) > 0;
+        if (got != 1)
+        {
+            printf("合成帧 %s 解码失败\n", frames[k].name);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t min_ms = argc > 1 ? (uint32_t)atoi(argv[1]) : 200;
+    const char *filter = argc > 2 ? argv[2] : NULL;
+    int k;
+
+    frames[0].name = "hi91";
+    frames[0].len = hipnuc_synth_hi91(frames[0].frame, FRAME_CAP, 1);
+    frames[1].name = "hi81";
+    frames[1].len = hipnuc_synth_hi81(frames[1].frame, FRAME_CAP, 1);
+    frames[2].name = "hi83_typ";
+    frames[2].len = hipnuc_synth_hi83(frames[2].frame, FRAME_CAP, HIPNUC_SYNTH_HI83_TYPICAL, 1);
+    frames[3].name = "hi83_all";
+    frames[3].len = hipnuc_synth_hi83(frames[3].frame, FRAME_CAP, HIPNUC_SYNTH_HI83_ALL, 1);
+
+    if (!verify_frames())
+        return 1;
+
+    printf("HiPNUC 解码基准（每项至少 %u ms）\n", min_ms);
+    printf("  %-22s %6s %12s %12s %10s\n", "case", "bytes", "ns/frame", "frames/s", "MB/s");
+
+    for (k = 0; k < 4; k++)
+        run("input", op_input, &frames[k], min_ms, filter);
+    for (k = 0; k < 4; k++)
+        run("crc16", op_crc16, &frames[k], min_ms, filter);
+    for (k = 0; k < 4; k++)
+        run("parse", op_parse, &frames[k], min_ms, filter);
+    for (k = 0; k < 4; k++)
+        run("dump", op_dump, &frames[k], min_ms, filter);
+
+    return 0;
+}
@@ -0,0 +1,483 @@
+/**
+ * @file imu_codec_test.c
+ * @brief imu_codec 主机往返测试：编码 → 解码后逐字节比对，并覆盖关键帧边界和损坏输入
+ *
+ * @details 测试场景：
+ *          - 合成 HI91 / HI81 交替流：HI91 解码结果与 imu_codec_quantize_hi91(输入) 逐字节相同，
+ *            HI81 解码结果与原始输入逐字节相同（输入整体随机填充，字段表漏掉任何字节都会暴露）
+ *          - 录制流：hipnuc_synth 生成的完整帧经 hipnuc_dec 解码后再压缩，与设备端数据路径一致；
+ *            命令行给出 RCAP 录制文件时，同样处理录制中的全部 HI91 / HI81 帧
+ *          - 差值极端值：字段在 INT32_MIN / INT32_MAX 之间跳变（32 位回绕差分 + 5 字节 varint）
+ *          - 关键帧：每 key_interval 条一个关键帧，force_key 后下一条为关键帧；
+ *            新解码器从关键帧开始可以还原，从差分记录开始返回 -1
+ *          - 截断：每条记录的所有前缀都返回 0，且不改变解码器状态
+ *          - 损坏：varint 超过 5 字节或第 5 字节超出 32 位返回 -1，未知类型返回 -1
+ *          - 编码缓冲区不足返回 -1，且不改变编码器状态
+ *
+ *          PlatformIO：
+ *              pio run -e native_codec && .pio/build/native_codec/program [录制.rcap]
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/imu_codec_test.c src/imu_codec.c src/hipnuc_dec.c \
+ *                  src/hipnuc_synth.c src/rs485_capture.c -lm -o imu_codec_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hipnuc_dec.h"
+#include "hipnuc_synth.h"
+#include "imu_codec.h"
+#include "rs485_capture.h"
+
+#define KEY_INTERVAL 16
+#define STREAM_RECORDS 600
+#define STREAM_SIZE (STREAM_RECORDS * IMU_CODEC_MAX_RECORD_SIZE)
+
+typedef struct
+{
+    uint8_t is_hi81;
+    hi91_t hi91;
+    hi81_t hi81;
+} imu_rec_t;
+
+static int failures = 0;
+static uint32_t rng_state = 0x1234567u;
+static imu_rec_t recs[STREAM_RECORDS];
+static uint8_t stream[STREAM_SIZE];
+static uint32_t rec_ofs[STREAM_RECORDS + 1];
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static float frand(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(rng() & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+/* ==================== 合成记录 ==================== */
+
+/* 平滑变化的姿态 + 噪声，接近真实 IMU 输出 */
+static void synth_hi91(hi91_t *p, uint32_t i)
+{
+    int k;
+
+    memset(p, 0, sizeof(hi91_t));
+    p->tag = 0x91;
+    p->main_status = (uint16_t)(i & 0x3);
+    p->temp = (int8_t)(25 + (i >> 6) % 5);
+    p->system_time = 1000u + i * 5u;
+    p->air_pressure = 101325.0f + frand(-3.0f, 3.0f);
+    for (k = 0; k < 3; k++)
+    {
+        p->acc[k] = (k == 2 ? 1.0f : 0.0f) + frand(-0.02f, 0.02f);
+        p->gyr[k] = frand(-2.0f, 2.0f);
+        p->mag[k] = 30.0f + frand(-1.0f, 1.0f);
+    }
+    p->roll = frand(-1.0f, 1.0f);
+    p->pitch = frand(-1.0f, 1.0f);
+    p->yaw = -180.0f + (float)(i % 3600) * 0.1f;
+    for (k = 0; k < 4; k++)
+        p->quat[k] = frand(-1.0f, 1.0f);
+}
+
+/* 整体随机填充：任何不在字段表中的字节都会在比对时暴露 */
+static void synth_hi81(hi81_t *p)
+{
+    uint8_t *b = (uint8_t *)p;
+    size_t k;
+
+    for (k = 0; k < sizeof(hi81_t); k++)
+        b[k] = (uint8_t)rng();
+    p->tag = 0x81;
+}
+
+/* ==================== 流编解码 ==================== */
+
+/* 全部记录依次编码到 stream，返回总字节数 */
+static size_t encode_stream(imu_codec_t *c, const imu_rec_t *r, int n)
+{
+    size_t pos = 0;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        int len = r[i].is_hi81 ? imu_codec_encode_hi81(c, &r[i].hi81, stream + pos, STREAM_SIZE - pos)
+                               : imu_codec_encode_hi91(c, &r[i].hi91, stream + pos, STREAM_SIZE - pos);
+        rec_ofs[i] = (uint32_t)pos;
+        if (len <= 0)
+            return 0;
+        pos += (size_t)len;
+    }
+    rec_ofs[n] = (uint32_t)pos;
+    return pos;
+}
+
+/* 从第 first 条记录开始解码到末尾，返回与期望值不一致的条数（解码失败也计入） */
+static int decode_stream(imu_codec_t *c, const imu_rec_t *r, int first, int n)
+{
+    int i, bad = 0;
+
+    for (i = first; i < n; i++)
+    {
+        hi91_t o91, q91;
+        hi81_t o81;
+        size_t len = rec_ofs[n] - rec_ofs[i];
+        int ret = imu_codec_decode(c, stream + rec_ofs[i], len, &o91, &o81);
+
+        if (ret != (int)(rec_ofs[i + 1] - rec_ofs[i]))
+        {
+            bad++;
+            continue;
+        }
+        if (r[i].is_hi81)
+        {
+            bad += memcmp(&o81, &r[i].hi81, sizeof(hi81_t)) != 0;
+        }
+        else
+        {
+            imu_codec_quantize_hi91(&r[i].hi91, &q91);
+            bad += memcmp(&o91, &q91, sizeof(hi91_t)) != 0;
+        }
+    }
+    return bad;
+}
+
+static int roundtrip(const imu_rec_t *r, int n, uint32_t key_interval, imu_codec_t *enc)
+{
+    imu_codec_t dec;
+
+    imu_codec_init(enc, key_interval);
+    imu_codec_init(&dec, key_interval);
+    if (encode_stream(enc, r, n) == 0)
+        return -1;
+    return decode_stream(&dec, r, 0, n);
+}
+
+/* ==================== 测试 ==================== */
+
+static void test_synthetic(void)
+{
+    imu_codec_t enc;
+    int i, n91 = 0;
+
+    printf("  合成流（HI91 / HI81 交替）\n");
+    for (i = 0; i < STREAM_RECORDS; i++)
+    {
+        recs[i].is_hi81 = (i % 5) == 4;
+        if (recs[i].is_hi81)
+            synth_hi81(&recs[i].hi81);
+        else
+            synth_hi91(&recs[i].hi91, n91++);
+    }
+    check("逐字节还原", roundtrip(recs, STREAM_RECORDS, KEY_INTERVAL, &enc) != 0);
+    check("记录数", enc.records != STREAM_RECORDS);
+    check("压缩后小于原始", enc.coded_bytes >= enc.raw_bytes);
+
+    // 量化是幂等的：解码结果再量化不变
+    {
+        hi91_t q1, q2;
+        imu_codec_quantize_hi91(&recs[0].hi91, &q1);
+        imu_codec_quantize_hi91(&q1, &q2);
+        check("量化幂等", memcmp(&q1, &q2, sizeof(hi91_t)) != 0);
+    }
+}
+
+static void test_extremes(void)
+{
+    // gpst_tow 的差值依次为 INT32_MIN、-1、1、INT32_MAX、INT32_MIN（回绕）...
+    static const uint32_t tow[8] = {0, 0x80000000u, 0x7FFFFFFFu, 0x80000000u,
+                                    0xFFFFFFFFu, 0x7FFFFFFFu, 0, 0x80000000u};
+    static const uint8_t max_varint[5] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F}; // ZigZag(INT32_MIN)
+    imu_codec_t enc;
+    uint32_t k;
+    int i, found = 0;
+
+    printf("  差值极端值\n");
+    for (i = 0; i < 8; i++)
+    {
+        uint8_t *b = (uint8_t *)&recs[i].hi81;
+        recs[i].is_hi81 = 1;
+        memset(b, (i & 1) ? 0x7F : 0x80, sizeof(hi81_t)); // 其余字段每条都跨越大半个取值范围
+        if (i >= 6)
+            memset(b, i == 6 ? 0xFF : 0x00, sizeof(hi81_t));
+        recs[i].hi81.tag = 0x81;
+        recs[i].hi81.gpst_tow = tow[i];
+    }
+    check("INT32_MIN <-> INT32_MAX", roundtrip(recs, 8, KEY_INTERVAL, &enc) != 0);
+    for (k = rec_ofs[1]; k + 5 <= rec_ofs[2]; k++)
+        found |= memcmp(stream + k, max_varint, 5) == 0;
+    check("5 字节 varint", !found);
+}
+
+static void test_recorded(void)
+{
+    static uint8_t frame[HIPNUC_MAX_RAW_SIZE];
+    static hipnuc_raw_t raw;
+    imu_codec_t enc;
+    int n = 0, frames = 0, k;
+    uint32_t seq;
+
+    printf("  录制流（hipnuc_synth → hipnuc_dec）\n");
+    memset(&raw, 0, sizeof(raw));
+    for (seq = 0; n < STREAM_RECORDS; seq++)
+    {
+        int len = (seq % 7) == 6 ? hipnuc_synth_hi81(frame, sizeof(frame), seq)
+                                 : hipnuc_synth_hi91(frame, sizeof(frame), seq);
+        for (k = 0; k < len && n < STREAM_RECORDS; k++)
+        {
+            if (hipnuc_input(&raw, frame[k]) <= 0)
+                continue;
+            frames++;
+            recs[n].is_hi81 = raw.hi81.tag == 0x81;
+            recs[n].hi91 = raw.hi91;
+            recs[n].hi81 = raw.hi81;
+            n++;
+        }
+    }
+    check("帧解码", frames != STREAM_RECORDS);
+    check("逐字节还原", roundtrip(recs, n, KEY_INTERVAL, &enc) != 0);
+}
+
+static void test_capture(const char *path)
+{
+    static hipnuc_raw_t raw;
+    rcap_reader_t rd;
+    imu_codec_t enc;
+    uint8_t *cap;
+    const uint8_t *data;
+    uint32_t t_us;
+    uint16_t len;
+    long size;
+    int n = 0, bad = 0, total = 0, k;
+    FILE *f = fopen(path, "rb");
+
+    printf("  录制文件 %s\n", path);
+    if (f == NULL)
+    {
+        check("打开录制", 1);
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    cap = (uint8_t *)malloc(size > 0 ? (size_t)size : 1);
+    if (cap == NULL || fread(cap, 1, (size_t)size, f) != (size_t)size || !rcap_reader_init(&rd, cap, (size_t)size))
+    {
+        fclose(f);
+        free(cap);
+        check("读取录制", 1);
+        return;
+    }
+    fclose(f);
+
+    // 每 STREAM_RECORDS 条为一段，各段独立往返
+    memset(&raw, 0, sizeof(raw));
+    while (rcap_reader_next(&rd, &t_us, &data, &len) > 0)
+    {
+        (void)t_us;
+        for (k = 0; k < len; k++)
+        {
+            if (hipnuc_input(&raw, data[k]) <= 0 || (raw.hi91.tag != 0x91 && raw.hi81.tag != 0x81))
+                continue;
+            recs[n].is_hi81 = raw.hi81.tag == 0x81;
+            recs[n].hi91 = raw.hi91;
+            recs[n].hi81 = raw.hi81;
+            if (++n == STREAM_RECORDS)
+            {
+                bad += roundtrip(recs, n, KEY_INTERVAL, &enc) != 0;
+                total += n;
+                n = 0;
+            }
+        }
+    }
+    if (n > 0)
+    {
+        bad += roundtrip(recs, n, KEY_INTERVAL, &enc) != 0;
+        total += n;
+    }
+    free(cap);
+    printf("    %d 条 HI91 / HI81 记录\n", total);
+    check("逐字节还原", bad != 0);
+}
+
+static void test_keyframes(void)
+{
+    imu_codec_t enc, dec;
+    hi91_t o91;
+    hi81_t o81;
+    int i, bad = 0;
+
+    printf("  关键帧边界\n");
+    for (i = 0; i < 100; i++)
+    {
+        recs[i].is_hi81 = 0;
+        synth_hi91(&recs[i].hi91, i);
+    }
+
+    // 按 key_interval 分布
+    imu_codec_init(&enc, KEY_INTERVAL);
+    encode_stream(&enc, recs, 100);
+    for (i = 0; i < 100; i++)
+        bad += (stream[rec_ofs[i]] == IMU_CODEC_REC_HI91_KEY) != (i % KEY_INTERVAL == 0);
+    check("每 key_interval 条一个关键帧", bad != 0 || enc.keyframes != (100 + KEY_INTERVAL - 1) / KEY_INTERVAL);
+
+    // 新解码器：从关键帧开始可还原，从差分记录开始拒绝
+    imu_codec_init(&dec, KEY_INTERVAL);
+    check("从差分记录开始返回 -1",
+          imu_codec_decode(&dec, stream + rec_ofs[KEY_INTERVAL + 1], rec_ofs[100] - rec_ofs[KEY_INTERVAL + 1], &o91,
+                           &o81) != -1);
+    check("从关键帧开始还原", decode_stream(&dec, recs, KEY_INTERVAL * 2, 100) != 0);
+    check("关键帧前一条（差分）", stream[rec_ofs[KEY_INTERVAL * 2 - 1]] != IMU_CODEC_REC_HI91_DELTA);
+
+    // force_key：下一条立即为关键帧，之后重新计数
+    imu_codec_init(&enc, KEY_INTERVAL);
+    encode_stream(&enc, recs, 5);
+    imu_codec_force_key(&enc);
+    encode_stream(&enc, recs + 5, KEY_INTERVAL + 1);
+    check("force_key 后为关键帧",
+          stream[rec_ofs[0]] != IMU_CODEC_REC_HI91_KEY || stream[rec_ofs[1]] != IMU_CODEC_REC_HI91_DELTA ||
+              stream[rec_ofs[KEY_INTERVAL]] != IMU_CODEC_REC_HI91_KEY);
+    imu_codec_init(&dec, KEY_INTERVAL);
+    check("force_key 后还原", decode_stream(&dec, recs + 5, 0, KEY_INTERVAL + 1) != 0);
+
+    // key_interval = 1：全部为关键帧
+    imu_codec_init(&enc, 1);
+    encode_stream(&enc, recs, 10);
+    check("key_interval = 1", enc.keyframes != 10);
+}
+
+static void test_truncated(void)
+{
+    imu_codec_t enc, dec;
+    hi91_t o91;
+    hi81_t o81;
+    int i, bad = 0, n = 40;
+
+    printf("  截断\n");
+    for (i = 0; i < n; i++)
+    {
+        recs[i].is_hi81 = (i % 3) == 1;
+        if (recs[i].is_hi81)
+            synth_hi81(&recs[i].hi81);
+        else
+            synth_hi91(&recs[i].hi91, i);
+    }
+    imu_codec_init(&enc, 8);
+    encode_stream(&enc, recs, n);
+
+    // 每条记录的每个前缀都返回 0；解码器状态不变，随后完整解码仍然正确
+    imu_codec_init(&dec, 8);
+    for (i = 0; i < n; i++)
+    {
+        uint32_t len = rec_ofs[i + 1] - rec_ofs[i], k;
+        for (k = 0; k < len; k++)
+            bad += imu_codec_decode(&dec, stream + rec_ofs[i], k, &o91, &o81) != 0;
+        bad += decode_stream(&dec, recs, i, i + 1);
+    }
+    check("所有前缀返回 0", bad != 0);
+    check("截断不计入统计", dec.records != (uint32_t)n);
+}
+
+static void test_corrupt(void)
+{
+    imu_codec_t dec;
+    hi91_t o91;
+    hi81_t o81;
+    uint8_t buf[IMU_CODEC_MAX_RECORD_SIZE];
+    int k;
+
+    printf("  损坏输入\n");
+    imu_codec_init(&dec, KEY_INTERVAL);
+    memset(buf, 0, sizeof(buf));
+
+    // 6 字节 varint
+    buf[0] = IMU_CODEC_REC_HI91_KEY;
+    for (k = 1; k <= 5; k++)
+        buf[k] = 0x80;
+    buf[6] = 0x01;
+    check("6 字节 varint 返回 -1", imu_codec_decode(&dec, buf, sizeof(buf), &o91, &o81) != -1);
+    check("6 字节 varint（截断）", imu_codec_decode(&dec, buf, 6, &o91, &o81) != -1);
+
+    // 第 5 字节超出 32 位
+    buf[5] = 0x10;
+    check("第 5 字节超出 32 位", imu_codec_decode(&dec, buf, sizeof(buf), &o91, &o81) != -1);
+
+    // 第 5 字节恰好用满 32 位（ZigZag 0xFFFFFFFF，即 INT32_MIN）：合法。放在第 4 个字段 gpst_tow（u32）
+    memset(buf, 0, sizeof(buf));
+    buf[0] = IMU_CODEC_REC_HI81_KEY;
+    for (k = 4; k <= 7; k++)
+        buf[k] = 0xFF;
+    buf[8] = 0x0F;
+    check("32 位最大 varint 合法", imu_codec_decode(&dec, buf, sizeof(buf), &o91, &o81) != 9 + IMU_CODEC_HI81_FIELDS - 4 ||
+                                     o81.gpst_tow != 0x80000000u);
+
+    // 未知类型与空输入
+    buf[0] = 0x00;
+    check("未知类型返回 -1", imu_codec_decode(&dec, buf, sizeof(buf), &o91, &o81) != -1);
+    buf[0] = 0x91;
+    check("HiPNUC 标签不是记录类型", imu_codec_decode(&dec, buf, sizeof(buf), &o91, &o81) != -1);
+    check("空输入返回 0", imu_codec_decode(&dec, buf, 0, &o91, &o81) != 0);
+}
+
+static void test_encode_short(void)
+{
+    imu_codec_t enc, dec;
+    uint8_t small[8];
+    int i;
+
+    printf("  编码缓冲区不足\n");
+    for (i = 0; i < 3; i++)
+    {
+        recs[i].is_hi81 = 0;
+        synth_hi91(&recs[i].hi91, i);
+    }
+    imu_codec_init(&enc, KEY_INTERVAL);
+    encode_stream(&enc, recs, 1);
+    check("返回 -1", imu_codec_encode_hi91(&enc, &recs[1].hi91, small, sizeof(small)) != -1);
+    check("不计入统计", enc.records != 1);
+
+    // 失败的那条不影响后续：解码器只见到第 0、2 条
+    {
+        imu_rec_t pair[2];
+        uint32_t ofs1 = rec_ofs[1];
+        int len = imu_codec_encode_hi91(&enc, &recs[2].hi91, stream + ofs1, STREAM_SIZE - ofs1);
+
+        pair[0] = recs[0];
+        pair[1] = recs[2];
+        rec_ofs[2] = ofs1 + (uint32_t)(len > 0 ? len : 0);
+        imu_codec_init(&dec, KEY_INTERVAL);
+        check("后续记录仍可还原", len <= 0 || decode_stream(&dec, pair, 0, 2) != 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    printf("imu_codec 往返\n");
+    test_synthetic();
+    test_extremes();
+    test_recorded();
+    if (argc > 1)
+        test_capture(argv[1]);
+    test_keyframes();
+    test_truncated();
+    test_corrupt();
+    test_encode_short();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
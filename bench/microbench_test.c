@@ -0,0 +1,233 @@
+/**
+ * @file microbench_test.c
+ * @brief 微基准注册表主机测试：用可控的模拟计数器核对统计结果，再用真实时钟跑一张示例表
+ *
+ * @details 模拟计数器：每次读取前进固定的 TICK_COST，被测操作按预设序列推进计数器，
+ *          因此每批的真实耗时已知：
+ *          - 计时开销被扣除，最小值 / 中位数 / 最大值与预设序列一致（含偶数批的中位数取整）
+ *          - 预热与计时的调用次数 = (warmup + reps) × batch，teardown 只在 setup 成功后调用
+ *          - setup 失败时整项跳过，run 不被调用
+ *          - 表格行：有字节数时为 MB/s，否则为 op/s
+ *          最后用 clock_gettime（ns）计时，对 memcpy / CRC 跑一次 microbench_suite 作为输出示例。
+ *
+ *          PlatformIO：
+ *              pio run -e native_microbench && .pio/build/native_microbench/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/microbench_test.c src/microbench.c src/hipnuc_synth.c -o microbench_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "microbench.h"
+#include "hipnuc_synth.h"
+
+#define TICK_COST 7
+
+static uint32_t fake_now = 0;
+static uint32_t run_calls, setup_calls, teardown_calls;
+static const uint32_t *op_cost; // 每次 run 推进的周期数，按调用序号循环
+static uint32_t op_cost_len;
+static int failures = 0;
+static uint8_t buf_a[4096], buf_b[4096];
+static volatile uint32_t sink;
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+static uint32_t fake_ticks(void)
+{
+    fake_now += TICK_COST;
+    return fake_now;
+}
+
+static int fake_setup_ok(void *ctx)
+{
+    (void)ctx;
+    setup_calls++;
+    return 0;
+}
+
+static int fake_setup_fail(void *ctx)
+{
+    (void)ctx;
+    setup_calls++;
+    return -1;
+}
+
+static uint32_t fake_run(void *ctx)
+{
+    fake_now += op_cost[run_calls % op_cost_len];
+    run_calls++;
+    return (uint32_t)(uintptr_t)ctx;
+}
+
+static void fake_teardown(void *ctx)
+{
+    (void)ctx;
+    teardown_calls++;
+}
+
+static void reset_counts(const uint32_t *cost, uint32_t n)
+{
+    run_calls = setup_calls = teardown_calls = 0;
+    op_cost = cost;
+    op_cost_len = n;
+}
+
+static void test_stats(void)
+{
+    // 预热 2 批后计时 5 批（batch 1）：耗时 400, 100, 300, 500, 200 → 最小 100，中位 300，最大 500
+    static const uint32_t cost[] = {9999, 9999, 400, 100, 300, 500, 200};
+    microbench_cfg_t cfg = {fake_ticks, 1, 2, 5};
+    microbench_t b = {"fake", fake_setup_ok, fake_run, fake_teardown, (void *)(uintptr_t)64, 1};
+    microbench_result_t r;
+
+    printf("  统计（模拟计数器）\n");
+    reset_counts(cost, 7);
+    microbench_run(&b, &cfg, &r);
+    check("扣除计时开销", r.overhead != TICK_COST);
+    check("最小 / 中位 / 最大", r.min != 100 || r.median != 300 || r.max != 500 || r.reps != 5);
+    check("预热 + 计时调用次数", run_calls != 7 || setup_calls != 1 || teardown_calls != 1);
+    check("字节数", r.bytes != 64);
+
+    // batch 4：每批 4 次，各批总耗时 40, 48, 56, 64 → 每次 10, 12, 14, 16，偶数批中位数 (12 + 14) / 2
+    {
+        static const uint32_t cost4[] = {10, 10, 10, 10, 12, 12, 12, 12, 14, 14, 14, 14, 16, 16, 16, 16};
+        microbench_cfg_t cfg4 = {fake_ticks, 1, 0, 4};
+        b.batch = 4;
+        reset_counts(cost4, 16);
+        microbench_run(&b, &cfg4, &r);
+        check("batch 平均与偶数批中位数", r.min != 10 || r.median != 13 || r.max != 16 || run_calls != 16);
+    }
+
+    // reps 超过上限时截断
+    {
+        static const uint32_t cost1[] = {5};
+        microbench_cfg_t big = {fake_ticks, 1, 0, 1000};
+        b.batch = 1;
+        reset_counts(cost1, 1);
+        microbench_run(&b, &big, &r);
+        check("reps 上限", r.reps != MICROBENCH_MAX_REPS || run_calls != MICROBENCH_MAX_REPS || r.median != 5);
+    }
+}
+
+static void test_skip(void)
+{
+    static const uint32_t cost[] = {1};
+    microbench_cfg_t cfg = {fake_ticks, 1, 3, 5};
+    microbench_t b = {"absent", fake_setup_fail, fake_run, fake_teardown, NULL, 8};
+    microbench_result_t r;
+    char line[256];
+
+    printf("  跳过（setup 失败）\n");
+    reset_counts(cost, 1);
+    check("返回 1 且不运行", microbench_run(&b, &cfg, &r) != 1 || !r.skipped || run_calls != 0 || teardown_calls != 0);
+    microbench_format_row(&b, &r, 240, line, sizeof(line));
+    check("表格行标注跳过", strstr(line, "absent") == NULL || strstr(line, "跳过") == NULL);
+}
+
+static void test_format(void)
+{
+    microbench_t b = {"crc", NULL, fake_run, NULL, NULL, 16};
+    microbench_result_t r;
+    char line[256];
+
+    printf("  表格行\n");
+    memset(&r, 0, sizeof(r));
+    r.reps = 20;
+    r.min = 2300;
+    r.median = 2400;
+    r.max = 9000;
+    r.bytes = 256;
+    microbench_format_row(&b, &r, 240, line, sizeof(line)); // 10 us / 256 B = 25.6 MB/s
+    check("MB/s", strstr(line, "25.60 MB/s") == NULL || strstr(line, "10.00") == NULL || strstr(line, "16 x 20") == NULL);
+    r.bytes = 0;
+    microbench_format_row(&b, &r, 240, line, sizeof(line)); // 10 us → 100000 op/s
+    check("op/s", strstr(line, "100000 op/s") == NULL);
+    check("截断", microbench_format_row(&b, &r, 240, line, 10) != 9 || strlen(line) != 9);
+}
+
+/* ==================== 真实时钟示例 ==================== */
+
+static uint32_t ns_ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+static uint32_t op_memcpy(void *ctx)
+{
+    (void)ctx;
+    memcpy(buf_b, buf_a, sizeof(buf_a));
+    sink += buf_b[sink & 0xFFF];
+    return sizeof(buf_a);
+}
+
+static uint32_t op_crc16(void *ctx)
+{
+    (void)ctx;
+    sink += hipnuc_synth_crc16(0, buf_a, 256);
+    return 256;
+}
+
+static uint32_t op_hi91(void *ctx)
+{
+    (void)ctx;
+    return (uint32_t)hipnuc_synth_hi91(buf_b, sizeof(buf_b), sink++);
+}
+
+static uint32_t op_malloc(void *ctx)
+{
+    void *p = malloc(256);
+    (void)ctx;
+    sink += (uint32_t)(uintptr_t)p;
+    free(p);
+    return 0;
+}
+
+static void print_text(const char *text)
+{
+    fputs(text, stdout);
+}
+
+static void run_example(void)
+{
+    static const microbench_t list[] = {
+        {"memcpy_4k", NULL, op_memcpy, NULL, NULL, 16},
+        {"crc16_bitwise", NULL, op_crc16, NULL, NULL, 16},
+        {"hi91_synth", NULL, op_hi91, NULL, NULL, 64},
+        {"heap_256", NULL, op_malloc, NULL, NULL, 64},
+        {"absent", fake_setup_fail, op_malloc, NULL, NULL, 1},
+    };
+    microbench_cfg_t cfg = {ns_ticks, 1000, 5, 21}; // 计数单位为 ns，表中 cyc 列即 ns
+    size_t i;
+    int done;
+
+    for (i = 0; i < sizeof(buf_a); i++)
+        buf_a[i] = (uint8_t)(i * 7);
+    printf("\n示例表（主机，cyc 列为 ns）\n");
+    done = microbench_suite(list, (int)(sizeof(list) / sizeof(list[0])), &cfg, print_text);
+    check("完成项数", done != 4);
+}
+
+int main(void)
+{
+    printf("微基准注册表\n");
+    test_stats();
+    test_skip();
+    test_format();
+    run_example();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
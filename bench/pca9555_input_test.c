@@ -0,0 +1,296 @@
+/**
+ * @file pca9555_input_test.c
+ * @brief PCA9555 输入服务主机测试：用合成的端口读数序列验证逐引脚消抖与边沿事件
+ *
+ * @details 场景：
+ *          - 干净边沿：消抖到期前不产生事件，到期后产生一个事件，时间戳为边沿时刻
+ *          - 抖动边沿：多次抖动后停在新电平，只产生一个事件，时间戳为第一次边沿，到期时刻按最后一次边沿计算
+ *          - 毛刺：窗口内恢复原电平，不产生事件，计为 bounce
+ *          - 多引脚：各自独立计时；未监视的引脚不产生边沿
+ *          - micros() 回绕：时间戳跨越 0xFFFFFFFF 时消抖正常
+ *          - 队列：先进先出，满时丢弃并计入 overflow
+ *          - 随机轨迹：16 个引脚各自按随机节奏按下 / 松开（带抖动）或出现毛刺，
+ *            每次电平变化模拟一次 INT 读端口，主循环每 1ms poll；事件序列须与真实跳变逐一对应，
+ *            且确认延迟不超过 debounce + poll 周期
+ *
+ *          PlatformIO：
+ *              pio run -e native_pca9555_in && .pio/build/native_pca9555_in/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/pca9555_input_test.c src/pca9555_input.c -o pca9555_input_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pca9555_input.h"
+
+#define DEBOUNCE_US 10000
+#define TICK_US 100        // 随机轨迹的时间分辨率
+#define POLL_US 1000       // 主循环 poll 周期
+#define TRACE_US 30000000u // 随机轨迹时长
+#define MAX_EXPECT 4096
+
+typedef struct
+{
+    uint8_t level;    // 当前输出电平
+    uint8_t start;    // 本轮开始前的电平
+    uint8_t target;   // 本轮结束后的电平
+    uint8_t edges;    // 本轮剩余的边沿数
+    uint32_t first;   // 本轮第一次边沿时刻（0 表示尚未开始）
+    uint32_t next_us; // 下一次边沿时刻
+} pin_model_t;
+
+static uint32_t rng_state = 0x2545F491u;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+static int pop_all(pca9555_in_t *in, pca9555_in_event_t *ev, int max)
+{
+    int n = 0;
+    while (n < max && pca9555_in_pop(in, &ev[n]))
+        n++;
+    return n;
+}
+
+/* ==================== 固定场景 ==================== */
+
+static void test_clean(void)
+{
+    pca9555_in_t in;
+    pca9555_in_event_t ev[4];
+
+    printf("  干净边沿\n");
+    pca9555_in_init(&in, 0xFFFF, 0xFFFF, DEBOUNCE_US);
+    check("空闲时不忙", pca9555_in_busy(&in));
+    pca9555_in_update(&in, 0xFFFE, 1000);
+    check("边沿后忙", !pca9555_in_busy(&in));
+    check("到期前无事件", pca9555_in_poll(&in, 1000 + DEBOUNCE_US - 1) != 0 || pop_all(&in, ev, 4) != 0);
+    check("到期产生事件", pca9555_in_poll(&in, 1000 + DEBOUNCE_US) != 1);
+    check("事件内容", pop_all(&in, ev, 4) != 1 || ev[0].pin != 0 || ev[0].level != 0 || ev[0].t_us != 1000);
+    check("确认后不忙", pca9555_in_busy(&in) || in.stable != 0xFFFE);
+
+    pca9555_in_update(&in, 0xFFFF, 50000);
+    pca9555_in_poll(&in, 50000 + DEBOUNCE_US);
+    check("松开事件", pop_all(&in, ev, 4) != 1 || ev[0].level != 1 || ev[0].t_us != 50000);
+    check("统计", in.stats.edges != 2 || in.stats.events != 2 || in.stats.bounces != 0);
+}
+
+static void test_bounce(void)
+{
+    static const uint32_t t[] = {2000, 2300, 2900, 3100, 4500}; // 奇数次边沿，最终为低
+    pca9555_in_t in;
+    pca9555_in_event_t ev[4];
+    int i;
+
+    printf("  抖动边沿\n");
+    pca9555_in_init(&in, 0x0010, 0x0010, DEBOUNCE_US);
+    for (i = 0; i < 5; i++)
+        pca9555_in_update(&in, (i & 1) ? 0x0010 : 0x0000, t[i]);
+    check("按最后一次边沿计时", pca9555_in_poll(&in, 4500 + DEBOUNCE_US - 1) != 0);
+    check("只产生一个事件", pca9555_in_poll(&in, 4500 + DEBOUNCE_US) != 1 || pop_all(&in, ev, 4) != 1);
+    check("时间戳为第一次边沿", ev[0].pin != 4 || ev[0].level != 0 || ev[0].t_us != 2000);
+    check("边沿计数", in.stats.edges != 5 || in.stats.bounces != 0);
+
+    // 毛刺：按下后 3ms 恢复
+    pca9555_in_init(&in, 0x0010, 0x0010, DEBOUNCE_US);
+    pca9555_in_update(&in, 0x0000, 10000);
+    pca9555_in_update(&in, 0x0010, 13000);
+    pca9555_in_poll(&in, 13000 + DEBOUNCE_US);
+    check("毛刺不产生事件", pop_all(&in, ev, 4) != 0 || in.stats.bounces != 1 || pca9555_in_busy(&in));
+}
+
+static void test_pins(void)
+{
+    pca9555_in_t in;
+    pca9555_in_event_t ev[4];
+
+    printf("  多引脚与掩码\n");
+    pca9555_in_init(&in, 0x8001, 0xFFFF, DEBOUNCE_US);
+    pca9555_in_update(&in, 0x7FFE, 0);           // P0.0 与 P1.7 同时变低，其余未监视
+    pca9555_in_update(&in, 0x7FFF, 4000);        // P0.0 抖回高电平
+    pca9555_in_update(&in, 0x7FFE, 6000);        // P0.0 再次变低
+    check("未监视引脚不计边沿", in.stats.edges != 4);
+    check("P1.7 先确认", pca9555_in_poll(&in, DEBOUNCE_US) != 1 || pop_all(&in, ev, 4) != 1 || ev[0].pin != 15);
+    check("P0.0 独立计时", pca9555_in_poll(&in, 6000 + DEBOUNCE_US - 1) != 0 ||
+                              pca9555_in_poll(&in, 6000 + DEBOUNCE_US) != 1);
+    check("P0.0 事件", pop_all(&in, ev, 4) != 1 || ev[0].pin != 0 || ev[0].level != 0 || ev[0].t_us != 0);
+    check("消抖后电平", in.stable != 0x0000);
+}
+
+static void test_wrap(void)
+{
+    pca9555_in_t in;
+    pca9555_in_event_t ev[4];
+    uint32_t t0 = 0xFFFFFFFFu - 3000;
+
+    printf("  micros() 回绕\n");
+    pca9555_in_init(&in, 0x0002, 0x0000, DEBOUNCE_US);
+    pca9555_in_update(&in, 0x0002, t0);
+    check("跨越回绕前不确认", pca9555_in_poll(&in, t0 + DEBOUNCE_US - 1) != 0);
+    check("跨越回绕后确认", pca9555_in_poll(&in, t0 + DEBOUNCE_US) != 1);
+    check("时间戳", pop_all(&in, ev, 4) != 1 || ev[0].level != 1 || ev[0].t_us != t0);
+}
+
+static void test_queue(void)
+{
+    pca9555_in_t in;
+    pca9555_in_event_t ev[PCA9555_IN_QUEUE_LEN];
+    uint32_t t = 0;
+    int i, n, bad = 0;
+
+    printf("  事件队列\n");
+    pca9555_in_init(&in, 0x0001, 0x0001, DEBOUNCE_US);
+    for (i = 0; i < PCA9555_IN_QUEUE_LEN + 8; i++)
+    {
+        pca9555_in_update(&in, (i & 1) ? 0x0001 : 0x0000, t);
+        pca9555_in_poll(&in, t + DEBOUNCE_US);
+        t += 2 * DEBOUNCE_US;
+    }
+    n = pop_all(&in, ev, PCA9555_IN_QUEUE_LEN);
+    for (i = 0; i < n; i++)
+        bad += ev[i].level != (uint8_t)(i & 1) || ev[i].t_us != (uint32_t)i * 2 * DEBOUNCE_US;
+    check("容量", n != PCA9555_IN_QUEUE_LEN - 1);
+    check("先进先出", bad != 0);
+    check("满时丢弃", in.stats.overflow != 9 || in.stats.events != PCA9555_IN_QUEUE_LEN - 1);
+    check("溢出时电平仍跟随", pca9555_in_pop(&in, ev) != 0 || in.stable != 0x0001);
+}
+
+/* ==================== 随机轨迹 ==================== */
+
+/* 开始下一轮：75% 为真实跳变（奇数个边沿），其余为毛刺（偶数个边沿，回到原电平） */
+static void model_next(pin_model_t *m, uint32_t now)
+{
+    int glitch = (rng() & 3) == 0;
+
+    m->start = m->level;
+    m->first = 0;
+    m->target = glitch ? m->level : (uint8_t)!m->level;
+    m->edges = (uint8_t)(glitch ? 2 * rng_range(1, 3) : 2 * rng_range(0, 3) + 1);
+    m->next_us = now + rng_range(DEBOUNCE_US + 2 * POLL_US, 300000); // 保持时间长于消抖窗口
+}
+
+static void test_random(void)
+{
+    static pin_model_t pins[16];
+    static uint32_t expect_t[16][MAX_EXPECT];
+    static uint8_t expect_level[16][MAX_EXPECT];
+    static int n_expect[16], n_seen[16];
+    pca9555_in_t in;
+    pca9555_in_event_t ev;
+    uint16_t port = 0;
+    uint32_t now, max_latency = 0;
+    uint32_t order_bad = 0, latency_bad = 0, truth = 0, glitches = 0;
+    int p;
+
+    printf("  随机轨迹（16 引脚，%u 秒）\n", TRACE_US / 1000000u);
+    for (p = 0; p < 16; p++)
+    {
+        pins[p].level = (uint8_t)(rng() & 1);
+        port |= (uint16_t)(pins[p].level << p);
+        model_next(&pins[p], 0);
+    }
+    pca9555_in_init(&in, 0xFFFF, port, DEBOUNCE_US);
+
+    for (now = TICK_US; now <= TRACE_US; now += TICK_US)
+    {
+        uint16_t next_port = port;
+
+        for (p = 0; p < 16; p++)
+        {
+            pin_model_t *m = &pins[p];
+            if (now < m->next_us)
+                continue;
+            if (m->first == 0)
+                m->first = now;
+            m->level = (uint8_t)!m->level;
+            m->edges--;
+            if (m->edges > 0)
+            {
+                m->next_us = now + rng_range(TICK_US, 2000); // 抖动间隔远小于消抖窗口
+                continue;
+            }
+            if (m->target != m->start && n_expect[p] < MAX_EXPECT)
+            {
+                expect_t[p][n_expect[p]] = m->first;
+                expect_level[p][n_expect[p]] = m->target;
+                n_expect[p]++;
+                truth++;
+            }
+            else
+            {
+                glitches++;
+            }
+            model_next(m, now);
+        }
+        for (p = 0; p < 16; p++)
+            next_port = (uint16_t)((next_port & ~(1u << p)) | (pins[p].level << p));
+
+        // 电平变化即 INT，读一次端口
+        if (next_port != port)
+        {
+            port = next_port;
+            pca9555_in_update(&in, port, now);
+        }
+        if (now % POLL_US == 0 && pca9555_in_busy(&in))
+            pca9555_in_poll(&in, now);
+
+        while (pca9555_in_pop(&in, &ev))
+        {
+            int k = n_seen[ev.pin]++;
+            uint32_t lat = now - in.last_us[ev.pin];
+
+            if (k >= n_expect[ev.pin] || expect_t[ev.pin][k] != ev.t_us || expect_level[ev.pin][k] != ev.level)
+                order_bad++;
+            if (lat < DEBOUNCE_US || lat > DEBOUNCE_US + POLL_US)
+                latency_bad++;
+            if (lat > max_latency)
+                max_latency = lat;
+        }
+    }
+
+    for (p = 0; p < 16; p++)
+        order_bad += (uint32_t)abs(n_expect[p] - n_seen[p]);
+    printf("    真实跳变 %lu，毛刺 %lu，边沿 %lu，bounce %lu，最大确认延迟 %lu us\n", (unsigned long)truth,
+           (unsigned long)glitches, (unsigned long)in.stats.edges, (unsigned long)in.stats.bounces,
+           (unsigned long)max_latency);
+    check("事件与真实跳变一一对应", order_bad != 0 || in.stats.events != truth);
+    check("毛刺全部计为 bounce", in.stats.bounces != glitches);
+    check("确认延迟", latency_bad != 0);
+    check("无溢出", in.stats.overflow != 0);
+}
+
+int main(void)
+{
+    printf("PCA9555 输入消抖\n");
+    test_clean();
+    test_bounce();
+    test_pins();
+    test_wrap();
+    test_queue();
+    test_random();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file rate_est_test.c
+ * @brief 帧率估计主机测试：用带抖动、丢帧和变频的合成时间戳序列核对估计结果
+ *
+ * @details 场景（随机种子固定，样本间隔 = 标称间隔 + 均匀抖动）：
+ *          - 稳态：400Hz ±3% 抖动，平均间隔 / 频率误差 < 0.5%，抖动估计接近 E|抖动|，直方图只落在 ≤5% 的桶
+ *          - 丢帧：100Hz 随机丢 1~5 帧，间断次数与估计漏帧数和实际完全一致，平均间隔不受影响
+ *          - 降频：100Hz → 25Hz，前 RATE_EST_RELOCK - 1 次记为间断，随后重新锁定到新间隔
+ *          - 升频：50Hz → 200Hz，不计间断，EWMA 收敛到新间隔
+ *          - 停止：数据源停止后频率按 1 / 距上一样本的时间衰减
+ *          - micros() 回绕：时间戳跨越 0xFFFFFFFF 不产生间断
+ *          - 边界：0 / 1 个样本时频率为 0；错误与字节数计入快照；reset 保留名称；格式化输出截断安全
+ *
+ *          PlatformIO：
+ *              pio run -e native_rate && .pio/build/native_rate/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/rate_est_test.c src/rate_est.c -lm -o rate_est_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rate_est.h"
+
+static uint32_t rng_state = 0x6C8E9CF5u;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* 均匀分布 [-j, j] 的整数抖动 */
+static int32_t jitter(uint32_t j)
+{
+    return j ? (int32_t)(rng() % (2 * j + 1)) - (int32_t)j : 0;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+static int near(float v, float ref, float rel)
+{
+    return fabsf(v - ref) <= rel * fabsf(ref);
+}
+
+/* 按标称间隔 period_us ± j_us 送入 n 个样本，返回最后一个样本的时刻 */
+static uint32_t feed(rate_est_t *r, uint32_t t, uint32_t period_us, uint32_t j_us, int n, uint16_t bytes)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        t += (uint32_t)((int32_t)period_us + jitter(j_us));
+        rate_est_sample(r, t, bytes);
+    }
+    return t;
+}
+
+static void test_steady(void)
+{
+    rate_est_t r;
+    uint32_t t, small = 0, large = 0;
+    int i;
+
+    printf("  稳态 400Hz ±3%%\n");
+    rate_est_init(&r, "imu");
+    rate_est_sample(&r, 1000, 40);
+    t = feed(&r, 1000, 2500, 75, 4000, 40);
+    for (i = 0; i < 3; i++)
+        small += r.hist[i];
+    for (i = 3; i < RATE_EST_HIST_BINS; i++)
+        large += r.hist[i];
+    printf("    平均间隔 %.1f us，抖动 %.1f us，频率 %.2f Hz\n", r.avg_dt_us, r.jitter_us, rate_est_hz(&r, t));
+    check("平均间隔", !near(r.avg_dt_us, 2500.0f, 0.005f));
+    check("频率", !near(rate_est_hz(&r, t), 400.0f, 0.005f));
+    check("抖动接近 E|u| = 37.5 us", !near(r.jitter_us, 37.5f, 0.3f));
+    check("无间断", r.gaps != 0 || r.missed != 0);
+    check("直方图 ≤5%", small != 3999 || large != 0);
+    check("最大间隔", r.dt_max_us > 2575 || r.dt_max_us < 2500);
+}
+
+static void test_gaps(void)
+{
+    rate_est_t r;
+    uint32_t t = 0, dropped = 0, runs = 0;
+    int i;
+
+    printf("  随机丢帧（100Hz ±2%%）\n");
+    rate_est_init(&r, "hi91");
+    t = feed(&r, t, 10000, 200, 50, 0);
+    for (i = 0; i < 200; i++)
+    {
+        if ((rng() & 7) == 0)
+        {
+            uint32_t lost = 1 + rng() % 5;
+            t += lost * 10000;
+            dropped += lost;
+            runs++;
+        }
+        t = feed(&r, t, 10000, 200, 1 + (int)(rng() % 8), 0);
+    }
+    printf("    丢失 %lu 帧 / %lu 段，估计漏 %lu / 间断 %lu\n", (unsigned long)dropped, (unsigned long)runs,
+           (unsigned long)r.missed, (unsigned long)r.gaps);
+    check("间断次数", r.gaps != runs || r.hist[RATE_EST_HIST_BINS - 1] != runs);
+    check("估计漏帧", r.missed != dropped);
+    check("平均间隔不受间断影响", !near(r.avg_dt_us, 10000.0f, 0.005f));
+    check("最大间隔", r.dt_max_us < 50000);
+}
+
+static void test_rate_change(void)
+{
+    rate_est_t r;
+    uint32_t t, gaps;
+
+    printf("  变频\n");
+    rate_est_init(&r, "dps310");
+    t = feed(&r, 0, 10000, 100, 100, 0);
+    t = feed(&r, t, 40000, 400, RATE_EST_RELOCK - 1, 0);
+    gaps = r.gaps;
+    check("降频前几帧记为间断", gaps != RATE_EST_RELOCK - 1 || !near(r.avg_dt_us, 10000.0f, 0.01f));
+    t = feed(&r, t, 40000, 400, 1, 0);
+    check("重新锁定", r.gaps != RATE_EST_RELOCK || !near(r.avg_dt_us, 40000.0f, 0.02f) || r.jitter_us != 0.0f);
+    t = feed(&r, t, 40000, 400, 100, 0);
+    check("降频后稳定", r.gaps != RATE_EST_RELOCK || !near(rate_est_hz(&r, t), 25.0f, 0.01f));
+
+    // 升频：间隔变短不是间断，EWMA 每样本收敛 1/16
+    rate_est_init(&r, "enc");
+    t = feed(&r, 0, 20000, 0, 100, 0);
+    t = feed(&r, t, 5000, 50, 150, 0);
+    check("升频不计间断", r.gaps != 0);
+    check("升频收敛", !near(rate_est_hz(&r, t), 200.0f, 0.01f));
+}
+
+static void test_stop_wrap(void)
+{
+    rate_est_t r;
+    uint32_t t;
+
+    printf("  停止与回绕\n");
+    rate_est_init(&r, "imu");
+    t = feed(&r, 0xFFFFFFFFu - 500000u, 2500, 50, 400, 0); // 跨越回绕
+    check("回绕无间断", r.gaps != 0 || r.dt_max_us > 2550 || !near(r.avg_dt_us, 2500.0f, 0.01f));
+    check("停止前频率", !near(rate_est_hz(&r, t + 1000), 400.0f, 0.01f));
+    check("停止 100ms", !near(rate_est_hz(&r, t + 100000), 10.0f, 0.001f));
+    check("停止 10s", !near(rate_est_hz(&r, t + 10000000), 0.1f, 0.001f));
+}
+
+static void test_edges(void)
+{
+    rate_est_t r;
+    rate_est_snapshot_t s;
+    char buf[512];
+    int n;
+
+    printf("  边界与输出\n");
+    rate_est_init(&r, "hi83");
+    check("无样本频率 0", rate_est_hz(&r, 12345) != 0.0f);
+    rate_est_sample(&r, 1000, 60);
+    check("单个样本频率 0", rate_est_hz(&r, 2000) != 0.0f);
+    rate_est_sample(&r, 3500, 80);
+    rate_est_error(&r, 3);
+    rate_est_snapshot(&r, 4500, &s);
+    check("快照", s.samples != 2 || s.errors != 3 || s.age_us != 1000 || s.bytes_per_frame != 70.0f ||
+                      !near(s.hz, 400.0f, 0.001f));
+
+    n = rate_est_format(&r, 4500, buf, sizeof(buf));
+    check("格式化", n != (int)strlen(buf) || strstr(buf, "hi83") == NULL || strstr(buf, "间断") == NULL);
+    n = rate_est_format(&r, 4500, buf, 20);
+    check("截断", n != 19 || strlen(buf) != 19);
+    check("零长度缓冲", rate_est_format(&r, 4500, buf, 0) != 0);
+
+    rate_est_reset(&r);
+    check("reset 保留名称", r.samples != 0 || r.errors != 0 || r.name == NULL || strcmp(r.name, "hi83") != 0);
+}
+
+int main(void)
+{
+    printf("帧率估计\n");
+    test_steady();
+    test_gaps();
+    test_rate_change();
+    test_stop_wrap();
+    test_edges();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
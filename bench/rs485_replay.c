@@ -0,0 +1,342 @@
+/**
+ * @file rs485_replay.c
+ * @brief RS485 录制重放工具：把 RCAP 录制送入 HiPNUC 解码 + imu_codec 压缩（或 Modbus RTU 解帧），输出帧率/延迟/丢帧报告
+ *
+ * @details 录制来源：test/imu_sd_logger.cpp 的 'c' 命令（imu_raw.rcap），或本工具 --make 生成的合成录制。
+ *          同一个录制重复重放，确定性指标完全相同，可用于比较解码器修改前后的差异，
+ *          以及区分帧率波动来自 IMU 输出本身还是设备主循环读取不及时（交付延迟、最大读取间隔）。
+ *
+ *          用法：
+ *              rs485_replay <录制.rcap> [-s 倍速] [-r 标称帧率Hz] [-m]
+ *                  -s 1 按录制节奏重放（默认不限速）；-s 10 十倍速
+ *                  -r 50 按 50Hz 估计漏帧
+ *                  -m 同时按 Modbus RTU 解帧（RS485_1 编码器总线录制）
+ *              rs485_replay --make <输出.rcap> [帧数] [帧率Hz]
+ *                  生成带发送抖动、主循环卡顿、丢帧和误码的 HI91 合成录制（固定随机种子）
+ *
+ *          PlatformIO：pio run -e native_replay && .pio/build/native_replay/program ...
+ *
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hipnuc_dec.h"
+#include "hipnuc_synth.h"
+#include "imu_codec.h"
+#include "replay.h"
+#include "rs485_capture.h"
+
+#define DEFAULT_BAUD 115200
+#define KEY_INTERVAL 400
+
+/* ==================== 主机时钟 ==================== */
+
+static uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void host_sleep_ns(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    nanosleep(&ts, NULL);
+}
+
+static const replay_clock_t host_clock = {host_now_ns, host_sleep_ns};
+
+/* ==================== HiPNUC 解码 + 压缩 ==================== */
+
+typedef struct
+{
+    hipnuc_raw_t raw;
+    imu_codec_t codec;
+    uint8_t rec[IMU_CODEC_MAX_RECORD_SIZE];
+} hipnuc_sink_t;
+
+static int hipnuc_sink_input(void *ctx, uint8_t byte, uint32_t t_us, uint32_t *done_us)
+{
+    hipnuc_sink_t *h = (hipnuc_sink_t *)ctx;
+    int ret = hipnuc_input(&h->raw, byte);
+
+    (void)t_us;
+    (void)done_us;
+    if (ret <= 0)
+        return ret;
+
+    // 下游：与 imu_sd_logger 相同的压缩记录
+    if (h->raw.hi91.tag == 0x91)
+        imu_codec_encode_hi91(&h->codec, &h->raw.hi91, h->rec, sizeof(h->rec));
+    else if (h->raw.hi81.tag == 0x81)
+        imu_codec_encode_hi81(&h->codec, &h->raw.hi81, h->rec, sizeof(h->rec));
+    return 1;
+}
+
+/* ==================== Modbus RTU 解帧 ==================== */
+
+typedef struct
+{
+    uint8_t buf[256];
+    uint16_t len;
+    uint32_t last_us;
+    uint32_t silent_us; // 3.5 字符时间
+} modbus_sink_t;
+
+static uint16_t modbus_crc16(const uint8_t *p, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+    int b;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= p[i];
+        for (b = 0; b < 8; b++)
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+/* 结束当前帧：长度 ≥4 且 CRC 正确为有效帧 */
+static int modbus_close(modbus_sink_t *m, uint32_t *done_us)
+{
+    int ok;
+
+    if (m->len == 0)
+        return 0;
+    ok = m->len >= 4 && modbus_crc16(m->buf, m->len) == 0;
+    *done_us = m->last_us + m->silent_us;
+    m->len = 0;
+    return ok ? 1 : -1;
+}
+
+static int modbus_sink_input(void *ctx, uint8_t byte, uint32_t t_us, uint32_t *done_us)
+{
+    modbus_sink_t *m = (modbus_sink_t *)ctx;
+    int ret = 0;
+
+    if (m->len > 0 && t_us - m->last_us > m->silent_us)
+        ret = modbus_close(m, done_us);
+    if (m->len < sizeof(m->buf))
+        m->buf[m->len++] = byte;
+    m->last_us = t_us;
+    return ret;
+}
+
+static int modbus_sink_flush(void *ctx, uint32_t t_us, uint32_t *done_us)
+{
+    (void)t_us;
+    return modbus_close((modbus_sink_t *)ctx, done_us);
+}
+
+/* ==================== 合成录制 ==================== */
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * @brief 模拟 IMU 以 rate_hz 发送 HI91（±10% 抖动，1% 丢帧，0.5% 误码），
+ *        设备主循环每 1ms 读取一次，5% 概率卡顿 5~40ms（模拟 LCD 刷新、串口打印）
+ */
+static int make_capture(const char *path, uint32_t frames, uint32_t rate_hz)
+{
+    FILE *f = fopen(path, "wb");
+    uint8_t hdr[RCAP_HEADER_SIZE];
+    uint8_t frame[HIPNUC_MAX_RAW_SIZE];
+    static uint8_t wire[1 << 16];  // 待读取的字节
+    static uint32_t wire_t[1 << 16]; // 各字节到达时刻
+    uint32_t n_wire = 0;
+    uint32_t byte_us = rcap_byte_ns(DEFAULT_BAUD) / 1000;
+    uint32_t period = 1000000u / (rate_hz ? rate_hz : 50);
+    uint32_t t_send = 1000, t_line = 0, t_poll = 0;
+    uint32_t seq = 0;
+    uint32_t records = 0;
+
+    if (!f)
+    {
+        printf("无法创建 %s\n", path);
+        return 1;
+    }
+    rcap_encode_header(hdr, DEFAULT_BAUD);
+    fwrite(hdr, 1, sizeof(hdr), f);
+
+    while (seq < frames || n_wire > 0)
+    {
+        // 把 t_poll 之前发出的帧放上线路
+        while (seq < frames && t_send <= t_poll)
+        {
+            int len = hipnuc_synth_hi91(frame, sizeof(frame), seq);
+            int i;
+            uint32_t r = rng() % 1000;
+
+            if (r >= 10) // 1% 丢帧
+            {
+                if (r < 15) // 0.5% 误码
+                    frame[10 + rng() % (uint32_t)(len - 10)] ^= 0x5A;
+                if (t_line < t_send)
+                    t_line = t_send;
+                for (i = 0; i < len && n_wire < sizeof(wire); i++)
+                {
+                    t_line += byte_us;
+                    wire[n_wire] = frame[i];
+                    wire_t[n_wire] = t_line;
+                    n_wire++;
+                }
+            }
+            seq++;
+            t_send += period - period / 10 + rng() % (period / 5 + 1);
+        }
+
+        // 主循环读取：取出 t_poll 之前到达的字节写成一条记录
+        {
+            uint32_t n = 0;
+            while (n < n_wire && wire_t[n] <= t_poll)
+                n++;
+            if (n > 0)
+            {
+                uint8_t rh[RCAP_RECORD_HDR_SIZE];
+                rcap_encode_record_hdr(rh, t_poll, (uint16_t)n);
+                fwrite(rh, 1, sizeof(rh), f);
+                fwrite(wire, 1, n, f);
+                memmove(wire, wire + n, n_wire - n);
+                memmove(wire_t, wire_t + n, (n_wire - n) * sizeof(uint32_t));
+                n_wire -= n;
+                records++;
+            }
+        }
+
+        t_poll += 1000;
+        if (rng() % 100 < 5)
+            t_poll += 5000 + rng() % 35000;
+    }
+
+    fclose(f);
+    printf("已生成 %s: %u 帧 @ %u Hz, %u 条记录\n", path, frames, rate_hz, records);
+    return 0;
+}
+
+/* ==================== 入口 ==================== */
+
+static uint8_t *load_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long n;
+
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = (uint8_t *)malloc(n > 0 ? (size_t)n : 1);
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+static void usage(void)
+{
+    printf("用法:\n"
+           "  rs485_replay <录制.rcap> [-s 倍速] [-r 标称帧率Hz] [-m]\n"
+           "  rs485_replay --make <输出.rcap> [帧数] [帧率Hz]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static hipnuc_sink_t hip;
+    static modbus_sink_t mb;
+    static char report[2048];
+    replay_t e;
+    float speed = 0;
+    uint32_t rate_hz = 0;
+    int use_modbus = 0;
+    uint8_t *cap;
+    size_t size;
+    int i, ret;
+
+    if (argc < 2)
+    {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "--make") == 0)
+    {
+        if (argc < 3)
+        {
+            usage();
+            return 1;
+        }
+        return make_capture(argv[2], argc > 3 ? (uint32_t)atoi(argv[3]) : 3000,
+                            argc > 4 ? (uint32_t)atoi(argv[4]) : 50);
+    }
+
+    for (i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            speed = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            rate_hz = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0)
+            use_modbus = 1;
+    }
+
+    cap = load_file(argv[1], &size);
+    if (!cap)
+    {
+        printf("无法读取 %s\n", argv[1]);
+        return 1;
+    }
+
+    replay_init(&e);
+    memset(&hip, 0, sizeof(hip));
+    imu_codec_init(&hip.codec, KEY_INTERVAL);
+    replay_add_sink(&e, "hipnuc", hipnuc_sink_input, NULL, &hip, rate_hz ? 1000000u / rate_hz : 0);
+
+    if (use_modbus)
+    {
+        uint32_t baud = DEFAULT_BAUD;
+        if (size >= RCAP_HEADER_SIZE)
+            rcap_decode_header(cap, &baud);
+        memset(&mb, 0, sizeof(mb));
+        mb.silent_us = rcap_byte_ns(baud) * 35 / 10000; // 3.5 字符
+        replay_add_sink(&e, "modbus", modbus_sink_input, modbus_sink_flush, &mb, 0);
+    }
+
+    ret = replay_run(&e, cap, size, speed, &host_clock);
+    if (ret == -1)
+    {
+        printf("%s 不是 RCAP 录制文件\n", argv[1]);
+        free(cap);
+        return 1;
+    }
+
+    replay_format(&e, report, sizeof(report));
+    printf("%s", report);
+    printf("[imu_codec] %lu 条记录, 压缩率 %.2f:1\n",
+           (unsigned long)hip.codec.records, imu_codec_ratio(&hip.codec));
+    if (ret == -2)
+        printf("⚠ 录制文件末尾记录不完整，已忽略\n");
+
+    free(cap);
+    return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file run_stats_test.c
+ * @brief run_stats 主机测试：与双精度两遍算法比较窗口 / 累计的均值、标准差、最小/最大值，并测耗时
+ *
+ * @details 每个场景生成 N_SAMPLES 个单精度样本（随机种子固定），逐个送入 run_stats_add()，
+ *          在随机检查点（覆盖块未满、块刚满、环形队列回绕）比较：
+ *          - 累计统计 vs 前 n 个样本的两遍算法（先求均值，再求 Σ(x - mean)²，双精度）
+ *          - 窗口统计 vs 最后 window.n 个样本的两遍算法；window.n 须在配置的范围内
+ *          均值误差扣除单精度舍入（数据量级的 2 ulp）后以标准差衡量，标准差比较相对误差，最小/最大值须完全相等。
+ *          同时打印单精度 Σx² - n·mean² 的结果作对比（大偏置小波动时相消）。
+ *
+ *          PlatformIO：
+ *              pio run -e native_stats && .pio/build/native_stats/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/run_stats_test.c src/run_stats.c -lm -o run_stats_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "run_stats.h"
+
+#define N_SAMPLES 200000
+#define N_CHECKS 200
+
+typedef struct
+{
+    const char *name;
+    uint16_t block_len;
+    uint8_t blocks;
+    double offset; // 偏置
+    double sigma;  // 白噪声
+    double drift;  // 每样本线性漂移
+    double saw;    // 锯齿幅度（0 ~ saw 循环，如编码器角度）
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {"气压 101325±2 Pa", 50, 10, 101325.0, 2.0, 0.0, 0.0},
+    {"气压 + 漂移", 50, 10, 101325.0, 2.0, 1e-4, 0.0},
+    {"陀螺 0.3±0.05 °/s", 200, 16, 0.3, 0.05, 0.0, 0.0},
+    {"编码器 0~360° 锯齿", 64, 8, 0.0, 0.01, 0.0, 360.0},
+    {"常数", 10, 4, 25.5, 0.0, 0.0, 0.0},
+    {"单块窗口", 100, 1, -3.0, 1.0, 0.0, 0.0},
+};
+
+static float samples[N_SAMPLES];
+static uint32_t rng_state;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_uniform(void) // (0, 1)
+{
+    return ((double)(rng() >> 8) + 0.5) / 16777216.0;
+}
+
+static double rng_gauss(void)
+{
+    return sqrt(-2.0 * log(rng_uniform())) * cos(6.283185307179586 * rng_uniform());
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct
+{
+    double mean, std, min, max;
+} ref_t;
+
+/* 双精度两遍算法 */
+static ref_t two_pass(const float *x, uint32_t n)
+{
+    ref_t r = {0, 0, x[0], x[0]};
+    double m2 = 0;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        r.mean += x[i];
+        if (x[i] < r.min)
+            r.min = x[i];
+        if (x[i] > r.max)
+            r.max = x[i];
+    }
+    r.mean /= n;
+    for (i = 0; i < n; i++)
+        m2 += (x[i] - r.mean) * (x[i] - r.mean);
+    r.std = n > 1 ? sqrt(m2 / (n - 1)) : 0;
+    return r;
+}
+
+typedef struct
+{
+    double mean_err; // |Δmean| / max(std, 单精度分辨率)
+    double std_err;  // |Δstd| / max(std, 单精度分辨率)
+    int minmax_bad;
+} err_t;
+
+static void compare(const run_stats_acc_t *a, const ref_t *r, err_t *e)
+{
+    // 结果是单精度：均值的误差先扣除数据量级的 2 个 ulp（减偏移、加回偏移各舍入一次），std 为 0 时以 ulp 为尺度
+    float m = (float)fmax(fabs(r->min), fabs(r->max));
+    double ulp = 2.0 * (double)(nextafterf(m, INFINITY) - m);
+    double scale = fmax(r->std, ulp);
+    double d;
+
+    d = fmax(fabs((double)a->mean - r->mean) - ulp, 0.0) / scale;
+    if (d > e->mean_err)
+        e->mean_err = d;
+    d = fabs((double)run_stats_acc_std(a) - r->std) / scale;
+    if (d > e->std_err)
+        e->std_err = d;
+    if ((double)a->min != r->min || (double)a->max != r->max)
+        e->minmax_bad++;
+}
+
+static void check(const char *what, double err, double limit)
+{
+    int ok = err <= limit;
+    printf("    %-18s %.3g（阈值 %.0e）%s\n", what, err, limit, ok ? "" : "  FAIL");
+    if (!ok)
+        failures++;
+}
+
+static void run_scenario(const scenario_t *sc)
+{
+    static run_stats_t s;
+    uint32_t i, next_check, checks = 0, window_bad = 0;
+    err_t et = {0, 0, 0}, ew = {0, 0, 0};
+    float naive_sum = 0.0f, naive_sq = 0.0f;
+    run_stats_acc_t a;
+    ref_t r;
+
+    for (i = 0; i < N_SAMPLES; i++)
+    {
+        double v = sc->offset + sc->sigma * rng_gauss() + sc->drift * i;
+        if (sc->saw > 0)
+            v += fmod(i * 0.37, sc->saw);
+        samples[i] = (float)v;
+    }
+
+    run_stats_init(&s, sc->name, "", sc->block_len, sc->blocks);
+    next_check = 1 + rng() % 97;
+    for (i = 0; i < N_SAMPLES; i++)
+    {
+        run_stats_add(&s, samples[i]);
+        naive_sum += samples[i];
+        naive_sq += samples[i] * samples[i];
+        if (i + 1 != next_check && i + 1 != N_SAMPLES)
+            continue;
+
+        uint32_t n = i + 1;
+        uint32_t lo = (uint32_t)(sc->blocks - 1) * sc->block_len;
+        uint32_t hi = (uint32_t)sc->blocks * sc->block_len;
+
+        run_stats_total(&s, &a);
+        r = two_pass(samples, n);
+        if (a.n != n)
+            window_bad++;
+        compare(&a, &r, &et);
+
+        run_stats_window(&s, &a);
+        if (a.n > n || a.n > hi || (n >= hi && a.n <= lo && sc->blocks > 1) || a.n == 0)
+            window_bad++;
+        else
+        {
+            r = two_pass(samples + n - a.n, a.n);
+            compare(&a, &r, &ew);
+        }
+        checks++;
+        next_check += 1 + rng() % (2 * N_SAMPLES / N_CHECKS);
+    }
+
+    r = two_pass(samples, N_SAMPLES);
+    run_stats_total(&s, &a);
+    {
+        float m = naive_sum / N_SAMPLES;
+        float var = (naive_sq - N_SAMPLES * m * m) / (N_SAMPLES - 1);
+        printf("  %s（块 %u × %u，%lu 个检查点）\n", sc->name, sc->block_len, sc->blocks, (unsigned long)checks);
+        printf("    参考 %.6f ±%.6f | Welford %.6f ±%.6f | 单精度 Σx² %.6f ±%.6g\n", r.mean, r.std,
+               (double)a.mean, (double)run_stats_acc_std(&a), (double)m, var > 0 ? sqrt((double)var) : 0.0);
+    }
+    check("累计均值误差/σ", et.mean_err, 1e-2);
+    check("累计标准差误差/σ", et.std_err, 1e-3);
+    check("窗口均值误差/σ", ew.mean_err, 1e-2);
+    check("窗口标准差误差/σ", ew.std_err, 1e-3);
+    check("最小/最大值不符", et.minmax_bad + ew.minmax_bad, 0);
+    check("样本数不符", window_bad, 0);
+}
+
+static void test_reject(void)
+{
+    run_stats_t s;
+    run_stats_acc_t a;
+    char line[256];
+
+    run_stats_init(&s, "nan", "", 4, 2);
+    run_stats_add(&s, 1.0f);
+    run_stats_add(&s, NAN);
+    run_stats_add(&s, INFINITY);
+    run_stats_add(&s, 3.0f);
+    run_stats_total(&s, &a);
+    printf("  NaN / Inf 样本\n");
+    check("计入的样本数 - 2", fabs((double)a.n - 2.0), 0);
+    check("无效计数 - 2", fabs((double)s.rejected - 2.0), 0);
+    check("均值 - 2", fabs((double)a.mean - 2.0), 0);
+    run_stats_format(&s, line, sizeof(line));
+    printf("    %s", line);
+}
+
+static void test_speed(void)
+{
+    static run_stats_t s;
+    run_stats_acc_t a;
+    uint64_t t0;
+    uint32_t i;
+    int k;
+
+    run_stats_init(&s, "speed", "", 50, RUN_STATS_MAX_BLOCKS);
+    t0 = now_ns();
+    for (k = 0; k < 10; k++)
+        for (i = 0; i < N_SAMPLES; i++)
+            run_stats_add(&s, samples[i]);
+    printf("\n耗时（主机）\n  run_stats_add     %6.2f ns/样本\n", (double)(now_ns() - t0) / (10.0 * N_SAMPLES));
+    t0 = now_ns();
+    for (i = 0; i < N_SAMPLES; i++)
+        run_stats_window(&s, &a);
+    printf("  run_stats_window  %6.2f ns/次（%u 块）\n", (double)(now_ns() - t0) / N_SAMPLES, RUN_STATS_MAX_BLOCKS);
+}
+
+int main(void)
+{
+    size_t i;
+
+    printf("run_stats 精度（%d 个样本 / 场景）\n", N_SAMPLES);
+    rng_state = 0x2545F491u;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+        run_scenario(&scenarios[i]);
+    test_reject();
+    test_speed();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
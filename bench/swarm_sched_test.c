@@ -0,0 +1,392 @@
+/**
+ * @file swarm_sched_test.c
+ * @brief ESP-NOW 组网调度主机测试：多节点、时钟偏差与信标抖动下的时隙占用
+ *
+ * @details 场景（随机种子固定，基站时间为参考时钟）：
+ *          - 锚点不对齐：信标 base_time 不是时隙长度的整数倍，单时隙节点每超帧只发一帧
+ *          - 重新锚定：信标提前 / 推迟到达，跨锚点不重复发送，超帧计数接续
+ *          - 多节点：5 个节点，本地时钟任意偏移并带 ±30ppm 漂移，信标按基站主循环延迟抖动、
+ *            接收延迟各不相同、随机丢失；逐帧检查每节点每时隙最多一帧、空口不重叠、
+ *            基站不记越界帧，且各节点按分配的时隙数发满
+ *          - 基站重启：epoch 变化后所有节点重新入网
+ *
+ *          PlatformIO：
+ *              pio run -e native_swarm && .pio/build/native_swarm/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/swarm_sched_test.c src/swarm_sched.c -o swarm_sched_test
+ *
+ * @version 1.0
+ * @date 2026-02-09
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swarm_sched.h"
+
+#define SUPERFRAME_US 40000 // 与 test/espnow_swarm.cpp 一致：10 个 4ms 时隙
+#define SLOTS 10
+#define DATA_LEN 200        // 遥测帧长度（空口约 1.8ms）
+#define TICK_US 10          // 仿真步长
+#define N_NODES 5
+#define MS_EPOCH 0xFF000000u // millis() 的起点：micros() 回绕时 millis() 并不回绕
+
+static uint32_t rng_state = 0x3B9AC9FFu;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* 均匀分布 [lo, hi] */
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+static const uint8_t BASE_MAC[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+
+/* 构造信标 / 分配报文，供单节点场景直接驱动 */
+static size_t make_beacon(uint8_t *buf, uint32_t base_time, uint8_t epoch, uint32_t members)
+{
+    swarm_base_t b;
+
+    swarm_base_init(&b, SUPERFRAME_US, SLOTS, epoch);
+    swarm_base_beacon(&b, base_time, buf);
+    buf[15] = (uint8_t)members;
+    buf[16] = (uint8_t)(members >> 8);
+    buf[17] = (uint8_t)(members >> 16);
+    buf[18] = (uint8_t)(members >> 24);
+    return SWARM_BEACON_SIZE;
+}
+
+static void assign(swarm_node_t *n, uint8_t first, uint8_t count, uint8_t idx, uint8_t epoch)
+{
+    uint8_t buf[SWARM_MSG_MAX];
+
+    buf[0] = SWARM_MAGIC;
+    buf[1] = SWARM_TYPE_ASSIGN;
+    memcpy(buf + 2, n->own_mac, 6);
+    buf[8] = first;
+    buf[9] = count;
+    buf[10] = idx;
+    buf[11] = epoch;
+    swarm_node_on_message(n, BASE_MAC, buf, SWARM_ASSIGN_SIZE, 0);
+}
+
+/* 从 t0 起每 TICK_US 轮询一次，返回 [t0, t1) 内的发送次数 */
+static int poll_sends(swarm_node_t *n, uint32_t t0, uint32_t t1, size_t len)
+{
+    int sends = 0;
+    uint32_t t;
+
+    for (t = t0; (int32_t)(t1 - t) > 0; t += TICK_US)
+        sends += swarm_node_can_send(n, t, len);
+    return sends;
+}
+
+static void test_unaligned_anchor(void)
+{
+    static const uint32_t anchors[] = {1234567u, 1000u, 3999u, 0xFFFFFFFFu - 41000u};
+    swarm_node_t n;
+    uint8_t mac[6] = {2, 0, 0, 0, 0, 1};
+    uint8_t buf[SWARM_MSG_MAX];
+    uint32_t bad = 0, local = 777000u;
+    unsigned i;
+    int f;
+
+    printf("  锚点不对齐（单时隙节点，短帧）\n");
+    for (i = 0; i < sizeof(anchors) / sizeof(anchors[0]); i++)
+    {
+        swarm_node_init(&n, 1, mac, 25);
+        swarm_node_on_message(&n, BASE_MAC, buf, make_beacon(buf, anchors[i], 7, 1), local);
+        assign(&n, 3, 1, 0, 7);
+        for (f = 0; f < 4; f++)
+        {
+            uint32_t t0 = local + (uint32_t)f * SUPERFRAME_US;
+            bad += poll_sends(&n, t0, t0 + SUPERFRAME_US, 10) != 1;
+        }
+    }
+    check("每超帧恰好一帧", bad);
+}
+
+static void test_reanchor(void)
+{
+    static const int32_t shifts[] = {-120, -10, 0, 10, 120, 900};
+    swarm_node_t n;
+    uint8_t mac[6] = {2, 0, 0, 0, 0, 2};
+    uint8_t buf[SWARM_MSG_MAX];
+    uint32_t bad = 0, frames_bad = 0;
+    unsigned i;
+
+    printf("  信标提前 / 推迟到达\n");
+    for (i = 0; i < sizeof(shifts) / sizeof(shifts[0]); i++)
+    {
+        uint32_t local = 5000u, base_time = 8123457u, frame0;
+        int f, sends = 0;
+
+        swarm_node_init(&n, 2, mac, 25);
+        swarm_node_on_message(&n, BASE_MAC, buf, make_beacon(buf, base_time, 9, 1), local);
+        assign(&n, 1, 1, 0, 9);
+        frame0 = n.anchor_frame;
+        for (f = 0; f < 6; f++)
+        {
+            // 本超帧的时隙 1 发送后，下一信标按偏移提前或推迟到达
+            uint32_t next = local + SUPERFRAME_US + (uint32_t)shifts[i];
+            sends += poll_sends(&n, local, next, 10);
+            base_time += SUPERFRAME_US + (uint32_t)shifts[i];
+            local = next;
+            swarm_node_on_message(&n, BASE_MAC, buf, make_beacon(buf, base_time, 9, 1), local);
+        }
+        sends += poll_sends(&n, local, local + SUPERFRAME_US, 10);
+        bad += sends != 7;
+        frames_bad += (int32_t)(n.anchor_frame - frame0) < 6;
+    }
+    check("每个锚点一帧", bad);
+    check("超帧计数接续", frames_bad);
+}
+
+/* ================================ 多节点仿真 ================================ */
+
+typedef struct
+{
+    swarm_node_t n;
+    uint8_t mac[6];
+    uint32_t offset;      // 本地时钟相对基站的偏移（origin 时刻）
+    uint32_t origin;
+    int32_t drift_ppm;
+    uint32_t rx_delay_us; // 信标到达本节点的延迟
+    int join_pending;
+    uint32_t seq;
+    uint32_t last_key;    // 上次发送所在的基站时隙（信标序号 × 64 + 时隙）
+    uint32_t sends;
+    uint32_t dup_slot;    // 同一基站时隙内的第二帧
+    uint32_t active_frames;
+} sim_node_t;
+
+typedef struct
+{
+    uint32_t overlaps;    // 与上一次发送（数据帧或信标）空口重叠
+    uint32_t beacons;
+    uint32_t beacons_lost;
+} sim_stats_t;
+
+static uint32_t local_time(const sim_node_t *s, uint32_t base_us)
+{
+    uint32_t el = base_us - s->origin;
+    return s->offset + el + (uint32_t)((int64_t)el * s->drift_ppm / 1000000);
+}
+
+static void run_sim(swarm_base_t *b, sim_node_t *nodes, uint32_t start, uint32_t duration_us, sim_stats_t *st)
+{
+    uint8_t beacon[SWARM_MSG_MAX];
+    uint32_t beacon_due[N_NODES]; // 信标到达各节点的基站时刻
+    int beacon_pending[N_NODES];
+    uint32_t busy_until = start, beacon_at = 0, t;
+    int beacon_armed = 0, i;
+
+    memset(beacon_pending, 0, sizeof(beacon_pending));
+    for (t = start; t - start < duration_us; t += TICK_US)
+    {
+        uint32_t now_ms = (t - MS_EPOCH) / 1000;
+
+        // 基站主循环：超帧到期后再延迟 0 ~ 60μs 才发出信标（锚点随之漂移）
+        if (!beacon_armed && t - b->anchor_us >= SUPERFRAME_US)
+        {
+            beacon_armed = 1;
+            beacon_at = t + rng_range(0, 6) * TICK_US;
+        }
+        if (beacon_armed && t == beacon_at)
+        {
+            beacon_armed = 0;
+            if ((int32_t)(t - busy_until) < 0)
+                st->overlaps++;
+            busy_until = t + SWARM_AIRTIME_US(swarm_base_beacon(b, t, beacon));
+            st->beacons++;
+            for (i = 0; i < N_NODES; i++)
+            {
+                if ((rng() % 100) < 5)
+                {
+                    st->beacons_lost++;
+                    continue;
+                }
+                beacon_due[i] = t + nodes[i].rx_delay_us;
+                beacon_pending[i] = 1;
+            }
+        }
+
+        for (i = 0; i < N_NODES; i++)
+        {
+            sim_node_t *s = &nodes[i];
+            uint32_t lt = local_time(s, t);
+
+            if (beacon_pending[i] && (int32_t)(t - beacon_due[i]) >= 0)
+            {
+                beacon_pending[i] = 0;
+                if (swarm_node_on_message(&s->n, BASE_MAC, beacon, SWARM_BEACON_SIZE, lt))
+                    s->join_pending = 1;
+            }
+            swarm_node_check(&s->n, lt);
+
+            // JOIN 不计入空口检查（竞争时隙本就允许碰撞），基站立即回复分配
+            if (s->join_pending && swarm_node_can_join(&s->n, lt))
+            {
+                uint8_t msg[SWARM_MSG_MAX], reply[SWARM_MSG_MAX];
+                size_t len = swarm_node_join(&s->n, msg);
+                int idx = swarm_base_on_join(b, s->mac, msg, len, now_ms);
+                s->join_pending = 0;
+                if (idx >= 0)
+                    swarm_node_on_message(&s->n, BASE_MAC, reply, swarm_base_assign(b, idx, reply), lt);
+            }
+
+            if (swarm_node_can_send(&s->n, lt, DATA_LEN))
+            {
+                uint32_t key = (uint32_t)b->beacon_seq * 64u + (t - b->anchor_us) / b->slot_us;
+                if (key == s->last_key)
+                    s->dup_slot++;
+                s->last_key = key;
+                if ((int32_t)(t - busy_until) < 0)
+                    st->overlaps++;
+                busy_until = t + SWARM_AIRTIME_US(DATA_LEN);
+                swarm_base_on_data(b, s->mac, s->seq++, DATA_LEN, t, now_ms);
+                swarm_node_on_sent(&s->n, DATA_LEN, 1);
+                s->sends++;
+            }
+        }
+
+        // 每超帧起点统计已入网的节点
+        if ((t - start) % SUPERFRAME_US == 0)
+        {
+            for (i = 0; i < N_NODES; i++)
+                nodes[i].active_frames += nodes[i].n.state == SWARM_NODE_ACTIVE;
+            swarm_base_expire(b, now_ms);
+        }
+    }
+}
+
+static void init_nodes(sim_node_t *nodes, uint32_t origin)
+{
+    static const uint16_t rates[N_NODES] = {25, 50, 25, 50, 50};
+    int i;
+
+    for (i = 0; i < N_NODES; i++)
+    {
+        sim_node_t *s = &nodes[i];
+        memset(s, 0, sizeof(*s));
+        s->mac[0] = 0x02;
+        s->mac[5] = (uint8_t)(i + 1);
+        s->offset = rng();
+        s->origin = origin;
+        s->drift_ppm = (int32_t)rng_range(0, 60) - 30;
+        s->rx_delay_us = rng_range(20, 80);
+        s->last_key = 0xFFFFFFFFu;
+        swarm_node_init(&s->n, (uint8_t)(i + 1), s->mac, rates[i]);
+    }
+}
+
+static void test_multi_node(void)
+{
+    static swarm_base_t b;
+    sim_node_t nodes[N_NODES];
+    sim_stats_t st;
+    uint32_t start = 0xFFFFFFFFu - 2500000u; // 仿真中途跨越基站 micros() 回绕
+    uint32_t dup = 0, oos = 0, lost = 0, short_tx = 0, inactive = 0, rejoins = 0;
+    int i;
+
+    printf("  多节点（%d 节点，时钟偏移 + 漂移，信标抖动 / 丢失）\n", N_NODES);
+    memset(&st, 0, sizeof(st));
+    init_nodes(nodes, start);
+    swarm_base_init(&b, SUPERFRAME_US, SLOTS, 0x5A);
+    b.anchor_us = start - SUPERFRAME_US;
+    run_sim(&b, nodes, start, 5000000u, &st);
+
+    for (i = 0; i < N_NODES; i++)
+    {
+        const sim_node_t *s = &nodes[i];
+        const swarm_peer_t *p = NULL;
+        int k;
+
+        for (k = 0; k < SWARM_MAX_PEERS; k++)
+            if (b.peers[k].in_use && memcmp(b.peers[k].mac, s->mac, 6) == 0)
+                p = &b.peers[k];
+        printf("    节点%d 时隙 %d+%d，发送 %lu / 入网超帧 %lu，推迟 %lu\n", i + 1, s->n.slot_first,
+               s->n.slot_count, (unsigned long)s->sends, (unsigned long)s->active_frames,
+               (unsigned long)s->n.deferred);
+        dup += s->dup_slot;
+        rejoins += s->n.rejoins;
+        if (p == NULL)
+        {
+            inactive++;
+            continue;
+        }
+        oos += p->stats.out_of_slot;
+        lost += p->stats.lost;
+        // 每个入网超帧应发满 slot_count 帧（首尾超帧可能不完整）
+        short_tx += s->sends + 2u * s->n.slot_count < s->active_frames * s->n.slot_count;
+    }
+    printf("    信标 %lu（丢失 %lu 次接收），空口重叠 %lu\n", (unsigned long)st.beacons,
+           (unsigned long)st.beacons_lost, (unsigned long)st.overlaps);
+    check("全部入网", inactive != 0 || rejoins != 0);
+    check("每时隙最多一帧", dup);
+    check("空口不重叠", st.overlaps);
+    check("基站无越界帧", oos);
+    check("基站无丢帧", lost);
+    check("按分配时隙发满", short_tx);
+}
+
+static void test_base_restart(void)
+{
+    static swarm_base_t b;
+    sim_node_t nodes[N_NODES];
+    sim_stats_t st;
+    uint32_t start = 40000000u, rejoined = 0, dup = 0;
+    int i;
+
+    printf("  基站重启\n");
+    memset(&st, 0, sizeof(st));
+    init_nodes(nodes, start);
+    swarm_base_init(&b, SUPERFRAME_US, SLOTS, 0x11);
+    b.anchor_us = start - SUPERFRAME_US;
+    run_sim(&b, nodes, start, 1000000u, &st);
+
+    // 新 epoch、空节点表，锚点与旧基站无关
+    swarm_base_init(&b, SUPERFRAME_US, SLOTS, 0x22);
+    b.anchor_us = start + 1000000u + 13579u - SUPERFRAME_US;
+    run_sim(&b, nodes, start + 1000000u, 100000u, &st);
+
+    // 节点收到新信标之前仍按旧网格发送，可能与新基站的首个信标碰撞：只检查重新入网之后
+    memset(&st, 0, sizeof(st));
+    run_sim(&b, nodes, start + 1100000u, 900000u, &st);
+
+    for (i = 0; i < N_NODES; i++)
+    {
+        rejoined += nodes[i].n.rejoins == 1 && nodes[i].n.state == SWARM_NODE_ACTIVE && nodes[i].n.epoch == 0x22;
+        dup += nodes[i].dup_slot;
+    }
+    check("全部重新入网", rejoined != N_NODES || swarm_base_peer_count(&b) != N_NODES);
+    check("重启前后每时隙最多一帧", dup);
+    check("空口不重叠", st.overlaps);
+}
+
+int main(void)
+{
+    printf("ESP-NOW 组网调度\n");
+    test_unaligned_anchor();
+    test_reanchor();
+    test_multi_node();
+    test_base_restart();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
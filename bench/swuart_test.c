@@ -0,0 +1,309 @@
+/**
+ * @file swuart_test.c
+ * @brief 软件 UART 位解码主机测试：合成 RX 波形（RMT 条目 / I2S 并行采样），检查解码结果与耗时
+ *
+ * @details 发送端按“实际波特率 = 标称 × (1 + 偏差)”生成 8N1 波形，每个边沿加随机抖动，
+ *          字节间插入 0~2 位随机空闲，可选在空闲处插入短于 1/3 位的毛刺；然后
+ *          - RMT：按 80MHz 计数打包成 rmt_item32_t（单段超过 32767 拆分），以 0 结束标记收尾
+ *          - I2S：4 路不同数据流按固定采样率合成 16 位并行采样字（第 n 位为第 n 路）
+ *          送入 swuart 解码后逐字节比对。随机种子固定，结果可重复。
+ *
+ *          PlatformIO：
+ *              pio run -e native_swuart && .pio/build/native_swuart/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/swuart_test.c src/swuart.c -o swuart_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "swuart.h"
+
+#define RMT_HZ 80000000u
+#define N_BYTES 4000
+#define I2S_LINES 4
+#define MAX_RUNS (N_BYTES * 24)
+
+typedef struct
+{
+    uint8_t level;
+    uint32_t ticks;
+} run_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t baud;
+    double mismatch; // 实际波特率相对偏差
+    double jitter;   // 每个边沿的随机抖动（位宽比例，±）
+    int glitches;    // 是否在字节间空闲处插入毛刺
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {"115200 标准", 115200, 0, 0, 0},
+    {"115200 +3%", 115200, 0.03, 0, 0},
+    {"115200 -3%", 115200, -0.03, 0, 0},
+    {"115200 抖动±10%", 115200, 0, 0.10, 0},
+    {"115200 毛刺", 115200, 0, 0.02, 1},
+    {"460800 标准", 460800, 0, 0, 0},
+    {"460800 -2% 抖动±5%", 460800, -0.02, 0.05, 0},
+    {"460800 +3.5%", 460800, 0.035, 0, 0},
+    {"460800 +4.5%（I2S 超限）", 460800, 0.045, 0, 0}, // 每位 8 采样时起始沿量化占去 1/8 位
+};
+
+static uint32_t rng_state;
+static uint8_t sent[I2S_LINES][N_BYTES];
+static uint8_t recv[N_BYTES * 2];
+static run_t runs[I2S_LINES][MAX_RUNS];
+static size_t n_runs[I2S_LINES];
+static uint32_t items[MAX_RUNS];
+static uint16_t *samples;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_sym(void) // [-1, 1)
+{
+    return (double)(rng() >> 8) / 8388608.0 - 1.0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 把理想边沿时刻（浮点 tick）转换为游程，合并同电平 */
+static void push(run_t *r, size_t *n, uint8_t level, double *t_prev, double t_edge)
+{
+    uint32_t ticks;
+
+    if (t_edge <= *t_prev)
+        return;
+    ticks = (uint32_t)(t_edge + 0.5) - (uint32_t)(*t_prev + 0.5);
+    *t_prev = t_edge;
+    if (ticks == 0)
+        return;
+    if (*n > 0 && r[*n - 1].level == level)
+    {
+        r[*n - 1].ticks += ticks;
+        return;
+    }
+    r[*n].level = level;
+    r[*n].ticks = ticks;
+    (*n)++;
+}
+
+/* 生成一路波形：起始空闲 → 各字节 → 结束空闲 */
+static void synth(const scenario_t *sc, double tick_hz, const uint8_t *data, size_t len, run_t *r, size_t *n)
+{
+    double bit = tick_hz / (sc->baud * (1.0 + sc->mismatch));
+    double t = 0, t_prev = 0;
+    size_t i;
+    int k;
+
+    *n = 0;
+    t += 5 * bit;
+    push(r, n, 1, &t_prev, t);
+    for (i = 0; i < len; i++)
+    {
+        uint16_t frame = (uint16_t)(0x200 | (data[i] << 1)); // 起始 0，数据 LSB 先，停止 1
+        for (k = 0; k < 10; k++)
+        {
+            double edge = t + bit + sc->jitter * bit * rng_sym();
+            push(r, n, (uint8_t)((frame >> k) & 1), &t_prev, k == 9 ? t + bit : edge);
+            t += bit;
+        }
+        // 字节间空闲，可选毛刺
+        {
+            double idle = bit * (rng() % 3);
+            if (sc->glitches && idle > bit && rng() % 4 == 0)
+            {
+                double g = bit * (0.1 + 0.2 * (rng() % 100) / 100.0);
+                push(r, n, 1, &t_prev, t + idle / 2);
+                push(r, n, 0, &t_prev, t + idle / 2 + g);
+            }
+            t += idle;
+            push(r, n, 1, &t_prev, t);
+        }
+    }
+    t += 20 * bit;
+    push(r, n, 1, &t_prev, t);
+}
+
+static size_t to_rmt(const run_t *r, size_t n, uint32_t *out)
+{
+    uint32_t half[2 * MAX_RUNS];
+    size_t h = 0, i, m = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        uint32_t left = r[i].ticks;
+        while (left > 0)
+        {
+            uint32_t d = left > 32767 ? 32767 : left;
+            half[h++] = d | ((uint32_t)r[i].level << 15);
+            left -= d;
+        }
+    }
+    half[h++] = 0; // 结束标记
+    for (i = 0; i < h; i += 2)
+        out[m++] = half[i] | ((i + 1 < h ? half[i + 1] : 0) << 16);
+    return m;
+}
+
+static uint32_t compare(const uint8_t *a, size_t na, const uint8_t *b, size_t nb)
+{
+    size_t i, n = na < nb ? na : nb;
+    uint32_t err = (uint32_t)(na > nb ? na - nb : nb - na);
+
+    for (i = 0; i < n; i++)
+        err += a[i] != b[i];
+    return err;
+}
+
+static void print_stats(const swuart_t *u)
+{
+    printf("  帧错误 %u, break %u, 毛刺 %u", u->stats.frame_errors, u->stats.breaks, u->stats.glitches);
+}
+
+static void test_rmt(const scenario_t *sc)
+{
+    swuart_t u;
+    size_t i, m;
+    int got;
+    uint64_t t0, dt;
+
+    for (i = 0; i < N_BYTES; i++)
+        sent[0][i] = (uint8_t)rng();
+    synth(sc, RMT_HZ, sent[0], N_BYTES, runs[0], &n_runs[0]);
+    m = to_rmt(runs[0], n_runs[0], items);
+
+    swuart_init(&u, RMT_HZ, sc->baud);
+    t0 = now_ns();
+    got = swuart_feed_rmt(&u, items, m, recv, sizeof(recv));
+    dt = now_ns() - t0;
+
+    printf("RMT  %-22s %5d/%d 字节, 错误 %u, %.1f ns/字节 (%zu 条目)", sc->name, got, N_BYTES,
+           compare(sent[0], N_BYTES, recv, (size_t)got), (double)dt / N_BYTES, m);
+    print_stats(&u);
+    printf("\n");
+}
+
+/* 4 路不同数据流合成并行采样，按 block 分批送入（模拟 DMA 缓冲） */
+static void test_i2s(const scenario_t *sc, uint32_t sample_hz)
+{
+    static uint8_t out[I2S_LINES][N_BYTES * 2];
+    swuart_t u[I2S_LINES];
+    int got[I2S_LINES] = {0};
+    size_t total = 0, l, i, block = 1024;
+    uint64_t t0, dt;
+
+    for (l = 0; l < I2S_LINES; l++)
+    {
+        size_t len = 0, r;
+        for (i = 0; i < N_BYTES; i++)
+            sent[l][i] = (uint8_t)rng();
+        synth(sc, sample_hz, sent[l], N_BYTES, runs[l], &n_runs[l]);
+        for (r = 0; r < n_runs[l]; r++)
+            len += runs[l][r].ticks;
+        if (l == 0 || len > total)
+            total = len;
+    }
+
+    samples = (uint16_t *)malloc(total * sizeof(uint16_t));
+    if (!samples)
+        return;
+    for (i = 0; i < total; i++)
+        samples[i] = 0xFFFF; // 空闲为高
+    for (l = 0; l < I2S_LINES; l++)
+    {
+        size_t pos = 0, r, k;
+        for (r = 0; r < n_runs[l]; r++)
+            for (k = 0; k < runs[l][r].ticks && pos < total; k++, pos++)
+                if (!runs[l][r].level)
+                    samples[pos] &= (uint16_t)~(1u << l);
+    }
+
+    for (l = 0; l < I2S_LINES; l++)
+        swuart_init(&u[l], sample_hz, sc->baud);
+    t0 = now_ns();
+    for (i = 0; i < total; i += block)
+    {
+        size_t n = total - i < block ? total - i : block;
+        for (l = 0; l < I2S_LINES; l++)
+            got[l] += swuart_feed_samples(&u[l], samples + i, n, (uint8_t)l, out[l] + got[l],
+                                          (int)sizeof(out[l]) - got[l]);
+    }
+    for (l = 0; l < I2S_LINES; l++)
+        got[l] += swuart_flush(&u[l], out[l] + got[l], (int)sizeof(out[l]) - got[l]);
+    dt = now_ns() - t0;
+
+    {
+        uint32_t err = 0;
+        int sum = 0;
+        for (l = 0; l < I2S_LINES; l++)
+        {
+            err += compare(sent[l], N_BYTES, out[l], (size_t)got[l]);
+            sum += got[l];
+        }
+        printf("I2S  %-22s %5d/%d 字节 ×%d 路, 错误 %u, %.1f ns/字节/路 (%.2f MHz 采样)", sc->name, sum / I2S_LINES,
+               N_BYTES, I2S_LINES, err, (double)dt / N_BYTES / I2S_LINES, sample_hz / 1e6);
+        print_stats(&u[0]);
+        printf("\n");
+    }
+    free(samples);
+}
+
+/* break（线路持续低电平）之后应能在线路恢复高电平后的下一个下降沿重新同步 */
+static void test_break(void)
+{
+    swuart_t u;
+    uint8_t out[4];
+    int got = 0;
+    uint32_t bit = RMT_HZ / 115200u;
+
+    swuart_init(&u, RMT_HZ, 115200);
+    got += swuart_feed_run(&u, 1, 3 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 0, 25 * bit, out + got, (int)sizeof(out) - got); // break
+    got += swuart_feed_run(&u, 1, 2 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 0, 1 * bit, out + got, (int)sizeof(out) - got); // 0x5A: 起始 0 + 0 1 0 1 1 0 1 0 + 停止 1
+    got += swuart_feed_run(&u, 0, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 1, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 0, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 1, 2 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 0, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 1, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_feed_run(&u, 0, 1 * bit, out + got, (int)sizeof(out) - got);
+    got += swuart_flush(&u, out + got, (int)sizeof(out) - got);
+
+    printf("break 后重新同步: %s（break %u, 输出 %d 字节%s）\n",
+           u.stats.breaks == 1 && got == 1 && out[0] == 0x5A ? "通过" : "失败", u.stats.breaks, got,
+           got == 1 && out[0] == 0x5A ? " 0x5A" : "");
+}
+
+int main(void)
+{
+    size_t k;
+
+    rng_state = 0x9E3779B9u;
+    printf("软件 UART 位解码测试（每项 %d 字节，8N1）\n\n", N_BYTES);
+    for (k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++)
+        test_rmt(&scenarios[k]);
+    test_break();
+    printf("\n");
+    for (k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++)
+        test_i2s(&scenarios[k], scenarios[k].baud * 8u); // 每位 8 个采样
+    return 0;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file telemetry_frame_test.c
+ * @brief 遥测帧主机测试：打包 / 解包往返、格式错误帧，以及链路统计的丢帧 / 重复 / 乱序 / 重启判定
+ *
+ * @details 场景（随机种子固定）：
+ *          - 往返：随机 IMU / 编码器采样打包到帧满，解包后误差不超过半个定点单位，饱和与 NaN 按约定处理；
+ *                  帧内时间跨度超过 65ms 时拒绝追加；丢弃未发送的帧不改变序号
+ *          - 格式错误：逐字节截断、错误的 magic / version / 采样类型、count 不符均返回 -1；
+ *                      输出数组不足时只解出容量内的采样
+ *          - 链路（手工序列）：逐帧核对丢帧、重复、迟到、过旧与重新同步计数
+ *          - 链路（随机）：10% 丢帧、3% 重复、20 帧内乱序，计数与真值完全一致；
+ *                         相对延迟统计与注入的延迟一致
+ *
+ *          PlatformIO：
+ *              pio run -e native_telem && .pio/build/native_telem/program
+ *          无 PlatformIO 时：
+ *              gcc -O2 -std=gnu99 -Iinclude bench/telemetry_frame_test.c src/telemetry_frame.c -lm -o telemetry_frame_test
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry_frame.h"
+
+#define RAND_N 100000
+#define MAX_DELAY 20 // 乱序：到达位置最多推后的帧数
+
+static uint32_t rng_state = 0x68E31DA4u;
+static int failures = 0;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static float frand(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(rng() & 0xFFFFFF) / 16777215.0f;
+}
+
+static void check(const char *what, uint32_t bad)
+{
+    printf("    %-30s %s\n", what, bad ? "FAIL" : "OK");
+    if (bad)
+        failures++;
+}
+
+/* 期望的解包值：按定点单位四舍五入并饱和 */
+static float quantized(float v, float scale)
+{
+    float s = v * scale;
+    if (s != s)
+        return 0.0f;
+    if (s > 32767.0f)
+        s = 32767.0f;
+    if (s < -32768.0f)
+        s = -32768.0f;
+    return (float)(int)(s >= 0.0f ? s + 0.5f : s - 0.5f) / scale;
+}
+
+static int near(float a, float b)
+{
+    return fabsf(a - b) <= 1e-6f + fabsf(b) * 1e-6f;
+}
+
+/* ==================== 打包 / 解包 ==================== */
+
+static void test_roundtrip(void)
+{
+    static telem_tx_t tx;
+    telem_sample_t in[64], out[64];
+    telem_header_t hdr;
+    uint32_t frame, bad = 0, count_bad = 0, t = 1000;
+    size_t len;
+    int i, k, n;
+
+    printf("  打包 / 解包往返\n");
+    telem_tx_init(&tx, 7);
+    for (frame = 0; frame < 2000; frame++)
+    {
+        n = 0;
+        for (;;)
+        {
+            telem_sample_t *s = &in[n];
+            int ok;
+            t += rng() % 3000;
+            s->t_us = t;
+            if (rng() % 3)
+            {
+                s->type = TELEM_SAMPLE_IMU;
+                for (k = 0; k < 4; k++)
+                    s->imu.quat[k] = frand(-1.0f, 1.0f);
+                for (k = 0; k < 3; k++)
+                {
+                    s->imu.gyr[k] = frand(-4000.0f, 4000.0f); // 超出 ±3276 °/s 时饱和
+                    s->imu.acc[k] = frand(-40.0f, 40.0f);
+                }
+                if (rng() % 50 == 0)
+                    s->imu.gyr[0] = NAN;
+                ok = telem_tx_add_imu(&tx, t, s->imu.quat, s->imu.gyr, s->imu.acc);
+            }
+            else
+            {
+                s->type = TELEM_SAMPLE_ENCODER;
+                s->enc.id = (uint8_t)rng();
+                s->enc.angle = frand(-10.0f, 700.0f); // 超出 [0, 655.35] 时饱和
+                ok = telem_tx_add_encoder(&tx, t, s->enc.id, s->enc.angle);
+            }
+            if (!ok)
+                break;
+            n++;
+        }
+
+        len = telem_tx_finish(&tx, t + 500);
+        k = telem_unpack(tx.buf, len, &hdr, out, 64);
+        if (k != n || hdr.count != n || hdr.node_id != 7 || hdr.seq != frame || hdr.tx_us != t + 500 ||
+            hdr.t0_us != in[0].t_us)
+            count_bad++;
+        for (i = 0; i < k && i < n; i++)
+        {
+            const telem_sample_t *a = &in[i], *b = &out[i];
+            if (a->type != b->type || a->t_us != b->t_us)
+                bad++;
+            else if (a->type == TELEM_SAMPLE_IMU)
+            {
+                for (k = 0; k < 4; k++)
+                    bad += !near(b->imu.quat[k], quantized(a->imu.quat[k], TELEM_SCALE_QUAT));
+                for (k = 0; k < 3; k++)
+                {
+                    bad += !near(b->imu.gyr[k], quantized(a->imu.gyr[k], TELEM_SCALE_GYR));
+                    bad += !near(b->imu.acc[k], quantized(a->imu.acc[k], TELEM_SCALE_ACC));
+                }
+            }
+            else
+            {
+                float s = a->enc.angle * TELEM_SCALE_ANGLE;
+                float want = (s <= 0.0f ? 0.0f : s >= 65535.0f ? 65535.0f : (float)(uint32_t)(s + 0.5f)) / TELEM_SCALE_ANGLE;
+                bad += b->enc.id != a->enc.id || !near(b->enc.angle, want);
+            }
+        }
+        telem_tx_reset(&tx);
+        t += 1000;
+    }
+    check("帧头与采样数", count_bad);
+    check("量化、饱和、NaN", bad);
+
+    // 帧内时间跨度与空帧
+    {
+        float q[4] = {1, 0, 0, 0}, v[3] = {0, 0, 0};
+        telem_tx_init(&tx, 1);
+        check("空帧不发送", telem_tx_finish(&tx, 0) != 0);
+        telem_tx_add_imu(&tx, 100, q, v, v);
+        check("跨度 65535us 可追加", !telem_tx_add_imu(&tx, 100 + 0xFFFF, q, v, v));
+        check("跨度超过 65535us 拒绝", telem_tx_add_encoder(&tx, 100 + 0x10000, 0, 1.0f) != 0);
+
+        // 帧满未发出：丢弃后重新打包，序号不变，下一次发送仍是 seq 0
+        telem_tx_clear(&tx);
+        telem_tx_add_encoder(&tx, 200000, 3, 90.0f);
+        len = telem_tx_finish(&tx, 200500);
+        n = telem_unpack(tx.buf, len, &hdr, out, 64);
+        check("丢弃未发送帧不增序号", n != 1 || hdr.seq != 0 || hdr.t0_us != 200000 || len != TELEM_HDR_SIZE + TELEM_ENCODER_SIZE);
+        telem_tx_reset(&tx);
+        check("发送后序号递增", tx.seq != 1 || tx.count != 0 || tx.len != TELEM_HDR_SIZE);
+    }
+}
+
+static void test_malformed(void)
+{
+    static telem_tx_t tx;
+    telem_sample_t out[16];
+    telem_header_t hdr;
+    uint8_t buf[TELEM_FRAME_MAX];
+    float q[4] = {1, 0, 0, 0}, v[3] = {0.1f, 0.2f, 0.3f};
+    size_t len, cut;
+    uint32_t bad = 0;
+
+    printf("  格式错误帧\n");
+    telem_tx_init(&tx, 3);
+    telem_tx_add_imu(&tx, 10, q, v, v);
+    telem_tx_add_encoder(&tx, 20, 1, 90.0f);
+    telem_tx_add_imu(&tx, 30, q, v, v);
+    len = telem_tx_finish(&tx, 40);
+
+    for (cut = 0; cut < len; cut++)
+        bad += telem_unpack(tx.buf, cut, &hdr, out, 16) != -1;
+    check("任意截断", bad);
+
+    memcpy(buf, tx.buf, len);
+    buf[0] ^= 0xFF;
+    check("magic", telem_unpack(buf, len, &hdr, out, 16) != -1);
+    memcpy(buf, tx.buf, len);
+    buf[1] = TELEM_VERSION + 1;
+    check("version", telem_unpack(buf, len, &hdr, out, 16) != -1);
+    memcpy(buf, tx.buf, len);
+    buf[TELEM_HDR_SIZE] = 9;
+    check("未知采样类型", telem_unpack(buf, len, &hdr, out, 16) != -1);
+    memcpy(buf, tx.buf, len);
+    buf[3] = 4;
+    check("count 不符", telem_unpack(buf, len, &hdr, out, 16) != -1);
+    check("超过 250 字节", telem_unpack(tx.buf, TELEM_FRAME_MAX + 1, &hdr, out, 16) != -1);
+    check("输出容量不足", telem_unpack(tx.buf, len, &hdr, out, 2) != 2 || out[1].type != TELEM_SAMPLE_ENCODER);
+}
+
+/* ==================== 链路统计 ==================== */
+
+static void feed(telem_link_t *link, uint32_t seq, uint32_t tx_us, uint32_t rx_us)
+{
+    telem_header_t h;
+
+    h.node_id = 1;
+    h.count = 4;
+    h.seq = seq;
+    h.t0_us = tx_us - 1000;
+    h.tx_us = tx_us;
+    telem_link_update(link, &h, rx_us, 100);
+}
+
+static void test_link_script(void)
+{
+    // 每步：到达的序号，以及之后 frames / lost / duplicates / reordered / stale / resyncs 的期望值
+    static const uint32_t script[][7] = {
+        {0, 1, 0, 0, 0, 0, 0},     {1, 2, 0, 0, 0, 0, 0},     {2, 3, 0, 0, 0, 0, 0},
+        {4, 4, 1, 0, 0, 0, 0},     // 3 丢失
+        {3, 5, 0, 0, 1, 0, 0},     // 3 迟到：补回丢帧
+        {4, 5, 0, 1, 1, 0, 0},     // 重复
+        {2, 5, 0, 2, 1, 0, 0},     // 更早的重复：旧实现误计为乱序并减少丢帧
+        {10, 6, 5, 2, 1, 0, 0},    // 5~9 丢失
+        {7, 7, 4, 2, 2, 0, 0},     {7, 7, 4, 3, 2, 0, 0},     {3, 7, 4, 4, 2, 0, 0},
+        {60, 8, 53, 4, 2, 0, 0},   // 11~59 丢失
+        {20, 8, 53, 4, 2, 1, 0},   // 早于位图窗口：无法区分，丢弃
+        {61, 9, 53, 4, 2, 1, 0},   // 正常帧打断“连续过旧”
+        {21, 9, 53, 4, 2, 2, 0},   {22, 9, 53, 4, 2, 3, 0},
+        {23, 10, 53, 4, 2, 3, 1},  // 连续 3 帧过旧：发送端重启，重新同步
+        {24, 11, 53, 4, 2, 3, 1},  {24, 11, 53, 5, 2, 3, 1},
+        {5000, 12, 5028, 5, 2, 3, 1}, // 25~4999 丢失
+        {0, 13, 5028, 5, 2, 3, 2},    // 序号倒退超过 TELEM_RESYNC_GAP：立即重新同步
+    };
+    telem_link_t link;
+    uint32_t i, bad = 0;
+
+    printf("  链路统计（手工序列）\n");
+    telem_link_init(&link);
+    for (i = 0; i < sizeof(script) / sizeof(script[0]); i++)
+    {
+        const uint32_t *e = script[i];
+        feed(&link, e[0], 0, 0);
+        if (link.frames != e[1] || link.lost != e[2] || link.duplicates != e[3] || link.reordered != e[4] ||
+            link.stale != e[5] || link.resyncs != e[6])
+        {
+            printf("    第 %lu 步（序号 %lu）: frames %lu lost %lu dup %lu reord %lu stale %lu resync %lu\n",
+                   (unsigned long)i, (unsigned long)e[0], (unsigned long)link.frames, (unsigned long)link.lost,
+                   (unsigned long)link.duplicates, (unsigned long)link.reordered, (unsigned long)link.stale,
+                   (unsigned long)link.resyncs);
+            bad++;
+        }
+    }
+    check("逐帧计数", bad);
+    check("重新同步后接续", (feed(&link, 1, 0, 0), link.frames != 14 || link.lost != 5028 || link.next_seq != 2));
+}
+
+typedef struct
+{
+    uint32_t at; // 到达位置（越小越早）
+    uint32_t seq;
+    uint32_t delay_us;
+} arrival_t;
+
+static int cmp_arrival(const void *a, const void *b)
+{
+    const arrival_t *x = (const arrival_t *)a, *y = (const arrival_t *)b;
+    return x->at < y->at ? -1 : x->at > y->at ? 1 : (x->seq < y->seq ? -1 : x->seq > y->seq);
+}
+
+static void test_link_random(void)
+{
+    static arrival_t arr[2 * RAND_N];
+    static uint8_t got[RAND_N];
+    telem_link_t link;
+    uint32_t i, n = 0, max_seen = 0, frames = 0, lost = 0, dups = 0, late = 0, dmin = 0xFFFFFFFFu, dmax = 0;
+    float loss;
+
+    printf("  链路统计（随机：10%% 丢帧、3%% 重复、%d 帧内乱序）\n", MAX_DELAY);
+    for (i = 0; i < RAND_N; i++)
+    {
+        int copies = (i == 0) ? 1 : (rng() % 100 < 10) ? 0 : (rng() % 100 < 3) ? 2 : 1;
+        while (copies-- > 0)
+        {
+            arr[n].seq = i;
+            arr[n].at = i == 0 ? 0 : i * 4 + 1 + rng() % (MAX_DELAY * 4); // 序号 0 最先到达
+            arr[n].delay_us = 300 + rng() % 4000;
+            n++;
+        }
+    }
+    qsort(arr, n, sizeof(arr[0]), cmp_arrival);
+
+    // 真值：首次到达的帧有效，早于已到达最大序号的为迟到；其余拷贝为重复
+    memset(got, 0, sizeof(got));
+    telem_link_init(&link);
+    for (i = 0; i < n; i++)
+    {
+        uint32_t s = arr[i].seq, tx = 100000 + s * 2500;
+        if (got[s])
+            dups++;
+        else
+        {
+            got[s] = 1;
+            frames++;
+            if (s < max_seen)
+                late++;
+            if (s > max_seen)
+                max_seen = s;
+            if (arr[i].delay_us < dmin)
+                dmin = arr[i].delay_us;
+            if (arr[i].delay_us > dmax)
+                dmax = arr[i].delay_us;
+        }
+        feed(&link, s, tx, tx + 12345 + arr[i].delay_us); // 接收端时钟超前 12345us
+    }
+    for (i = 0; i <= max_seen; i++)
+        lost += !got[i];
+
+    loss = telem_link_loss_rate(&link);
+    printf("    有效 %lu 帧，丢失 %lu，重复 %lu，迟到 %lu | 统计: %lu / %lu / %lu / %lu，丢包率 %.2f%%\n",
+           (unsigned long)frames, (unsigned long)lost, (unsigned long)dups, (unsigned long)late,
+           (unsigned long)link.frames, (unsigned long)link.lost, (unsigned long)link.duplicates,
+           (unsigned long)link.reordered, loss * 100.0f);
+    check("有效帧与丢帧", link.frames != frames || link.lost != lost);
+    check("重复与迟到", link.duplicates != dups || link.reordered != late || link.stale != 0 || link.resyncs != 0);
+    check("丢包率", fabsf(loss - (float)lost / (float)(frames + lost)) > 1e-6f);
+    check("相对延迟", link.latency_max != dmax - dmin || link.offset_min != (int32_t)(12345 + dmin));
+}
+
+int main(void)
+{
+    printf("遥测帧\n");
+    test_roundtrip();
+    test_malformed();
+    test_link_script();
+    test_link_random();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file vec_math_bench.cpp
+ * @brief vec_math.h 主机测试：与双精度参考实现比较精度，并测各运算耗时
+ *
+ * @details 精度（随机单位四元数 / 向量各 100000 组，固定随机种子）：
+ *          - fastInvSqrt 相对误差（1e-6 ~ 1e6）
+ *          - rotate() / rotateInv() / toMat3() × v 与双精度 q ⊗ v ⊗ q* 的差
+ *          - 四元数乘法结合律、fromEuler → toEuler 往返（|pitch| < 85°）
+ *          任一项超过阈值时打印 FAIL 并返回非零。
+ *
+ *          编译期检查：static_assert 验证 constexpr 运算可在编译期求值。
+ *          以 -Wdouble-promotion 编译：库中任何隐式 float → double 提升都会产生警告。
+ *
+ *          PlatformIO：pio run -e native_vecmath && .pio/build/native_vecmath/program
+ *          无 PlatformIO 时：
+ *              g++ -O2 -std=gnu++11 -Wdouble-promotion -Iinclude bench/vec_math_bench.cpp -o vec_math_bench
+ *
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vec_math.h"
+
+#define N_SAMPLES 100000
+
+// constexpr 运算可在编译期求值
+static_assert(Vec3(1.0f, 0.0f, 0.0f).cross(Vec3(0.0f, 1.0f, 0.0f)).z == 1.0f, "cross");
+static_assert((Quat(0.0f, 1.0f, 0.0f, 0.0f) * Quat(0.0f, 1.0f, 0.0f, 0.0f)).w == -1.0f, "hamilton");
+static_assert(Quat(0.0f, 0.0f, 0.0f, 1.0f).rotate(Vec3(1.0f, 0.0f, 0.0f)).x == -1.0f, "rotate 180° about z");
+static_assert((Mat3() * Vec3(1.0f, 2.0f, 3.0f)).z == 3.0f, "identity");
+
+static uint32_t rng_state = 0x6C8E9CF5u;
+
+static uint32_t rng()
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static float rng_sym() // [-1, 1)
+{
+    return (float)(rng() >> 8) * (1.0f / 8388608.0f) - 1.0f;
+}
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static Quat random_quat()
+{
+    Quat q(rng_sym(), rng_sym(), rng_sym(), rng_sym());
+    return q.normalized();
+}
+
+static Vec3 random_vec()
+{
+    return Vec3(rng_sym() * 10.0f, rng_sym() * 10.0f, rng_sym() * 10.0f);
+}
+
+/* 双精度参考：v' = q ⊗ (0, v) ⊗ q* */
+static void ref_rotate(const Quat &qf, const Vec3 &vf, double out[3])
+{
+    double w = qf.w, x = qf.x, y = qf.y, z = qf.z;
+    double n = 1.0 / sqrt(w * w + x * x + y * y + z * z);
+    double v[3] = {vf.x, vf.y, vf.z};
+    double a[4], b[4];
+
+    w *= n;
+    x *= n;
+    y *= n;
+    z *= n;
+    // a = q ⊗ (0, v)
+    a[0] = -x * v[0] - y * v[1] - z * v[2];
+    a[1] = w * v[0] + y * v[2] - z * v[1];
+    a[2] = w * v[1] - x * v[2] + z * v[0];
+    a[3] = w * v[2] + x * v[1] - y * v[0];
+    // b = a ⊗ q*
+    b[1] = -a[0] * x + a[1] * w - a[2] * z + a[3] * y;
+    b[2] = -a[0] * y + a[1] * z + a[2] * w - a[3] * x;
+    b[3] = -a[0] * z - a[1] * y + a[2] * x + a[3] * w;
+    out[0] = b[1];
+    out[1] = b[2];
+    out[2] = b[3];
+}
+
+static double vec_err(const Vec3 &v, const double r[3])
+{
+    double dx = (double)v.x - r[0], dy = (double)v.y - r[1], dz = (double)v.z - r[2];
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static int failures = 0;
+
+static void check(const char *name, double err, double limit)
+{
+    bool ok = err <= limit;
+    printf("  %-32s 最大误差 %.3g（阈值 %.0e）%s\n", name, err, limit, ok ? "" : "  FAIL");
+    if (!ok)
+        failures++;
+}
+
+static void test_accuracy()
+{
+    double e_inv = 0, e_rot = 0, e_inv_rot = 0, e_mat = 0, e_assoc = 0, e_euler = 0, e_norm = 0;
+    int i;
+
+    printf("精度（%d 组随机数据）\n", N_SAMPLES);
+    for (float x = 1e-6f; x < 1e6f; x *= 1.001f)
+    {
+        double r = (double)fastInvSqrt(x) * sqrt((double)x) - 1.0;
+        if (fabs(r) > e_inv)
+            e_inv = fabs(r);
+    }
+
+    for (i = 0; i < N_SAMPLES; i++)
+    {
+        Quat q = random_quat(), p = random_quat(), s = random_quat();
+        Vec3 v = random_vec();
+        double r[3], back[3];
+        double scale = sqrt((double)v.norm2());
+
+        ref_rotate(q, v, r);
+        e_rot = fmax(e_rot, vec_err(q.rotate(v), r) / scale);
+        e_mat = fmax(e_mat, vec_err(q.toMat3() * v, r) / scale);
+        ref_rotate(q.conj(), v, back);
+        e_inv_rot = fmax(e_inv_rot, vec_err(q.rotateInv(v), back) / scale);
+        e_norm = fmax(e_norm, fabs((double)q.norm2() - 1.0));
+
+        // (q p) s 与 q (p s) 作用于同一向量
+        Vec3 a = ((q * p) * s).rotate(v), b = (q * (p * s)).rotate(v);
+        double bd[3] = {b.x, b.y, b.z};
+        e_assoc = fmax(e_assoc, vec_err(a, bd) / scale);
+
+        // 欧拉角往返（避开万向节锁附近）
+        Vec3 rpy(rng_sym() * 3.1f, rng_sym() * 1.48f, rng_sym() * 3.1f);
+        Vec3 got = Quat::fromEuler(rpy).toEuler();
+        double d[3] = {rpy.x, rpy.y, rpy.z};
+        e_euler = fmax(e_euler, vec_err(got, d));
+    }
+
+    check("fastInvSqrt 相对误差", e_inv, 2e-7);
+    check("normalized() 模长", e_norm, 1e-6);
+    check("rotate() 相对误差", e_rot, 2e-6);
+    check("rotateInv() 相对误差", e_inv_rot, 2e-6);
+    check("toMat3() * v 相对误差", e_mat, 2e-6);
+    check("乘法结合律（旋转后）", e_assoc, 4e-6);
+    check("欧拉角往返（rad）", e_euler, 1e-4);
+}
+
+/* 每个运算跑 N_SAMPLES 次，结果累加防止被优化掉 */
+template <typename F>
+static void bench(const char *name, F fn)
+{
+    volatile float sink = 0.0f;
+    uint64_t t0 = now_ns();
+    float acc = 0.0f;
+    int i;
+
+    for (i = 0; i < N_SAMPLES; i++)
+        acc += fn(i);
+    sink = acc;
+    (void)sink;
+    printf("  %-24s %6.2f ns/次\n", name, (double)(now_ns() - t0) / N_SAMPLES);
+}
+
+static Quat qs[N_SAMPLES];
+static Vec3 vs[N_SAMPLES];
+
+static void test_speed()
+{
+    int i;
+
+    for (i = 0; i < N_SAMPLES; i++)
+    {
+        qs[i] = random_quat();
+        vs[i] = random_vec();
+    }
+    printf("\n耗时（主机；设备上以 CCOUNT 计时另测）\n");
+    bench("fastInvSqrt", [](int k) { return fastInvSqrt(vs[k].norm2() + 1.0f); });
+    bench("1.0f / sqrtf", [](int k) { return 1.0f / sqrtf(vs[k].norm2() + 1.0f); });
+    bench("Vec3::normalized", [](int k) { return vs[k].normalized().x; });
+    bench("Quat::normalized", [](int k) { return qs[k].normalized().x; });
+    bench("Quat * Quat", [](int k) { return (qs[k] * qs[(k + 1) % N_SAMPLES]).w; });
+    bench("Quat::rotate", [](int k) { return qs[k].rotate(vs[k]).x; });
+    bench("Quat::toMat3", [](int k) { return qs[k].toMat3().r1.y; });
+    bench("Mat3 * Vec3", [](int k) {
+        static const Mat3 m = Quat(0.5f, 0.5f, 0.5f, 0.5f).toMat3();
+        return (m * vs[k]).x;
+    });
+    bench("Quat::toEuler", [](int k) { return qs[k].toEuler().z; });
+    bench("Quat::fromEuler", [](int k) { return Quat::fromEuler(vs[k] * 0.1f).w; });
+}
+
+int main()
+{
+    test_accuracy();
+    test_speed();
+    printf("\n%s\n", failures ? "FAIL" : "全部通过");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file ahrs.h
+ * @brief 板载姿态解算：由 HI83 原始 acc_b / gyr_b / mag_b 估计四元数（Mahony / Madgwick 可选）
+ *
+ * @details IMU 只输出原始数据（HI83 位图只含 ACC_B | GYR_B | MAG_B）时，由本模块在 ESP32 上融合姿态。
+ *          每个样本调用一次 ahrs_update()，状态全部在 ahrs_t 中，不分配内存，单精度浮点运算。
+ *
+ *          坐标系：导航系 x 指向磁北（水平）、z 向上（北-西-天）；q 为机体系 → 导航系的旋转 (w, x, y, z)。
+ *          静止时加速度计输出 +1G 指向上方，即 HiPNUC 的默认输出方式。
+ *
+ *          - Mahony：互补滤波，误差 e = a × v̂ + m × ŵ（实测方向 × 预测方向），
+ *                    ω' = ω + kp·e + ki·∫e，再积分四元数；ki 估计陀螺零偏
+ *          - Madgwick：梯度下降，q̇ = ½ q ⊗ ω − beta · ∇f / |∇f|
+ *          - 磁力计为 NULL 或全零时退化为 6 轴（只修正横滚/俯仰，航向由陀螺积分）
+ *          - 首次更新按加速度/磁场直接对准（倾斜补偿罗盘），无需等待收敛
+ *
+ *          归一化用快速平方根倒数（位运算初值 + 3 次牛顿迭代，相对误差 < 2e-7）；
+ *          ESP32 的 FPU 没有硬件开方和除法，比 1.0f / sqrtf() 快得多。只迭代 2 次时结果系统性偏小约 2e-6，
+ *          四元数模长每步都略小于 1，Madgwick 的倾角误差会翻倍（bench/ahrs_bench.c 可复现）。
+ *          编译时定义 AHRS_FAST_INV_SQRT=0 改用标准库。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；输入单位：gyr 为 °/s（HiPNUC 原始单位），acc / mag 只用方向
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef AHRS_H
+#define AHRS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifndef AHRS_FAST_INV_SQRT
+#define AHRS_FAST_INV_SQRT 1
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AHRS_MAHONY_KP 0.5f    // 比例增益（rad/s，每单位误差）
+#define AHRS_MAHONY_KI 0.01f   // 积分增益（零偏估计）
+#define AHRS_MADGWICK_BETA 0.1f // 梯度步长（rad/s）
+
+    typedef enum
+    {
+        AHRS_MAHONY = 0,
+        AHRS_MADGWICK
+    } ahrs_algo_t;
+
+    typedef struct
+    {
+        ahrs_algo_t algo;
+        float q[4];       // 机体 → 导航 (w, x, y, z)
+        float kp, ki;     // Mahony 增益
+        float beta;       // Madgwick 增益
+        float bias[3];    // Mahony 积分项（rad/s），即估计的陀螺零偏的相反数
+        uint8_t aligned;  // 已用加速度/磁场对准
+        uint8_t mag_used; // 最近一次更新使用了磁力计
+        uint32_t updates;
+    } ahrs_t;
+
+    /**
+     * @brief 快速平方根倒数（x > 0）
+     */
+    static inline float ahrs_inv_sqrt(float x)
+    {
+#if AHRS_FAST_INV_SQRT
+        union
+        {
+            float f;
+            uint32_t i;
+        } u;
+        float half = 0.5f * x;
+
+        u.f = x;
+        u.i = 0x5F3759DFu - (u.i >> 1);
+        u.f = u.f * (1.5f - half * u.f * u.f);
+        u.f = u.f * (1.5f - half * u.f * u.f);
+        u.f = u.f * (1.5f - half * u.f * u.f);
+        return u.f;
+#else
+        return 1.0f / sqrtf(x);
+#endif
+    }
+
+    /**
+     * @brief 初始化为单位四元数，增益取默认值；下一次更新时重新对准
+     */
+    void ahrs_init(ahrs_t *a, ahrs_algo_t algo);
+
+    /**
+     * @brief 按当前加速度（和磁场）直接设置姿态，清除零偏估计
+     * @param mag 为 NULL 或全零时航向取 0
+     * @return 0 加速度为零无法对准
+     */
+    int ahrs_align(ahrs_t *a, const float acc[3], const float mag[3]);
+
+    /**
+     * @brief 融合一个样本
+     * @param gyr  角速度（°/s）
+     * @param acc  加速度（任意单位，为零时只积分陀螺）
+     * @param mag  磁场（任意单位），NULL 或全零时按 6 轴处理
+     * @param dt   距上一样本的时间（s）
+     */
+    void ahrs_update(ahrs_t *a, const float gyr[3], const float acc[3], const float mag[3], float dt);
+
+    /**
+     * @brief 四元数转欧拉角（°）：roll 绕 x，pitch 绕 y，yaw 绕 z（ZYX 顺序）
+     */
+    void ahrs_quat_to_euler(const float q[4], float rpy[3]);
+
+    /**
+     * @brief 两个姿态之间的夹角（°）
+     */
+    float ahrs_quat_angle(const float q1[4], const float q2[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AHRS_H
@@ -0,0 +1,188 @@
+/**
+ * @file blackbox.h
+ * @brief 黑匣子：RAM 环形缓冲持续保存最近几秒的传感器记录，触发后冻结并在后台导出
+ *
+ * @details 各采集路径把解码后的数据压缩成定长记录追加到字节环形缓冲，缓冲满时淘汰最旧的记录：
+ *
+ *          ARMED ──触发──► POST ──post_us 后──► FROZEN ──导出完毕──► ARMED
+ *          （持续淘汰）     （继续记录，持续淘汰）   （只用空闲空间记录，不淘汰）
+ *
+ *          - 触发：高 g（blackbox_highg_update）、串口命令、按键、IMU 链路中断等，
+ *                  非 ARMED 状态下的触发只计数；触发时刻写入一条 BB_REC_TRIGGER 记录
+ *          - 冻结：淘汰触发前 pre_us 之外的记录，剩余内容即快照
+ *          - 导出：blackbox_drain() 每次从最旧处取出若干条完整记录并释放其空间，
+ *                  由后台任务写到 SD 卡 / Flash；期间采集继续写入空闲空间，空间不足时新记录丢弃并计数，
+ *                  快照本身不会被覆盖。导出完毕后冻结期间的记录留在缓冲中作为下一次触发的历史
+ *
+ *          记录（小端）：| type (u8) | len (u8) | t_us (u32) | payload[len] |
+ *          导出文件：blackbox_file_header() 的 16 字节文件头，后接按时间顺序的记录
+ *          | "BBOX" | version (u16) | reason (u8) | 0 | trig_us (u32) | bytes (u32) |
+ *
+ *          容量需覆盖 pre + post 时间内的全部记录（400Hz IMU 每秒约 9.6KB），不足时最早的历史被淘汰。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；时间由调用者传入（micros()），并发访问需由调用者加锁
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BLACKBOX_VERSION 1
+#define BLACKBOX_FILE_HDR_SIZE 16
+#define BLACKBOX_REC_HDR_SIZE 6
+#define BLACKBOX_MAX_PAYLOAD 255
+#define BLACKBOX_MAX_REC (BLACKBOX_REC_HDR_SIZE + BLACKBOX_MAX_PAYLOAD)
+#define BLACKBOX_ENCODER_MAX 8
+
+    typedef enum
+    {
+        BB_REC_IMU = 1, // acc mG, gyr 0.1°/s, rpy 0.01°（int16 × 9，18 字节）
+        BB_REC_BARO,    // 气压 0.1 Pa（int32）, 温度 0.01°C（int16），6 字节
+        BB_REC_ENCODER, // 一次轮询周期内各编码器原始计数（u16 × n）
+        BB_REC_TRIGGER, // 触发原因（u8）
+    } blackbox_rec_t;
+
+    typedef enum
+    {
+        BB_TRIG_NONE = 0,
+        BB_TRIG_HIGH_G,
+        BB_TRIG_COMMAND,
+        BB_TRIG_BUTTON,
+        BB_TRIG_LINK_LOSS,
+    } blackbox_trig_t;
+
+    typedef enum
+    {
+        BB_ARMED = 0,
+        BB_POST,
+        BB_FROZEN,
+    } blackbox_state_t;
+
+    typedef struct
+    {
+        uint32_t records;   // 写入的记录数
+        uint32_t evicted;   // 淘汰的旧记录数
+        uint32_t dropped;   // 冻结期间空间不足丢弃的新记录数
+        uint32_t triggers;  // 生效的触发次数
+        uint32_t ignored;   // 非 ARMED 状态下被忽略的触发次数
+        uint32_t snapshots; // 导出完毕的快照数
+    } blackbox_stats_t;
+
+    typedef struct
+    {
+        uint8_t *buf;
+        uint32_t cap;
+        uint32_t head; // 下一条记录写入位置
+        uint32_t tail; // 最旧记录位置
+        uint32_t used;
+        uint32_t snap_left; // 冻结后尚未导出的快照字节数
+        uint32_t pre_us;
+        uint32_t post_us;
+        uint32_t trig_us;
+        blackbox_state_t state;
+        blackbox_trig_t reason;
+        blackbox_stats_t stats;
+    } blackbox_t;
+
+    /**
+     * @brief 高 g 触发检测：|acc| ≥ 阈值连续 need 个样本，且距上次触发超过 holdoff_us
+     */
+    typedef struct
+    {
+        float thr2; // 阈值²（G²）
+        uint8_t need;
+        uint8_t run;
+        uint8_t fired; // 曾触发过（holdoff 只在触发后生效）
+        uint32_t holdoff_us;
+        uint32_t last_us;
+        float peak; // 最近一次触发时的 |acc|（G）
+    } blackbox_highg_t;
+
+    /**
+     * @param buf 记录缓冲（调用者提供，cap 字节）
+     */
+    void blackbox_init(blackbox_t *bb, uint8_t *buf, uint32_t cap, uint32_t pre_us, uint32_t post_us);
+
+    /**
+     * @brief 追加一条记录；ARMED / POST 时淘汰最旧记录腾出空间，FROZEN 时空间不足则丢弃
+     * @return 1 已写入，0 丢弃
+     */
+    int blackbox_put(blackbox_t *bb, uint8_t type, uint32_t t_us, const void *payload, uint8_t len);
+
+    /**
+     * @param acc G，gyr °/s，rpy °（无姿态时传 NULL）
+     */
+    int blackbox_put_imu(blackbox_t *bb, uint32_t t_us, const float acc[3], const float gyr[3], const float rpy[3]);
+
+    /**
+     * @param pressure Pa，temp °C
+     */
+    int blackbox_put_baro(blackbox_t *bb, uint32_t t_us, float pressure, float temp);
+
+    /**
+     * @param n 通道数（超过 BLACKBOX_ENCODER_MAX 时截断）
+     */
+    int blackbox_put_encoder(blackbox_t *bb, uint32_t t_us, const uint16_t *counts, uint8_t n);
+
+    /**
+     * @brief 触发；post_us 为 0 时立即冻结
+     * @return 1 已触发，0 当前不在 ARMED 状态（只计数）
+     */
+    int blackbox_trigger(blackbox_t *bb, blackbox_trig_t reason, uint32_t t_us);
+
+    /**
+     * @brief 检查 POST 阶段是否结束（追加记录时也会检查，数据源全部中断时靠周期调用）
+     */
+    void blackbox_poll(blackbox_t *bb, uint32_t now_us);
+
+    /**
+     * @brief 取出快照中最旧的若干条完整记录（out 至少 BLACKBOX_MAX_REC 字节）
+     * @return 写入 out 的字节数；0 表示没有待导出的快照（导出完毕后自动回到 ARMED）
+     */
+    size_t blackbox_drain(blackbox_t *bb, uint8_t *out, size_t max);
+
+    /**
+     * @brief 当前快照的导出文件头（应在第一次 blackbox_drain() 之前调用，bytes 为快照总字节数）
+     */
+    void blackbox_file_header(const blackbox_t *bb, uint8_t out[BLACKBOX_FILE_HDR_SIZE]);
+
+    /**
+     * @brief 解析一条记录
+     * @return 记录总长度；0 表示 buf 中的数据不足一条记录
+     */
+    size_t blackbox_parse(const uint8_t *buf, size_t size, uint8_t *type, uint32_t *t_us, const uint8_t **payload,
+                          uint8_t *len);
+
+    /**
+     * @brief 单行状态：状态、占用、记录 / 淘汰 / 丢弃、触发次数
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int blackbox_format(const blackbox_t *bb, char *buf, size_t buf_size);
+
+    const char *blackbox_trig_name(blackbox_trig_t reason);
+
+    /**
+     * @param thr_g 阈值（G），need 连续样本数，holdoff_us 两次触发的最小间隔
+     */
+    void blackbox_highg_init(blackbox_highg_t *d, float thr_g, uint8_t need, uint32_t holdoff_us);
+
+    /**
+     * @param acc G
+     * @return 1 本样本满足触发条件
+     */
+    int blackbox_highg_update(blackbox_highg_t *d, const float acc[3], uint32_t t_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLACKBOX_H
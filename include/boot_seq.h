@@ -0,0 +1,109 @@
+/**
+ * @file boot_seq.h
+ * @brief 启动编排：按依赖关系调度外设初始化步骤，记录启动时间线与首帧时间
+ *
+ * @details 每个初始化步骤声明它依赖的步骤（位掩码），调度器只负责"谁可以开始"和"谁已结束"，
+ *          步骤如何执行（在调用线程中直接执行，或放入独立任务并行执行）由调用者决定：
+ *
+ *          id = boot_seq_next()  取一个依赖已全部完成的等待步骤
+ *          boot_seq_start()      标记开始
+ *          ... 执行 ...
+ *          boot_seq_finish()     标记完成/失败；依赖失败步骤的后续步骤自动跳过
+ *
+ *          时间均为调用者传入的微秒时间戳（ESP32 上为 micros()，即应用启动以来的时间），
+ *          boot_seq_format() 输出每步的开始时刻、耗时和甘特条，以及串行总耗时与实际耗时的对比。
+ *
+ * @note 纯 C 实现，不依赖 Arduino / FreeRTOS；并发访问需由调用者加锁
+ * @version 1.0
+ * @date 2026-02-06
+ */
+
+#ifndef BOOT_SEQ_H
+#define BOOT_SEQ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BOOT_MAX_STEPS 16
+#define BOOT_DEP(id) (1UL << (id)) // 依赖掩码
+
+    typedef enum
+    {
+        BOOT_WAITING = 0,
+        BOOT_RUNNING,
+        BOOT_DONE,
+        BOOT_FAILED,
+        BOOT_SKIPPED // 依赖的步骤失败
+    } boot_state_t;
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t deps; // 依赖步骤掩码
+        uint8_t state; // boot_state_t
+        uint32_t start_us;
+        uint32_t end_us;
+    } boot_step_t;
+
+    typedef struct
+    {
+        boot_step_t steps[BOOT_MAX_STEPS];
+        uint8_t count;
+        uint32_t t0_us;          // 时间线零点
+        uint32_t first_frame_us; // 首个有效数据帧时刻
+        uint8_t first_frame_seen;
+    } boot_seq_t;
+
+    void boot_seq_init(boot_seq_t *b, uint32_t t0_us);
+
+    /**
+     * @brief 注册步骤（注册顺序即同时就绪时的启动顺序）
+     * @param deps 依赖掩码，如 BOOT_DEP(a) | BOOT_DEP(b)
+     * @return 步骤 id，步骤表已满返回 -1
+     */
+    int boot_seq_add(boot_seq_t *b, const char *name, uint32_t deps);
+
+    /**
+     * @brief 取一个可以开始的步骤（依赖均已完成）
+     * @return 步骤 id，没有可开始的步骤返回 -1
+     */
+    int boot_seq_next(boot_seq_t *b, uint32_t now_us);
+
+    void boot_seq_start(boot_seq_t *b, int id, uint32_t now_us);
+
+    /**
+     * @param ok 0 表示失败，依赖它的步骤将被跳过
+     */
+    void boot_seq_finish(boot_seq_t *b, int id, int ok, uint32_t now_us);
+
+    /**
+     * @brief 步骤是否已成功完成
+     */
+    int boot_seq_done(const boot_seq_t *b, int id);
+
+    /**
+     * @brief 是否所有步骤都已结束（完成、失败或跳过）
+     */
+    int boot_seq_complete(const boot_seq_t *b);
+
+    /**
+     * @brief 记录首个有效数据帧（只记录第一次）
+     */
+    void boot_seq_first_frame(boot_seq_t *b, uint32_t now_us);
+
+    /**
+     * @brief 输出启动时间线文本
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int boot_seq_format(const boot_seq_t *b, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_SEQ_H
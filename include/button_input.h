@@ -0,0 +1,202 @@
+/**
+ * @file button_input.h
+ * @brief 按键输入引擎：中断记录边沿 + 主循环手势识别（单击/双击/长按/波轮方向）
+ *
+ * @details 分为两层：
+ *          - 中断层：btn_ring_push() 把 (线路, 电平, 时间戳) 写入无锁环形缓冲区，
+ *                    单生产者（ISR）/单消费者（主循环），不做任何判断
+ *          - 识别层：btn_engine_process() 在主循环中取出边沿，按时间戳消抖，
+ *                    驱动每个按键的手势状态机和波轮的正交解码，生成事件
+ *
+ *          按键状态机（时间均取自边沿时间戳，结果与调用时机无关）：
+ *
+ *          IDLE --按下--> DOWN1 --松开(<长按)--> UP1 --超过双击间隔--> 单击
+ *                           |                    |
+ *                           +--保持≥长按--> 长按  +--再次按下--> DOWN2 --松开--> 双击
+ *
+ *          波轮两个触点按正交编码（格雷码）解码，每 steps_per_detent 个有效跳变输出一次方向，
+ *          A 触点先动作为 +1。拨动式波轮（上拨/下拨各一个触点）使用 BTN_ROTARY_TOGGLE：
+ *          A 触点接通为 +1，B 触点接通为 -1。
+ *
+ * @note 纯 C 实现，不访问 GPIO；可在主机上用合成的边沿序列验证
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BTN_MAX_LINES 8
+#define BTN_RING_LEN 64     // 边沿缓冲深度（2 的幂）
+#define BTN_EVENT_QUEUE_LEN 16
+
+#define BTN_DEFAULT_DEBOUNCE_US 5000
+#define BTN_DEFAULT_LONG_US 800000
+#define BTN_DEFAULT_DOUBLE_GAP_US 300000
+
+#define BTN_ROTARY_TOGGLE 0 // steps_per_detent 取 0：拨动式波轮
+
+    /**
+     * @brief 中断记录的原始边沿
+     */
+    typedef struct
+    {
+        uint8_t line;
+        uint8_t level;
+        uint32_t t_us;
+    } btn_edge_t;
+
+    /**
+     * @brief ISR 写入、主循环读取的环形缓冲区
+     */
+    typedef struct
+    {
+        btn_edge_t buf[BTN_RING_LEN];
+        volatile uint8_t head; // 仅 ISR 写
+        volatile uint8_t tail; // 仅主循环写
+        volatile uint32_t overflow;
+    } btn_ring_t;
+
+    /**
+     * @brief 在 ISR 中记录一个边沿（内联，便于放入 IRAM 的中断函数）
+     */
+    static inline void btn_ring_push(btn_ring_t *r, uint8_t line, uint8_t level, uint32_t t_us)
+    {
+        uint8_t head = r->head;
+        uint8_t next = (uint8_t)((head + 1) & (BTN_RING_LEN - 1));
+
+        if (next == r->tail)
+        {
+            r->overflow++;
+            return;
+        }
+        r->buf[head].line = line;
+        r->buf[head].level = level;
+        r->buf[head].t_us = t_us;
+        r->head = next;
+    }
+
+    /**
+     * @brief 事件类型
+     */
+    typedef enum
+    {
+        BTN_EV_CLICK = 1,
+        BTN_EV_DOUBLE_CLICK,
+        BTN_EV_LONG_PRESS,   // 按住达到长按时间时立即产生
+        BTN_EV_LONG_RELEASE, // 长按后松开
+        BTN_EV_ROTATE        // 波轮转动一格，dir = +1 / -1
+    } btn_event_type_t;
+
+    typedef struct
+    {
+        uint8_t type; // btn_event_type_t
+        uint8_t line; // 按键线路；波轮事件为 A 触点线路
+        int8_t dir;
+        uint32_t t_us;
+    } btn_event_t;
+
+    typedef enum
+    {
+        BTN_ROLE_NONE = 0,
+        BTN_ROLE_BUTTON,
+        BTN_ROLE_ROTARY
+    } btn_role_t;
+
+    typedef enum
+    {
+        BTN_ST_IDLE = 0,
+        BTN_ST_DOWN1,
+        BTN_ST_UP1,
+        BTN_ST_DOWN2,
+        BTN_ST_LONG
+    } btn_state_t;
+
+    typedef struct
+    {
+        uint8_t role;
+        uint8_t active_low; // 按下为低电平
+        uint8_t raw;        // 最近一次边沿电平
+        uint8_t stable;     // 消抖后电平
+        uint32_t raw_us;    // 最近一次边沿时刻
+        uint8_t state;      // btn_state_t
+        uint32_t state_us;  // 进入当前状态的时刻
+    } btn_line_t;
+
+    typedef struct
+    {
+        uint32_t edges;    // 处理的原始边沿
+        uint32_t glitches; // 消抖丢弃的边沿
+        uint32_t events;
+        uint32_t dropped;  // 事件队列满丢弃
+    } btn_stats_t;
+
+    typedef struct
+    {
+        btn_line_t lines[BTN_MAX_LINES];
+        uint32_t debounce_us;
+        uint32_t long_us;
+        uint32_t double_gap_us;
+
+        // 波轮
+        uint8_t rot_a;
+        uint8_t rot_b;
+        uint8_t rot_state; // (A << 1) | B
+        uint8_t rot_rest;  // 静止位置（注册时的状态）
+        int8_t rot_acc;
+        uint8_t rot_steps; // 每格有效跳变数（1/2/4），0 为拨动式
+
+        btn_event_t queue[BTN_EVENT_QUEUE_LEN];
+        uint8_t q_head;
+        uint8_t q_tail;
+
+        btn_stats_t stats;
+    } btn_engine_t;
+
+    /**
+     * @brief 初始化（默认消抖 5ms、长按 800ms、双击间隔 300ms）
+     */
+    void btn_engine_init(btn_engine_t *e);
+
+    /**
+     * @brief 注册按键
+     * @param level 当前电平（初始化时读一次）
+     */
+    void btn_engine_add_button(btn_engine_t *e, uint8_t line, uint8_t active_low, uint8_t level);
+
+    /**
+     * @brief 注册波轮（两个触点线路）
+     * @param steps_per_detent 每格正交跳变数；BTN_ROTARY_TOGGLE 为拨动式
+     */
+    void btn_engine_add_rotary(btn_engine_t *e, uint8_t line_a, uint8_t line_b, uint8_t level_a, uint8_t level_b, uint8_t steps_per_detent);
+
+    /**
+     * @brief 取出缓冲区中的边沿并推进状态机到 now_us
+     * @return 本次生成的事件数
+     */
+    int btn_engine_process(btn_engine_t *e, btn_ring_t *ring, uint32_t now_us);
+
+    /**
+     * @brief 取出一个事件
+     * @return 1 成功，0 无事件
+     */
+    int btn_engine_pop(btn_engine_t *e, btn_event_t *ev);
+
+    /**
+     * @brief 按键当前是否按下（消抖后）
+     */
+    int btn_engine_pressed(const btn_engine_t *e, uint8_t line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTON_INPUT_H
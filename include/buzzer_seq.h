@@ -0,0 +1,113 @@
+/**
+ * @file buzzer_seq.h
+ * @brief 非阻塞蜂鸣器音序器：音符表 + 优先级抢占
+ *
+ * @details tone() + delay() 播放旋律会阻塞调用者，启动提示音一项就占用 3 秒以上。
+ *          本模块只计算"此刻应输出什么频率、多久后再检查"，实际输出由调用者完成：
+ *
+ *          主循环 ──> buzzer_seq_play()    开始播放一段旋律（立即返回）
+ *          定时器 ──> buzzer_seq_update()  推进音符，返回是否需要改变输出频率以及下次检查的等待时间
+ *                 ──> ledcWriteTone()      仅在频率变化时写 LEDC
+ *
+ *          音符边界按理想时间累加（不以回调实际时刻为准），定时器延迟不会累积成节拍漂移。
+ *
+ *          优先级：新旋律优先级 ≥ 正在播放的旋律时抢占，否则被拒绝。
+ *          报警音可打断状态提示音，按键音不会打断正在播放的报警。
+ *
+ * @note 纯 C 实现，不依赖 Arduino，时间由调用者传入
+ * @version 1.0
+ * @date 2026-02-05
+ */
+
+#ifndef BUZZER_SEQ_H
+#define BUZZER_SEQ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BUZZER_REST 0 // 休止符
+
+#define BUZZER_PRIO_CHIRP 1  // 按键音等短提示
+#define BUZZER_PRIO_STATUS 2 // 启动音、状态提示、乐曲
+#define BUZZER_PRIO_ALARM 3  // 报警
+
+#define BUZZER_REPEAT_FOREVER 0 // repeat 取 0：循环播放直到 stop 或被抢占
+
+    /**
+     * @brief 音符
+     */
+    typedef struct
+    {
+        uint16_t freq_hz; // 0 为休止
+        uint16_t dur_ms;  // 含音符末尾的间隙
+    } buzzer_note_t;
+
+    /**
+     * @brief 旋律（可定义为 const 常量）
+     */
+    typedef struct
+    {
+        const buzzer_note_t *notes;
+        uint16_t count;
+        uint8_t priority;
+        uint8_t gap_ms; // 每个音符末尾的静音，使相同的连续音符可分辨
+        uint8_t repeat; // 播放次数，BUZZER_REPEAT_FOREVER 为循环
+    } buzzer_melody_t;
+
+    typedef struct
+    {
+        uint32_t started;   // 开始播放的旋律
+        uint32_t preempted; // 被抢占而中断的旋律
+        uint32_t rejected;  // 优先级不足被拒绝的请求
+        uint32_t completed; // 正常播放完成的旋律
+        uint32_t notes;     // 播放的音符数
+        uint32_t writes;    // 输出频率变化次数
+    } buzzer_seq_stats_t;
+
+    typedef struct
+    {
+        const buzzer_melody_t *melody; // NULL 表示空闲
+        uint16_t index;
+        uint8_t loops_left;
+        uint32_t note_start_ms;
+        uint32_t total_ms; // 一遍旋律的总时长
+        uint16_t out_hz;   // 当前输出频率
+        buzzer_seq_stats_t stats;
+    } buzzer_seq_t;
+
+    void buzzer_seq_init(buzzer_seq_t *s);
+
+    /**
+     * @brief 开始播放旋律（从第一个音符开始）
+     * @return 1 已开始，0 优先级低于正在播放的旋律或旋律为空
+     */
+    int buzzer_seq_play(buzzer_seq_t *s, const buzzer_melody_t *m, uint32_t now_ms);
+
+    /**
+     * @brief 停止播放（下次 update 时静音）
+     */
+    void buzzer_seq_stop(buzzer_seq_t *s);
+
+    /**
+     * @brief 推进到 now_ms
+     * @param freq_out 当前应输出的频率（0 为静音）
+     * @param wait_ms  距下一个音符边界的时间，0 表示已空闲、无需再调度
+     * @return 1 输出频率有变化，需要写硬件；0 无变化
+     */
+    int buzzer_seq_update(buzzer_seq_t *s, uint32_t now_ms, uint16_t *freq_out, uint32_t *wait_ms);
+
+    /**
+     * @brief 正在播放的旋律优先级，空闲返回 0
+     */
+    uint8_t buzzer_seq_priority(const buzzer_seq_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUZZER_SEQ_H
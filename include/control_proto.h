@@ -0,0 +1,205 @@
+/**
+ * @file control_proto.h
+ * @brief ESP-NOW 双向命令/控制协议（选择重传 ACK + 有限重试 + 去重 + RTT 直方图）
+ *
+ * @details 报文格式（小端）：
+ *          - 命令：[magic][type=1][session][seq:2][cmd_id][flags][len][payload...]
+ *          - 应答：[magic][type=2][session][seq:2][sack:4]
+ *            sack 第 i 位表示 seq-1-i 也已收到，一个应答可同时确认多条命令；session 为被确认命令的会话号
+ *
+ *          会话号由发送端每次上电随机选取：接收端看到新的会话号立即重新同步序号窗口（对端重启后第一条
+ *          命令即可交付），此后迟到的上一会话报文（最多 CTRL_WINDOW × (重试次数 + 1) 条）直接丢弃；
+ *          发送端忽略会话号不符的应答。
+ *
+ *          发送端维护 CTRL_WINDOW 个在途命令槽，每个槽独立超时重传，
+ *          重试 max_retries 次仍未确认则判定失败（延迟有上界）。
+ *          带 CTRL_FLAG_LATEST 的命令（如设定值）会取代同 cmd_id 的旧在途命令。
+ *          接收端用 32 位滑动窗口做重复抑制：重复命令只回 ACK，不重复交付；
+ *          带 CTRL_FLAG_LATEST 的命令若序号早于已交付的同 cmd_id 命令（迟到的旧设定值），只回 ACK 不交付。
+ *          RTT 只统计首次发送即被确认的命令（Karn 算法），避免重传歧义。
+ *
+ * @note 纯 C 实现，时间由调用者传入，发送通过回调完成，可在主机上模拟丢包
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#ifndef CONTROL_PROTO_H
+#define CONTROL_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ====================================================================================
+ *  协议常量
+ * ==================================================================================== */
+
+#define CTRL_MAGIC 0xC7
+#define CTRL_TYPE_CMD 1
+#define CTRL_TYPE_ACK 2
+#define CTRL_CMD_HDR_SIZE 8
+#define CTRL_ACK_SIZE 9
+
+#define CTRL_WINDOW 8              // 在途命令槽数量
+#define CTRL_MAX_PAYLOAD 32        // 单条命令最大负载
+#define CTRL_DEFAULT_RTO_US 4000   // 默认重传超时
+#define CTRL_DEFAULT_RETRIES 3     // 默认最大重试次数
+#define CTRL_LATEST_TRACK 4        // 接收端跟踪最新序号的 CTRL_FLAG_LATEST 命令 ID 数
+
+#define CTRL_RTT_BINS 16       // RTT 直方图桶数（最后一桶为溢出桶）
+#define CTRL_RTT_BIN_US 500    // 每桶宽度
+
+#define CTRL_FLAG_LATEST 0x01 // 新命令取代同 cmd_id 的旧在途命令
+
+/* ====================================================================================
+ *  命令 ID 命名空间
+ *  0x00-0x0F 链路管理 | 0x10-0x3F 运动控制 | 0x40-0x6F 配置 | 0x70-0x7F 调试 | 0x80+ 用户自定义
+ * ==================================================================================== */
+
+#define CTRL_CMD_PING 0x01         // 空命令，用于测量 RTT
+#define CTRL_CMD_SETPOINT 0x10     // 设定值：ctrl_setpoint_t
+#define CTRL_CMD_ESTOP 0x11        // 急停
+#define CTRL_CMD_SET_MODE 0x12     // 切换运行模式：uint8_t
+#define CTRL_CMD_SET_PARAM 0x40    // 设置参数：uint8_t id + float value
+#define CTRL_CMD_USER_BASE 0x80
+
+    /**
+     * @brief 设定值负载
+     */
+    typedef struct __attribute__((__packed__))
+    {
+        float value[4]; // 各轴设定值（含义由机器人定义）
+        uint32_t t_ms;  // 基站生成时间
+    } ctrl_setpoint_t;
+
+    typedef int (*ctrl_send_fn)(void *ctx, const uint8_t *buf, size_t len);
+    typedef void (*ctrl_deliver_fn)(void *ctx, uint8_t cmd_id, const uint8_t *payload, uint8_t len);
+
+    /**
+     * @brief 在途命令槽
+     */
+    typedef struct
+    {
+        uint8_t in_use;
+        uint8_t cmd_id;
+        uint8_t flags;
+        uint8_t len;
+        uint8_t retries;
+        uint16_t seq;
+        uint32_t first_tx_us;
+        uint32_t last_tx_us;
+        uint8_t payload[CTRL_MAX_PAYLOAD];
+    } ctrl_slot_t;
+
+    /**
+     * @brief 协议统计
+     */
+    typedef struct
+    {
+        uint32_t submitted;   // 提交的命令数
+        uint32_t sent;        // 发送次数（含重传）
+        uint32_t retransmits; // 重传次数
+        uint32_t acked;       // 被确认的命令数
+        uint32_t failed;      // 重试耗尽的命令数
+        uint32_t superseded;  // 被新设定值取代的命令数
+        uint32_t window_full; // 因窗口满被拒绝的提交
+        uint32_t delivered;   // 接收端交付的命令数
+        uint32_t duplicates;  // 接收端抑制的重复命令
+        uint32_t stale;       // 接收端丢弃的过时设定值（迟于同 ID 的新命令到达）
+        uint32_t resyncs;     // 接收端因会话号变化重新同步的次数
+        uint32_t old_session; // 丢弃的上一会话报文（命令与应答）
+        uint32_t bad;         // 格式错误报文
+
+        uint32_t rtt_hist[CTRL_RTT_BINS];
+        uint32_t rtt_count;
+        uint32_t rtt_min;
+        uint32_t rtt_max;
+        uint64_t rtt_sum;
+    } ctrl_stats_t;
+
+    /**
+     * @brief 协议端点（每个设备一个，既可发送命令也可接收命令）
+     */
+    typedef struct
+    {
+        ctrl_send_fn send;
+        ctrl_deliver_fn deliver;
+        void *ctx;
+
+        uint32_t rto_us;
+        uint8_t max_retries;
+
+        // 发送端
+        uint8_t session; // 本次上电的会话号
+        uint16_t next_seq;
+        ctrl_slot_t slots[CTRL_WINDOW];
+
+        // 接收端
+        uint8_t rx_synced;
+        uint8_t rx_session;     // 对端当前会话号
+        uint8_t rx_old_session; // 对端上一会话号
+        uint8_t rx_old_budget;  // 还要丢弃的上一会话报文数（在途报文有上限，用完后该会话号可再次同步）
+        uint16_t rx_top;        // 已收到的最大序号
+        uint32_t rx_seen;       // rx_top-1-i 是否已收到
+        struct
+        {
+            uint8_t in_use;
+            uint8_t cmd_id;
+            uint16_t seq; // 已交付的最新序号
+        } rx_latest[CTRL_LATEST_TRACK];
+        uint8_t rx_latest_next; // 表满时轮流替换
+
+        ctrl_stats_t stats;
+    } ctrl_endpoint_t;
+
+    /**
+     * @brief 初始化端点
+     * @param send 发送回调（返回 0 表示成功交给底层）
+     * @param deliver 命令交付回调（每条命令只交付一次）
+     * @param session 会话号：每次上电取随机值（如 esp_random()）。与上次相同（1/256）时退化为只靠序号窗口，
+     *                与上上次相同时对端最多丢弃 CTRL_WINDOW × (重试次数 + 1) 条报文后重新同步
+     */
+    void ctrl_init(ctrl_endpoint_t *ep, ctrl_send_fn send, ctrl_deliver_fn deliver, void *ctx, uint8_t session);
+
+    /**
+     * @brief 提交一条命令并立即发送
+     * @param flags CTRL_FLAG_xxx
+     * @return 命令序号；窗口满或负载过长返回 -1
+     */
+    int ctrl_submit(ctrl_endpoint_t *ep, uint8_t cmd_id, uint8_t flags, const void *payload, uint8_t len, uint32_t now_us);
+
+    /**
+     * @brief 处理收到的报文（命令或应答）
+     */
+    void ctrl_on_receive(ctrl_endpoint_t *ep, const uint8_t *buf, size_t len, uint32_t now_us);
+
+    /**
+     * @brief 周期调用：处理超时重传与失败判定
+     */
+    void ctrl_poll(ctrl_endpoint_t *ep, uint32_t now_us);
+
+    /**
+     * @brief 当前在途命令数
+     */
+    int ctrl_in_flight(const ctrl_endpoint_t *ep);
+
+    /**
+     * @brief 从 RTT 直方图估算分位数（μs，按桶上界）
+     * @param pct 分位（0~100）
+     */
+    uint32_t ctrl_rtt_percentile(const ctrl_stats_t *stats, float pct);
+
+    /**
+     * @brief 清零统计
+     */
+    void ctrl_reset_stats(ctrl_endpoint_t *ep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONTROL_PROTO_H
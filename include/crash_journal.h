@@ -0,0 +1,145 @@
+/**
+ * @file crash_journal.h
+ * @brief 崩溃日志：放在 RTC 慢速内存中，ESP.restart()、看门狗和 panic 复位后仍保留最近几秒的运行记录
+ *
+ * @details 主循环每个阶段进出时更新当前阶段标记和本周期最长耗时，每个周期（如 100ms）提交一条记录：
+ *
+ *          crash_journal_enter / leave ──► 当前阶段、本周期 loop 次数与各阶段最长耗时（几次存储）
+ *          crash_journal_commit        ──► 记录（CRC-32）写入 slots 条的环形队列，覆盖最旧的一条
+ *
+ *          记录：| seq | t_ms | loops | frames | stage_max_us[STAGES] | value[VALUES] | crc |
+ *
+ *          复位后 crash_journal_open() 检查布局（魔数、版本、尺寸），逐条校验 CRC，
+ *          按 seq 从旧到新遍历（crash_journal_next），提交到一半被复位的记录因 CRC 不符被跳过；
+ *          阶段标记指出复位时 loop() 停在哪个阶段（看门狗复位时即卡住的阶段）。
+ *          导出后 crash_journal_start() 清空记录开始本次运行，启动次数保留。
+ *
+ *          记录先在栈上组装并计算 CRC，再整条复制进 RTC 内存，热路径上不逐字节访问慢速内存。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；结构体由调用者放入 RTC_NOINIT_ATTR 变量（上电时内容随机，由 open 识别）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef CRASH_JOURNAL_H
+#define CRASH_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CRASH_JOURNAL_MAGIC 0x4C4E524Au // "JRNL"
+#define CRASH_JOURNAL_VERSION 1
+#define CRASH_JOURNAL_SLOTS 64 // 100ms 一条时约 6.4 秒
+#define CRASH_JOURNAL_STAGES 8 // 阶段 0 为整个 loop()，其余阶段嵌套在其中
+#define CRASH_JOURNAL_VALUES 4
+#define CRASH_JOURNAL_IDLE 0xFF // 不在 loop() 中（delay / 其他任务）
+
+    typedef struct
+    {
+        uint32_t seq;    // 从 1 开始递增
+        uint32_t t_ms;   // 提交时刻（millis）
+        uint16_t loops;  // 本周期完成的 loop() 次数
+        uint16_t frames; // 本周期的 IMU 帧数
+        uint16_t stage_max_us[CRASH_JOURNAL_STAGES]; // 各阶段最长耗时（μs，超过 65535 时饱和）
+        float value[CRASH_JOURNAL_VALUES];          // 最新传感器值
+        uint32_t crc;                               // 以上字段的 CRC-32
+    } crash_journal_entry_t;
+
+    typedef struct
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t entry_size;
+        uint16_t slots;
+        uint16_t head; // 下一条记录写入位置
+        uint32_t boots;
+        uint32_t seq; // 最近一条记录的序号
+        uint32_t ticks_per_us;
+
+        // 当前周期（未提交）
+        volatile uint8_t stage;
+        uint8_t reset_stage; // open() 时读到的阶段标记，即复位时所在阶段
+        uint16_t loops;
+        uint32_t max_ticks[CRASH_JOURNAL_STAGES];
+
+        uint16_t first; // 最旧有效记录的位置
+        uint16_t valid; // 有效记录数
+        crash_journal_entry_t ring[CRASH_JOURNAL_SLOTS];
+    } crash_journal_t;
+
+    /**
+     * @brief 复位后检查日志内容，启动次数加 1
+     * @return 有效记录数；布局不符（上电、固件改变了布局）时重新初始化并返回 -1
+     */
+    int crash_journal_open(crash_journal_t *j);
+
+    /**
+     * @brief 按时间顺序取下一条有效记录（*pos 从 0 开始，由函数推进）
+     * @return 记录，遍历结束返回 NULL
+     */
+    const crash_journal_entry_t *crash_journal_next(const crash_journal_t *j, int *pos);
+
+    /**
+     * @brief 清空记录和当前周期，开始本次运行的记录（保留启动次数和序号）
+     * @param ticks_per_us 耗时计数的频率（ESP32 CCOUNT 为 CPU 主频 MHz）
+     */
+    void crash_journal_start(crash_journal_t *j, uint32_t ticks_per_us);
+
+    /**
+     * @brief 进入阶段
+     */
+    static inline void crash_journal_enter(crash_journal_t *j, uint8_t stage)
+    {
+        j->stage = stage;
+    }
+
+    /**
+     * @brief 离开阶段并记录耗时；离开阶段 0 计一次 loop()
+     */
+    static inline void crash_journal_leave(crash_journal_t *j, uint8_t stage, uint32_t ticks)
+    {
+        if (ticks > j->max_ticks[stage])
+            j->max_ticks[stage] = ticks;
+        if (stage == 0)
+        {
+            j->loops++;
+            j->stage = CRASH_JOURNAL_IDLE;
+        }
+        else
+            j->stage = 0;
+    }
+
+    /**
+     * @brief 提交本周期：loop 次数、各阶段最长耗时和 value，然后开始新周期
+     */
+    void crash_journal_commit(crash_journal_t *j, uint32_t t_ms, uint16_t frames,
+                              const float value[CRASH_JOURNAL_VALUES]);
+
+    int crash_journal_entry_valid(const crash_journal_entry_t *e);
+
+    /**
+     * @brief 单行输出一条记录
+     * @param stage_names CRASH_JOURNAL_STAGES 个阶段名（NULL 项不输出）
+     * @param value_names CRASH_JOURNAL_VALUES 个数值的单位（或名称），输出在数值之后
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int crash_journal_format_entry(const crash_journal_entry_t *e, const char *const *stage_names,
+                                   const char *const *value_names, char *buf, size_t buf_size);
+
+    /**
+     * @brief 摘要：启动次数、有效记录数、复位时所在阶段、最后一条记录之后未提交的 loop 次数
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int crash_journal_format_summary(const crash_journal_t *j, const char *const *stage_names, char *buf,
+                                     size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRASH_JOURNAL_H
@@ -0,0 +1,150 @@
+/**
+ * @file flash_log.h
+ * @brief Flash 分区环形日志：无 SD 卡时在专用数据分区中按扇区循环记录，不依赖文件系统
+ *
+ * @details 分区按 4KB 扇区划分，扇区按序号循环使用，每圈每个扇区只擦除一次（各扇区磨损均匀）：
+ *
+ *          扇区 k：| 扇区头 20B | 记录 | 记录 | ... | 0xFF（未写入）|
+ *          扇区头：| "FLOG" | seq (u32) | rec (u32) | version (u16) | 20 (u16) | crc32 |
+ *          记录：  | len (u16) | type (u8) | 0xFF | seq (u32) | crc32 | payload[len] | 填充到 4 字节 |
+ *
+ *          - 扇区序号 seq 单调递增，且 seq % 扇区数 == k，圈数 = seq / 扇区数；rec 为扇区内第一条记录的序号
+ *          - 写满一个扇区后擦除下一个扇区并写入扇区头（覆盖最旧的扇区），记录不跨扇区
+ *          - 记录先写头再写 payload，CRC-32 覆盖记录头前 8 字节与 payload；写入中途断电的记录校验失败被跳过，
+ *            之后的记录接着写在它后面，不会对已写入的位置重复编程
+ *
+ *          启动恢复：圈数沿扇区编号呈 “L, L, ..., L, L-1, ..., L-1”（第一圈时后段为未写入），
+ *          二分查找最后一个圈数为 L 的扇区即写入扇区，只需读 O(log 扇区数) 个扇区头，
+ *          再顺序扫描该扇区的记录头得到写入位置。
+ *
+ *          预擦除：擦除一个扇区约 45ms，期间 Cache 关闭。flash_log_reserve() 在空闲时提前擦除写入扇区之后的
+ *          若干扇区（每次调用最多一个），之后的追加直接使用，写入突发期间不再擦除。预擦除的扇区没有扇区头，
+ *          启动恢复时从写入扇区之后逐个检查是否为全 0xFF 得到已擦除的扇区数。
+ *
+ *          读出：按扇区序号从旧到新遍历（flash_log_next），提供内存映射地址（esp_partition_mmap）时
+ *          记录数据直接指向映射区，不复制。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；Flash 读 / 写 / 擦除经回调完成（主机测试使用模拟 Flash 映像），
+ *       并发访问需由调用者加锁
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FLASH_LOG_SECTOR 4096
+#define FLASH_LOG_MAGIC 0x474F4C46u // "FLOG"
+#define FLASH_LOG_VERSION 1
+#define FLASH_LOG_SECTOR_HDR 20
+#define FLASH_LOG_REC_HDR 12
+#define FLASH_LOG_MAX_PAYLOAD (FLASH_LOG_SECTOR - FLASH_LOG_SECTOR_HDR - FLASH_LOG_REC_HDR)
+#define FLASH_LOG_PREERASE_MAX 16 // 最多预擦除的扇区数（恢复时参照扇区在前 MAX + 2 个扇区中查找）
+
+    /**
+     * @brief Flash 回调（地址相对分区起点），成功返回 0（同 esp_err_t）
+     */
+    typedef struct
+    {
+        int (*read)(void *ctx, uint32_t addr, void *buf, uint32_t len);
+        int (*write)(void *ctx, uint32_t addr, const void *buf, uint32_t len);
+        int (*erase)(void *ctx, uint32_t addr); // 擦除 addr 起的一个扇区
+    } flash_log_ops_t;
+
+    typedef struct
+    {
+        uint32_t appended;   // 本次运行写入的记录数
+        uint32_t bytes;      // 本次运行写入的字节数（含记录头和填充）
+        uint32_t erases;     // 本次运行擦除的扇区数（含预擦除）
+        uint32_t pre_erases; // 其中由 flash_log_reserve 预先擦除的扇区数
+        uint32_t rejected;   // payload 超长被拒绝
+        uint32_t io_errors;  // 回调返回错误
+        uint32_t crc_errors; // 遍历时校验失败跳过的记录
+        uint32_t open_reads; // 启动恢复读取的扇区头数
+    } flash_log_stats_t;
+
+    typedef struct
+    {
+        flash_log_ops_t ops;
+        void *ctx;
+        const uint8_t *map; // 分区的内存映射地址（可为 NULL，此时经 ops.read 读取）
+        uint32_t sectors;
+        uint8_t empty;     // 尚无任何有效扇区
+        uint32_t head;     // 写入扇区
+        uint32_t head_seq; // 写入扇区的序号
+        uint32_t head_off; // 写入扇区内下一条记录的位置
+        uint32_t rec_seq;  // 下一条记录的序号
+        uint32_t erased;   // 写入扇区之后已预先擦除的扇区数
+        flash_log_stats_t stats;
+    } flash_log_t;
+
+    typedef struct
+    {
+        uint32_t seq; // 当前扇区序号
+        uint32_t off; // 扇区内偏移，0 表示尚未检查扇区头
+    } flash_log_cursor_t;
+
+    typedef struct
+    {
+        uint32_t seq;
+        uint8_t type;
+        uint16_t len;
+        const uint8_t *data; // 映射区或调用者缓冲中的 payload
+    } flash_log_rec_t;
+
+    /**
+     * @brief 挂载分区并恢复写入位置与已预擦除的扇区数（不擦除、不写入）
+     * @param size 分区大小（按扇区向下取整，至少 2 个扇区）
+     * @return 0 成功，-1 分区过小或读取失败
+     */
+    int flash_log_open(flash_log_t *log, const flash_log_ops_t *ops, void *ctx, const uint8_t *map, uint32_t size);
+
+    /**
+     * @brief 追加一条记录；当前扇区放不下时擦除下一个扇区（最旧的数据）
+     * @return 1 已写入，0 超长或 Flash 错误
+     */
+    int flash_log_append(flash_log_t *log, uint8_t type, const void *payload, uint16_t len);
+
+    /**
+     * @brief 预先擦除写入扇区之后的扇区，直到有 n 个已擦除扇区（n 最多 FLASH_LOG_PREERASE_MAX）
+     * @note 每次调用最多擦除一个扇区，供后台任务在空闲时周期调用，把擦除停顿分散到写入突发之外
+     * @return 1 本次擦除了一个扇区，0 已满足，-1 Flash 错误
+     */
+    int flash_log_reserve(flash_log_t *log, uint32_t n);
+
+    /**
+     * @brief 遍历起点：仍保留的最旧扇区
+     */
+    void flash_log_rewind(const flash_log_t *log, flash_log_cursor_t *c);
+
+    /**
+     * @brief 按时间顺序取下一条校验通过的记录
+     * @param buf 无内存映射时存放 payload（至少 FLASH_LOG_MAX_PAYLOAD 字节）；有映射时可为 NULL
+     * @return 1 取得记录，0 遍历结束
+     */
+    int flash_log_next(flash_log_t *log, flash_log_cursor_t *c, flash_log_rec_t *rec, uint8_t *buf);
+
+    /**
+     * @brief 保留的数据字节数（最旧扇区起点到写入位置，含扇区头）
+     */
+    uint32_t flash_log_used(const flash_log_t *log);
+
+    /**
+     * @brief 单行状态：扇区数、圈数、占用、记录与擦除计数、恢复时读取的扇区头数
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int flash_log_format(const flash_log_t *log, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,88 @@
+/**
+ * @file hipnuc_sync.h
+ * @brief HiPNUC 抗干扰分帧器：校验失败后在已缓存字节中重新搜索帧头，快速恢复同步
+ *
+ * @details hipnuc_input() 在长度错误或 CRC 错误时丢弃整帧，并从下一个输入字节开始逐字节找帧头，
+ *          被丢弃的数据中若含有真正的帧头（例如干扰截断了上一帧，下一帧紧随其后），该帧也一并丢失。
+ *
+ *          本模块在 hipnuc_input() 之前做分帧：
+ *
+ *          字节 → [候选缓冲] → 5A A5 → 帧头校验 → 收满 len → hipnuc_input() 逐字节解码
+ *                     ↑                  │失败                      │CRC 失败
+ *                     └── 丢弃首字节，从候选的第 2 字节起重新搜索 ←─┘
+ *
+ *          帧头校验（提交候选帧之前）：
+ *          - len 不为 0 且不超过 max_len（默认协议上限，已知帧长时可调小以更快拒绝）
+ *          - check_tag 打开时，payload 首字节必须是 0x91 / 0x81 / 0x83
+ *
+ *          成功解码一帧后，缓冲中剩余的字节在下一次调用时继续处理，每次调用最多输出一帧，
+ *          调用方式与 hipnuc_input() 相同。厂商文件 hipnuc_dec.c 保持不变。
+ *
+ * @note 纯 C 实现，不依赖 Arduino
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef HIPNUC_SYNC_H
+#define HIPNUC_SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hipnuc_dec.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define HIPNUC_SYNC_HDR_SIZE 6
+
+    typedef struct
+    {
+        uint32_t frames;     // 成功解码的帧数
+        uint32_t recovered;  // 帧头位于失败候选内部、经重新搜索找回的帧数
+        uint32_t crc_errors; // CRC 校验失败
+        uint32_t len_errors; // 帧头长度为 0 或超过 max_len
+        uint32_t tag_errors; // payload 首字节不是已知数据包标签
+        uint32_t skipped;    // 未归入任何有效帧而被丢弃的字节数
+    } hipnuc_sync_stats_t;
+
+    typedef struct
+    {
+        uint8_t buf[HIPNUC_MAX_RAW_SIZE];
+        uint16_t head;    // 当前候选帧起点
+        uint16_t scan;    // 已检查到的位置（相对 head）
+        uint16_t n;       // 缓冲中的字节总数
+        uint16_t rescan;  // 此位置之前的字节来自失败的候选帧（绝对位置）
+        uint16_t max_len; // 允许的最大 payload 长度
+        uint8_t check_tag;
+        hipnuc_sync_stats_t stats;
+    } hipnuc_sync_t;
+
+    /**
+     * @brief 初始化（max_len 为协议上限，check_tag 打开）
+     */
+    void hipnuc_sync_init(hipnuc_sync_t *s);
+
+    /**
+     * @brief 输入一个字节
+     * @return >0 raw 中有新解码的一帧；<0 本次有候选帧被拒绝（长度/标签/CRC）；0 继续接收
+     */
+    int hipnuc_sync_input(hipnuc_sync_t *s, hipnuc_raw_t *raw, uint8_t data);
+
+    /**
+     * @brief 清空缓冲和统计
+     */
+    void hipnuc_sync_reset(hipnuc_sync_t *s);
+
+    /**
+     * @brief 输出统计文本
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int hipnuc_sync_format(const hipnuc_sync_t *s, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HIPNUC_SYNC_H
@@ -0,0 +1,67 @@
+/**
+ * @file hipnuc_synth.h
+ * @brief HiPNUC 合成帧生成器：按协议格式构造 HI91 / HI81 / HI83 完整帧
+ *
+ * @details 用于主机基准测试和解码器验证，无需连接 IMU。帧格式与 hipnuc_dec.c 一致：
+ *
+ *          | 0x5A | 0xA5 | len (u16 LE) | crc (u16 LE) | payload[len] |
+ *
+ *          crc 为 CRC16-CCITT（多项式 0x1021，初值 0），覆盖前 4 字节和 payload。
+ *          字段值由 seq 决定，相同 seq 生成的帧完全相同，便于比对解码结果。
+ *
+ * @note 纯 C 实现，不依赖 Arduino
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#ifndef HIPNUC_SYNTH_H
+#define HIPNUC_SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define HIPNUC_SYNTH_HDR_SIZE 6
+
+// HI83 全部已定义字段（bit 0~19、30、31）
+#define HIPNUC_SYNTH_HI83_ALL 0xC00FFFFFu
+// HI83 常用配置：加速度、角速度、欧拉角、四元数、时间戳
+#define HIPNUC_SYNTH_HI83_TYPICAL 0x0000003Bu
+
+    /**
+     * @brief 计算 CRC16-CCITT（可分段累加）
+     */
+    uint16_t hipnuc_synth_crc16(uint16_t crc, const uint8_t *buf, size_t len);
+
+    /**
+     * @brief 为任意 payload 加上帧头和校验
+     * @return 帧长度，缓冲区不足返回 -1
+     */
+    int hipnuc_synth_frame(uint8_t *out, size_t cap, const uint8_t *payload, uint16_t len);
+
+    /**
+     * @brief 生成 HI91（IMU 浮点数据）帧
+     * @return 帧长度，缓冲区不足返回 -1
+     */
+    int hipnuc_synth_hi91(uint8_t *out, size_t cap, uint32_t seq);
+
+    /**
+     * @brief 生成 HI81（INS 数据）帧
+     */
+    int hipnuc_synth_hi81(uint8_t *out, size_t cap, uint32_t seq);
+
+    /**
+     * @brief 生成 HI83（按位图选择字段）帧
+     * @param bitmap HI83_BMAP_* 组合
+     */
+    int hipnuc_synth_hi83(uint8_t *out, size_t cap, uint32_t bitmap, uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HIPNUC_SYNTH_H
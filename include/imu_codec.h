@@ -0,0 +1,131 @@
+/**
+ * @file imu_codec.h
+ * @brief HiPNUC IMU 记录流式压缩编解码器（量化 + 差分 + ZigZag 变长整数）
+ *
+ * @details 面向 SD 卡日志的 HI91/HI81 记录压缩：
+ *          - HI91 浮点字段按传感器分辨率量化为整数（有损，但量化后可逐位还原）
+ *          - HI81 本身为整数字段，全字段无损
+ *          - 与同类型上一条记录做差分，差值经 ZigZag 变换后按 varint 编码
+ *          - 每 N 条记录插入一次关键帧（绝对值编码），便于从任意关键帧开始解码
+ *
+ *          记录格式：[类型字节][字段1 varint][字段2 varint]...
+ *          类型字节见 IMU_CODEC_REC_xxx，字段顺序由 imu_codec.c 中的字段表决定。
+ *
+ * @note 纯 C 实现，不依赖 Arduino，可直接在主机上编译验证
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#ifndef IMU_CODEC_H
+#define IMU_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hipnuc_dec.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ====================================================================================
+ *  编码参数
+ * ==================================================================================== */
+
+#define IMU_CODEC_DEFAULT_KEY_INTERVAL 400 // 默认关键帧间隔（400Hz 下为 1 秒）
+#define IMU_CODEC_MAX_RECORD_SIZE 256      // 单条编码记录的最大字节数（最坏情况）
+
+// HI91 量化分辨率（每 LSB 的倒数）
+#define IMU_CODEC_SCALE_ACC 10000.0f   // 加速度 0.1 mG
+#define IMU_CODEC_SCALE_GYR 100.0f     // 角速度 0.01 °/s
+#define IMU_CODEC_SCALE_MAG 100.0f     // 磁场 0.01 uT
+#define IMU_CODEC_SCALE_EUL 100.0f     // 欧拉角 0.01 °（与 HI81 一致）
+#define IMU_CODEC_SCALE_QUAT 10000.0f  // 四元数 0.0001（与 HI81 一致）
+#define IMU_CODEC_SCALE_PRESSURE 10.0f // 气压 0.1 Pa
+
+// 记录类型字节
+#define IMU_CODEC_REC_HI91_DELTA 0x01
+#define IMU_CODEC_REC_HI91_KEY 0x02
+#define IMU_CODEC_REC_HI81_DELTA 0x03
+#define IMU_CODEC_REC_HI81_KEY 0x04
+
+#define IMU_CODEC_HI91_FIELDS 20 // HI91 量化后的字段数（不含 tag）
+#define IMU_CODEC_HI81_FIELDS 53 // HI81 整数字段数（不含 tag）
+
+    /**
+     * @brief 单一数据包类型的差分状态
+     */
+    typedef struct
+    {
+        int32_t prev[IMU_CODEC_HI81_FIELDS]; // 上一条记录的量化值
+        uint32_t since_key;                  // 距上一个关键帧的记录数
+        uint8_t valid;                       // prev 是否有效（已出现过关键帧）
+    } imu_codec_chan_t;
+
+    /**
+     * @brief 编解码器状态（编码端与解码端各持有一份）
+     */
+    typedef struct
+    {
+        uint32_t key_interval; // 关键帧间隔（记录数）
+        imu_codec_chan_t hi91; // HI91 差分状态
+        imu_codec_chan_t hi81; // HI81 差分状态
+
+        // 统计信息
+        uint32_t records;     // 已处理记录数
+        uint32_t keyframes;   // 其中的关键帧数
+        uint32_t raw_bytes;   // 原始结构体字节数合计
+        uint32_t coded_bytes; // 编码后字节数合计
+    } imu_codec_t;
+
+    /**
+     * @brief 初始化编解码器
+     * @param c 编解码器状态
+     * @param key_interval 关键帧间隔，0 表示使用默认值
+     */
+    void imu_codec_init(imu_codec_t *c, uint32_t key_interval);
+
+    /**
+     * @brief 强制下一条记录编码为关键帧（例如切换日志文件后）
+     */
+    void imu_codec_force_key(imu_codec_t *c);
+
+    /**
+     * @brief 编码一条 HI91 记录
+     * @param out 输出缓冲区，建议不小于 IMU_CODEC_MAX_RECORD_SIZE
+     * @return 写入字节数，缓冲区不足返回 -1
+     */
+    int imu_codec_encode_hi91(imu_codec_t *c, const hi91_t *in, uint8_t *out, size_t out_size);
+
+    /**
+     * @brief 编码一条 HI81 记录（无损）
+     * @return 写入字节数，缓冲区不足返回 -1
+     */
+    int imu_codec_encode_hi81(imu_codec_t *c, const hi81_t *in, uint8_t *out, size_t out_size);
+
+    /**
+     * @brief 解码一条记录
+     * @param buf 编码数据
+     * @param len 可用字节数
+     * @param hi91 HI91 输出（记录为 HI91 时写入，tag = 0x91）
+     * @param hi81 HI81 输出（记录为 HI81 时写入，tag = 0x81）
+     * @return 消耗的字节数；0 表示数据不完整；-1 表示格式错误或缺少关键帧
+     */
+    int imu_codec_decode(imu_codec_t *c, const uint8_t *buf, size_t len, hi91_t *hi91, hi81_t *hi81);
+
+    /**
+     * @brief 将 HI91 记录按编码分辨率量化再还原，结果与解码输出逐位一致
+     * @note 用于往返校验：decode(encode(x)) == imu_codec_quantize_hi91(x)
+     */
+    void imu_codec_quantize_hi91(const hi91_t *in, hi91_t *out);
+
+    /**
+     * @brief 压缩率（原始字节 / 编码字节），未编码时返回 0
+     */
+    float imu_codec_ratio(const imu_codec_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CODEC_H
@@ -0,0 +1,149 @@
+/**
+ * @file loop_prof.h
+ * @brief 主循环分段剖析：CCOUNT 周期计数探针 + 对数直方图（min/avg/p99/max）
+ *
+ * @details 每个探针记录一段代码的执行周期数，统计量与直方图常驻内存，按需导出：
+ *
+ *          PROF_SCOPE(&prof, id);             C++：作用域结束时自动记录
+ *          PROF_BEGIN(t); ... PROF_END(&prof, id, t);   C：手动成对使用
+ *
+ *          计时源为 Xtensa CCOUNT 寄存器（每个 CPU 周期 +1，读取仅 1 条指令）；
+ *          CCOUNT 按核心独立计数，探针的开始和结束必须在同一核心上执行。
+ *          240MHz 下约 17.9 秒回绕一次，单次测量远小于此，差值用无符号减法即可。
+ *
+ *          直方图按对数-线性分桶：每个 2 的幂区间再均分为 4 个子桶，
+ *          124 个桶覆盖全部 32 位范围，百分位取桶中点，相对误差不超过 12.5%。
+ *
+ *          编译时定义 PROF_ENABLE=0 可移除所有探针：宏展开为空，不读计数器也不访问统计数据。
+ *
+ * @note 纯 C 实现；非 Xtensa 平台（主机验证）以纳秒单调时钟代替 CCOUNT
+ * @version 1.0
+ * @date 2026-02-06
+ */
+
+#ifndef LOOP_PROF_H
+#define LOOP_PROF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if !defined(__XTENSA__)
+#include <time.h>
+#endif
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PROF_MAX_PROBES 8
+#define PROF_SUB_BITS 2 // 每个 2 的幂区间的子桶数 = 1 << PROF_SUB_BITS
+#define PROF_BUCKETS ((32 - PROF_SUB_BITS + 1) << PROF_SUB_BITS)
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t sum;
+        uint32_t hist[PROF_BUCKETS];
+    } prof_probe_t;
+
+    typedef struct
+    {
+        prof_probe_t probes[PROF_MAX_PROBES];
+        uint8_t count;
+        uint32_t ticks_per_us; // ESP32 为 CPU 主频（MHz）
+    } prof_t;
+
+    /**
+     * @brief 读取周期计数器
+     */
+    static inline uint32_t prof_ticks(void)
+    {
+#if defined(__XTENSA__)
+        uint32_t c;
+        __asm__ __volatile__("rsr %0, ccount" : "=a"(c));
+        return c;
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+    }
+
+    void prof_init(prof_t *p, uint32_t ticks_per_us);
+
+    /**
+     * @brief 注册探针
+     * @return 探针 id，已满返回 -1
+     */
+    int prof_add(prof_t *p, const char *name);
+
+    /**
+     * @brief 记录一次测量（周期数）
+     */
+    void prof_record(prof_t *p, int id, uint32_t ticks);
+
+    /**
+     * @brief 百分位（permille：990 为 p99），单位为周期数
+     */
+    uint32_t prof_percentile(const prof_probe_t *probe, uint32_t permille);
+
+    /**
+     * @brief 清空所有探针的统计（保留注册）
+     */
+    void prof_reset(prof_t *p);
+
+    /**
+     * @brief 输出统计表：次数、min/avg/p99/max（μs）
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int prof_format(const prof_t *p, char *buf, size_t buf_size);
+
+    /**
+     * @brief 输出单个探针的直方图（按 2 的幂合并，只列出非空区间）
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int prof_format_hist(const prof_t *p, int id, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if PROF_ENABLE
+#define PROF_BEGIN(var) uint32_t var = prof_ticks()
+#define PROF_END(p, id, var) prof_record((p), (id), prof_ticks() - (var))
+#else
+#define PROF_BEGIN(var)
+#define PROF_END(p, id, var)
+#endif
+
+#ifdef __cplusplus
+#if PROF_ENABLE
+/**
+ * @brief 作用域探针：构造时读计数器，析构时记录
+ */
+struct ProfScope
+{
+    prof_t *p;
+    int id;
+    uint32_t t0;
+
+    ProfScope(prof_t *prof, int probe) : p(prof), id(probe), t0(prof_ticks()) {}
+    ~ProfScope() { prof_record(p, id, prof_ticks() - t0); }
+};
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(p, id) ProfScope PROF_CONCAT(prof_scope_, __LINE__)((p), (id))
+#else
+#define PROF_SCOPE(p, id)
+#endif
+#endif
+
+#endif // LOOP_PROF_H
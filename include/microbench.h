@@ -0,0 +1,94 @@
+/**
+ * @file microbench.h
+ * @brief 微基准注册表：预热 + 多次计时，输出周期数、耗时和吞吐量的统一表格
+ *
+ * @details 每个基准是一组回调：setup（外设未就绪时返回非 0，整项跳过）、run（一次被测操作，
+ *          返回处理的字节数）、teardown。运行过程：
+ *
+ *          setup ─► 预热 warmup 批（不计时）─► 计时 reps 批 ─► teardown
+ *          每批连续调用 batch 次 run，批耗时扣除计时开销后除以 batch 得到每次操作的周期数
+ *
+ *          结果取各批的最小值 / 中位数 / 最大值（中位数不受偶发中断和任务切换影响），
+ *          吞吐量按中位数计算：有字节数时为 MB/s，否则为每秒操作次数。
+ *
+ *          表格（microbench_format_header / microbench_format_row）：
+ *          | 名称 | 批×次 | 周期中位 | 周期最小 | 周期最大 | us/次 | 吞吐 |
+ *
+ * @note 纯 C 实现，不依赖 Arduino；计时函数由调用者提供（ESP32 为 CCOUNT 周期计数器），
+ *       单批耗时需小于计数器回绕周期（240MHz 时约 17 秒）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MICROBENCH_MAX_REPS 64
+
+    typedef struct
+    {
+        const char *name;
+        int (*setup)(void *ctx);     // 可为 NULL；返回非 0 表示未就绪，跳过该项
+        uint32_t (*run)(void *ctx);  // 一次被测操作，返回处理的字节数（0 表示只按次数计）
+        void (*teardown)(void *ctx); // 可为 NULL；只在 setup 成功后调用
+        void *ctx;
+        uint16_t batch; // 每批调用 run 的次数（0 按 1），很短的操作取大值以摊薄计时开销
+    } microbench_t;
+
+    typedef struct
+    {
+        uint32_t (*ticks)(void); // 单调递增的计数器
+        uint32_t ticks_per_us;   // ESP32 为 CPU 主频（MHz）
+        uint16_t warmup;         // 不计时的预热批数
+        uint16_t reps;           // 计时批数（最多 MICROBENCH_MAX_REPS）
+    } microbench_cfg_t;
+
+    typedef struct
+    {
+        uint8_t skipped;  // setup 返回非 0
+        uint16_t reps;    // 实际计时批数
+        uint32_t min;     // 每次操作的周期数（已扣除计时开销）
+        uint32_t median;
+        uint32_t max;
+        uint32_t bytes;   // 最后一次 run 返回的字节数
+        uint32_t overhead; // 一次计时本身的周期数
+    } microbench_result_t;
+
+    /**
+     * @brief 运行一项基准
+     * @return 0 完成，1 跳过
+     */
+    int microbench_run(const microbench_t *b, const microbench_cfg_t *cfg, microbench_result_t *r);
+
+    /**
+     * @brief 表头（两行：列名与分隔线）
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int microbench_format_header(char *buf, size_t buf_size);
+
+    /**
+     * @brief 一项结果的表格行（跳过的项只输出名称）
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int microbench_format_row(const microbench_t *b, const microbench_result_t *r, uint32_t ticks_per_us, char *buf,
+                              size_t buf_size);
+
+    /**
+     * @brief 依次运行注册表中的全部基准，每完成一项输出一行（print 收到以换行结尾的文本）
+     * @return 完成的项数
+     */
+    int microbench_suite(const microbench_t *list, int n, const microbench_cfg_t *cfg, void (*print)(const char *text));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MICROBENCH_H
@@ -0,0 +1,100 @@
+/**
+ * @file pca9555_cs.h
+ * @brief PCA9555 片选驱动：输出端口影子寄存器 + 只写变化的端口字节
+ *
+ * @details TCA9555 库的 digitalWrite() 每次都要先读输出寄存器再写回（读-改-写），
+ *          400kHz I2C 下一次片选翻转约 7 个字节的总线时间。本驱动在内存中保存两个
+ *          输出端口的影子副本：
+ *          - 不再回读，直接根据影子计算新值
+ *          - 值不变时不访问总线
+ *          - 只有一个端口变化时写 1 字节（寄存器 2 或 3）
+ *          - 两个端口都变化时利用寄存器自动递增，一次传输写 2 字节
+ *          - pca9555_cs_select() 把"释放旧片选 + 选中新片选"合并为一次写入
+ *
+ *          PCA9555 寄存器：0/1 输入，2/3 输出，4/5 极性反转，6/7 方向（0=输出）
+ *
+ * @note 纯 C 实现，I2C 写入通过回调完成，可在主机上验证写入序列
+ * @warning 使用本驱动后不要再通过其它途径写输出寄存器，否则影子与芯片不一致
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#ifndef PCA9555_CS_H
+#define PCA9555_CS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PCA9555_REG_INPUT0 0
+#define PCA9555_REG_OUTPUT0 2
+#define PCA9555_REG_POLARITY0 4
+#define PCA9555_REG_CONFIG0 6
+
+    /**
+     * @brief I2C 写回调：从寄存器 reg 开始连续写 len 字节（芯片自动递增地址）
+     * @return 0 成功，其它为失败
+     */
+    typedef int (*pca9555_write_fn)(void *ctx, uint8_t reg, const uint8_t *data, uint8_t len);
+
+    /**
+     * @brief 总线访问统计
+     */
+    typedef struct
+    {
+        uint32_t writes;  // I2C 写传输次数
+        uint32_t bytes;   // 总线字节数（含器件地址和寄存器字节）
+        uint32_t skipped; // 值未变化而省略的写入
+        uint32_t errors;  // 写失败次数
+    } pca9555_cs_stats_t;
+
+    typedef struct
+    {
+        uint8_t out[2];   // 输出端口影子寄存器
+        uint16_t cs_mask; // 用作片选的引脚（高电平为释放）
+        pca9555_write_fn write;
+        void *ctx;
+        pca9555_cs_stats_t stats;
+    } pca9555_cs_t;
+
+    /**
+     * @brief 初始化：cs_mask 中的引脚配置为输出并置高，其余保持输入
+     * @return 0 成功，-1 I2C 写失败
+     */
+    int pca9555_cs_init(pca9555_cs_t *cs, uint16_t cs_mask, pca9555_write_fn write, void *ctx);
+
+    /**
+     * @brief 写 16 位输出值（bit0=P0.0 … bit15=P1.7），只写变化的端口
+     * @return 0 成功（含无需写入），-1 I2C 写失败（影子保持不变）
+     */
+    int pca9555_cs_write16(pca9555_cs_t *cs, uint16_t value);
+
+    /**
+     * @brief 设置单个引脚电平
+     */
+    int pca9555_cs_write_pin(pca9555_cs_t *cs, uint8_t pin, uint8_t level);
+
+    /**
+     * @brief 选中 pin（拉低），同时释放其它所有片选；一次 I2C 传输完成
+     */
+    int pca9555_cs_select(pca9555_cs_t *cs, uint8_t pin);
+
+    /**
+     * @brief 释放所有片选
+     */
+    int pca9555_cs_release(pca9555_cs_t *cs);
+
+    /**
+     * @brief 当前影子寄存器值
+     */
+    uint16_t pca9555_cs_shadow(const pca9555_cs_t *cs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCA9555_CS_H
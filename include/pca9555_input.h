@@ -0,0 +1,109 @@
+/**
+ * @file pca9555_input.h
+ * @brief PCA9555 中断驱动输入服务：逐引脚软件消抖 + 带时间戳的事件队列
+ *
+ * @details PCA9555 任一输入引脚与上次读取值不同时拉低 INT，读输入寄存器后 INT 释放。
+ *          因此只需在 INT 下降沿后读一次 2 字节输入端口，空闲时 I2C 总线零访问：
+ *
+ *          INT 中断 ──> 读端口(2字节) ──> pca9555_in_update()   记录原始边沿
+ *          主循环   ──> pca9555_in_poll()（仅在 busy 时）      消抖到期后产生事件
+ *          主循环   ──> pca9555_in_pop()                         取事件
+ *
+ *          消抖规则：引脚原始电平需保持 debounce_us 不变才确认；期间每次抖动重新计时，
+ *          事件时间戳为本轮第一次边沿的时刻。恢复到原电平的抖动不产生事件（计为 bounce）。
+ *          两次 INT 之间引脚电平不会变化（否则会再次触发 INT），消抖到期确认不需要再读总线。
+ *
+ * @note 纯 C 实现，不做 I/O，端口值和时间由调用者传入，可在主机上验证消抖逻辑
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#ifndef PCA9555_INPUT_H
+#define PCA9555_INPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PCA9555_IN_QUEUE_LEN 32       // 事件队列深度（2 的幂）
+#define PCA9555_IN_DEFAULT_DEBOUNCE_US 10000
+
+    /**
+     * @brief 输入事件
+     */
+    typedef struct
+    {
+        uint8_t pin;   // 0~15（P0.0~P1.7）
+        uint8_t level; // 确认后的电平
+        uint32_t t_us; // 第一次边沿时刻
+    } pca9555_in_event_t;
+
+    /**
+     * @brief 统计
+     */
+    typedef struct
+    {
+        uint32_t reads;    // 端口读取次数（每次 2 字节）
+        uint32_t edges;    // 原始边沿数（含抖动）
+        uint32_t bounces;  // 消抖窗口内恢复原电平而被丢弃的变化
+        uint32_t events;   // 确认的事件数
+        uint32_t overflow; // 队列满丢弃的事件
+    } pca9555_in_stats_t;
+
+    typedef struct
+    {
+        uint16_t mask;        // 监视的输入引脚
+        uint16_t raw;         // 最近一次读到的原始电平
+        uint16_t stable;      // 消抖后的电平
+        uint16_t pending;     // 正在消抖的引脚
+        uint32_t debounce_us;
+        uint32_t first_us[16]; // 本轮第一次边沿时刻
+        uint32_t last_us[16];  // 最近一次边沿时刻
+
+        pca9555_in_event_t queue[PCA9555_IN_QUEUE_LEN];
+        uint8_t head;
+        uint8_t tail;
+
+        pca9555_in_stats_t stats;
+    } pca9555_in_t;
+
+    /**
+     * @brief 初始化
+     * @param mask 监视的引脚（需已配置为输入）
+     * @param initial 初始端口值（初始化时读一次）
+     */
+    void pca9555_in_init(pca9555_in_t *in, uint16_t mask, uint16_t initial, uint32_t debounce_us);
+
+    /**
+     * @brief 处理一次端口读取（INT 触发后调用）
+     * @param port 输入寄存器值（bit0=P0.0 … bit15=P1.7）
+     * @param now_us 读取时刻（建议使用 INT 中断时记录的时间）
+     */
+    void pca9555_in_update(pca9555_in_t *in, uint16_t port, uint32_t now_us);
+
+    /**
+     * @brief 检查消抖到期的引脚并生成事件
+     * @return 本次生成的事件数
+     */
+    int pca9555_in_poll(pca9555_in_t *in, uint32_t now_us);
+
+    /**
+     * @brief 是否有引脚正在消抖（为 0 时主循环无需调用 poll）
+     */
+    int pca9555_in_busy(const pca9555_in_t *in);
+
+    /**
+     * @brief 取出一个事件
+     * @return 1 成功，0 队列为空
+     */
+    int pca9555_in_pop(pca9555_in_t *in, pca9555_in_event_t *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCA9555_INPUT_H
@@ -194,6 +194,12 @@ extern "C"
      */
     void pin_init_peripherals(void);
 
+    /**
+     * @brief 检测 SD 卡是否插入
+     * @return true=已插入, false=未插入
+     */
+    bool sd_card_detected(void);
+
 #ifdef __cplusplus
 }
 #endif
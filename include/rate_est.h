@@ -0,0 +1,110 @@
+/**
+ * @file rate_est.h
+ * @brief 单数据源帧率 / 抖动 / 链路质量估计（每个样本 O(1)）
+ *
+ * @details 每个数据源（IMU 各数据包类型、DPS310、编码器……）各用一个 rate_est_t，
+ *          在收到一个样本时调用 rate_est_sample()：
+ *
+ *          dt = t - t_prev
+ *          ├── dt ≤ RATE_EST_GAP_FACTOR × 平均间隔 → 更新 EWMA 间隔和 EWMA 抖动，按偏差计入直方图
+ *          └── 否则记为一次间断，按 dt / 平均间隔 估计漏掉的样本数（不污染平均值）
+ *
+ *          连续 RATE_EST_RELOCK 次间断视为数据源改变了输出频率，以新的间隔重新开始平均。
+ *
+ *          抖动直方图按 |dt - 平均间隔| 占平均间隔的比例分桶：
+ *          ≤1% | ≤2% | ≤5% | ≤10% | ≤20% | ≤50% | >50% | 间断
+ *
+ *          当前频率 = 1e6 / max(平均间隔, 距上一样本的时间)，数据源停止后自然衰减到 0 附近，
+ *          不再依赖 1 秒窗口计数。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；时间由调用者传入（micros()）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef RATE_EST_H
+#define RATE_EST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RATE_EST_HIST_BINS 8
+#define RATE_EST_ALPHA_SHIFT 4  // EWMA 系数 1/16
+#define RATE_EST_GAP_FACTOR 1.5f // 超过 1.5 倍平均间隔视为间断
+#define RATE_EST_RELOCK 4        // 连续间断次数达到后重新锁定频率
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t samples;  // 样本数
+        uint32_t errors;   // 校验失败等错误
+        uint32_t gaps;     // 间断次数
+        uint32_t missed;   // 按间断估计的漏掉样本数
+        uint64_t bytes;    // 样本字节数合计
+        uint32_t dt_max_us;
+        uint32_t hist[RATE_EST_HIST_BINS];
+
+        float avg_dt_us; // EWMA 样本间隔
+        float jitter_us; // EWMA |dt - 平均间隔|
+        uint32_t last_us;
+        uint8_t gap_run; // 连续间断次数
+    } rate_est_t;
+
+    /**
+     * @brief 对外读取的快照（显示、's' 命令、遥测）
+     */
+    typedef struct
+    {
+        float hz;             // 当前频率（停止后随时间衰减）
+        float avg_dt_us;      // 平均间隔
+        float jitter_us;      // 平均抖动
+        float bytes_per_frame;
+        uint32_t age_us;      // 距上一样本
+        uint32_t samples;
+        uint32_t errors;
+        uint32_t gaps;
+        uint32_t missed;
+        uint32_t dt_max_us;
+    } rate_est_snapshot_t;
+
+    void rate_est_init(rate_est_t *r, const char *name);
+
+    /**
+     * @brief 记录一个样本
+     * @param bytes 该样本在链路上的字节数（无意义时传 0）
+     */
+    void rate_est_sample(rate_est_t *r, uint32_t t_us, uint16_t bytes);
+
+    /**
+     * @brief 记录错误（CRC 失败等）
+     */
+    void rate_est_error(rate_est_t *r, uint32_t count);
+
+    /**
+     * @brief 当前频率；从未收到或只收到一个样本时为 0
+     */
+    float rate_est_hz(const rate_est_t *r, uint32_t now_us);
+
+    void rate_est_snapshot(const rate_est_t *r, uint32_t now_us, rate_est_snapshot_t *out);
+
+    /**
+     * @brief 清零统计，保留名称
+     */
+    void rate_est_reset(rate_est_t *r);
+
+    /**
+     * @brief 输出单行摘要和抖动直方图
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int rate_est_format(const rate_est_t *r, uint32_t now_us, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RATE_EST_H
@@ -0,0 +1,118 @@
+/**
+ * @file replay.h
+ * @brief 串口录制重放引擎：把 RCAP 录制按原速或加速送入解码器等下游模块，统计帧率/延迟/丢帧
+ *
+ * @details 每个下游模块注册为一个 sink，按字节接收数据：
+ *
+ *          input(ctx, byte, t_us, &done_us)  返回 >0 完成一帧，<0 错误帧（校验/长度），0 继续
+ *
+ *          字节时间戳由记录时间戳反推：一条记录的最后一个字节在读取时刻到达，
+ *          之前的字节按波特率依次提前一个字节时间。sink 可改写 done_us 表示帧实际结束时刻
+ *          （例如 Modbus RTU 以 3.5 字符静默判定帧尾）。
+ *
+ *          报告分两类：
+ *          - 确定性指标（只取决于录制内容，重复运行结果完全相同）：
+ *            帧数、错误帧、帧间隔 min/avg/max/σ、估计漏帧数、交付延迟（帧结束 → 主循环读到）
+ *          - 主机性能指标：每帧处理耗时、按原速重放时落后于录制时间的最大值
+ *
+ * @note 纯 C 实现；计时和休眠由调用者通过 replay_clock_t 提供
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "rs485_capture.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define REPLAY_MAX_SINKS 4
+
+    typedef int (*replay_input_fn)(void *ctx, uint8_t byte, uint32_t t_us, uint32_t *done_us);
+    typedef int (*replay_flush_fn)(void *ctx, uint32_t t_us, uint32_t *done_us);
+
+    typedef struct
+    {
+        uint32_t bytes;
+        uint32_t frames;
+        uint32_t errors;
+        uint32_t missed; // 按首末帧时长和标称间隔估计的漏帧数（错误帧不计入）
+
+        uint32_t first_us; // 第一帧结束时刻
+        uint32_t last_us;  // 最后一帧结束时刻
+        uint32_t gap_min_us;
+        uint32_t gap_max_us;
+        uint64_t gap_sum_us;
+        uint64_t gap_sq_sum; // μs²，用于计算标准差
+
+        uint32_t delay_max_us; // 交付延迟：帧结束 → 所在记录被读取
+        uint64_t delay_sum_us;
+
+        uint64_t proc_ns;     // 主机处理耗时合计
+        uint32_t proc_max_ns; // 单条记录的最大处理耗时
+    } replay_stats_t;
+
+    typedef struct
+    {
+        const char *name;
+        replay_input_fn input;
+        replay_flush_fn flush; // 录制结束时收尾，可为 NULL
+        void *ctx;
+        uint32_t nominal_us; // 标称帧间隔，0 表示不估计漏帧
+        replay_stats_t stats;
+    } replay_sink_t;
+
+    typedef struct
+    {
+        uint64_t (*now_ns)(void);
+        void (*sleep_ns)(uint64_t ns);
+    } replay_clock_t;
+
+    typedef struct
+    {
+        replay_sink_t sinks[REPLAY_MAX_SINKS];
+        uint8_t count;
+
+        uint32_t baud;
+        uint32_t records;
+        uint32_t bytes;
+        uint32_t span_us;         // 第一条到最后一条记录
+        uint32_t read_gap_max_us; // 相邻两次读取的最大间隔（主循环卡顿）
+        uint64_t late_max_ns;     // 按原速重放时落后于录制时间的最大值
+        uint8_t paced;
+    } replay_t;
+
+    void replay_init(replay_t *e);
+
+    /**
+     * @brief 注册下游模块
+     * @return sink 序号，已满返回 -1
+     */
+    int replay_add_sink(replay_t *e, const char *name, replay_input_fn input, replay_flush_fn flush,
+                        void *ctx, uint32_t nominal_us);
+
+    /**
+     * @brief 重放整个录制
+     * @param speed 1.0 为原速，2.0 为两倍速，≤0 为不限速
+     * @param clock speed > 0 时用于等待；不限速时只用 now_ns 统计处理耗时，可为 NULL
+     * @return 0 成功，-1 文件头无效，-2 记录被截断（已重放部分的统计仍有效）
+     */
+    int replay_run(replay_t *e, const uint8_t *capture, size_t size, float speed, const replay_clock_t *clock);
+
+    /**
+     * @brief 输出报告文本
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int replay_format(const replay_t *e, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REPLAY_H
@@ -0,0 +1,88 @@
+/**
+ * @file rs485_capture.h
+ * @brief 带时间戳的串口字节录制格式（RCAP）
+ *
+ * @details 设备端每次从 UART 读出一批字节，就以读取时刻为时间戳写一条记录；
+ *          主机端按记录重放，可还原数据到达主循环的节奏（包括主循环卡顿造成的成批到达）。
+ *
+ *          文件头（12 字节，小端）：
+ *          | "RCAP" | version (u16) | flags (u16) | baud (u32) |
+ *
+ *          记录（6 + len 字节，小端）：
+ *          | t_us (u32) | len (u16) | data[len] |
+ *
+ *          t_us 为设备 micros()，约 71 分钟回绕一次，使用时只取相邻记录的差值。
+ *
+ * @note 纯 C 实现，不依赖 Arduino
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#ifndef RS485_CAPTURE_H
+#define RS485_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RCAP_VERSION 1
+#define RCAP_HEADER_SIZE 12
+#define RCAP_RECORD_HDR_SIZE 6
+
+    /**
+     * @brief 写文件头
+     */
+    void rcap_encode_header(uint8_t out[RCAP_HEADER_SIZE], uint32_t baud);
+
+    /**
+     * @brief 解析文件头
+     * @return 1 有效，0 不是 RCAP 文件或版本不支持
+     */
+    int rcap_decode_header(const uint8_t in[RCAP_HEADER_SIZE], uint32_t *baud);
+
+    /**
+     * @brief 写记录头（数据紧随其后写入）
+     */
+    void rcap_encode_record_hdr(uint8_t out[RCAP_RECORD_HDR_SIZE], uint32_t t_us, uint16_t len);
+
+    void rcap_decode_record_hdr(const uint8_t in[RCAP_RECORD_HDR_SIZE], uint32_t *t_us, uint16_t *len);
+
+    /**
+     * @brief 内存中的录制文件读取器
+     */
+    typedef struct
+    {
+        const uint8_t *buf;
+        size_t size;
+        size_t pos;
+        uint32_t baud;
+    } rcap_reader_t;
+
+    /**
+     * @return 1 成功，0 文件头无效
+     */
+    int rcap_reader_init(rcap_reader_t *r, const uint8_t *buf, size_t size);
+
+    /**
+     * @brief 取下一条记录（data 指向读取器缓冲区内部）
+     * @return 1 成功，0 已到结尾，-1 记录被截断
+     */
+    int rcap_reader_next(rcap_reader_t *r, uint32_t *t_us, const uint8_t **data, uint16_t *len);
+
+    /**
+     * @brief 每字节在线上的传输时间（8N1，10 位）
+     */
+    static inline uint32_t rcap_byte_ns(uint32_t baud)
+    {
+        return baud ? (uint32_t)(10000000000ULL / baud) : 0;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RS485_CAPTURE_H
@@ -0,0 +1,128 @@
+/**
+ * @file run_stats.h
+ * @brief 单通道流式统计：Welford 均值/方差、最小/最大值，累计与滑动窗口（每个样本 O(1)，固定内存）
+ *
+ * @details 每个通道（气压、温度、陀螺各轴、编码器角度……）各用一个 run_stats_t，
+ *          按通道自身的采样频率调用 run_stats_add()：
+ *
+ *          样本 ──► 当前块（Welford 逐样本更新）
+ *                      │ 满 block_len 个样本
+ *                      ├──► 合并进累计统计（Chan 并行合并公式）
+ *                      └──► 压入块环形队列（blocks 个块，覆盖最旧的块）
+ *
+ *          窗口统计 = 环形队列中的块 + 当前未满的块，查询时合并（O(blocks)）；
+ *          窗口长度在 (blocks - 1) × block_len 与 blocks × block_len 个样本之间，
+ *          最小/最大值在窗口内是精确的。累计统计同样是“已合并的块 + 当前块”。
+ *
+ *          Welford：delta = x - mean，mean += delta / n，m2 += delta × (x - mean)，
+ *          只累加与均值的偏差，不会像 Σx² - n·mean² 那样相消。此外样本先减去首个样本作为偏移：
+ *          气压约 101325 Pa 时单精度分辨率只有 0.008 Pa，累计均值每合并一块只该移动千分之几 Pa，
+ *          不减偏移时这些增量会被舍入掉（bench/run_stats_test.c 的漂移场景可复现）。
+ *          逐样本更新只发生在块内，累计统计按块合并，误差不会逐样本累积。
+ *
+ *          NaN / Inf 样本不计入，单独计数。
+ *
+ * @note 纯 C 实现，不依赖 Arduino；方差为样本方差（除以 n - 1）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RUN_STATS_MAX_BLOCKS 16
+
+    /**
+     * @brief 一组样本的摘要，可相互合并
+     */
+    typedef struct
+    {
+        uint32_t n;
+        float mean;
+        float m2; // Σ(x - mean)²
+        float min;
+        float max;
+    } run_stats_acc_t;
+
+    typedef struct
+    {
+        const char *name;
+        const char *unit;
+        uint16_t block_len; // 每块样本数
+        uint8_t blocks;     // 窗口块数
+        uint8_t head;       // 下一个写入的块
+        uint8_t filled;     // 环形队列中已有的块数
+        uint32_t rejected;  // NaN / Inf 样本数
+        float shift;        // 偏移（首个样本）；以下各块的 mean / m2 按 x - shift 计算
+        run_stats_acc_t cur;   // 当前未满的块
+        run_stats_acc_t total; // 已合并的完整块
+        run_stats_acc_t ring[RUN_STATS_MAX_BLOCKS];
+    } run_stats_t;
+
+    void run_stats_acc_clear(run_stats_acc_t *a);
+
+    /**
+     * @brief Welford 单样本更新
+     */
+    void run_stats_acc_add(run_stats_acc_t *a, float x);
+
+    /**
+     * @brief dst ← dst ∪ src
+     */
+    void run_stats_acc_merge(run_stats_acc_t *dst, const run_stats_acc_t *src);
+
+    /**
+     * @brief 样本方差；少于 2 个样本时为 0
+     */
+    float run_stats_acc_var(const run_stats_acc_t *a);
+
+    /**
+     * @brief 样本标准差
+     */
+    float run_stats_acc_std(const run_stats_acc_t *a);
+
+    /**
+     * @param block_len 每块样本数（≥ 1）
+     * @param blocks    窗口块数（1 ~ RUN_STATS_MAX_BLOCKS，超出时取边界值）
+     */
+    void run_stats_init(run_stats_t *s, const char *name, const char *unit, uint16_t block_len, uint8_t blocks);
+
+    /**
+     * @brief 记录一个样本
+     */
+    void run_stats_add(run_stats_t *s, float x);
+
+    /**
+     * @brief 滑动窗口统计
+     */
+    void run_stats_window(const run_stats_t *s, run_stats_acc_t *out);
+
+    /**
+     * @brief 自初始化 / 清零以来的累计统计
+     */
+    void run_stats_total(const run_stats_t *s, run_stats_acc_t *out);
+
+    /**
+     * @brief 清零统计，保留名称和窗口配置
+     */
+    void run_stats_reset(run_stats_t *s);
+
+    /**
+     * @brief 输出单行摘要：窗口与累计的样本数、均值、标准差、最小/最大值
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int run_stats_format(const run_stats_t *s, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUN_STATS_H
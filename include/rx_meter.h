@@ -0,0 +1,89 @@
+/**
+ * @file rx_meter.h
+ * @brief 接收路径测量：CPU 占用与帧交付延迟
+ *
+ * @details 用于比较 IMU 的两种接收方式（loop() 轮询 / UART 事件任务）：
+ *
+ *          - CPU 占用：接收路径每次执行（一次轮询或一次唤醒）的 CCOUNT 周期数累加，
+ *            除以统计区间时长；轮询方式下没有数据的空轮询也计入
+ *          - 交付延迟：设备没有“帧到达时刻”的硬件时间戳，改用 IMU 自身时间戳估计相对延迟：
+ *
+ *              offset = 解码时刻(本地 us) - IMU 时间戳(us)
+ *              延迟   = offset - 区间内 offset 的最小值
+ *
+ *            即每帧比“最快交付的那一帧”晚了多少，与两端时钟的固定偏差无关。
+ *            时钟漂移会在长区间内累积（几十 ppm），统计区间应在几十秒以内。
+ *
+ *          延迟直方图：≤0.25 | ≤0.5 | ≤1 | ≤2 | ≤5 | ≤10 | ≤20 | >20 ms
+ *
+ * @note 纯 C 实现，不依赖 Arduino；时间和周期数由调用者传入
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef RX_METER_H
+#define RX_METER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RX_METER_LAT_BINS 8
+
+    typedef struct
+    {
+        uint32_t ticks_per_us;
+        uint32_t start_us;    // 统计区间起点
+        uint64_t busy_ticks;  // 接收路径累计周期数
+        uint32_t calls;       // 接收路径执行次数
+        uint32_t idle_calls;  // 其中没有读到数据的次数
+        uint32_t bytes;
+        uint32_t frames;
+
+        uint32_t offset_min;  // 最小 offset（本地 - IMU）
+        uint8_t offset_valid;
+        uint32_t lat_max_us;
+        uint64_t lat_sum_us;
+        uint32_t lat_hist[RX_METER_LAT_BINS];
+    } rx_meter_t;
+
+    void rx_meter_init(rx_meter_t *m, uint32_t ticks_per_us, uint32_t now_us);
+
+    /**
+     * @brief 清零统计，开始新区间
+     */
+    void rx_meter_reset(rx_meter_t *m, uint32_t now_us);
+
+    /**
+     * @brief 记录一次接收路径执行
+     * @param ticks 本次耗时（周期数）
+     * @param bytes 本次读到的字节数
+     */
+    void rx_meter_busy(rx_meter_t *m, uint32_t ticks, uint32_t bytes);
+
+    /**
+     * @brief 记录一帧的交付
+     * @param rx_us  解码完成时刻（本地 micros()）
+     * @param src_us 帧内 IMU 时间戳（换算为 us）
+     */
+    void rx_meter_frame(rx_meter_t *m, uint32_t rx_us, uint32_t src_us);
+
+    /**
+     * @brief 区间内接收路径占用一个核心的比例（‰）
+     */
+    uint32_t rx_meter_cpu_permille(const rx_meter_t *m, uint32_t now_us);
+
+    /**
+     * @return 写入的字节数（不含结尾 0）
+     */
+    int rx_meter_format(const rx_meter_t *m, uint32_t now_us, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RX_METER_H
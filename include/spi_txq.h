@@ -0,0 +1,126 @@
+/**
+ * @file spi_txq.h
+ * @brief SPI 事务队列：按设备分组合并，摊薄 PCA9555 片选的 I2C 开销
+ *
+ * @details 片选挂在 I2C 扩展器上时，每次 CS 变化都是一次 I2C 写（约 70μs），
+ *          往往比 SPI 传输本身还慢。调用者先把若干 (设备, tx, rx) 作业提交到队列，
+ *          spi_txq_flush() 再统一执行：
+ *          - 重排：按设备首次出现的顺序分组，同一设备内保持提交顺序
+ *          - 合并：同一设备的连续作业只选中一次，CS 在整组期间保持有效
+ *          - 切换：从设备 A 切到设备 B 只需一次 select 回调（pca9555_cs_select
+ *                  把释放 A 与选中 B 合并为一次 I2C 写）
+ *          - 分帧：需要 CS 上升沿结束命令的作业（如 Flash 指令）置 SPI_TXQ_CS_BREAK
+ *
+ *          不同设备间的作业会被重排；跨设备有顺序要求时在两段之间调用 spi_txq_flush()。
+ *
+ * @note 纯 C 实现，片选与 SPI 传输通过回调完成，可在主机上验证执行序列
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#ifndef SPI_TXQ_H
+#define SPI_TXQ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SPI_TXQ_MAX_JOBS 32
+#define SPI_TXQ_MAX_DEVICES 16
+
+// 作业标志
+#define SPI_TXQ_CS_BREAK 0x01 // 本作业结束后释放 CS（即使下一个作业属于同一设备）
+
+    /**
+     * @brief 设备描述
+     */
+    typedef struct
+    {
+        uint8_t cs_pin;   // 扩展器上的片选引脚
+        uint8_t mode;     // SPI 模式 0~3
+        uint32_t freq_hz; // SPI 时钟
+    } spi_txq_dev_t;
+
+    /**
+     * @brief 作业（缓冲区在 flush 完成前必须保持有效）
+     */
+    typedef struct
+    {
+        uint8_t dev;
+        uint8_t flags;
+        uint16_t len;
+        const uint8_t *tx; // NULL 表示发送 0xFF
+        uint8_t *rx;       // NULL 表示丢弃接收数据
+    } spi_txq_job_t;
+
+    /**
+     * @brief 执行回调
+     */
+    typedef struct
+    {
+        int (*select)(void *ctx, const spi_txq_dev_t *dev); // 选中设备（同时释放其它片选）并应用其 SPI 设置；
+                                                            // 设置与当前不同时须先释放旧片选再改模式 / 时钟
+        int (*release)(void *ctx);                          // 释放所有片选
+        void (*transfer)(void *ctx, const uint8_t *tx, uint8_t *rx, uint16_t len);
+    } spi_txq_ops_t;
+
+    /**
+     * @brief 统计
+     */
+    typedef struct
+    {
+        uint32_t jobs;      // 已执行作业
+        uint32_t bytes;     // SPI 传输字节
+        uint32_t selects;   // select 回调次数
+        uint32_t releases;  // release 回调次数
+        uint32_t cs_saved;  // 相比每作业"选中+释放"节省的片选操作
+        uint32_t reordered; // 被提前执行的作业数
+        uint32_t rejected;  // 队列满被拒绝的提交
+        uint32_t errors;    // 片选回调失败
+    } spi_txq_stats_t;
+
+    typedef struct
+    {
+        spi_txq_dev_t devs[SPI_TXQ_MAX_DEVICES];
+        uint8_t n_devs;
+        spi_txq_job_t jobs[SPI_TXQ_MAX_JOBS];
+        uint8_t n_jobs;
+        spi_txq_ops_t ops;
+        void *ctx;
+        spi_txq_stats_t stats;
+    } spi_txq_t;
+
+    void spi_txq_init(spi_txq_t *q, const spi_txq_ops_t *ops, void *ctx);
+
+    /**
+     * @brief 注册设备
+     * @return 设备编号；表满返回 -1
+     */
+    int spi_txq_add_device(spi_txq_t *q, uint8_t cs_pin, uint32_t freq_hz, uint8_t mode);
+
+    /**
+     * @brief 提交作业（不立即执行）
+     * @return 队列中的位置；队列满或参数错误返回 -1
+     */
+    int spi_txq_submit(spi_txq_t *q, uint8_t dev, const uint8_t *tx, uint8_t *rx, uint16_t len, uint8_t flags);
+
+    /**
+     * @brief 按分组顺序执行并清空队列
+     * @return 执行的作业数；片选失败时返回 -1（剩余作业丢弃）
+     */
+    int spi_txq_flush(spi_txq_t *q);
+
+    /**
+     * @brief 队列中待执行的作业数
+     */
+    int spi_txq_pending(const spi_txq_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPI_TXQ_H
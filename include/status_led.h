@@ -0,0 +1,104 @@
+/**
+ * @file status_led.h
+ * @brief 状态 LED 逻辑层：颜色去重 + 非阻塞闪烁/呼吸图案 + 实际刷新次数统计
+ *
+ * @details FastLED.show() 在发送 WS2812 数据时关闭中断 30~50μs，高频调用会让软串口丢字节。
+ *          本模块只负责"该显示什么颜色"，实际发送由调用者通过 RMT 异步完成：
+ *
+ *          主循环 ──> status_led_set()/blink()/fade()    只修改图案参数，重复设置直接忽略
+ *          定时器 ──> status_led_update()                 计算当前颜色，与上次发送的相同则返回 0
+ *                 ──> RMT 发送成功后 status_led_commit()  记录已发送颜色与刷新次数
+ *
+ *          颜色以 0xRRGGBB 表示，亮度在输出时统一缩放。
+ *
+ * @note 纯 C 实现，不依赖 Arduino，时间由调用者传入
+ * @version 1.0
+ * @date 2026-02-05
+ */
+
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum
+    {
+        STATUS_LED_SOLID = 0,
+        STATUS_LED_BLINK,
+        STATUS_LED_FADE // 呼吸：亮度按三角波变化
+    } status_led_mode_t;
+
+    typedef struct
+    {
+        uint32_t requests;     // set/blink/fade 调用次数
+        uint32_t ignored;      // 与当前图案相同而忽略的调用
+        uint32_t pushes;       // 实际发送次数
+        uint32_t deduped;      // 颜色未变而省略的刷新
+        uint32_t busy;         // 上一帧仍在发送而推迟的刷新
+        uint16_t pushes_per_s; // 最近 1 秒的实际发送次数
+    } status_led_stats_t;
+
+    typedef struct
+    {
+        uint8_t mode;
+        uint32_t color;
+        uint16_t on_ms;     // 闪烁：亮的时间
+        uint16_t off_ms;    // 闪烁：灭的时间
+        uint16_t period_ms; // 呼吸周期
+        uint32_t start_ms;  // 图案起始时刻（相位基准）
+        uint8_t brightness;
+
+        uint32_t shown;      // 最近一次发送的颜色（已缩放）
+        uint8_t shown_valid;
+
+        uint32_t window_ms;      // 统计窗口起点
+        uint32_t window_pushes;
+        status_led_stats_t stats;
+    } status_led_t;
+
+    void status_led_init(status_led_t *s, uint8_t brightness);
+
+    /**
+     * @brief 常亮
+     */
+    void status_led_set(status_led_t *s, uint32_t rgb, uint32_t now_ms);
+
+    /**
+     * @brief 闪烁（与当前图案相同时不重置相位）
+     */
+    void status_led_blink(status_led_t *s, uint32_t rgb, uint16_t on_ms, uint16_t off_ms, uint32_t now_ms);
+
+    /**
+     * @brief 呼吸
+     */
+    void status_led_fade(status_led_t *s, uint32_t rgb, uint16_t period_ms, uint32_t now_ms);
+
+    void status_led_set_brightness(status_led_t *s, uint8_t brightness);
+
+    /**
+     * @brief 计算 now_ms 时刻应显示的颜色（已按亮度缩放）
+     * @return 1 需要发送（与上次发送的颜色不同），0 无需发送
+     */
+    int status_led_update(status_led_t *s, uint32_t now_ms, uint32_t *rgb_out);
+
+    /**
+     * @brief 记录一次成功发送
+     */
+    void status_led_commit(status_led_t *s, uint32_t rgb);
+
+    /**
+     * @brief 记录一次因发送器忙而推迟的刷新
+     */
+    void status_led_busy(status_led_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATUS_LED_H
@@ -0,0 +1,242 @@
+/**
+ * @file swarm_sched.h
+ * @brief ESP-NOW 多机组网：广播信标自动配对 + 时隙调度 + 每节点速率控制与空口统计
+ *
+ * @details 基站周期性广播信标，机器人收到信标后申请加入，基站按申请速率分配时隙：
+ *
+ *          超帧（superframe_us）被等分为 n_slots 个时隙：
+ *          - 时隙 0            ：基站专用（信标、分配消息）
+ *          - 时隙 1 ~ n_slots-2：数据时隙，按节点申请速率连续分配
+ *          - 时隙 n_slots-1    ：竞争时隙，未入网节点在此发送 JOIN
+ *
+ *          报文格式（小端）：
+ *          - 信标  ：[magic][type=1][seq:2][base_time:4][superframe_us:4][n_slots][peers][epoch][members:4]
+ *          - 加入  ：[magic][type=2][node_id][rate_hz:2]
+ *          - 分配  ：[magic][type=3][mac:6][slot_first][slot_count][peer_idx][epoch]
+ *          数据帧沿用 telemetry_frame.h 格式，基站按帧序号统计每节点丢包。
+ *
+ *          成员关系：members 第 i 位表示节点表第 i 项在用，epoch 为基站每次上电的随机值。
+ *          已入网的机器人在信标中发现 epoch 变化（基站重启）或自己的表项位被清除（超时移出）时
+ *          回到 JOINING 重新申请时隙。新节点从上次分配位置之后轮流选取空闲表项，刚释放的表项最后才被重用。
+ *
+ *          超帧以最近一次信标中的 base_time 为锚点；机器人在收到信标时记录
+ *          本地时间与基站时间的偏差，据此计算自己时隙在本地时钟中的位置。
+ *          每时隙一帧的判断与时隙位置使用同一网格：超帧计数从锚点起算，重新锚定时接续，
+ *          不依赖 base_time 是否为时隙长度的整数倍。
+ *
+ * @note 纯 C 实现，时间由调用者传入，可在主机上模拟多节点调度
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#ifndef SWARM_SCHED_H
+#define SWARM_SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ====================================================================================
+ *  协议常量
+ * ==================================================================================== */
+
+#define SWARM_MAGIC 0x5B
+#define SWARM_TYPE_BEACON 1
+#define SWARM_TYPE_JOIN 2
+#define SWARM_TYPE_ASSIGN 3
+
+#define SWARM_BEACON_SIZE 19
+#define SWARM_JOIN_SIZE 5
+#define SWARM_ASSIGN_SIZE 12
+#define SWARM_MSG_MAX 20
+
+#define SWARM_MAX_PEERS 20         // ESP_NOW_MAX_TOTAL_PEER_NUM（不超过 32，成员位图宽度）
+#define SWARM_MAX_SLOTS 32         // 时隙位图宽度
+#define SWARM_GUARD_US 300         // 时隙保护间隔（时钟偏差 + 发送排队）
+#define SWARM_PEER_TIMEOUT_MS 3000 // 节点超时未发数据即移出表
+
+// ESP-NOW 默认 1Mbps 速率下的空口时间估算：前导/MAC 开销 + 每字节 8μs
+#define SWARM_AIRTIME_US(len) (200u + (uint32_t)(len) * 8u)
+
+    /**
+     * @brief 基站端每节点统计
+     */
+    typedef struct
+    {
+        uint32_t frames;      // 收到的数据帧
+        uint32_t bytes;       // 收到的字节数
+        uint32_t airtime_us;  // 估算的空口占用
+        uint32_t lost;        // 按帧序号推算的丢帧（含碰撞）
+        uint32_t out_of_slot; // 在其它节点时隙内收到的帧（碰撞风险）
+        uint32_t next_seq;    // 期望的下一帧序号
+        uint8_t seq_synced;
+    } swarm_peer_stats_t;
+
+    /**
+     * @brief 基站端节点表项
+     */
+    typedef struct
+    {
+        uint8_t in_use;
+        uint8_t mac[6];
+        uint8_t node_id;
+        uint16_t rate_hz;   // 申请的发送速率（帧/秒）
+        uint8_t slot_first; // 分配的首个时隙
+        uint8_t slot_count; // 分配的时隙数（每超帧可发帧数）
+        uint32_t last_seen_ms;
+        swarm_peer_stats_t stats;
+    } swarm_peer_t;
+
+    /**
+     * @brief 基站状态
+     */
+    typedef struct
+    {
+        uint32_t superframe_us;
+        uint8_t n_slots;
+        uint32_t slot_us;
+        uint32_t slot_map;          // 已分配的数据时隙位图
+        uint8_t max_slots_per_peer; // 单节点最多占用的时隙数（默认为数据时隙的 1/4）
+        uint16_t beacon_seq;
+        uint32_t anchor_us;         // 最近一次信标的基站时间（超帧起点）
+        uint8_t epoch;              // 本次上电的随机值，随信标与分配消息发出
+        uint8_t next_idx;           // 下一次从该表项开始寻找空闲项
+        swarm_peer_t peers[SWARM_MAX_PEERS];
+        uint32_t join_rejected;     // 表满或时隙不足而拒绝的加入请求
+    } swarm_base_t;
+
+    /**
+     * @brief 机器人端状态
+     */
+    typedef enum
+    {
+        SWARM_NODE_SCANNING = 0, // 等待信标
+        SWARM_NODE_JOINING,      // 已发送 JOIN，等待分配
+        SWARM_NODE_ACTIVE        // 已分配时隙
+    } swarm_node_state_t;
+
+    typedef struct
+    {
+        swarm_node_state_t state;
+        uint8_t node_id;
+        uint8_t own_mac[6];
+        uint8_t base_mac[6];
+        uint16_t rate_hz;
+
+        uint32_t superframe_us;
+        uint8_t n_slots;
+        uint32_t slot_us;
+        uint8_t slot_first;
+        uint8_t slot_count;
+        uint8_t peer_idx;         // 在基站节点表中的下标（对应信标成员位图）
+        uint8_t epoch;            // 分配时隙时基站的 epoch
+        uint32_t anchor_base_us;  // 信标中的基站时间
+        uint32_t anchor_local_us; // 收到信标时的本地时间
+        uint32_t last_beacon_us;
+        uint32_t anchor_frame;    // 当前锚点处的超帧计数（重新锚定时接续递增）
+        uint32_t last_tx_slot;    // 上次发送的时隙编号（超帧计数 × n_slots + 时隙），保证每时隙最多一帧
+
+        // 发送统计（由 ESP-NOW 发送回调反馈）
+        uint32_t tx_ok;
+        uint32_t tx_fail;    // 未收到 MAC 层确认（碰撞/干扰）
+        uint32_t airtime_us;
+        uint32_t deferred;   // 因不在自己时隙而推迟的发送
+        uint32_t rejoins;    // 被基站移出或基站重启后重新加入的次数
+    } swarm_node_t;
+
+    /* ================================ 基站 ================================ */
+
+    /**
+     * @brief 初始化基站
+     * @param superframe_us 超帧长度
+     * @param n_slots 每超帧时隙数（3 ~ SWARM_MAX_SLOTS）
+     * @param epoch 每次上电取随机值（如 esp_random()），机器人据此发现基站重启
+     */
+    void swarm_base_init(swarm_base_t *b, uint32_t superframe_us, uint8_t n_slots, uint8_t epoch);
+
+    /**
+     * @brief 生成信标，并以 now_us 作为新的超帧锚点
+     * @return 报文长度
+     */
+    size_t swarm_base_beacon(swarm_base_t *b, uint32_t now_us, uint8_t *buf);
+
+    /**
+     * @brief 处理 JOIN 请求（重复加入会按新速率重新分配）
+     * @return 节点表下标；表满或无可用时隙返回 -1
+     */
+    int swarm_base_on_join(swarm_base_t *b, const uint8_t *mac, const uint8_t *msg, size_t len, uint32_t now_ms);
+
+    /**
+     * @brief 生成某节点的时隙分配消息
+     * @return 报文长度
+     */
+    size_t swarm_base_assign(const swarm_base_t *b, int idx, uint8_t *buf);
+
+    /**
+     * @brief 记录一帧数据（用于每节点统计）
+     * @param seq 数据帧序号
+     * @return 节点表下标；未入网节点返回 -1
+     */
+    int swarm_base_on_data(swarm_base_t *b, const uint8_t *mac, uint32_t seq, size_t len, uint32_t rx_us, uint32_t now_ms);
+
+    /**
+     * @brief 移除超时节点并回收时隙
+     * @return 移除的节点数
+     */
+    int swarm_base_expire(swarm_base_t *b, uint32_t now_ms);
+
+    /**
+     * @brief 当前入网节点数
+     */
+    int swarm_base_peer_count(const swarm_base_t *b);
+
+    /* ================================ 机器人 ================================ */
+
+    /**
+     * @brief 初始化机器人端
+     * @param rate_hz 申请的发送速率（帧/秒）
+     */
+    void swarm_node_init(swarm_node_t *n, uint8_t node_id, const uint8_t *own_mac, uint16_t rate_hz);
+
+    /**
+     * @brief 处理收到的基站报文（信标或分配）
+     * @note 已入网时信标中 epoch 变化或自己的成员位被清除，回到 JOINING
+     * @return 1 表示需要发送 JOIN（调用 swarm_node_join 生成）
+     */
+    int swarm_node_on_message(swarm_node_t *n, const uint8_t *mac, const uint8_t *buf, size_t len, uint32_t rx_us);
+
+    /**
+     * @brief 生成 JOIN 报文
+     */
+    size_t swarm_node_join(const swarm_node_t *n, uint8_t *buf);
+
+    /**
+     * @brief 当前是否处于自己的时隙且剩余时间足够发送 len 字节
+     * @note 返回 1 后调用者应立即发送并调用 swarm_node_on_sent()
+     */
+    int swarm_node_can_send(swarm_node_t *n, uint32_t now_us, size_t len);
+
+    /**
+     * @brief JOIN 只能在竞争时隙发送
+     */
+    int swarm_node_can_join(const swarm_node_t *n, uint32_t now_us);
+
+    /**
+     * @brief 记录一次发送结果（由 ESP-NOW 发送回调转发）
+     */
+    void swarm_node_on_sent(swarm_node_t *n, size_t len, int ok);
+
+    /**
+     * @brief 检查信标超时（丢失基站后回到扫描状态）
+     */
+    void swarm_node_check(swarm_node_t *n, uint32_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWARM_SCHED_H
@@ -0,0 +1,97 @@
+/**
+ * @file swuart.h
+ * @brief 软件 UART 接收位解码：把 RX 线电平的“游程”（电平 + 持续时间）解成字节
+ *
+ * @details 采集与解码分离，不需要每一位一个中断：
+ *          - RMT 接收：硬件把 RX 线的每段电平记录为 {duration, level}，空闲超时后一次交给 CPU
+ *          - I2S 并行输入：DMA 按固定频率采样多根 RX 线，每个采样字的第 n 位为第 n 路
+ *          两种数据都转换为游程送入本模块，每路一个 swuart_t。
+ *
+ *          8N1 帧解码（每个字节以起始位下降沿重新对齐，累积误差不跨字节）：
+ *
+ *          ‾‾‾‾‾|___|_D0_|_D1_| ... |_D7_|‾‾‾‾|‾‾‾‾
+ *               ↑ 下降沿 t=0
+ *                 ↑ 在 (k + 0.5) × 位宽处取第 k 位（k=0 起始位，1~8 数据位，9 停止位）
+ *
+ *          - 起始位中点为高：视为毛刺，丢弃
+ *          - 停止位中点为低：帧错误；若 9 位全低则计为 break，需等到线路回到高电平再找下一个下降沿
+ *          - duration 为 0 表示线路空闲到采集结束（RMT 结束标记），按高电平补齐未完成的字节
+ *
+ *          位宽以 1/256 tick 定点表示。可容忍的波特率偏差取决于起始沿的时间分辨率：
+ *          RMT（80MHz 计数）约 ±4.5%；I2S 每位 8 个采样时起始沿最多滞后 1/8 位，约 ±3.5%。
+ *
+ * @note 纯 C 实现，不依赖 Arduino / ESP-IDF，可在主机上用合成波形测试（bench/swuart_test.c）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef SWUART_H
+#define SWUART_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        uint32_t bytes;
+        uint32_t frame_errors; // 停止位为低
+        uint32_t breaks;       // 整帧为低（线路断开 / break）
+        uint32_t glitches;     // 起始位中点为高的短脉冲
+        uint32_t overflows;    // 输出缓冲不足而丢弃的字节
+    } swuart_stats_t;
+
+    typedef struct
+    {
+        uint32_t bit_q8;    // 位宽（tick × 256）
+        uint32_t t_q8;      // 当前帧内已经过的时间（tick × 256）
+        uint16_t shift;     // 已收到的数据位
+        uint8_t bit;        // 下一个待取样的位序号（0 = 起始位）
+        uint8_t in_frame;
+        uint8_t need_high;  // 帧错误后等待线路回到高电平
+
+        // swuart_feed_samples() 的游程累积
+        uint8_t run_level;
+        uint32_t run_ticks;
+
+        swuart_stats_t stats;
+    } swuart_t;
+
+    /**
+     * @param tick_hz 游程时间单位（RMT 计数频率 / I2S 采样频率）
+     */
+    void swuart_init(swuart_t *u, uint32_t tick_hz, uint32_t baud);
+
+    /**
+     * @brief 输入一段电平
+     * @param ticks 持续时间；0 表示空闲到采集结束
+     * @return 写入 out 的字节数
+     */
+    int swuart_feed_run(swuart_t *u, uint8_t level, uint32_t ticks, uint8_t *out, int cap);
+
+    /**
+     * @brief 输入 RMT 接收条目（rmt_item32_t.val：bit0~14 duration0，bit15 level0，bit16~30 duration1，bit31 level1）
+     * @return 写入 out 的字节数；遇到 duration 为 0 的结束标记后停止
+     */
+    int swuart_feed_rmt(swuart_t *u, const uint32_t *items, size_t n, uint8_t *out, int cap);
+
+    /**
+     * @brief 输入按固定频率采样的并行数据（I2S 16 位并行输入），取第 line 位
+     * @return 写入 out 的字节数
+     */
+    int swuart_feed_samples(swuart_t *u, const uint16_t *samples, size_t n, uint8_t line, uint8_t *out, int cap);
+
+    /**
+     * @brief 采集结束（空闲超时）：把累积的游程按空闲处理
+     */
+    int swuart_flush(swuart_t *u, uint8_t *out, int cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWUART_H
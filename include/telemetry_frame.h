@@ -0,0 +1,216 @@
+/**
+ * @file telemetry_frame.h
+ * @brief ESP-NOW 高速遥测帧打包/解包与链路统计
+ *
+ * @details 将多条 IMU/编码器采样打包进一个 ESP-NOW 帧（最大 250 字节）：
+ *
+ *          帧头（16 字节，小端）：
+ *          [magic][version][node_id][count][seq:4][t0_us:4][tx_us:4]
+ *
+ *          采样记录（紧随帧头，按类型变长）：
+ *          - IMU    : [type=1][dt_us:2][quat:4×i16][gyr:3×i16][acc:3×i16]   23 字节
+ *          - 编码器 : [type=2][dt_us:2][enc_id][angle:u16]                  6 字节
+ *
+ *          dt_us 为相对 t0_us（帧内第一条采样时间）的偏移，tx_us 为发送时刻。
+ *          接收端按 seq 统计丢包/重复/乱序，按 rx_us - tx_us 估算相对单向延迟：
+ *          - 最近 TELEM_SEEN_WINDOW 帧的接收位图区分重复帧与迟到帧，迟到帧补回之前计入的丢帧
+ *          - 序号倒退超过 TELEM_RESYNC_GAP，或连续 TELEM_RESYNC_FRAMES 帧落在位图窗口之前，
+ *            视为发送端重启，以当前帧重新同步（延迟基准一并重置）
+ *
+ * @note 纯 C 实现，不依赖 Arduino，可直接在主机上编译验证
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ====================================================================================
+ *  帧格式常量
+ * ==================================================================================== */
+
+#define TELEM_FRAME_MAX 250 // ESP_NOW_MAX_DATA_LEN
+#define TELEM_HDR_SIZE 16
+#define TELEM_MAGIC 0xA7
+#define TELEM_VERSION 1
+
+#define TELEM_SAMPLE_IMU 1
+#define TELEM_SAMPLE_ENCODER 2
+
+#define TELEM_IMU_SIZE 23
+#define TELEM_ENCODER_SIZE 6
+
+#define TELEM_SEEN_WINDOW 32   // 接收位图覆盖的帧数
+#define TELEM_RESYNC_GAP 1024  // 序号倒退超过该值立即重新同步
+#define TELEM_RESYNC_FRAMES 3  // 连续多少帧早于位图窗口时重新同步
+
+// 定点分辨率
+#define TELEM_SCALE_QUAT 10000.0f // 四元数 0.0001
+#define TELEM_SCALE_GYR 10.0f     // 角速度 0.1 °/s（±3276 °/s）
+#define TELEM_SCALE_ACC 1000.0f   // 加速度 1 mG（±32 G）
+#define TELEM_SCALE_ANGLE 100.0f  // 编码器角度 0.01 °
+
+    /**
+     * @brief 单条采样（解包后的物理量）
+     */
+    typedef struct
+    {
+        uint8_t type;  // TELEM_SAMPLE_xxx
+        uint32_t t_us; // 采样时间戳（发送端 micros()）
+        union
+        {
+            struct
+            {
+                float quat[4]; // w, x, y, z
+                float gyr[3];  // °/s
+                float acc[3];  // G
+            } imu;
+            struct
+            {
+                uint8_t id;  // 编码器编号
+                float angle; // °
+            } enc;
+        };
+    } telem_sample_t;
+
+    /**
+     * @brief 帧头
+     */
+    typedef struct
+    {
+        uint8_t node_id; // 发送节点编号
+        uint8_t count;   // 帧内采样数
+        uint32_t seq;    // 帧序号（每帧 +1）
+        uint32_t t0_us;  // 第一条采样时间
+        uint32_t tx_us;  // 发送时刻
+    } telem_header_t;
+
+    /**
+     * @brief 发送端打包器
+     */
+    typedef struct
+    {
+        uint8_t buf[TELEM_FRAME_MAX];
+        size_t len;      // 当前已用字节（含预留帧头）
+        uint8_t count;   // 当前采样数
+        uint8_t node_id;
+        uint32_t seq;    // 下一帧序号
+        uint32_t t0_us;  // 当前帧第一条采样时间
+    } telem_tx_t;
+
+    /**
+     * @brief 接收端链路统计
+     */
+    typedef struct
+    {
+        uint32_t frames;      // 有效帧数
+        uint32_t samples;     // 有效采样数
+        uint32_t bytes;       // 有效字节数
+        uint32_t lost;        // 根据序号推算的丢帧数
+        uint32_t duplicates;  // 重复帧
+        uint32_t reordered;   // 迟到（乱序）帧，计入有效帧并从丢帧中扣除
+        uint32_t stale;       // 早于位图窗口的迟到帧（无法区分重复与乱序，丢弃）
+        uint32_t resyncs;     // 发送端重启后的重新同步次数
+        uint32_t bad;         // 格式错误帧
+        uint32_t next_seq;    // 期望的下一帧序号
+        uint32_t seen;        // 第 i 位：next_seq-1-i 已收到
+        uint8_t behind;       // 连续早于位图窗口的帧数
+        uint8_t synced;       // 是否已收到第一帧
+
+        int32_t offset_min;   // rx_us - tx_us 的历史最小值（时钟偏差 + 最小传输时间）
+        uint32_t latency_last; // 最近一帧相对延迟（μs，高于最小值的部分）
+        uint32_t latency_max;
+        uint64_t latency_sum;
+        uint32_t age_max;     // 帧内最早采样到发送的最大间隔（批量等待时间）
+
+        uint32_t first_rx_us; // 统计开始时间
+        uint32_t last_rx_us;  // 最近一帧接收时间
+    } telem_link_t;
+
+    /* ================================ 发送端 ================================ */
+
+    /**
+     * @brief 初始化打包器
+     */
+    void telem_tx_init(telem_tx_t *tx, uint8_t node_id);
+
+    /**
+     * @brief 追加一条 IMU 采样
+     * @return 1 成功；0 帧已满（或时间跨度超出 dt 范围），需先发送当前帧
+     */
+    int telem_tx_add_imu(telem_tx_t *tx, uint32_t t_us, const float quat[4], const float gyr[3], const float acc[3]);
+
+    /**
+     * @brief 追加一条编码器采样
+     * @return 1 成功；0 帧已满，需先发送当前帧
+     */
+    int telem_tx_add_encoder(telem_tx_t *tx, uint32_t t_us, uint8_t id, float angle);
+
+    /**
+     * @brief 写入帧头，返回可发送的帧长度（无采样时返回 0）
+     * @param tx_us 发送时刻
+     * @note 发送完成后调用 telem_tx_reset() 开始下一帧
+     */
+    size_t telem_tx_finish(telem_tx_t *tx, uint32_t tx_us);
+
+    /**
+     * @brief 清空当前帧，序号递增
+     */
+    void telem_tx_reset(telem_tx_t *tx);
+
+    /**
+     * @brief 丢弃未发送的当前帧，序号不变
+     * @note 帧未发出时使用：接收端不会把本地丢弃计为空口丢帧
+     */
+    void telem_tx_clear(telem_tx_t *tx);
+
+    /* ================================ 接收端 ================================ */
+
+    /**
+     * @brief 解包一帧
+     * @param out 采样输出数组
+     * @param max_samples 输出数组容量
+     * @return 解出的采样数；-1 表示格式错误
+     */
+    int telem_unpack(const uint8_t *buf, size_t len, telem_header_t *hdr, telem_sample_t *out, int max_samples);
+
+    /**
+     * @brief 重置链路统计
+     */
+    void telem_link_init(telem_link_t *link);
+
+    /**
+     * @brief 用一帧更新链路统计（O(1)）
+     * @param rx_us 接收时刻（接收端 micros()）
+     * @param len 帧字节数
+     */
+    void telem_link_update(telem_link_t *link, const telem_header_t *hdr, uint32_t rx_us, size_t len);
+
+    /**
+     * @brief 丢包率（0~1）
+     */
+    float telem_link_loss_rate(const telem_link_t *link);
+
+    /**
+     * @brief 平均相对延迟（μs）
+     */
+    float telem_link_latency_avg(const telem_link_t *link);
+
+    /**
+     * @brief 有效吞吐量（字节/秒）
+     */
+    float telem_link_throughput(const telem_link_t *link);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_FRAME_H
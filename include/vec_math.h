@@ -0,0 +1,211 @@
+/**
+ * @file vec_math.h
+ * @brief 定长向量 / 四元数 / 3×3 矩阵（仅头文件，单精度）
+ *
+ * @details ESP32 的 FPU 只支持单精度：double 运算全部走软件库，一次乘法要几十个周期。
+ *          本库只用 float：字面量带 f 后缀，数学函数用 sqrtf / atan2f / asinf，
+ *          主机测试以 -Wdouble-promotion 编译确保没有隐式提升（bench/vec_math_bench.cpp）。
+ *
+ *          Vec3      加减、数乘、点积、叉积、归一化
+ *          Quat      (w, x, y, z)，Hamilton 乘法；rotate() 把向量从机体系转到参考系
+ *                    （与 HiPNUC quat 及 ahrs.h 的约定相同）；欧拉角为 ZYX 顺序（yaw → pitch → roll）
+ *          Mat3      按行存储，可由四元数构造；矩阵乘向量只要 9 次乘法，同一姿态旋转多个向量时更省
+ *
+ *          所有运算返回新值，不修改操作数；简单运算为 constexpr（C++11），可用于编译期常量。
+ *          库内不做浮点除法（改为乘以倒数）：ESP32 的浮点除法和开方都要几十个周期。
+ *
+ * @note 仅 C++；C 代码（ahrs.c 等）仍使用各自的内联实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#ifndef VEC_MATH_H
+#define VEC_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+constexpr float GRAVITY_MS2 = 9.80665f; // m/s²，HiPNUC 加速度单位为 G
+constexpr float DEG_TO_RAD_F = 0.0174532925f;
+constexpr float RAD_TO_DEG_F = 57.2957795f;
+
+/**
+ * @brief 快速平方根倒数（x > 0）：位运算初值 + 3 次牛顿迭代，相对误差 < 2e-7
+ */
+inline float fastInvSqrt(float x)
+{
+    union
+    {
+        float f;
+        uint32_t i;
+    } u;
+    float half = 0.5f * x;
+
+    u.f = x;
+    u.i = 0x5F3759DFu - (u.i >> 1);
+    u.f = u.f * (1.5f - half * u.f * u.f);
+    u.f = u.f * (1.5f - half * u.f * u.f);
+    u.f = u.f * (1.5f - half * u.f * u.f);
+    return u.f;
+}
+
+struct Vec3
+{
+    float x, y, z;
+
+    constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+
+    /**
+     * @brief 从 float[3] 读取（数据包中的 acc / gyr / mag 等）
+     */
+    static Vec3 load(const float *p) { return Vec3(p[0], p[1], p[2]); }
+    void store(float *p) const
+    {
+        p[0] = x;
+        p[1] = y;
+        p[2] = z;
+    }
+
+    constexpr Vec3 operator+(const Vec3 &v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+    constexpr Vec3 operator-(const Vec3 &v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+    constexpr Vec3 operator-() const { return Vec3(-x, -y, -z); }
+    constexpr Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+
+    constexpr float dot(const Vec3 &v) const { return x * v.x + y * v.y + z * v.z; }
+    constexpr Vec3 cross(const Vec3 &v) const
+    {
+        return Vec3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+    }
+    constexpr float norm2() const { return x * x + y * y + z * z; }
+    float norm() const { return sqrtf(norm2()); }
+
+    /**
+     * @brief 单位向量；零向量原样返回
+     */
+    Vec3 normalized() const
+    {
+        float n2 = norm2();
+        return n2 > 0.0f ? *this * fastInvSqrt(n2) : *this;
+    }
+};
+
+constexpr Vec3 operator*(float s, const Vec3 &v) { return v * s; }
+
+struct Mat3
+{
+    Vec3 r0, r1, r2; // 行
+
+    constexpr Mat3() : r0(1.0f, 0.0f, 0.0f), r1(0.0f, 1.0f, 0.0f), r2(0.0f, 0.0f, 1.0f) {}
+    constexpr Mat3(const Vec3 &a, const Vec3 &b, const Vec3 &c) : r0(a), r1(b), r2(c) {}
+
+    constexpr Vec3 operator*(const Vec3 &v) const { return Vec3(r0.dot(v), r1.dot(v), r2.dot(v)); }
+    constexpr Mat3 transposed() const
+    {
+        return Mat3(Vec3(r0.x, r1.x, r2.x), Vec3(r0.y, r1.y, r2.y), Vec3(r0.z, r1.z, r2.z));
+    }
+    constexpr Mat3 operator*(const Mat3 &m) const { return mulT(m.transposed()); }
+
+    /**
+     * @brief 转置后的行就是列，乘法化为点积
+     */
+    constexpr Mat3 mulT(const Mat3 &t) const
+    {
+        return Mat3(Vec3(r0.dot(t.r0), r0.dot(t.r1), r0.dot(t.r2)), Vec3(r1.dot(t.r0), r1.dot(t.r1), r1.dot(t.r2)),
+                    Vec3(r2.dot(t.r0), r2.dot(t.r1), r2.dot(t.r2)));
+    }
+};
+
+struct Quat
+{
+    float w, x, y, z;
+
+    constexpr Quat() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr Quat(float w_, float x_, float y_, float z_) : w(w_), x(x_), y(y_), z(z_) {}
+
+    /**
+     * @brief 从 float[4] (w, x, y, z) 读取
+     */
+    static Quat load(const float *p) { return Quat(p[0], p[1], p[2], p[3]); }
+    void store(float *p) const
+    {
+        p[0] = w;
+        p[1] = x;
+        p[2] = y;
+        p[3] = z;
+    }
+
+    constexpr Vec3 vec() const { return Vec3(x, y, z); }
+    constexpr Quat conj() const { return Quat(w, -x, -y, -z); }
+    constexpr float dot(const Quat &q) const { return w * q.w + x * q.x + y * q.y + z * q.z; }
+    constexpr float norm2() const { return dot(*this); }
+
+    constexpr Quat operator*(const Quat &q) const
+    {
+        return Quat(w * q.w - x * q.x - y * q.y - z * q.z, w * q.x + x * q.w + y * q.z - z * q.y,
+                    w * q.y - x * q.z + y * q.w + z * q.x, w * q.z + x * q.y - y * q.x + z * q.w);
+    }
+
+    Quat normalized() const
+    {
+        float n2 = norm2();
+        if (n2 <= 0.0f)
+            return Quat();
+        float s = fastInvSqrt(n2);
+        return Quat(w * s, x * s, y * s, z * s);
+    }
+
+    /**
+     * @brief v' = q ⊗ v ⊗ q*，展开为 t = 2(u × v)，v' = v + w·t + u × t（18 次乘法，q 须为单位四元数）
+     */
+    constexpr Vec3 rotate(const Vec3 &v) const { return rotateBy(vec().cross(v) * 2.0f, v); }
+
+    /**
+     * @brief 反向旋转 q* ⊗ v ⊗ q（参考系 → 机体系）
+     */
+    constexpr Vec3 rotateInv(const Vec3 &v) const { return conj().rotate(v); }
+
+    constexpr Mat3 toMat3() const
+    {
+        return Mat3(Vec3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y)),
+                    Vec3(2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x)),
+                    Vec3(2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y)));
+    }
+
+    /**
+     * @param axis 单位向量
+     */
+    static Quat fromAxisAngle(const Vec3 &axis, float rad)
+    {
+        float s = sinf(0.5f * rad);
+        return Quat(cosf(0.5f * rad), axis.x * s, axis.y * s, axis.z * s);
+    }
+
+    /**
+     * @brief ZYX 欧拉角（rad）→ 四元数：q = yaw(z) ⊗ pitch(y) ⊗ roll(x)
+     */
+    static Quat fromEuler(const Vec3 &rpy)
+    {
+        float cr = cosf(0.5f * rpy.x), sr = sinf(0.5f * rpy.x);
+        float cp = cosf(0.5f * rpy.y), sp = sinf(0.5f * rpy.y);
+        float cy = cosf(0.5f * rpy.z), sy = sinf(0.5f * rpy.z);
+        return Quat(cr * cp * cy + sr * sp * sy, sr * cp * cy - cr * sp * sy, cr * sp * cy + sr * cp * sy,
+                    cr * cp * sy - sr * sp * cy);
+    }
+
+    /**
+     * @brief 四元数 → ZYX 欧拉角（rad）：x = roll，y = pitch（±π/2 内），z = yaw
+     */
+    Vec3 toEuler() const
+    {
+        float sp = 2.0f * (w * y - z * x);
+        sp = sp > 1.0f ? 1.0f : (sp < -1.0f ? -1.0f : sp);
+        return Vec3(atan2f(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y)), asinf(sp),
+                    atan2f(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z)));
+    }
+
+private:
+    constexpr Vec3 rotateBy(const Vec3 &t, const Vec3 &v) const { return v + t * w + vec().cross(t); }
+};
+
+#endif // VEC_MATH_H
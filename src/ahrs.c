@@ -0,0 +1,288 @@
+/**
+ * @file ahrs.c
+ * @brief 板载姿态解算实现（Mahony / Madgwick）
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "ahrs.h"
+#include <string.h>
+
+#define DEG2RAD 0.0174532925f
+#define RAD2DEG 57.2957795f
+
+void ahrs_init(ahrs_t *a, ahrs_algo_t algo)
+{
+    memset(a, 0, sizeof(ahrs_t));
+    a->algo = algo;
+    a->q[0] = 1.0f;
+    a->kp = AHRS_MAHONY_KP;
+    a->ki = AHRS_MAHONY_KI;
+    a->beta = AHRS_MADGWICK_BETA;
+}
+
+static int has_vec(const float v[3])
+{
+    return v && (v[0] != 0.0f || v[1] != 0.0f || v[2] != 0.0f);
+}
+
+static void normalize3(float v[3])
+{
+    float n = ahrs_inv_sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] *= n;
+    v[1] *= n;
+    v[2] *= n;
+}
+
+static void normalize4(float q[4])
+{
+    float n = ahrs_inv_sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    q[0] *= n;
+    q[1] *= n;
+    q[2] *= n;
+    q[3] *= n;
+}
+
+int ahrs_align(ahrs_t *a, const float acc[3], const float mag[3])
+{
+    float up[3], north[3], west[3], r[3][3];
+    float d, tr, s;
+    float *q = a->q;
+    int i;
+
+    if (!has_vec(acc))
+        return 0;
+    memcpy(up, acc, sizeof(up));
+    normalize3(up);
+
+    // 磁场（或没有磁场时的机体 x 轴）去掉竖直分量即为北向
+    if (has_vec(mag))
+        memcpy(north, mag, sizeof(north));
+    else
+    {
+        north[0] = 1.0f;
+        north[1] = 0.0f;
+        north[2] = 0.0f;
+    }
+    d = north[0] * up[0] + north[1] * up[1] + north[2] * up[2];
+    for (i = 0; i < 3; i++)
+        north[i] -= d * up[i];
+    if (north[0] * north[0] + north[1] * north[1] + north[2] * north[2] < 1e-6f)
+    {
+        // 磁场（或 x 轴）与竖直方向平行，改用机体 y 轴
+        north[0] = -up[1] * up[0];
+        north[1] = 1.0f - up[1] * up[1];
+        north[2] = -up[1] * up[2];
+    }
+    normalize3(north);
+    west[0] = up[1] * north[2] - up[2] * north[1];
+    west[1] = up[2] * north[0] - up[0] * north[2];
+    west[2] = up[0] * north[1] - up[1] * north[0];
+
+    // 机体 → 导航的旋转矩阵：每行为一个导航轴在机体系中的方向
+    memcpy(r[0], north, sizeof(north));
+    memcpy(r[1], west, sizeof(west));
+    memcpy(r[2], up, sizeof(up));
+
+    tr = r[0][0] + r[1][1] + r[2][2];
+    if (tr > 0.0f)
+    {
+        s = 2.0f * sqrtf(tr + 1.0f);
+        q[0] = 0.25f * s;
+        q[1] = (r[2][1] - r[1][2]) / s;
+        q[2] = (r[0][2] - r[2][0]) / s;
+        q[3] = (r[1][0] - r[0][1]) / s;
+    }
+    else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+    {
+        s = 2.0f * sqrtf(1.0f + r[0][0] - r[1][1] - r[2][2]);
+        q[0] = (r[2][1] - r[1][2]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (r[0][1] + r[1][0]) / s;
+        q[3] = (r[0][2] + r[2][0]) / s;
+    }
+    else if (r[1][1] > r[2][2])
+    {
+        s = 2.0f * sqrtf(1.0f + r[1][1] - r[0][0] - r[2][2]);
+        q[0] = (r[0][2] - r[2][0]) / s;
+        q[1] = (r[0][1] + r[1][0]) / s;
+        q[2] = 0.25f * s;
+        q[3] = (r[1][2] + r[2][1]) / s;
+    }
+    else
+    {
+        s = 2.0f * sqrtf(1.0f + r[2][2] - r[0][0] - r[1][1]);
+        q[0] = (r[1][0] - r[0][1]) / s;
+        q[1] = (r[0][2] + r[2][0]) / s;
+        q[2] = (r[1][2] + r[2][1]) / s;
+        q[3] = 0.25f * s;
+    }
+    normalize4(q);
+    memset(a->bias, 0, sizeof(a->bias));
+    a->aligned = 1;
+    return 1;
+}
+
+/**
+ * @brief 导航系磁场参考 b = (bx, 0, bz)：把实测磁场转到导航系后取水平模长和竖直分量
+ */
+static void mag_reference(const float q[4], const float m[3], float *bx, float *bz)
+{
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+    float hx = m[0] * (1.0f - 2.0f * (y * y + z * z)) + m[1] * 2.0f * (x * y - w * z) + m[2] * 2.0f * (x * z + w * y);
+    float hy = m[0] * 2.0f * (x * y + w * z) + m[1] * (1.0f - 2.0f * (x * x + z * z)) + m[2] * 2.0f * (y * z - w * x);
+    float h2 = hx * hx + hy * hy;
+
+    *bx = h2 > 0.0f ? h2 * ahrs_inv_sqrt(h2) : 0.0f;
+    *bz = m[0] * 2.0f * (x * z - w * y) + m[1] * 2.0f * (y * z + w * x) + m[2] * (1.0f - 2.0f * (x * x + y * y));
+}
+
+static void mahony(ahrs_t *a, float g[3], const float acc[3], const float mag[3], float dt)
+{
+    float w = a->q[0], x = a->q[1], y = a->q[2], z = a->q[3];
+    float e[3] = {0.0f, 0.0f, 0.0f};
+    float v[3], m[3], an[3];
+    int i;
+
+    if (!has_vec(acc))
+        return;
+    memcpy(an, acc, sizeof(an));
+    normalize3(an);
+
+    // 预测的重力方向（机体系）
+    v[0] = 2.0f * (x * z - w * y);
+    v[1] = 2.0f * (y * z + w * x);
+    v[2] = 1.0f - 2.0f * (x * x + y * y);
+    e[0] = an[1] * v[2] - an[2] * v[1];
+    e[1] = an[2] * v[0] - an[0] * v[2];
+    e[2] = an[0] * v[1] - an[1] * v[0];
+
+    if (a->mag_used)
+    {
+        float bx, bz, p[3];
+
+        memcpy(m, mag, sizeof(m));
+        normalize3(m);
+        mag_reference(a->q, m, &bx, &bz);
+        // 预测的磁场方向（机体系）
+        p[0] = bx * (1.0f - 2.0f * (y * y + z * z)) + bz * 2.0f * (x * z - w * y);
+        p[1] = bx * 2.0f * (x * y - w * z) + bz * 2.0f * (y * z + w * x);
+        p[2] = bx * 2.0f * (x * z + w * y) + bz * (1.0f - 2.0f * (x * x + y * y));
+        e[0] += m[1] * p[2] - m[2] * p[1];
+        e[1] += m[2] * p[0] - m[0] * p[2];
+        e[2] += m[0] * p[1] - m[1] * p[0];
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        if (a->ki > 0.0f)
+        {
+            a->bias[i] += a->ki * e[i] * dt;
+            g[i] += a->bias[i];
+        }
+        g[i] += a->kp * e[i];
+    }
+}
+
+/**
+ * @brief Madgwick 目标函数梯度 ∇f = Jᵀ f（f 为预测方向与实测方向之差）
+ */
+static int madgwick_step(const ahrs_t *a, const float acc[3], const float mag[3], float s[4])
+{
+    float q1 = a->q[0], q2 = a->q[1], q3 = a->q[2], q4 = a->q[3];
+    float an[3], f1, f2, f3;
+
+    if (!has_vec(acc))
+        return 0;
+    memcpy(an, acc, sizeof(an));
+    normalize3(an);
+
+    f1 = 2.0f * (q2 * q4 - q1 * q3) - an[0];
+    f2 = 2.0f * (q1 * q2 + q3 * q4) - an[1];
+    f3 = 1.0f - 2.0f * (q2 * q2 + q3 * q3) - an[2];
+    s[0] = -2.0f * q3 * f1 + 2.0f * q2 * f2;
+    s[1] = 2.0f * q4 * f1 + 2.0f * q1 * f2 - 4.0f * q2 * f3;
+    s[2] = -2.0f * q1 * f1 + 2.0f * q4 * f2 - 4.0f * q3 * f3;
+    s[3] = 2.0f * q2 * f1 + 2.0f * q3 * f2;
+
+    if (a->mag_used)
+    {
+        float m[3], bx, bz;
+
+        memcpy(m, mag, sizeof(m));
+        normalize3(m);
+        mag_reference(a->q, m, &bx, &bz);
+        f1 = 2.0f * bx * (0.5f - q3 * q3 - q4 * q4) + 2.0f * bz * (q2 * q4 - q1 * q3) - m[0];
+        f2 = 2.0f * bx * (q2 * q3 - q1 * q4) + 2.0f * bz * (q1 * q2 + q3 * q4) - m[1];
+        f3 = 2.0f * bx * (q1 * q3 + q2 * q4) + 2.0f * bz * (0.5f - q2 * q2 - q3 * q3) - m[2];
+        s[0] += -2.0f * bz * q3 * f1 + (-2.0f * bx * q4 + 2.0f * bz * q2) * f2 + 2.0f * bx * q3 * f3;
+        s[1] += 2.0f * bz * q4 * f1 + (2.0f * bx * q3 + 2.0f * bz * q1) * f2 + (2.0f * bx * q4 - 4.0f * bz * q2) * f3;
+        s[2] += (-4.0f * bx * q3 - 2.0f * bz * q1) * f1 + (2.0f * bx * q2 + 2.0f * bz * q4) * f2 +
+                (2.0f * bx * q1 - 4.0f * bz * q3) * f3;
+        s[3] += (-4.0f * bx * q4 + 2.0f * bz * q2) * f1 + (-2.0f * bx * q1 + 2.0f * bz * q3) * f2 + 2.0f * bx * q2 * f3;
+    }
+
+    if (s[0] == 0.0f && s[1] == 0.0f && s[2] == 0.0f && s[3] == 0.0f)
+        return 0;
+    normalize4(s);
+    return 1;
+}
+
+void ahrs_update(ahrs_t *a, const float gyr[3], const float acc[3], const float mag[3], float dt)
+{
+    float g[3], dq[4], s[4];
+    float w, x, y, z;
+    int i;
+
+    a->mag_used = (uint8_t)has_vec(mag);
+    if (!a->aligned && !ahrs_align(a, acc, a->mag_used ? mag : NULL))
+        return;
+
+    g[0] = gyr[0] * DEG2RAD;
+    g[1] = gyr[1] * DEG2RAD;
+    g[2] = gyr[2] * DEG2RAD;
+    if (a->algo == AHRS_MAHONY)
+        mahony(a, g, acc, mag, dt);
+
+    // q̇ = ½ q ⊗ (0, ω)
+    w = a->q[0];
+    x = a->q[1];
+    y = a->q[2];
+    z = a->q[3];
+    dq[0] = 0.5f * (-x * g[0] - y * g[1] - z * g[2]);
+    dq[1] = 0.5f * (w * g[0] + y * g[2] - z * g[1]);
+    dq[2] = 0.5f * (w * g[1] - x * g[2] + z * g[0]);
+    dq[3] = 0.5f * (w * g[2] + x * g[1] - y * g[0]);
+
+    if (a->algo == AHRS_MADGWICK && madgwick_step(a, acc, mag, s))
+        for (i = 0; i < 4; i++)
+            dq[i] -= a->beta * s[i];
+
+    for (i = 0; i < 4; i++)
+        a->q[i] += dq[i] * dt;
+    normalize4(a->q);
+    a->updates++;
+}
+
+void ahrs_quat_to_euler(const float q[4], float rpy[3])
+{
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+    float sp = 2.0f * (w * y - z * x);
+
+    if (sp > 1.0f)
+        sp = 1.0f;
+    else if (sp < -1.0f)
+        sp = -1.0f;
+    rpy[0] = atan2f(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y)) * RAD2DEG;
+    rpy[1] = asinf(sp) * RAD2DEG;
+    rpy[2] = atan2f(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z)) * RAD2DEG;
+}
+
+float ahrs_quat_angle(const float q1[4], const float q2[4])
+{
+    float d = fabsf(q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3]);
+
+    if (d > 1.0f)
+        d = 1.0f;
+    return 2.0f * acosf(d) * RAD2DEG;
+}
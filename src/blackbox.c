@@ -0,0 +1,322 @@
+/**
+ * @file blackbox.c
+ * @brief 黑匣子环形缓冲与触发检测实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "blackbox.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* 四舍五入并限幅到 int16 */
+static int16_t q16(float x, float scale)
+{
+    float v = x * scale;
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (int16_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+static void ring_write(blackbox_t *bb, uint32_t pos, const uint8_t *src, uint32_t n)
+{
+    uint32_t first = bb->cap - pos;
+
+    if (n <= first)
+    {
+        memcpy(bb->buf + pos, src, n);
+        return;
+    }
+    memcpy(bb->buf + pos, src, first);
+    memcpy(bb->buf, src + first, n - first);
+}
+
+static void ring_read(const blackbox_t *bb, uint32_t pos, uint8_t *dst, uint32_t n)
+{
+    uint32_t first = bb->cap - pos;
+
+    if (n <= first)
+    {
+        memcpy(dst, bb->buf + pos, n);
+        return;
+    }
+    memcpy(dst, bb->buf + pos, first);
+    memcpy(dst + first, bb->buf, n - first);
+}
+
+static uint32_t ring_add(const blackbox_t *bb, uint32_t pos, uint32_t n)
+{
+    pos += n;
+    return pos >= bb->cap ? pos - bb->cap : pos;
+}
+
+/* 最旧记录的总长度 */
+static uint32_t tail_size(const blackbox_t *bb)
+{
+    return BLACKBOX_REC_HDR_SIZE + bb->buf[ring_add(bb, bb->tail, 1)];
+}
+
+static uint32_t tail_time(const blackbox_t *bb)
+{
+    uint8_t t[4];
+    ring_read(bb, ring_add(bb, bb->tail, 2), t, 4);
+    return get_u32(t);
+}
+
+static void release_tail(blackbox_t *bb, uint32_t size)
+{
+    bb->tail = ring_add(bb, bb->tail, size);
+    bb->used -= size;
+}
+
+static void freeze(blackbox_t *bb)
+{
+    uint32_t cutoff = bb->trig_us - bb->pre_us;
+
+    // 只保留触发前 pre_us 以内的历史
+    while (bb->used > 0 && (int32_t)(tail_time(bb) - cutoff) < 0)
+    {
+        release_tail(bb, tail_size(bb));
+        bb->stats.evicted++;
+    }
+    bb->snap_left = bb->used;
+    bb->state = BB_FROZEN;
+}
+
+static void check_post(blackbox_t *bb, uint32_t now_us)
+{
+    // 有符号比较：不同上下文的时间戳可能略早于触发时刻
+    if (bb->state == BB_POST && (int32_t)(now_us - bb->trig_us) >= (int32_t)bb->post_us)
+        freeze(bb);
+}
+
+void blackbox_init(blackbox_t *bb, uint8_t *buf, uint32_t cap, uint32_t pre_us, uint32_t post_us)
+{
+    memset(bb, 0, sizeof(blackbox_t));
+    bb->buf = buf;
+    bb->cap = cap;
+    bb->pre_us = pre_us;
+    bb->post_us = post_us;
+}
+
+int blackbox_put(blackbox_t *bb, uint8_t type, uint32_t t_us, const void *payload, uint8_t len)
+{
+    uint32_t need = BLACKBOX_REC_HDR_SIZE + len;
+    uint8_t hdr[BLACKBOX_REC_HDR_SIZE];
+
+    check_post(bb, t_us);
+    if (need > bb->cap || (bb->state == BB_FROZEN && bb->cap - bb->used < need))
+    {
+        bb->stats.dropped++;
+        return 0;
+    }
+    while (bb->cap - bb->used < need)
+    {
+        release_tail(bb, tail_size(bb));
+        bb->stats.evicted++;
+    }
+
+    hdr[0] = type;
+    hdr[1] = len;
+    put_u32(hdr + 2, t_us);
+    ring_write(bb, bb->head, hdr, BLACKBOX_REC_HDR_SIZE);
+    if (len > 0)
+        ring_write(bb, ring_add(bb, bb->head, BLACKBOX_REC_HDR_SIZE), (const uint8_t *)payload, len);
+    bb->head = ring_add(bb, bb->head, need);
+    bb->used += need;
+    bb->stats.records++;
+    return 1;
+}
+
+int blackbox_put_imu(blackbox_t *bb, uint32_t t_us, const float acc[3], const float gyr[3], const float rpy[3])
+{
+    uint8_t p[18];
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        put_u16(p + 2 * i, (uint16_t)q16(acc[i], 1000.0f));
+        put_u16(p + 6 + 2 * i, (uint16_t)q16(gyr[i], 10.0f));
+        put_u16(p + 12 + 2 * i, (uint16_t)(rpy ? q16(rpy[i], 100.0f) : 0));
+    }
+    return blackbox_put(bb, BB_REC_IMU, t_us, p, sizeof(p));
+}
+
+int blackbox_put_baro(blackbox_t *bb, uint32_t t_us, float pressure, float temp)
+{
+    uint8_t p[6];
+
+    put_u32(p, (uint32_t)(int32_t)(pressure * 10.0f + 0.5f));
+    put_u16(p + 4, (uint16_t)q16(temp, 100.0f));
+    return blackbox_put(bb, BB_REC_BARO, t_us, p, sizeof(p));
+}
+
+int blackbox_put_encoder(blackbox_t *bb, uint32_t t_us, const uint16_t *counts, uint8_t n)
+{
+    uint8_t p[2 * BLACKBOX_ENCODER_MAX];
+    uint8_t i;
+
+    if (n > BLACKBOX_ENCODER_MAX)
+        n = BLACKBOX_ENCODER_MAX;
+    for (i = 0; i < n; i++)
+        put_u16(p + 2 * i, counts[i]);
+    return blackbox_put(bb, BB_REC_ENCODER, t_us, p, (uint8_t)(2 * n));
+}
+
+int blackbox_trigger(blackbox_t *bb, blackbox_trig_t reason, uint32_t t_us)
+{
+    uint8_t r = (uint8_t)reason;
+
+    check_post(bb, t_us);
+    if (bb->state != BB_ARMED)
+    {
+        bb->stats.ignored++;
+        return 0;
+    }
+    bb->reason = reason;
+    bb->trig_us = t_us;
+    bb->stats.triggers++;
+    blackbox_put(bb, BB_REC_TRIGGER, t_us, &r, 1); // 仍为 ARMED：标记必定写入
+    bb->state = BB_POST;
+    if (bb->post_us == 0)
+        freeze(bb);
+    return 1;
+}
+
+void blackbox_poll(blackbox_t *bb, uint32_t now_us)
+{
+    check_post(bb, now_us);
+}
+
+size_t blackbox_drain(blackbox_t *bb, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+
+    if (bb->state != BB_FROZEN)
+        return 0;
+    while (bb->snap_left > 0)
+    {
+        uint32_t size = tail_size(bb);
+        if (n + size > max)
+            break;
+        ring_read(bb, bb->tail, out + n, size);
+        release_tail(bb, size);
+        bb->snap_left -= size;
+        n += size;
+    }
+    if (bb->snap_left == 0)
+    {
+        bb->state = BB_ARMED;
+        bb->reason = BB_TRIG_NONE;
+        bb->stats.snapshots++;
+    }
+    return n;
+}
+
+void blackbox_file_header(const blackbox_t *bb, uint8_t out[BLACKBOX_FILE_HDR_SIZE])
+{
+    memcpy(out, "BBOX", 4);
+    put_u16(out + 4, BLACKBOX_VERSION);
+    out[6] = (uint8_t)bb->reason;
+    out[7] = 0;
+    put_u32(out + 8, bb->trig_us);
+    put_u32(out + 12, bb->snap_left);
+}
+
+size_t blackbox_parse(const uint8_t *buf, size_t size, uint8_t *type, uint32_t *t_us, const uint8_t **payload,
+                      uint8_t *len)
+{
+    if (size < BLACKBOX_REC_HDR_SIZE || size < (size_t)BLACKBOX_REC_HDR_SIZE + buf[1])
+        return 0;
+    *type = buf[0];
+    *len = buf[1];
+    *t_us = get_u32(buf + 2);
+    *payload = buf + BLACKBOX_REC_HDR_SIZE;
+    return BLACKBOX_REC_HDR_SIZE + buf[1];
+}
+
+const char *blackbox_trig_name(blackbox_trig_t reason)
+{
+    switch (reason)
+    {
+    case BB_TRIG_HIGH_G:
+        return "高g";
+    case BB_TRIG_COMMAND:
+        return "命令";
+    case BB_TRIG_BUTTON:
+        return "按键";
+    case BB_TRIG_LINK_LOSS:
+        return "链路中断";
+    default:
+        return "无";
+    }
+}
+
+int blackbox_format(const blackbox_t *bb, char *buf, size_t buf_size)
+{
+    static const char *const states[] = {"待命", "触发后记录", "导出中"};
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    ret = snprintf(buf, buf_size,
+                   "黑匣子: %s（%s）| 占用 %lu/%lu B，待导出 %lu B | 记录 %lu，淘汰 %lu，丢弃 %lu | 触发 %lu（忽略 %lu），已导出 %lu\n",
+                   states[bb->state], blackbox_trig_name(bb->reason), (unsigned long)bb->used,
+                   (unsigned long)bb->cap, (unsigned long)bb->snap_left, (unsigned long)bb->stats.records,
+                   (unsigned long)bb->stats.evicted, (unsigned long)bb->stats.dropped,
+                   (unsigned long)bb->stats.triggers, (unsigned long)bb->stats.ignored,
+                   (unsigned long)bb->stats.snapshots);
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)buf_size - 1 : ret;
+}
+
+void blackbox_highg_init(blackbox_highg_t *d, float thr_g, uint8_t need, uint32_t holdoff_us)
+{
+    memset(d, 0, sizeof(blackbox_highg_t));
+    d->thr2 = thr_g * thr_g;
+    d->need = need > 0 ? need : 1;
+    d->holdoff_us = holdoff_us;
+}
+
+int blackbox_highg_update(blackbox_highg_t *d, const float acc[3], uint32_t t_us)
+{
+    float a2 = acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2];
+
+    if (a2 < d->thr2)
+    {
+        d->run = 0;
+        return 0;
+    }
+    if (d->run < 255)
+        d->run++;
+    if (d->run < d->need || (d->fired && t_us - d->last_us < d->holdoff_us))
+        return 0;
+    d->fired = 1;
+    d->last_us = t_us;
+    d->peak = sqrtf(a2);
+    d->run = 0;
+    return 1;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file boot_seq.c
+ * @brief 启动编排实现
+ * @version 1.0
+ * @date 2026-02-06
+ */
+
+#include "boot_seq.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BOOT_BAR_WIDTH 24
+
+static const char *const STATE_NAMES[] = {"等待", "运行", "完成", "失败", "跳过"};
+
+static uint32_t mask_of(const boot_seq_t *b, uint8_t state)
+{
+    uint32_t m = 0;
+    uint8_t i;
+
+    for (i = 0; i < b->count; i++)
+    {
+        if (b->steps[i].state == state)
+            m |= BOOT_DEP(i);
+    }
+    return m;
+}
+
+void boot_seq_init(boot_seq_t *b, uint32_t t0_us)
+{
+    memset(b, 0, sizeof(boot_seq_t));
+    b->t0_us = t0_us;
+}
+
+int boot_seq_add(boot_seq_t *b, const char *name, uint32_t deps)
+{
+    boot_step_t *s;
+
+    if (b->count >= BOOT_MAX_STEPS)
+        return -1;
+    s = &b->steps[b->count];
+    s->name = name;
+    s->deps = deps;
+    s->state = BOOT_WAITING;
+    return b->count++;
+}
+
+int boot_seq_next(boot_seq_t *b, uint32_t now_us)
+{
+    uint32_t done = mask_of(b, BOOT_DONE);
+    uint32_t dead = mask_of(b, BOOT_FAILED) | mask_of(b, BOOT_SKIPPED);
+    uint8_t i;
+
+    for (i = 0; i < b->count; i++)
+    {
+        boot_step_t *s = &b->steps[i];
+
+        if (s->state != BOOT_WAITING)
+            continue;
+        if (s->deps & dead)
+        {
+            s->state = BOOT_SKIPPED;
+            s->start_us = now_us;
+            s->end_us = now_us;
+            dead |= BOOT_DEP(i); // 依赖本步骤的后续步骤也跳过
+            continue;
+        }
+        if ((s->deps & done) == s->deps)
+            return i;
+    }
+    return -1;
+}
+
+void boot_seq_start(boot_seq_t *b, int id, uint32_t now_us)
+{
+    b->steps[id].state = BOOT_RUNNING;
+    b->steps[id].start_us = now_us;
+}
+
+void boot_seq_finish(boot_seq_t *b, int id, int ok, uint32_t now_us)
+{
+    b->steps[id].state = ok ? BOOT_DONE : BOOT_FAILED;
+    b->steps[id].end_us = now_us;
+}
+
+int boot_seq_done(const boot_seq_t *b, int id)
+{
+    return id >= 0 && id < b->count && b->steps[id].state == BOOT_DONE;
+}
+
+int boot_seq_complete(const boot_seq_t *b)
+{
+    uint8_t i;
+
+    for (i = 0; i < b->count; i++)
+    {
+        if (b->steps[i].state == BOOT_WAITING || b->steps[i].state == BOOT_RUNNING)
+            return 0;
+    }
+    return 1;
+}
+
+void boot_seq_first_frame(boot_seq_t *b, uint32_t now_us)
+{
+    if (b->first_frame_seen)
+        return;
+    b->first_frame_us = now_us;
+    b->first_frame_seen = 1;
+}
+
+int boot_seq_format(const boot_seq_t *b, char *buf, size_t buf_size)
+{
+    uint32_t span = 1;
+    uint32_t serial = 0;
+    size_t written = 0;
+    int ret;
+    uint8_t i;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+
+    for (i = 0; i < b->count; i++)
+    {
+        const boot_step_t *s = &b->steps[i];
+        if (s->state >= BOOT_DONE && s->end_us - b->t0_us > span)
+            span = s->end_us - b->t0_us;
+    }
+
+    for (i = 0; i < b->count && written < buf_size; i++)
+    {
+        const boot_step_t *s = &b->steps[i];
+        uint32_t start = s->start_us - b->t0_us;
+        uint32_t dur = s->state >= BOOT_DONE ? s->end_us - s->start_us : 0;
+        char bar[BOOT_BAR_WIDTH + 1];
+        uint32_t from;
+        uint32_t to;
+        uint32_t k;
+
+        if (s->state == BOOT_WAITING)
+        {
+            ret = snprintf(buf + written, buf_size - written, "  %-12s %s\n", s->name, STATE_NAMES[s->state]);
+            written += ret > 0 ? (size_t)ret : 0;
+            continue;
+        }
+
+        // 甘特条：按最晚结束时刻缩放，至少占一格
+        from = (uint32_t)((uint64_t)start * BOOT_BAR_WIDTH / span);
+        to = (uint32_t)((uint64_t)(start + dur) * BOOT_BAR_WIDTH / span);
+        if (from >= BOOT_BAR_WIDTH)
+            from = BOOT_BAR_WIDTH - 1;
+        if (to <= from)
+            to = from + 1;
+        if (to > BOOT_BAR_WIDTH)
+            to = BOOT_BAR_WIDTH;
+        for (k = 0; k < BOOT_BAR_WIDTH; k++)
+            bar[k] = (k >= from && k < to) ? '#' : '.';
+        bar[BOOT_BAR_WIDTH] = '\0';
+
+        serial += dur;
+        ret = snprintf(buf + written, buf_size - written,
+                       "  %-12s +%7.1fms %8.1fms |%s| %s\n",
+                       s->name, start / 1000.0, dur / 1000.0, bar, STATE_NAMES[s->state]);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+
+    if (written < buf_size)
+    {
+        ret = snprintf(buf + written, buf_size - written,
+                       "  串行合计 %.1fms，实际 %.1fms\n", serial / 1000.0, span / 1000.0);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+    if (written < buf_size && b->first_frame_seen)
+    {
+        ret = snprintf(buf + written, buf_size - written,
+                       "  首帧数据 +%.1fms\n", (b->first_frame_us - b->t0_us) / 1000.0);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file button_input.c
+ * @brief 按键输入引擎实现
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#include "button_input.h"
+#include <string.h>
+
+// 正交解码表：下标 = (旧状态 << 2) | 新状态，状态 = (A << 1) | B
+static const int8_t QDEC[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+
+static void emit(btn_engine_t *e, uint8_t type, uint8_t line, int8_t dir, uint32_t t_us)
+{
+    uint8_t next = (uint8_t)((e->q_head + 1) & (BTN_EVENT_QUEUE_LEN - 1));
+
+    if (next == e->q_tail)
+    {
+        e->stats.dropped++;
+        return;
+    }
+    e->queue[e->q_head].type = type;
+    e->queue[e->q_head].line = line;
+    e->queue[e->q_head].dir = dir;
+    e->queue[e->q_head].t_us = t_us;
+    e->q_head = next;
+    e->stats.events++;
+}
+
+static int is_pressed(const btn_line_t *l)
+{
+    return l->active_low ? (l->stable == 0) : (l->stable != 0);
+}
+
+/* 处理截至 t_us 已到期的长按/双击超时；事件时间取到期时刻 */
+static void run_timers(btn_engine_t *e, uint8_t line, uint32_t t_us)
+{
+    btn_line_t *l = &e->lines[line];
+
+    switch (l->state)
+    {
+    case BTN_ST_DOWN1:
+        if (t_us - l->state_us >= e->long_us)
+        {
+            l->state_us += e->long_us;
+            l->state = BTN_ST_LONG;
+            emit(e, BTN_EV_LONG_PRESS, line, 0, l->state_us);
+        }
+        break;
+
+    case BTN_ST_UP1:
+        if (t_us - l->state_us >= e->double_gap_us)
+        {
+            l->state = BTN_ST_IDLE;
+            emit(e, BTN_EV_CLICK, line, 0, l->state_us + e->double_gap_us);
+        }
+        break;
+
+    case BTN_ST_DOWN2:
+        // 第二次按下后一直按住：前一次算单击，本次算长按
+        if (t_us - l->state_us >= e->long_us)
+        {
+            emit(e, BTN_EV_CLICK, line, 0, l->state_us);
+            l->state_us += e->long_us;
+            l->state = BTN_ST_LONG;
+            emit(e, BTN_EV_LONG_PRESS, line, 0, l->state_us);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void on_button_change(btn_engine_t *e, uint8_t line, uint32_t t_us)
+{
+    btn_line_t *l = &e->lines[line];
+
+    if (is_pressed(l))
+    {
+        if (l->state == BTN_ST_IDLE)
+            l->state = BTN_ST_DOWN1;
+        else if (l->state == BTN_ST_UP1)
+            l->state = BTN_ST_DOWN2;
+        else
+            return;
+        l->state_us = t_us;
+        return;
+    }
+
+    switch (l->state)
+    {
+    case BTN_ST_DOWN1:
+        l->state = BTN_ST_UP1;
+        l->state_us = t_us;
+        break;
+    case BTN_ST_DOWN2:
+        l->state = BTN_ST_IDLE;
+        emit(e, BTN_EV_DOUBLE_CLICK, line, 0, t_us);
+        break;
+    case BTN_ST_LONG:
+        l->state = BTN_ST_IDLE;
+        emit(e, BTN_EV_LONG_RELEASE, line, 0, t_us);
+        break;
+    default:
+        break;
+    }
+}
+
+static void on_rotary_change(btn_engine_t *e, uint32_t t_us)
+{
+    uint8_t s = (uint8_t)((e->lines[e->rot_a].stable << 1) | e->lines[e->rot_b].stable);
+    int8_t d = QDEC[(e->rot_state << 2) | s];
+
+    if (e->rot_steps == BTN_ROTARY_TOGGLE)
+    {
+        uint8_t on = (uint8_t)((e->rot_rest ^ s) & ~(e->rot_rest ^ e->rot_state)); // 刚离开静止电平的触点
+        if (on & 2)
+            emit(e, BTN_EV_ROTATE, e->rot_a, 1, t_us);
+        if (on & 1)
+            emit(e, BTN_EV_ROTATE, e->rot_a, -1, t_us);
+        e->rot_state = s;
+        return;
+    }
+
+    e->rot_acc = (int8_t)(e->rot_acc + d);
+    if (e->rot_acc >= (int8_t)e->rot_steps || e->rot_acc <= -(int8_t)e->rot_steps)
+    {
+        emit(e, BTN_EV_ROTATE, e->rot_a, (int8_t)(e->rot_acc > 0 ? 1 : -1), t_us);
+        e->rot_acc = 0;
+    }
+    else if (s == e->rot_rest)
+    {
+        e->rot_acc = 0; // 回到静止位置，丢弃不完整的跳变（漏边沿后重新同步）
+    }
+    e->rot_state = s;
+}
+
+/* 把消抖已满足的电平提交为稳定电平，并推进该线路的状态机到 t_us */
+static void advance_line(btn_engine_t *e, uint8_t line, uint32_t t_us)
+{
+    btn_line_t *l = &e->lines[line];
+
+    if (l->raw != l->stable && t_us - l->raw_us >= e->debounce_us)
+    {
+        if (l->role == BTN_ROLE_BUTTON)
+            run_timers(e, line, l->raw_us);
+        l->stable = l->raw;
+        if (l->role == BTN_ROLE_BUTTON)
+            on_button_change(e, line, l->raw_us);
+        else
+            on_rotary_change(e, l->raw_us);
+    }
+    if (l->role == BTN_ROLE_BUTTON)
+        run_timers(e, line, t_us);
+}
+
+static void advance_all(btn_engine_t *e, uint32_t t_us)
+{
+    uint8_t i;
+
+    for (i = 0; i < BTN_MAX_LINES; i++)
+    {
+        if (e->lines[i].role != BTN_ROLE_NONE)
+            advance_line(e, i, t_us);
+    }
+}
+
+void btn_engine_init(btn_engine_t *e)
+{
+    memset(e, 0, sizeof(btn_engine_t));
+    e->debounce_us = BTN_DEFAULT_DEBOUNCE_US;
+    e->long_us = BTN_DEFAULT_LONG_US;
+    e->double_gap_us = BTN_DEFAULT_DOUBLE_GAP_US;
+}
+
+void btn_engine_add_button(btn_engine_t *e, uint8_t line, uint8_t active_low, uint8_t level)
+{
+    btn_line_t *l = &e->lines[line];
+
+    memset(l, 0, sizeof(btn_line_t));
+    l->role = BTN_ROLE_BUTTON;
+    l->active_low = active_low;
+    l->raw = level ? 1 : 0;
+    l->stable = l->raw;
+    l->state = BTN_ST_IDLE;
+}
+
+void btn_engine_add_rotary(btn_engine_t *e, uint8_t line_a, uint8_t line_b, uint8_t level_a, uint8_t level_b, uint8_t steps_per_detent)
+{
+    uint8_t pins[2];
+    uint8_t levels[2];
+    int i;
+
+    pins[0] = line_a;
+    pins[1] = line_b;
+    levels[0] = level_a ? 1 : 0;
+    levels[1] = level_b ? 1 : 0;
+    for (i = 0; i < 2; i++)
+    {
+        btn_line_t *l = &e->lines[pins[i]];
+        memset(l, 0, sizeof(btn_line_t));
+        l->role = BTN_ROLE_ROTARY;
+        l->active_low = 1;
+        l->raw = levels[i];
+        l->stable = levels[i];
+    }
+    e->rot_a = line_a;
+    e->rot_b = line_b;
+    e->rot_state = (uint8_t)((levels[0] << 1) | levels[1]);
+    e->rot_rest = e->rot_state;
+    e->rot_acc = 0;
+    e->rot_steps = steps_per_detent;
+}
+
+int btn_engine_process(btn_engine_t *e, btn_ring_t *ring, uint32_t now_us)
+{
+    uint32_t before = e->stats.events;
+
+    while (ring->tail != ring->head)
+    {
+        const btn_edge_t *edge = &ring->buf[ring->tail];
+        uint8_t line = edge->line;
+        uint8_t level = edge->level ? 1 : 0;
+        uint32_t t = edge->t_us;
+
+        ring->tail = (uint8_t)((ring->tail + 1) & (BTN_RING_LEN - 1));
+
+        if (line >= BTN_MAX_LINES || e->lines[line].role == BTN_ROLE_NONE)
+            continue;
+        e->stats.edges++;
+
+        advance_all(e, t);
+
+        {
+            btn_line_t *l = &e->lines[line];
+            if (level == l->raw)
+            {
+                e->stats.glitches++; // 电平未变（漏掉了一个边沿或误触发）
+                continue;
+            }
+            if (l->raw != l->stable)
+                e->stats.glitches++; // 消抖时间内翻回，丢弃上一个边沿
+            l->raw = level;
+            l->raw_us = t;
+        }
+    }
+
+    advance_all(e, now_us);
+    return (int)(e->stats.events - before);
+}
+
+int btn_engine_pop(btn_engine_t *e, btn_event_t *ev)
+{
+    if (e->q_tail == e->q_head)
+        return 0;
+    *ev = e->queue[e->q_tail];
+    e->q_tail = (uint8_t)((e->q_tail + 1) & (BTN_EVENT_QUEUE_LEN - 1));
+    return 1;
+}
+
+int btn_engine_pressed(const btn_engine_t *e, uint8_t line)
+{
+    if (line >= BTN_MAX_LINES || e->lines[line].role != BTN_ROLE_BUTTON)
+        return 0;
+    return is_pressed(&e->lines[line]);
+}
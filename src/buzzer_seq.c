@@ -0,0 +1,107 @@
+/**
+ * @file buzzer_seq.c
+ * @brief 非阻塞蜂鸣器音序器实现
+ * @version 1.0
+ * @date 2026-02-05
+ */
+
+#include "buzzer_seq.h"
+#include <string.h>
+
+void buzzer_seq_init(buzzer_seq_t *s)
+{
+    memset(s, 0, sizeof(buzzer_seq_t));
+}
+
+int buzzer_seq_play(buzzer_seq_t *s, const buzzer_melody_t *m, uint32_t now_ms)
+{
+    uint32_t total = 0;
+    uint16_t i;
+
+    for (i = 0; i < m->count; i++)
+        total += m->notes[i].dur_ms;
+    if (total == 0)
+        return 0;
+
+    if (s->melody)
+    {
+        if (m->priority < s->melody->priority)
+        {
+            s->stats.rejected++;
+            return 0;
+        }
+        s->stats.preempted++;
+    }
+
+    s->melody = m;
+    s->index = 0;
+    s->loops_left = m->repeat;
+    s->note_start_ms = now_ms;
+    s->total_ms = total;
+    s->stats.started++;
+    return 1;
+}
+
+void buzzer_seq_stop(buzzer_seq_t *s)
+{
+    s->melody = NULL;
+}
+
+int buzzer_seq_update(buzzer_seq_t *s, uint32_t now_ms, uint16_t *freq_out, uint32_t *wait_ms)
+{
+    uint16_t want = 0;
+
+    *wait_ms = 0;
+
+    while (s->melody)
+    {
+        const buzzer_melody_t *m = s->melody;
+        const buzzer_note_t *n = &m->notes[s->index];
+        uint32_t elapsed = now_ms - s->note_start_ms;
+        uint32_t tone_ms = n->dur_ms > m->gap_ms ? (uint32_t)(n->dur_ms - m->gap_ms) : n->dur_ms;
+
+        // 循环播放时长时间未调度：整遍跳过，避免逐个音符追赶
+        if (s->index == 0 && m->repeat == BUZZER_REPEAT_FOREVER && elapsed >= s->total_ms)
+        {
+            s->note_start_ms += elapsed / s->total_ms * s->total_ms;
+            elapsed = now_ms - s->note_start_ms;
+        }
+
+        if (elapsed < tone_ms)
+        {
+            want = n->freq_hz;
+            *wait_ms = tone_ms - elapsed;
+            break;
+        }
+        if (elapsed < n->dur_ms)
+        {
+            *wait_ms = n->dur_ms - elapsed;
+            break;
+        }
+
+        // 下一个音符：起点按理想时间累加
+        s->note_start_ms += n->dur_ms;
+        s->stats.notes++;
+        if (++s->index >= m->count)
+        {
+            s->index = 0;
+            if (m->repeat != BUZZER_REPEAT_FOREVER && --s->loops_left == 0)
+            {
+                s->melody = NULL;
+                s->stats.completed++;
+            }
+        }
+    }
+
+    *freq_out = want;
+    if (want == s->out_hz)
+        return 0;
+    s->out_hz = want;
+    s->stats.writes++;
+    return 1;
+}
+
+uint8_t buzzer_seq_priority(const buzzer_seq_t *s)
+{
+    return s->melody ? s->melody->priority : 0;
+}
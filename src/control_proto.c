@@ -0,0 +1,368 @@
+/**
+ * @file control_proto.c
+ * @brief ESP-NOW 双向命令/控制协议实现
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#include "control_proto.h"
+#include <string.h>
+
+/* ====================================================================================
+ *  内部函数
+ * ==================================================================================== */
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void transmit_slot(ctrl_endpoint_t *ep, ctrl_slot_t *s, uint32_t now_us)
+{
+    uint8_t buf[CTRL_CMD_HDR_SIZE + CTRL_MAX_PAYLOAD];
+
+    buf[0] = CTRL_MAGIC;
+    buf[1] = CTRL_TYPE_CMD;
+    buf[2] = ep->session;
+    put_u16(buf + 3, s->seq);
+    buf[5] = s->cmd_id;
+    buf[6] = s->flags;
+    buf[7] = s->len;
+    memcpy(buf + CTRL_CMD_HDR_SIZE, s->payload, s->len);
+
+    s->last_tx_us = now_us;
+    ep->stats.sent++;
+    ep->send(ep->ctx, buf, CTRL_CMD_HDR_SIZE + s->len);
+}
+
+static void send_ack(ctrl_endpoint_t *ep)
+{
+    uint8_t buf[CTRL_ACK_SIZE];
+
+    buf[0] = CTRL_MAGIC;
+    buf[1] = CTRL_TYPE_ACK;
+    buf[2] = ep->rx_session;
+    put_u16(buf + 3, ep->rx_top);
+    put_u32(buf + 5, ep->rx_seen);
+    ep->send(ep->ctx, buf, CTRL_ACK_SIZE);
+}
+
+static void record_rtt(ctrl_stats_t *st, uint32_t rtt)
+{
+    uint32_t bin = rtt / CTRL_RTT_BIN_US;
+
+    if (bin >= CTRL_RTT_BINS)
+        bin = CTRL_RTT_BINS - 1;
+    st->rtt_hist[bin]++;
+    if (st->rtt_count == 0 || rtt < st->rtt_min)
+        st->rtt_min = rtt;
+    if (rtt > st->rtt_max)
+        st->rtt_max = rtt;
+    st->rtt_sum += rtt;
+    st->rtt_count++;
+}
+
+/* 会话检查：返回 0 表示上一会话的迟到报文；新会话时重新同步序号窗口 */
+static int check_session(ctrl_endpoint_t *ep, uint8_t session)
+{
+    if (ep->rx_synced && session == ep->rx_session)
+        return 1;
+    if (ep->rx_synced && ep->rx_old_budget > 0 && session == ep->rx_old_session)
+    {
+        ep->rx_old_budget--;
+        ep->stats.old_session++;
+        return 0;
+    }
+
+    // 首次接收或对端重启：第一条命令即交付
+    if (ep->rx_synced)
+    {
+        uint32_t n = CTRL_WINDOW * (ep->max_retries + 1u);
+        ep->rx_old_session = ep->rx_session;
+        ep->rx_old_budget = (uint8_t)(n > 255 ? 255 : n);
+        ep->stats.resyncs++;
+    }
+    ep->rx_synced = 0;
+    ep->rx_session = session;
+    memset(ep->rx_latest, 0, sizeof(ep->rx_latest));
+    return 1;
+}
+
+/* 接收端去重：返回 1 表示新命令，0 表示重复或超出窗口的旧命令 */
+static int accept_seq(ctrl_endpoint_t *ep, uint16_t seq)
+{
+    int16_t d = (int16_t)(seq - ep->rx_top);
+
+    if (!ep->rx_synced)
+    {
+        ep->rx_synced = 1;
+        ep->rx_top = seq;
+        ep->rx_seen = 0;
+        return 1;
+    }
+
+    if (d > 0)
+    {
+        // 窗口前移，旧的 rx_top 成为位图中的一位
+        ep->rx_seen = (d >= 32) ? 0 : (ep->rx_seen << d);
+        if (d <= 32)
+            ep->rx_seen |= 1u << (d - 1);
+        ep->rx_top = seq;
+        return 1;
+    }
+
+    if (d == 0)
+        return 0;
+
+    // 迟到的命令：在窗口内且未收到过才交付
+    {
+        int i = -d - 1;
+        if (i >= 32 || (ep->rx_seen & (1u << i)))
+            return 0;
+        ep->rx_seen |= 1u << i;
+        return 1;
+    }
+}
+
+/* CTRL_FLAG_LATEST 命令：返回 0 表示早于已交付的同 ID 命令（过时），否则记录为最新 */
+static int accept_latest(ctrl_endpoint_t *ep, uint8_t cmd_id, uint16_t seq)
+{
+    int i;
+
+    for (i = 0; i < CTRL_LATEST_TRACK; i++)
+    {
+        if (ep->rx_latest[i].in_use && ep->rx_latest[i].cmd_id == cmd_id)
+        {
+            if ((int16_t)(seq - ep->rx_latest[i].seq) < 0)
+                return 0;
+            ep->rx_latest[i].seq = seq;
+            return 1;
+        }
+    }
+
+    for (i = 0; i < CTRL_LATEST_TRACK && ep->rx_latest[i].in_use; i++)
+        ;
+    if (i == CTRL_LATEST_TRACK)
+    {
+        i = ep->rx_latest_next;
+        ep->rx_latest_next = (uint8_t)((i + 1) % CTRL_LATEST_TRACK);
+    }
+    ep->rx_latest[i].in_use = 1;
+    ep->rx_latest[i].cmd_id = cmd_id;
+    ep->rx_latest[i].seq = seq;
+    return 1;
+}
+
+static void handle_cmd(ctrl_endpoint_t *ep, const uint8_t *buf, size_t len)
+{
+    uint8_t session = buf[2];
+    uint16_t seq = get_u16(buf + 3);
+    uint8_t cmd_id = buf[5];
+    uint8_t flags = buf[6];
+    uint8_t plen = buf[7];
+
+    if (len < (size_t)(CTRL_CMD_HDR_SIZE + plen))
+    {
+        ep->stats.bad++;
+        return;
+    }
+    if (!check_session(ep, session))
+        return; // 对端已重启，旧命令不交付也不确认
+
+    if (!accept_seq(ep, seq))
+    {
+        ep->stats.duplicates++; // 重复命令：对方没收到 ACK，只补发 ACK
+    }
+    else if ((flags & CTRL_FLAG_LATEST) && !accept_latest(ep, cmd_id, seq))
+    {
+        ep->stats.stale++; // 迟到的旧设定值：确认以停止重传，但不交付
+    }
+    else
+    {
+        ep->stats.delivered++;
+        if (ep->deliver)
+            ep->deliver(ep->ctx, cmd_id, buf + CTRL_CMD_HDR_SIZE, plen);
+    }
+
+    send_ack(ep);
+}
+
+static void handle_ack(ctrl_endpoint_t *ep, const uint8_t *buf, uint32_t now_us)
+{
+    uint16_t top = get_u16(buf + 3);
+    uint32_t sack = get_u32(buf + 5);
+    int i;
+
+    if (buf[2] != ep->session)
+    {
+        ep->stats.old_session++; // 确认的是本端重启前的命令，序号不可比
+        return;
+    }
+
+    for (i = 0; i < CTRL_WINDOW; i++)
+    {
+        ctrl_slot_t *s = &ep->slots[i];
+        int16_t d;
+
+        if (!s->in_use)
+            continue;
+        d = (int16_t)(top - s->seq);
+        if (d == 0 || (d >= 1 && d <= 32 && (sack & (1u << (d - 1)))))
+        {
+            if (s->retries == 0)
+                record_rtt(&ep->stats, now_us - s->first_tx_us);
+            ep->stats.acked++;
+            s->in_use = 0;
+        }
+    }
+}
+
+/* ====================================================================================
+ *  对外接口
+ * ==================================================================================== */
+
+void ctrl_init(ctrl_endpoint_t *ep, ctrl_send_fn send, ctrl_deliver_fn deliver, void *ctx, uint8_t session)
+{
+    memset(ep, 0, sizeof(ctrl_endpoint_t));
+    ep->send = send;
+    ep->deliver = deliver;
+    ep->ctx = ctx;
+    ep->session = session;
+    ep->rto_us = CTRL_DEFAULT_RTO_US;
+    ep->max_retries = CTRL_DEFAULT_RETRIES;
+}
+
+int ctrl_submit(ctrl_endpoint_t *ep, uint8_t cmd_id, uint8_t flags, const void *payload, uint8_t len, uint32_t now_us)
+{
+    ctrl_slot_t *free_slot = NULL;
+    int i;
+
+    if (len > CTRL_MAX_PAYLOAD)
+        return -1;
+
+    for (i = 0; i < CTRL_WINDOW; i++)
+    {
+        ctrl_slot_t *s = &ep->slots[i];
+        if (s->in_use && (flags & CTRL_FLAG_LATEST) && s->cmd_id == cmd_id)
+        {
+            // 旧设定值已过时，不再重传
+            s->in_use = 0;
+            ep->stats.superseded++;
+        }
+        if (!s->in_use && free_slot == NULL)
+            free_slot = s;
+    }
+
+    if (free_slot == NULL)
+    {
+        ep->stats.window_full++;
+        return -1;
+    }
+
+    free_slot->in_use = 1;
+    free_slot->cmd_id = cmd_id;
+    free_slot->flags = flags;
+    free_slot->len = len;
+    free_slot->retries = 0;
+    free_slot->seq = ep->next_seq++;
+    free_slot->first_tx_us = now_us;
+    if (len > 0)
+        memcpy(free_slot->payload, payload, len);
+
+    ep->stats.submitted++;
+    transmit_slot(ep, free_slot, now_us);
+    return free_slot->seq;
+}
+
+void ctrl_on_receive(ctrl_endpoint_t *ep, const uint8_t *buf, size_t len, uint32_t now_us)
+{
+    if (len < 2 || buf[0] != CTRL_MAGIC)
+    {
+        ep->stats.bad++;
+        return;
+    }
+
+    if (buf[1] == CTRL_TYPE_CMD && len >= CTRL_CMD_HDR_SIZE)
+        handle_cmd(ep, buf, len);
+    else if (buf[1] == CTRL_TYPE_ACK && len >= CTRL_ACK_SIZE)
+        handle_ack(ep, buf, now_us);
+    else
+        ep->stats.bad++;
+}
+
+void ctrl_poll(ctrl_endpoint_t *ep, uint32_t now_us)
+{
+    int i;
+
+    for (i = 0; i < CTRL_WINDOW; i++)
+    {
+        ctrl_slot_t *s = &ep->slots[i];
+
+        if (!s->in_use || now_us - s->last_tx_us < ep->rto_us)
+            continue;
+
+        if (s->retries >= ep->max_retries)
+        {
+            s->in_use = 0;
+            ep->stats.failed++;
+            continue;
+        }
+
+        s->retries++;
+        ep->stats.retransmits++;
+        transmit_slot(ep, s, now_us);
+    }
+}
+
+int ctrl_in_flight(const ctrl_endpoint_t *ep)
+{
+    int i, n = 0;
+
+    for (i = 0; i < CTRL_WINDOW; i++)
+        n += ep->slots[i].in_use;
+    return n;
+}
+
+uint32_t ctrl_rtt_percentile(const ctrl_stats_t *stats, float pct)
+{
+    uint32_t target, acc = 0;
+    int i;
+
+    if (stats->rtt_count == 0)
+        return 0;
+    target = (uint32_t)(stats->rtt_count * pct / 100.0f + 0.5f);
+    if (target == 0)
+        target = 1;
+
+    for (i = 0; i < CTRL_RTT_BINS; i++)
+    {
+        acc += stats->rtt_hist[i];
+        if (acc >= target)
+            return (i == CTRL_RTT_BINS - 1) ? stats->rtt_max : (uint32_t)(i + 1) * CTRL_RTT_BIN_US;
+    }
+    return stats->rtt_max;
+}
+
+void ctrl_reset_stats(ctrl_endpoint_t *ep)
+{
+    memset(&ep->stats, 0, sizeof(ctrl_stats_t));
+}
@@ -0,0 +1,197 @@
+/**
+ * @file crash_journal.c
+ * @brief RTC 内存崩溃日志实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "crash_journal.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ENTRY_CRC_BYTES offsetof(crash_journal_entry_t, crc)
+
+static uint32_t crc_table[256];
+
+/* CRC-32（IEEE 802.3，反射多项式 0xEDB88320），查表法 */
+static uint32_t crc32(const uint8_t *p, size_t n)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    if (crc_table[1] == 0)
+    {
+        uint32_t i, k, c;
+        for (i = 0; i < 256; i++)
+        {
+            c = i;
+            for (k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+    while (n--)
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+int crash_journal_entry_valid(const crash_journal_entry_t *e)
+{
+    return e->seq != 0 && crc32((const uint8_t *)e, ENTRY_CRC_BYTES) == e->crc;
+}
+
+static int layout_ok(const crash_journal_t *j)
+{
+    return j->magic == CRASH_JOURNAL_MAGIC && j->version == CRASH_JOURNAL_VERSION &&
+           j->entry_size == sizeof(crash_journal_entry_t) && j->slots == CRASH_JOURNAL_SLOTS &&
+           j->head < CRASH_JOURNAL_SLOTS;
+}
+
+static void clear_period(crash_journal_t *j)
+{
+    j->loops = 0;
+    memset(j->max_ticks, 0, sizeof(j->max_ticks));
+}
+
+int crash_journal_open(crash_journal_t *j)
+{
+    uint32_t oldest = 0;
+    uint16_t i;
+
+    if (!layout_ok(j))
+    {
+        memset(j, 0, sizeof(crash_journal_t));
+        j->magic = CRASH_JOURNAL_MAGIC;
+        j->version = CRASH_JOURNAL_VERSION;
+        j->entry_size = sizeof(crash_journal_entry_t);
+        j->slots = CRASH_JOURNAL_SLOTS;
+        j->boots = 1;
+        j->stage = CRASH_JOURNAL_IDLE;
+        j->reset_stage = CRASH_JOURNAL_IDLE;
+        return -1;
+    }
+
+    j->boots++;
+    j->reset_stage = j->stage;
+    j->valid = 0;
+    j->first = 0;
+    // 最旧的有效记录：不依赖 head（复位可能发生在写入记录与推进 head 之间）
+    for (i = 0; i < CRASH_JOURNAL_SLOTS; i++)
+    {
+        const crash_journal_entry_t *e = &j->ring[i];
+        if (!crash_journal_entry_valid(e))
+            continue;
+        if (j->valid == 0 || (int32_t)(e->seq - oldest) < 0)
+        {
+            oldest = e->seq;
+            j->first = i;
+        }
+        if ((int32_t)(e->seq - j->seq) > 0)
+            j->seq = e->seq;
+        j->valid++;
+    }
+    return j->valid;
+}
+
+const crash_journal_entry_t *crash_journal_next(const crash_journal_t *j, int *pos)
+{
+    while (*pos < CRASH_JOURNAL_SLOTS)
+    {
+        const crash_journal_entry_t *e = &j->ring[(j->first + *pos) % CRASH_JOURNAL_SLOTS];
+        (*pos)++;
+        if (crash_journal_entry_valid(e))
+            return e;
+    }
+    return NULL;
+}
+
+void crash_journal_start(crash_journal_t *j, uint32_t ticks_per_us)
+{
+    memset(j->ring, 0, sizeof(j->ring));
+    j->head = 0;
+    j->first = 0;
+    j->valid = 0;
+    j->ticks_per_us = ticks_per_us > 0 ? ticks_per_us : 1;
+    j->stage = CRASH_JOURNAL_IDLE;
+    clear_period(j);
+}
+
+void crash_journal_commit(crash_journal_t *j, uint32_t t_ms, uint16_t frames,
+                          const float value[CRASH_JOURNAL_VALUES])
+{
+    crash_journal_entry_t e;
+    int i;
+
+    e.seq = j->seq + 1 != 0 ? j->seq + 1 : 1;
+    e.t_ms = t_ms;
+    e.loops = j->loops;
+    e.frames = frames;
+    for (i = 0; i < CRASH_JOURNAL_STAGES; i++)
+    {
+        uint32_t us = j->max_ticks[i] / j->ticks_per_us;
+        e.stage_max_us[i] = (uint16_t)(us > 0xFFFF ? 0xFFFF : us);
+    }
+    memcpy(e.value, value, sizeof(e.value));
+    e.crc = crc32((const uint8_t *)&e, ENTRY_CRC_BYTES);
+
+    // 先写完整条记录再推进序号和 head；队列已满时覆盖的是最旧的一条
+    j->ring[j->head] = e;
+    j->seq = e.seq;
+    if (j->valid < CRASH_JOURNAL_SLOTS)
+        j->valid++;
+    else
+        j->first = (uint16_t)((j->head + 1) % CRASH_JOURNAL_SLOTS);
+    j->head = (uint16_t)((j->head + 1) % CRASH_JOURNAL_SLOTS);
+    clear_period(j);
+}
+
+int crash_journal_format_entry(const crash_journal_entry_t *e, const char *const *stage_names,
+                               const char *const *value_names, char *buf, size_t buf_size)
+{
+    size_t pos = 0;
+    int ret, i;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+
+#define APPEND(...)                                                                                    \
+    do                                                                                                 \
+    {                                                                                                  \
+        if (pos < buf_size)                                                                            \
+        {                                                                                              \
+            ret = snprintf(buf + pos, buf_size - pos, __VA_ARGS__);                                    \
+            if (ret > 0)                                                                               \
+                pos += (size_t)ret;                                                                    \
+        }                                                                                              \
+    } while (0)
+
+    APPEND("#%lu %8.3fs loop×%u 帧 %u |", (unsigned long)e->seq, e->t_ms / 1000.0, e->loops, e->frames);
+    for (i = 0; i < CRASH_JOURNAL_STAGES; i++)
+        if (stage_names[i])
+            APPEND(" %s %u", stage_names[i], e->stage_max_us[i]);
+    APPEND(" us |");
+    for (i = 0; i < CRASH_JOURNAL_VALUES; i++)
+        APPEND(" %.2f %s", e->value[i], value_names[i]);
+    APPEND("\n");
+
+#undef APPEND
+    return pos >= buf_size ? (int)buf_size - 1 : (int)pos;
+}
+
+int crash_journal_format_summary(const crash_journal_t *j, const char *const *stage_names, char *buf,
+                                 size_t buf_size)
+{
+    const char *stage = "不在 loop() 中";
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    if (j->reset_stage < CRASH_JOURNAL_STAGES && stage_names[j->reset_stage])
+        stage = stage_names[j->reset_stage];
+    ret = snprintf(buf, buf_size,
+                   "第 %lu 次启动 | 有效记录 %u 条（序号至 %lu）| 复位时阶段: %s，最后一条记录后又完成 %u 次 loop()\n",
+                   (unsigned long)j->boots, j->valid, (unsigned long)j->seq, stage, j->loops);
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)buf_size - 1 : ret;
+}
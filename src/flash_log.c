@@ -0,0 +1,398 @@
+/**
+ * @file flash_log.c
+ * @brief Flash 分区环形日志实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "flash_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ERASED_LEN 0xFFFF
+
+static uint32_t crc_table[256];
+
+/* CRC-32（IEEE 802.3，反射多项式 0xEDB88320），查表法；crc 初值 0 */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t n)
+{
+    if (crc_table[1] == 0)
+    {
+        uint32_t i, k, c;
+        for (i = 0; i < 256; i++)
+        {
+            c = i;
+            for (k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (n--)
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t rec_size(uint16_t len)
+{
+    return (FLASH_LOG_REC_HDR + (uint32_t)len + 3) & ~3u;
+}
+
+static int rd(flash_log_t *log, uint32_t addr, void *buf, uint32_t len)
+{
+    if (log->map)
+    {
+        memcpy(buf, log->map + addr, len);
+        return 0;
+    }
+    if (log->ops.read(log->ctx, addr, buf, len) != 0)
+    {
+        log->stats.io_errors++;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * 读取并校验扇区 k 的头
+ * @return 1 有效（*seq、*rec 为序号和首条记录序号），0 无效或未写入
+ */
+static int sector_hdr(flash_log_t *log, uint32_t k, uint32_t *seq, uint32_t *rec)
+{
+    uint8_t h[FLASH_LOG_SECTOR_HDR];
+
+    if (rd(log, k * FLASH_LOG_SECTOR, h, sizeof(h)) != 0)
+        return 0;
+    if (get_u32(h) != FLASH_LOG_MAGIC || get_u16(h + 12) != FLASH_LOG_VERSION ||
+        get_u16(h + 14) != FLASH_LOG_SECTOR_HDR || crc32_update(0, h, 16) != get_u32(h + 16))
+        return 0;
+    *seq = get_u32(h + 4);
+    *rec = get_u32(h + 8);
+    return *seq % log->sectors == k;
+}
+
+/* 二分查找的谓词：扇区 k 有效且圈数为 lap */
+static int in_lap(flash_log_t *log, uint32_t k, uint32_t lap)
+{
+    uint32_t seq, rec;
+
+    log->stats.open_reads++;
+    return sector_hdr(log, k, &seq, &rec) && seq / log->sectors == lap;
+}
+
+/* 扇区 k 是否全为 0xFF（已擦除、未写入） */
+static int sector_blank(flash_log_t *log, uint32_t k)
+{
+    uint32_t w[64], off, i;
+
+    for (off = 0; off < FLASH_LOG_SECTOR; off += sizeof(w))
+    {
+        if (rd(log, k * FLASH_LOG_SECTOR + off, w, sizeof(w)) != 0)
+            return 0;
+        for (i = 0; i < 64; i++)
+            if (w[i] != 0xFFFFFFFFu)
+                return 0;
+    }
+    return 1;
+}
+
+/* 下一个扇区的序号 */
+static uint32_t next_seq(const flash_log_t *log)
+{
+    return log->empty ? 0 : log->head_seq + 1;
+}
+
+/* 写入扇区之后连续的已擦除扇区数 */
+static uint32_t count_erased(flash_log_t *log)
+{
+    uint32_t n = 0, seq = next_seq(log);
+
+    while (n < FLASH_LOG_PREERASE_MAX && n + 2 <= log->sectors && sector_blank(log, (seq + n) % log->sectors))
+        n++;
+    return n;
+}
+
+int flash_log_open(flash_log_t *log, const flash_log_ops_t *ops, void *ctx, const uint8_t *map, uint32_t size)
+{
+    uint32_t r, lo, hi, seq, rec, off, limit, n = 0;
+
+    memset(log, 0, sizeof(flash_log_t));
+    log->ops = *ops;
+    log->ctx = ctx;
+    log->map = map;
+    log->sectors = size / FLASH_LOG_SECTOR;
+    log->empty = 1;
+    if (log->sectors < 2)
+        return -1;
+
+    // 参照扇区：第一个有效扇区。新一圈开头的扇区可能已被预擦除（最多 PREERASE_MAX 个）或扇区头写到一半
+    limit = FLASH_LOG_PREERASE_MAX + 2 < log->sectors ? FLASH_LOG_PREERASE_MAX + 2 : log->sectors;
+    for (r = 0; r < limit; r++)
+    {
+        log->stats.open_reads++;
+        if (sector_hdr(log, r, &seq, &rec))
+            break;
+    }
+    if (r == limit)
+    {
+        log->erased = count_erased(log); // 空分区
+        return log->stats.io_errors ? -1 : 0;
+    }
+    // 在 [r, sectors - 1] 中找最后一个与参照扇区同圈的扇区
+    lo = r;
+    hi = log->sectors - 1;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo + 1) / 2;
+        if (in_lap(log, mid, seq / log->sectors))
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    if (!sector_hdr(log, lo, &seq, &rec))
+        return -1;
+
+    // 扫描写入扇区的记录头：遇到未写入的位置为止；长度不合理时视为扇区已满
+    off = FLASH_LOG_SECTOR_HDR;
+    while (off + FLASH_LOG_REC_HDR <= FLASH_LOG_SECTOR)
+    {
+        uint8_t h[2];
+        uint16_t len;
+        if (rd(log, lo * FLASH_LOG_SECTOR + off, h, sizeof(h)) != 0)
+            return -1;
+        len = get_u16(h);
+        if (len == ERASED_LEN)
+            break;
+        if (len > FLASH_LOG_MAX_PAYLOAD || off + rec_size(len) > FLASH_LOG_SECTOR)
+        {
+            off = FLASH_LOG_SECTOR;
+            break;
+        }
+        off += rec_size(len);
+        n++;
+    }
+
+    log->empty = 0;
+    log->head = lo;
+    log->head_seq = seq;
+    log->head_off = off;
+    log->rec_seq = rec + n;
+    log->erased = count_erased(log);
+    return log->stats.io_errors ? -1 : 0;
+}
+
+/* 擦除下一个扇区（最旧的数据，已预擦除时跳过）并写入扇区头 */
+static int next_sector(flash_log_t *log)
+{
+    uint32_t seq = next_seq(log);
+    uint32_t k = seq % log->sectors;
+    uint8_t h[FLASH_LOG_SECTOR_HDR];
+
+    put_u32(h, FLASH_LOG_MAGIC);
+    put_u32(h + 4, seq);
+    put_u32(h + 8, log->rec_seq);
+    put_u16(h + 12, FLASH_LOG_VERSION);
+    put_u16(h + 14, FLASH_LOG_SECTOR_HDR);
+    put_u32(h + 16, crc32_update(0, h, 16));
+
+    if (log->erased == 0)
+    {
+        log->stats.erases++;
+        if (log->ops.erase(log->ctx, k * FLASH_LOG_SECTOR) != 0)
+        {
+            log->stats.io_errors++;
+            return 0;
+        }
+    }
+    else
+    {
+        log->erased--;
+    }
+    if (log->ops.write(log->ctx, k * FLASH_LOG_SECTOR, h, sizeof(h)) != 0)
+    {
+        // 扇区头写到一半：下次追加重新擦除该扇区
+        log->stats.io_errors++;
+        return 0;
+    }
+    log->empty = 0;
+    log->head = k;
+    log->head_seq = seq;
+    log->head_off = FLASH_LOG_SECTOR_HDR;
+    return 1;
+}
+
+int flash_log_append(flash_log_t *log, uint8_t type, const void *payload, uint16_t len)
+{
+    uint32_t size = rec_size(len), addr;
+    uint8_t h[FLASH_LOG_REC_HDR];
+    uint32_t crc;
+
+    if (len > FLASH_LOG_MAX_PAYLOAD || log->sectors < 2)
+    {
+        log->stats.rejected++;
+        return 0;
+    }
+    // 擦除或写扇区头失败时 head_off 不变，下次追加重试
+    if ((log->empty || log->head_off + size > FLASH_LOG_SECTOR) && !next_sector(log))
+        return 0;
+
+    put_u16(h, len);
+    h[2] = type;
+    h[3] = 0xFF;
+    put_u32(h + 4, log->rec_seq);
+    crc = crc32_update(0, h, 8);
+    crc = crc32_update(crc, (const uint8_t *)payload, len);
+    put_u32(h + 8, crc);
+
+    // 先写头：中途断电时头已指明长度，恢复后从其后继续，不会对已编程的位置重复写入
+    addr = log->head * FLASH_LOG_SECTOR + log->head_off;
+    log->head_off += size;
+    log->rec_seq++;
+    if (log->ops.write(log->ctx, addr, h, sizeof(h)) != 0 ||
+        (len > 0 && log->ops.write(log->ctx, addr + FLASH_LOG_REC_HDR, payload, len) != 0))
+    {
+        log->stats.io_errors++;
+        return 0;
+    }
+    log->stats.appended++;
+    log->stats.bytes += size;
+    return 1;
+}
+
+int flash_log_reserve(flash_log_t *log, uint32_t n)
+{
+    uint32_t k;
+
+    if (n > FLASH_LOG_PREERASE_MAX)
+        n = FLASH_LOG_PREERASE_MAX;
+    if (log->sectors < 2 || n + 2 > log->sectors)
+        n = log->sectors >= 2 ? log->sectors - 2 : 0; // 至少保留写入扇区和一个数据扇区
+    if (log->erased >= n)
+        return 0;
+
+    k = (next_seq(log) + log->erased) % log->sectors;
+    log->stats.erases++;
+    if (log->ops.erase(log->ctx, k * FLASH_LOG_SECTOR) != 0)
+    {
+        log->stats.io_errors++;
+        return -1;
+    }
+    log->erased++;
+    log->stats.pre_erases++;
+    return 1;
+}
+
+void flash_log_rewind(const flash_log_t *log, flash_log_cursor_t *c)
+{
+    c->off = 0;
+    if (log->empty)
+        c->seq = 1; // 大于 head_seq（0），遍历立即结束
+    else
+        c->seq = log->head_seq >= log->sectors ? log->head_seq - log->sectors + 1 : 0;
+}
+
+int flash_log_next(flash_log_t *log, flash_log_cursor_t *c, flash_log_rec_t *rec, uint8_t *buf)
+{
+    while (!log->empty && (int32_t)(c->seq - log->head_seq) <= 0)
+    {
+        uint32_t k = c->seq % log->sectors;
+        uint32_t end = c->seq == log->head_seq ? log->head_off : FLASH_LOG_SECTOR;
+        uint32_t seq, first, base = k * FLASH_LOG_SECTOR, crc;
+        uint8_t h[FLASH_LOG_REC_HDR];
+        uint16_t len;
+
+        // 扇区头无效（擦除后未写完）或已是新一圈的扇区：跳过
+        if (c->off == 0)
+        {
+            if (!sector_hdr(log, k, &seq, &first) || seq != c->seq)
+            {
+                c->seq++;
+                continue;
+            }
+            c->off = FLASH_LOG_SECTOR_HDR;
+        }
+        if (c->off + FLASH_LOG_REC_HDR > end || rd(log, base + c->off, h, sizeof(h)) != 0 ||
+            (len = get_u16(h)) == ERASED_LEN || len > FLASH_LOG_MAX_PAYLOAD || c->off + rec_size(len) > end)
+        {
+            c->seq++;
+            c->off = 0;
+            continue;
+        }
+
+        rec->seq = get_u32(h + 4);
+        rec->type = h[2];
+        rec->len = len;
+        if (log->map)
+            rec->data = log->map + base + c->off + FLASH_LOG_REC_HDR;
+        else if (rd(log, base + c->off + FLASH_LOG_REC_HDR, buf, len) == 0)
+            rec->data = buf;
+        else
+            rec->data = NULL;
+        c->off += rec_size(len);
+
+        crc = crc32_update(0, h, 8);
+        if (rec->data == NULL || crc32_update(crc, rec->data, len) != get_u32(h + 8))
+        {
+            log->stats.crc_errors++;
+            continue;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t flash_log_used(const flash_log_t *log)
+{
+    uint32_t full;
+
+    if (log->empty)
+        return 0;
+    full = log->head_seq >= log->sectors ? log->sectors - 1 : log->head_seq;
+    full = full > log->erased ? full - log->erased : 0; // 预擦除的扇区不再保留数据
+    return full * FLASH_LOG_SECTOR + log->head_off;
+}
+
+int flash_log_format(const flash_log_t *log, char *buf, size_t buf_size)
+{
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    ret = snprintf(buf, buf_size,
+                   "Flash日志: %lu 扇区，第 %lu 圈 | 占用 %lu/%lu B，预擦除 %lu 扇区 | 下一条记录 #%lu | 本次写入 %lu 条 %lu B，"
+                   "擦除 %lu（预擦除 %lu），拒绝 %lu，IO错误 %lu，CRC错误 %lu | 恢复读取扇区头 %lu 次\n",
+                   (unsigned long)log->sectors, (unsigned long)(log->empty ? 0 : log->head_seq / log->sectors + 1),
+                   (unsigned long)flash_log_used(log), (unsigned long)log->sectors * FLASH_LOG_SECTOR,
+                   (unsigned long)log->erased, (unsigned long)log->rec_seq, (unsigned long)log->stats.appended,
+                   (unsigned long)log->stats.bytes, (unsigned long)log->stats.erases,
+                   (unsigned long)log->stats.pre_erases, (unsigned long)log->stats.rejected,
+                   (unsigned long)log->stats.io_errors, (unsigned long)log->stats.crc_errors,
+                   (unsigned long)log->stats.open_reads);
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)buf_size - 1 : ret;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file hipnuc_sync.c
+ * @brief HiPNUC 抗干扰分帧器实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "hipnuc_sync.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SYNC1 0x5A
+#define SYNC2 0xA5
+
+void hipnuc_sync_init(hipnuc_sync_t *s)
+{
+    memset(s, 0, sizeof(hipnuc_sync_t));
+    s->max_len = HIPNUC_MAX_RAW_SIZE - HIPNUC_SYNC_HDR_SIZE;
+    s->check_tag = 1;
+}
+
+void hipnuc_sync_reset(hipnuc_sync_t *s)
+{
+    uint16_t max_len = s->max_len;
+    uint8_t check_tag = s->check_tag;
+
+    hipnuc_sync_init(s);
+    s->max_len = max_len;
+    s->check_tag = check_tag;
+}
+
+static uint16_t frame_len(const uint8_t *p)
+{
+    return (uint16_t)(p[2] | (p[3] << 8));
+}
+
+/* 丢弃候选起点字节，从下一字节重新找帧头 */
+static void drop_first(hipnuc_sync_t *s)
+{
+    s->head++;
+    s->scan = 0;
+    s->stats.skipped++;
+}
+
+/* 候选帧失败：已检查过的字节都要重新搜索 */
+static void reject(hipnuc_sync_t *s, uint16_t examined)
+{
+    if (s->head + examined > s->rescan)
+        s->rescan = (uint16_t)(s->head + examined);
+    drop_first(s);
+}
+
+static void compact(hipnuc_sync_t *s)
+{
+    memmove(s->buf, s->buf + s->head, s->n - s->head);
+    s->n = (uint16_t)(s->n - s->head);
+    s->rescan = s->rescan > s->head ? (uint16_t)(s->rescan - s->head) : 0;
+    s->head = 0;
+}
+
+int hipnuc_sync_input(hipnuc_sync_t *s, hipnuc_raw_t *raw, uint8_t data)
+{
+    int ret = 0;
+
+    if (s->n == sizeof(s->buf))
+    {
+        compact(s);
+        if (s->n == sizeof(s->buf)) // 不应发生：候选帧不超过协议上限
+        {
+            drop_first(s);
+            compact(s);
+        }
+    }
+    s->buf[s->n++] = data;
+
+    while (s->head + s->scan < s->n)
+    {
+        const uint8_t *p = s->buf + s->head;
+        uint16_t i = s->scan;
+
+        if (i == 0 && p[0] != SYNC1)
+        {
+            drop_first(s);
+            continue;
+        }
+        if (i == 1 && p[1] != SYNC2)
+        {
+            drop_first(s);
+            continue;
+        }
+        if (i == HIPNUC_SYNC_HDR_SIZE - 1)
+        {
+            uint16_t len = frame_len(p);
+            if (len == 0 || len > s->max_len)
+            {
+                s->stats.len_errors++;
+                reject(s, i + 1);
+                ret = -1;
+                continue;
+            }
+        }
+        if (i == HIPNUC_SYNC_HDR_SIZE && s->check_tag && p[i] != 0x91 && p[i] != 0x81 && p[i] != 0x83)
+        {
+            s->stats.tag_errors++;
+            reject(s, i + 1);
+            ret = -1;
+            continue;
+        }
+
+        s->scan++;
+        if (s->scan < HIPNUC_SYNC_HDR_SIZE || s->scan != HIPNUC_SYNC_HDR_SIZE + frame_len(p))
+            continue;
+
+        // 候选帧收满：交给厂商解码器做 CRC 校验和解析
+        {
+            uint16_t k;
+            int r = 0;
+
+            raw->nbyte = 0;
+            for (k = 0; k < s->scan; k++)
+                r = hipnuc_input(raw, p[k]);
+
+            if (r > 0)
+            {
+                s->stats.frames++;
+                if (s->head < s->rescan)
+                    s->stats.recovered++;
+                s->head = (uint16_t)(s->head + s->scan);
+                s->scan = 0;
+                return r;
+            }
+            s->stats.crc_errors++;
+            reject(s, s->scan);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int hipnuc_sync_format(const hipnuc_sync_t *s, char *buf, size_t buf_size)
+{
+    const hipnuc_sync_stats_t *st = &s->stats;
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    ret = snprintf(buf, buf_size, "帧 %lu (找回 %lu) | CRC错误 %lu | 长度错误 %lu | 标签错误 %lu | 跳过 %lu 字节\n",
+                   (unsigned long)st->frames, (unsigned long)st->recovered, (unsigned long)st->crc_errors,
+                   (unsigned long)st->len_errors, (unsigned long)st->tag_errors, (unsigned long)st->skipped);
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)(buf_size - 1) : ret;
+}
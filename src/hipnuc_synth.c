@@ -0,0 +1,227 @@
+/**
+ * @file hipnuc_synth.c
+ * @brief HiPNUC 合成帧生成器实现
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#include "hipnuc_synth.h"
+#include "hipnuc_dec.h"
+#include <string.h>
+
+#define SYNC1 0x5A
+#define SYNC2 0xA5
+
+uint16_t hipnuc_synth_crc16(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    size_t j;
+    int i;
+
+    for (j = 0; j < len; j++)
+    {
+        crc ^= (uint16_t)(buf[j] << 8);
+        for (i = 0; i < 8; i++)
+            crc = (uint16_t)((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+    }
+    return crc;
+}
+
+int hipnuc_synth_frame(uint8_t *out, size_t cap, const uint8_t *payload, uint16_t len)
+{
+    uint16_t crc;
+
+    if (cap < (size_t)HIPNUC_SYNTH_HDR_SIZE + len)
+        return -1;
+
+    out[0] = SYNC1;
+    out[1] = SYNC2;
+    out[2] = (uint8_t)(len & 0xFF);
+    out[3] = (uint8_t)(len >> 8);
+    memmove(out + HIPNUC_SYNTH_HDR_SIZE, payload, len);
+
+    crc = hipnuc_synth_crc16(0, out, 4);
+    crc = hipnuc_synth_crc16(crc, out + HIPNUC_SYNTH_HDR_SIZE, len);
+    out[4] = (uint8_t)(crc & 0xFF);
+    out[5] = (uint8_t)(crc >> 8);
+    return HIPNUC_SYNTH_HDR_SIZE + len;
+}
+
+/* 由 seq 生成的确定性取值 */
+static float val(uint32_t seq, int k)
+{
+    return (float)((int32_t)((seq * 37u + (uint32_t)k * 11u) % 2001u) - 1000) * 0.01f;
+}
+
+int hipnuc_synth_hi91(uint8_t *out, size_t cap, uint32_t seq)
+{
+    hi91_t p;
+    int i;
+
+    memset(&p, 0, sizeof(p));
+    p.tag = 0x91;
+    p.temp = 25;
+    p.air_pressure = 101325.0f + val(seq, 0);
+    p.system_time = seq * 10u;
+    for (i = 0; i < 3; i++)
+    {
+        p.acc[i] = val(seq, 1 + i) * 0.1f;
+        p.gyr[i] = val(seq, 4 + i);
+        p.mag[i] = val(seq, 7 + i) * 0.5f;
+    }
+    p.roll = val(seq, 10);
+    p.pitch = val(seq, 11) * 0.5f;
+    p.yaw = val(seq, 12) * 1.8f;
+    p.quat[0] = 1.0f;
+    for (i = 1; i < 4; i++)
+        p.quat[i] = val(seq, 12 + i) * 0.001f;
+
+    return hipnuc_synth_frame(out, cap, (const uint8_t *)&p, sizeof(p));
+}
+
+int hipnuc_synth_hi81(uint8_t *out, size_t cap, uint32_t seq)
+{
+    hi81_t p;
+    int i;
+
+    memset(&p, 0, sizeof(p));
+    p.tag = 0x81;
+    p.ins_status = 2;
+    p.gpst_wn = 2400;
+    p.gpst_tow = seq * 10u;
+    for (i = 0; i < 3; i++)
+    {
+        p.gyr_b[i] = (int16_t)(val(seq, i) * 100);
+        p.acc_b[i] = (int16_t)(val(seq, 3 + i) * 100);
+        p.mag_b[i] = (int16_t)(val(seq, 6 + i) * 100);
+        p.vel_enu[i] = (int16_t)(val(seq, 9 + i) * 10);
+        p.acc_enu[i] = (int16_t)(val(seq, 12 + i) * 10);
+    }
+    p.roll = (int16_t)(val(seq, 15) * 100);
+    p.pitch = (int16_t)(val(seq, 16) * 50);
+    p.yaw = (uint16_t)(seq % 36000u);
+    p.quat[0] = 10000;
+    p.ins_lon = 1163970000 + (int32_t)(seq % 1000u);
+    p.ins_lat = 399080000 + (int32_t)(seq % 1000u);
+    p.ins_msl = 50000;
+    p.solq_pos = 4;
+    p.nv_pos = 18;
+    p.gnss_lon = p.ins_lon;
+    p.gnss_lat = p.ins_lat;
+    p.gnss_msl = p.ins_msl;
+
+    return hipnuc_synth_frame(out, cap, (const uint8_t *)&p, sizeof(p));
+}
+
+static void put_f32(uint8_t *p, int *idx, float v)
+{
+    memcpy(p + *idx, &v, 4);
+    *idx += 4;
+}
+
+static void put_f32x(uint8_t *p, int *idx, uint32_t seq, int k, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        put_f32(p, idx, val(seq, k + i));
+}
+
+static void put_f64x(uint8_t *p, int *idx, uint32_t seq, int k, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        double v = 39.9 + val(seq, k + i) * 1e-4;
+        memcpy(p + *idx, &v, 8);
+        *idx += 8;
+    }
+}
+
+int hipnuc_synth_hi83(uint8_t *out, size_t cap, uint32_t bitmap, uint32_t seq)
+{
+    uint8_t p[256];
+    int idx = 8;
+    uint16_t status = 0;
+    uint64_t t_us = (uint64_t)seq * 10000u;
+
+    bitmap &= HIPNUC_SYNTH_HI83_ALL;
+
+    p[0] = 0x83;
+    memcpy(p + 1, &status, 2);
+    p[3] = 0;
+    memcpy(p + 4, &bitmap, 4);
+
+    // 字段顺序与 parse_data() 一致
+    if (bitmap & HI83_BMAP_ACC_B)
+        put_f32x(p, &idx, seq, 0, 3);
+    if (bitmap & HI83_BMAP_GYR_B)
+        put_f32x(p, &idx, seq, 3, 3);
+    if (bitmap & HI83_BMAP_MAG_B)
+        put_f32x(p, &idx, seq, 6, 3);
+    if (bitmap & HI83_BMAP_RPY)
+        put_f32x(p, &idx, seq, 9, 3);
+    if (bitmap & HI83_BMAP_QUAT)
+        put_f32x(p, &idx, seq, 12, 4);
+    if (bitmap & HI83_BMAP_SYSTEM_TIME)
+    {
+        memcpy(p + idx, &t_us, 8);
+        idx += 8;
+    }
+    if (bitmap & HI83_BMAP_UTC)
+    {
+        uint16_t ms = (uint16_t)(seq % 60000u);
+        p[idx + 0] = 26;
+        p[idx + 1] = 2;
+        p[idx + 2] = 7;
+        p[idx + 3] = 12;
+        p[idx + 4] = 0;
+        memcpy(p + idx + 5, &ms, 2);
+        p[idx + 7] = 0;
+        idx += 8;
+    }
+    if (bitmap & HI83_BMAP_AIR_PRESSURE)
+        put_f32(p, &idx, 101325.0f + val(seq, 16));
+    if (bitmap & HI83_BMAP_TEMPERATURE)
+        put_f32(p, &idx, 25.0f + val(seq, 17) * 0.01f);
+    if (bitmap & HI83_BMAP_INCLINATION)
+        put_f32x(p, &idx, seq, 18, 3);
+    if (bitmap & HI83_BMAP_HSS)
+        put_f32x(p, &idx, seq, 21, 3);
+    if (bitmap & HI83_BMAP_HSS_FRQ)
+        put_f32x(p, &idx, seq, 24, 3);
+    if (bitmap & HI83_BMAP_VEL_ENU)
+        put_f32x(p, &idx, seq, 27, 3);
+    if (bitmap & HI83_BMAP_ACC_ENU)
+        put_f32x(p, &idx, seq, 30, 3);
+    if (bitmap & HI83_BMAP_INS_LON_LAT_MSL)
+        put_f64x(p, &idx, seq, 33, 3);
+    if (bitmap & HI83_BMAP_GNSS_QUALITY_NV)
+    {
+        p[idx + 0] = 4;
+        p[idx + 1] = 18;
+        p[idx + 2] = 4;
+        p[idx + 3] = 16;
+        idx += 4;
+    }
+    if (bitmap & HI83_BMAP_OD_SPEED)
+        put_f32(p, &idx, val(seq, 36));
+    if (bitmap & HI83_BMAP_UNDULATION)
+        put_f32(p, &idx, val(seq, 37));
+    if (bitmap & HI83_BMAP_DIFF_AGE)
+        put_f32(p, &idx, 1.0f);
+    if (bitmap & HI83_BMAP_NODE_ID)
+    {
+        p[idx + 0] = (uint8_t)(seq & 0xFF);
+        p[idx + 1] = 0;
+        p[idx + 2] = 0;
+        p[idx + 3] = 0;
+        idx += 4;
+    }
+    if (bitmap & HI83_BMAP_GNSS_LON_LAT_MSL)
+        put_f64x(p, &idx, seq, 38, 3);
+    if (bitmap & HI83_BMAP_GNSS_VEL)
+        put_f32x(p, &idx, seq, 41, 3);
+
+    return hipnuc_synth_frame(out, cap, p, (uint16_t)idx);
+}
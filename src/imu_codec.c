@@ -0,0 +1,364 @@
+/**
+ * @file imu_codec.c
+ * @brief HiPNUC IMU 记录流式压缩编解码器实现
+ *
+ * @details 差分采用 32 位回绕运算：d = (uint32)cur - (uint32)prev，
+ *          解码 cur = (uint32)prev + (uint32)d，因此任意整数序列都能逐位还原。
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#include "imu_codec.h"
+#include <stddef.h>
+#include <string.h>
+
+/* ====================================================================================
+ *  HI81 字段表（偏移 + 宽度，宽度为负表示有符号）
+ * ==================================================================================== */
+
+typedef struct
+{
+    uint8_t ofs;
+    int8_t size;
+} field_desc_t;
+
+#define F_U(member) {(uint8_t)offsetof(hi81_t, member), (int8_t)sizeof(((hi81_t *)0)->member)}
+#define F_S(member) {(uint8_t)offsetof(hi81_t, member), (int8_t)(-(int)sizeof(((hi81_t *)0)->member))}
+
+static const field_desc_t hi81_fields[IMU_CODEC_HI81_FIELDS] = {
+    F_U(main_status), F_U(ins_status), F_U(gpst_wn), F_U(gpst_tow), F_U(reserved),
+    F_S(gyr_b[0]), F_S(gyr_b[1]), F_S(gyr_b[2]),
+    F_S(acc_b[0]), F_S(acc_b[1]), F_S(acc_b[2]),
+    F_S(mag_b[0]), F_S(mag_b[1]), F_S(mag_b[2]),
+    F_S(air_pressure), F_S(reserved1), F_S(temperature),
+    F_U(utc_year), F_U(utc_month), F_U(utc_day), F_U(utc_hour), F_U(utc_min), F_U(utc_msec),
+    F_S(roll), F_S(pitch), F_U(yaw),
+    F_S(quat[0]), F_S(quat[1]), F_S(quat[2]), F_S(quat[3]),
+    F_S(ins_lon), F_S(ins_lat), F_S(ins_msl),
+    F_U(pdop), F_U(hdop), F_U(solq_pos), F_U(nv_pos), F_U(solq_heading), F_U(nv_heading), F_U(diff_age),
+    F_S(undulation), F_U(ant_status),
+    F_S(vel_enu[0]), F_S(vel_enu[1]), F_S(vel_enu[2]),
+    F_S(acc_enu[0]), F_S(acc_enu[1]), F_S(acc_enu[2]),
+    F_S(gnss_lon), F_S(gnss_lat), F_S(gnss_msl),
+    F_U(reserved2[0]), F_U(reserved2[1]),
+};
+
+/* ====================================================================================
+ *  HI91 量化
+ * ==================================================================================== */
+
+#define HI91_INT_FIELDS 3 // main_status, temp, system_time 原样保留
+#define HI91_FLOAT_FIELDS (IMU_CODEC_HI91_FIELDS - HI91_INT_FIELDS)
+
+static const float hi91_scales[HI91_FLOAT_FIELDS] = {
+    IMU_CODEC_SCALE_PRESSURE,
+    IMU_CODEC_SCALE_ACC, IMU_CODEC_SCALE_ACC, IMU_CODEC_SCALE_ACC,
+    IMU_CODEC_SCALE_GYR, IMU_CODEC_SCALE_GYR, IMU_CODEC_SCALE_GYR,
+    IMU_CODEC_SCALE_MAG, IMU_CODEC_SCALE_MAG, IMU_CODEC_SCALE_MAG,
+    IMU_CODEC_SCALE_EUL, IMU_CODEC_SCALE_EUL, IMU_CODEC_SCALE_EUL,
+    IMU_CODEC_SCALE_QUAT, IMU_CODEC_SCALE_QUAT, IMU_CODEC_SCALE_QUAT, IMU_CODEC_SCALE_QUAT,
+};
+
+static int32_t quantize(float v, float scale)
+{
+    float s = v * scale;
+    if (s != s)
+        return 0; // NaN
+    if (s >= 2147483520.0f)
+        return INT32_MAX;
+    if (s <= -2147483648.0f)
+        return INT32_MIN;
+    return (int32_t)(s >= 0.0f ? s + 0.5f : s - 0.5f);
+}
+
+/* 浮点字段顺序：air_pressure, acc[3], gyr[3], mag[3], roll, pitch, yaw, quat[4] */
+static void hi91_floats(const hi91_t *in, float f[HI91_FLOAT_FIELDS])
+{
+    int i;
+    f[0] = in->air_pressure;
+    for (i = 0; i < 3; i++)
+    {
+        f[1 + i] = in->acc[i];
+        f[4 + i] = in->gyr[i];
+        f[7 + i] = in->mag[i];
+    }
+    f[10] = in->roll;
+    f[11] = in->pitch;
+    f[12] = in->yaw;
+    for (i = 0; i < 4; i++)
+        f[13 + i] = in->quat[i];
+}
+
+static void hi91_to_fields(const hi91_t *in, int32_t *v)
+{
+    float f[HI91_FLOAT_FIELDS];
+    int i;
+
+    v[0] = in->main_status;
+    v[1] = in->temp;
+    v[2] = (int32_t)in->system_time;
+    hi91_floats(in, f);
+    for (i = 0; i < HI91_FLOAT_FIELDS; i++)
+        v[HI91_INT_FIELDS + i] = quantize(f[i], hi91_scales[i]);
+}
+
+static void fields_to_hi91(const int32_t *v, hi91_t *out)
+{
+    float f[HI91_FLOAT_FIELDS];
+    int i;
+
+    for (i = 0; i < HI91_FLOAT_FIELDS; i++)
+        f[i] = (float)v[HI91_INT_FIELDS + i] / hi91_scales[i];
+
+    memset(out, 0, sizeof(hi91_t));
+    out->tag = 0x91;
+    out->main_status = (uint16_t)v[0];
+    out->temp = (int8_t)v[1];
+    out->system_time = (uint32_t)v[2];
+    out->air_pressure = f[0];
+    for (i = 0; i < 3; i++)
+    {
+        out->acc[i] = f[1 + i];
+        out->gyr[i] = f[4 + i];
+        out->mag[i] = f[7 + i];
+    }
+    out->roll = f[10];
+    out->pitch = f[11];
+    out->yaw = f[12];
+    for (i = 0; i < 4; i++)
+        out->quat[i] = f[13 + i];
+}
+
+/* ====================================================================================
+ *  HI81 字段提取
+ * ==================================================================================== */
+
+static void hi81_to_fields(const hi81_t *in, int32_t *v)
+{
+    const uint8_t *p = (const uint8_t *)in;
+    int i;
+
+    for (i = 0; i < IMU_CODEC_HI81_FIELDS; i++)
+    {
+        const field_desc_t *d = &hi81_fields[i];
+        switch (d->size)
+        {
+        case 1: v[i] = p[d->ofs]; break;
+        case -1: v[i] = (int8_t)p[d->ofs]; break;
+        case 2: { uint16_t u; memcpy(&u, p + d->ofs, 2); v[i] = u; } break;
+        case -2: { int16_t s; memcpy(&s, p + d->ofs, 2); v[i] = s; } break;
+        default: { uint32_t u; memcpy(&u, p + d->ofs, 4); v[i] = (int32_t)u; } break;
+        }
+    }
+}
+
+static void fields_to_hi81(const int32_t *v, hi81_t *out)
+{
+    uint8_t *p = (uint8_t *)out;
+    int i;
+
+    memset(out, 0, sizeof(hi81_t));
+    out->tag = 0x81;
+    for (i = 0; i < IMU_CODEC_HI81_FIELDS; i++)
+    {
+        const field_desc_t *d = &hi81_fields[i];
+        uint32_t u = (uint32_t)v[i];
+        int n = d->size < 0 ? -d->size : d->size;
+        memcpy(p + d->ofs, &u, n); // 小端：截取低位字节
+    }
+}
+
+/* ====================================================================================
+ *  ZigZag + varint
+ * ==================================================================================== */
+
+static int put_varint(uint8_t *out, size_t out_size, size_t pos, int32_t delta)
+{
+    uint32_t z = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+    while (z >= 0x80)
+    {
+        if (pos >= out_size)
+            return -1;
+        out[pos++] = (uint8_t)(z | 0x80);
+        z >>= 7;
+    }
+    if (pos >= out_size)
+        return -1;
+    out[pos++] = (uint8_t)z;
+    return (int)pos;
+}
+
+/* 返回新的位置；0 表示数据不完整；-1 表示 varint 超长（第 5 字节只允许低 4 位） */
+static int get_varint(const uint8_t *buf, size_t len, size_t pos, int32_t *delta)
+{
+    uint32_t z = 0;
+    int shift = 0;
+
+    while (1)
+    {
+        if (pos >= len)
+            return 0;
+        uint8_t b = buf[pos++];
+        if (shift == 28 && b > 0x0F)
+            return -1;
+        z |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+        shift += 7;
+    }
+    *delta = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+    return (int)pos;
+}
+
+/* ====================================================================================
+ *  通用编解码
+ * ==================================================================================== */
+
+static int encode_fields(imu_codec_t *c, imu_codec_chan_t *ch, const int32_t *v, int n,
+                         uint8_t rec_delta, uint8_t rec_key, uint8_t *out, size_t out_size)
+{
+    int key = !ch->valid || ch->since_key >= c->key_interval;
+    int pos, i;
+
+    if (out_size < 1)
+        return -1;
+    out[0] = key ? rec_key : rec_delta;
+    pos = 1;
+
+    for (i = 0; i < n; i++)
+    {
+        int32_t d = key ? v[i] : (int32_t)((uint32_t)v[i] - (uint32_t)ch->prev[i]);
+        pos = put_varint(out, out_size, pos, d);
+        if (pos < 0)
+            return -1;
+    }
+
+    memcpy(ch->prev, v, n * sizeof(int32_t));
+    ch->valid = 1;
+    ch->since_key = key ? 1 : ch->since_key + 1;
+
+    c->records++;
+    if (key)
+        c->keyframes++;
+    c->coded_bytes += pos;
+    return pos;
+}
+
+static int decode_fields(imu_codec_t *c, imu_codec_chan_t *ch, int key, int32_t *v, int n,
+                         const uint8_t *buf, size_t len)
+{
+    int pos = 1, i;
+
+    if (!key && !ch->valid)
+        return -1;
+
+    for (i = 0; i < n; i++)
+    {
+        int32_t d;
+        pos = get_varint(buf, len, pos, &d);
+        if (pos <= 0)
+            return pos;
+        v[i] = key ? d : (int32_t)((uint32_t)ch->prev[i] + (uint32_t)d);
+    }
+
+    memcpy(ch->prev, v, n * sizeof(int32_t));
+    ch->valid = 1;
+    ch->since_key = key ? 1 : ch->since_key + 1;
+
+    c->records++;
+    if (key)
+        c->keyframes++;
+    c->coded_bytes += pos;
+    return pos;
+}
+
+/* ====================================================================================
+ *  对外接口
+ * ==================================================================================== */
+
+void imu_codec_init(imu_codec_t *c, uint32_t key_interval)
+{
+    memset(c, 0, sizeof(imu_codec_t));
+    c->key_interval = key_interval ? key_interval : IMU_CODEC_DEFAULT_KEY_INTERVAL;
+}
+
+void imu_codec_force_key(imu_codec_t *c)
+{
+    c->hi91.valid = 0;
+    c->hi81.valid = 0;
+}
+
+int imu_codec_encode_hi91(imu_codec_t *c, const hi91_t *in, uint8_t *out, size_t out_size)
+{
+    int32_t v[IMU_CODEC_HI91_FIELDS];
+
+    hi91_to_fields(in, v);
+    int ret = encode_fields(c, &c->hi91, v, IMU_CODEC_HI91_FIELDS,
+                            IMU_CODEC_REC_HI91_DELTA, IMU_CODEC_REC_HI91_KEY, out, out_size);
+    if (ret > 0)
+        c->raw_bytes += sizeof(hi91_t);
+    return ret;
+}
+
+int imu_codec_encode_hi81(imu_codec_t *c, const hi81_t *in, uint8_t *out, size_t out_size)
+{
+    int32_t v[IMU_CODEC_HI81_FIELDS];
+
+    hi81_to_fields(in, v);
+    int ret = encode_fields(c, &c->hi81, v, IMU_CODEC_HI81_FIELDS,
+                            IMU_CODEC_REC_HI81_DELTA, IMU_CODEC_REC_HI81_KEY, out, out_size);
+    if (ret > 0)
+        c->raw_bytes += sizeof(hi81_t);
+    return ret;
+}
+
+int imu_codec_decode(imu_codec_t *c, const uint8_t *buf, size_t len, hi91_t *hi91, hi81_t *hi81)
+{
+    int32_t v[IMU_CODEC_HI81_FIELDS];
+    int ret;
+
+    if (len < 1)
+        return 0;
+
+    switch (buf[0])
+    {
+    case IMU_CODEC_REC_HI91_DELTA:
+    case IMU_CODEC_REC_HI91_KEY:
+        ret = decode_fields(c, &c->hi91, buf[0] == IMU_CODEC_REC_HI91_KEY, v, IMU_CODEC_HI91_FIELDS, buf, len);
+        if (ret > 0)
+        {
+            fields_to_hi91(v, hi91);
+            c->raw_bytes += sizeof(hi91_t);
+        }
+        return ret;
+
+    case IMU_CODEC_REC_HI81_DELTA:
+    case IMU_CODEC_REC_HI81_KEY:
+        ret = decode_fields(c, &c->hi81, buf[0] == IMU_CODEC_REC_HI81_KEY, v, IMU_CODEC_HI81_FIELDS, buf, len);
+        if (ret > 0)
+        {
+            fields_to_hi81(v, hi81);
+            c->raw_bytes += sizeof(hi81_t);
+        }
+        return ret;
+
+    default:
+        return -1;
+    }
+}
+
+void imu_codec_quantize_hi91(const hi91_t *in, hi91_t *out)
+{
+    int32_t v[IMU_CODEC_HI91_FIELDS];
+
+    hi91_to_fields(in, v);
+    fields_to_hi91(v, out);
+}
+
+float imu_codec_ratio(const imu_codec_t *c)
+{
+    if (c->coded_bytes == 0)
+        return 0.0f;
+    return (float)c->raw_bytes / (float)c->coded_bytes;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file loop_prof.c
+ * @brief 主循环分段剖析实现
+ * @version 1.0
+ * @date 2026-02-06
+ */
+
+#include "loop_prof.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SUB (1U << PROF_SUB_BITS)
+#define HIST_BAR_WIDTH 30
+
+static uint32_t bucket_of(uint32_t v)
+{
+    uint32_t msb;
+
+    if (v < SUB)
+        return v;
+    msb = 31U - (uint32_t)__builtin_clz(v);
+    return ((msb - PROF_SUB_BITS + 1) << PROF_SUB_BITS) | ((v >> (msb - PROF_SUB_BITS)) & (SUB - 1));
+}
+
+/* 桶的下界与宽度 */
+static void bucket_range(uint32_t idx, uint32_t *low, uint32_t *width)
+{
+    uint32_t shift;
+
+    if (idx < SUB)
+    {
+        *low = idx;
+        *width = 1;
+        return;
+    }
+    shift = (idx >> PROF_SUB_BITS) - 1;
+    *low = (SUB | (idx & (SUB - 1))) << shift;
+    *width = 1U << shift;
+}
+
+void prof_init(prof_t *p, uint32_t ticks_per_us)
+{
+    memset(p, 0, sizeof(prof_t));
+    p->ticks_per_us = ticks_per_us ? ticks_per_us : 1;
+}
+
+int prof_add(prof_t *p, const char *name)
+{
+    if (p->count >= PROF_MAX_PROBES)
+        return -1;
+    p->probes[p->count].name = name;
+    p->probes[p->count].min = UINT32_MAX;
+    return p->count++;
+}
+
+void prof_record(prof_t *p, int id, uint32_t ticks)
+{
+    prof_probe_t *probe;
+
+    if (id < 0 || id >= p->count)
+        return;
+    probe = &p->probes[id];
+    probe->count++;
+    probe->sum += ticks;
+    if (ticks < probe->min)
+        probe->min = ticks;
+    if (ticks > probe->max)
+        probe->max = ticks;
+    probe->hist[bucket_of(ticks)]++;
+}
+
+uint32_t prof_percentile(const prof_probe_t *probe, uint32_t permille)
+{
+    uint64_t target;
+    uint64_t acc = 0;
+    uint32_t i;
+
+    if (probe->count == 0)
+        return 0;
+    target = ((uint64_t)probe->count * permille + 999) / 1000;
+    if (target == 0)
+        target = 1;
+
+    for (i = 0; i < PROF_BUCKETS; i++)
+    {
+        acc += probe->hist[i];
+        if (acc >= target)
+        {
+            uint32_t low, width, mid;
+            bucket_range(i, &low, &width);
+            mid = low + width / 2;
+            if (mid < probe->min)
+                mid = probe->min;
+            if (mid > probe->max)
+                mid = probe->max;
+            return mid;
+        }
+    }
+    return probe->max;
+}
+
+void prof_reset(prof_t *p)
+{
+    uint8_t i;
+
+    for (i = 0; i < p->count; i++)
+    {
+        const char *name = p->probes[i].name;
+        memset(&p->probes[i], 0, sizeof(prof_probe_t));
+        p->probes[i].name = name;
+        p->probes[i].min = UINT32_MAX;
+    }
+}
+
+int prof_format(const prof_t *p, char *buf, size_t buf_size)
+{
+    double k = 1.0 / p->ticks_per_us;
+    size_t written = 0;
+    int ret;
+    uint8_t i;
+
+    if (buf_size == 0)
+        return 0;
+
+    ret = snprintf(buf, buf_size, "  %-12s %8s %9s %9s %9s %9s  (us)\n", "probe", "n", "min", "avg", "p99", "max");
+    written += ret > 0 ? (size_t)ret : 0;
+
+    for (i = 0; i < p->count && written < buf_size; i++)
+    {
+        const prof_probe_t *probe = &p->probes[i];
+
+        if (probe->count == 0)
+        {
+            ret = snprintf(buf + written, buf_size - written, "  %-12s %8u %9s %9s %9s %9s\n",
+                           probe->name, 0U, "-", "-", "-", "-");
+        }
+        else
+        {
+            ret = snprintf(buf + written, buf_size - written, "  %-12s %8lu %9.2f %9.2f %9.2f %9.2f\n",
+                           probe->name, (unsigned long)probe->count,
+                           probe->min * k, (double)probe->sum / probe->count * k,
+                           prof_percentile(probe, 990) * k, probe->max * k);
+        }
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
+
+int prof_format_hist(const prof_t *p, int id, char *buf, size_t buf_size)
+{
+    const prof_probe_t *probe;
+    uint32_t octave[33];
+    uint32_t peak = 1;
+    size_t written = 0;
+    int ret;
+    uint32_t i;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+    if (id < 0 || id >= p->count)
+        return 0;
+    probe = &p->probes[id];
+
+    // 合并到 2 的幂区间：octave[0] 为 0 周期，octave[n] 为 [2^(n-1), 2^n)
+    memset(octave, 0, sizeof(octave));
+    for (i = 0; i < PROF_BUCKETS; i++)
+    {
+        uint32_t low, width, o;
+        if (probe->hist[i] == 0)
+            continue;
+        bucket_range(i, &low, &width);
+        o = low ? 32U - (uint32_t)__builtin_clz(low) : 0;
+        octave[o] += probe->hist[i];
+    }
+    for (i = 0; i < 33; i++)
+    {
+        if (octave[i] > peak)
+            peak = octave[i];
+    }
+
+    ret = snprintf(buf, buf_size, "  [%s] n=%lu\n", probe->name, (unsigned long)probe->count);
+    written += ret > 0 ? (size_t)ret : 0;
+
+    for (i = 0; i < 33 && written < buf_size; i++)
+    {
+        char bar[HIST_BAR_WIDTH + 1];
+        uint32_t len;
+        double lo = i ? (double)(1ULL << (i - 1)) / p->ticks_per_us : 0.0;
+        double hi = (double)(1ULL << i) / p->ticks_per_us;
+
+        if (octave[i] == 0)
+            continue;
+        len = (uint32_t)((uint64_t)octave[i] * HIST_BAR_WIDTH / peak);
+        if (len == 0)
+            len = 1;
+        memset(bar, '#', len);
+        bar[len] = '\0';
+        ret = snprintf(buf + written, buf_size - written, "  %10.2f-%-10.2f %8lu %s\n",
+                       lo, hi, (unsigned long)octave[i], bar);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
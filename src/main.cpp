@@ -9,35 +9,190 @@
  * - LCD屏幕使用SPI和对应的控制引脚（GPIO18/23/5/13/4）
  * - RGB LED -> GPIO 15 (WS2812B)
  * - 蜂鸣器 -> GPIO 12
+ * - 波轮按键 -> GPIO 38/36/37，外部按键 -> GPIO 35/34（边沿中断）
  */
 
 #include <Arduino.h>
-#include <FastLED.h>
+#include <driver/rmt.h>
+#include <driver/uart.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_partition.h>
 #include <TFT_eSPI.h>
 #include <Adafruit_DPS310.h>
+#include <SdFat.h>
+#include <esp32/rom/crc.h>
 #include "hipnuc_dec.h"
+#include "hipnuc_sync.h"
+#include "button_input.h"
+#include "status_led.h"
+#include "buzzer_seq.h"
+#include "boot_seq.h"
+#include "loop_prof.h"
+#include "rate_est.h"
+#include "rx_meter.h"
+#include "run_stats.h"
+#include "blackbox.h"
+#include "crash_journal.h"
+#include "flash_log.h"
+#include "microbench.h"
+#include "hipnuc_synth.h"
+#include "ahrs.h"
+#include "vec_math.h"
 #include "pin_config.h"
 
 // ==================== 配置常量 ====================
 #define NUM_LEDS 1             // WS2812B LED数量
+#define LED_RMT_CHANNEL RMT_CHANNEL_0
+#define LED_REFRESH_US 20000   // LED 图案刷新周期（50Hz）
 #define DISPLAY_INTERVAL 10    // 10Hz显示频率
 #define LCD_UPDATE_INTERVAL 50 // LCD 20Hz刷新率
 
+// IMU 接收方式：1 = UART 事件任务（空闲超时/FIFO 阈值唤醒后批量读取），0 = loop() 轮询 Serial2（对比用）
+#define IMU_EVENT_DRIVEN 1
+#define IMU_UART_NUM UART_NUM_2
+#define IMU_RX_BUF_SIZE 2048       // 驱动环形缓冲
+#define IMU_RX_TIMEOUT_SYMBOLS 3   // 线路空闲 3 个字符时间即唤醒（一帧发完）
+#define IMU_RX_FULL_THRESHOLD 100  // 硬件 FIFO（128 字节）积累到 100 字节时提前唤醒
+
+// 板载姿态解算：HI83 含 ACC_B | GYR_B（可选 MAG_B）时每帧融合一次，串口命令 a 切换算法
+#define AHRS_DEFAULT_ALGO AHRS_MAHONY
+#define AHRS_MAX_DT_US 100000 // 两帧间隔超过 100ms 时重新对准
+
+// 通道统计：滑动窗口 = 块数 × 每块样本数（按各通道自身的采样频率），串口命令 v 查看、z 清零
+#define STATS_IMU_BLOCK 100 // IMU 每块样本数
+#define STATS_IMU_BLOCKS 10
+#define STATS_DPS_BLOCK 10 // DPS310 每块样本数（100ms 采样，每块 1 秒）
+#define STATS_DPS_BLOCKS 10
+
+// 黑匣子：RAM 中保留最近几秒的 IMU / DPS310 记录；高 g、命令 x、外部按键 1 长按或 IMU 中断时冻结，后台导出到 SD 卡
+#define BLACKBOX_BYTES 32768 // 400Hz IMU 约 3.4 秒
+#define BLACKBOX_PRE_MS 2000 // 保留触发前的时长
+#define BLACKBOX_POST_MS 1000 // 触发后继续记录的时长
+#define BLACKBOX_HIGH_G 4.0f  // |acc| 阈值（G）
+#define BLACKBOX_HIGH_G_SAMPLES 2
+#define BLACKBOX_CHUNK 512 // 每次从缓冲取出并写入 SD / Flash 的最大字节数
+#define FLASHLOG_PARTITION "datalog" // partitions.csv 中的数据分区
+#define FLASHLOG_SUBTYPE 0x40
+#define FLASHLOG_REC_BB_HDR 1  // 黑匣子快照文件头（16 字节）
+#define FLASHLOG_REC_BB_DATA 2 // 黑匣子快照数据块
+// 待命时预擦除的扇区数：足够写下一个快照（每扇区按最坏情况少放一块），写入快照期间不再擦除
+#define FLASHLOG_RESERVE_SECTORS                                                                                       \
+    ((BLACKBOX_BYTES + BLACKBOX_FILE_HDR_SIZE) /                                                                       \
+         (FLASH_LOG_SECTOR - FLASH_LOG_SECTOR_HDR - FLASH_LOG_REC_HDR - BLACKBOX_CHUNK) +                              \
+     2)
+
+// 崩溃日志：RTC 内存中每 100ms 一条记录，复位后启动时导出
+#define JOURNAL_PERIOD_MS 100
+
+// 微基准（命令 m）
+#define BENCH_WARMUP 3 // 每项预热批数
+#define BENCH_REPS 21  // 每项计时批数（奇数，中位数取中间一批）
+#define BENCH_CRC_BYTES 256
+#define BENCH_SD_BYTES 4096
+#define BENCH_SD_FILE "bench.dat"
+
 // ==================== 全局变量 ====================
 TFT_eSPI tft = TFT_eSPI(); // TFT屏幕实例
 Adafruit_DPS310 dps;       // DPS310传感器实例
-CRGB leds[NUM_LEDS];
-hipnuc_raw_t hipnuc_raw;
+status_led_t statusLed;    // 状态LED（RMT异步发送，不关中断）
+buzzer_seq_t buzzer;       // 蜂鸣器音序器（LEDC + 定时器，不阻塞）
+hipnuc_raw_t hipnuc_raw; // 主循环显示用的最新帧（由 imuFetch() 更新）
+hipnuc_sync_t imuSync;   // 校验失败后在缓存字节中重新找帧头
+
+// IMU 接收上下文（事件任务或 loop 轮询）解码，按帧发布给主循环
+struct ImuLatest
+{
+    hi91_t hi91;
+    hi81_t hi81;
+    hi83_t hi83;
+    int len;
+    float ahrsQuat[4]; // 板载 AHRS 最新姿态
+    bool ahrsValid;
+    uint32_t seq;      // 已发布帧数
+    uint32_t t_us;     // 最新帧解码时刻
+    uint32_t first_us; // 首帧解码时刻
+};
+
+hipnuc_raw_t imuRx;
+ImuLatest imuLatest;
+uint32_t imuFetchedSeq = 0;
+uint32_t imuFifoOverflows = 0; // 硬件 FIFO 溢出次数（中断未及时搬运，如 Cache 关闭期间），丢失的字节无法恢复
+uint32_t imuBufOverflows = 0;  // 驱动缓冲满次数（接收任务未及时读取）
+rx_meter_t imuMeter;       // 接收路径 CPU 占用与交付延迟
+QueueHandle_t imuUartQueue = NULL;
+portMUX_TYPE imuMux = portMUX_INITIALIZER_UNLOCKED; // 接收任务与主循环共享 imuLatest / rates / imuMeter / ahrsStats / stats
+
+// 板载 AHRS（只在接收上下文中更新）
+ahrs_t ahrs;
+uint32_t ahrsLastUs = 0;
+volatile int8_t ahrsSwitchTo = -1; // 主循环请求切换算法，由接收上下文执行
+struct AhrsStats
+{
+    uint32_t updates;
+    uint64_t cycles;
+    uint32_t cyclesMax;
+} ahrsStats;
+float ahrsQuat[4] = {1, 0, 0, 0}; // 主循环副本（由 imuFetch() 更新）
+bool ahrsValid = false;
 
 // DPS310数据
 float dps_temp = 0.0;     // 温度(°C)
 float dps_pressure = 0.0; // 气压(Pa)
 float dps_altitude = 0.0; // 高度(m)
 
-// 数据统计
+// 数据统计：每个数据源单独估计频率/抖动/间断
+enum RateSource
+{
+    RATE_IMU = 0, // IMU 链路（所有帧 + CRC 错误）
+    RATE_HI91,
+    RATE_HI81,
+    RATE_HI83,
+    RATE_DPS310,
+    RATE_COUNT
+};
+
+const char *const rateNames[RATE_COUNT] = {"imu", "hi91", "hi81", "hi83", "dps310"};
+rate_est_t rates[RATE_COUNT];
+
+// 传感器通道流式统计（均值 / 标准差 / 最小 / 最大，累计 + 滑动窗口）
+enum StatsChannel
+{
+    STAT_PRESSURE = 0,
+    STAT_TEMP,
+    STAT_GYR_X, // HI91 gyr 或 HI83 gyr_b
+    STAT_GYR_Y,
+    STAT_GYR_Z,
+    STAT_ACC_X, // HI91 acc 或 HI83 acc_b
+    STAT_ACC_Y,
+    STAT_ACC_Z,
+    STAT_COUNT
+};
+
+const char *const statNames[STAT_COUNT] = {"pressure", "temp", "gyr_x", "gyr_y", "gyr_z", "acc_x", "acc_y", "acc_z"};
+const char *const statUnits[STAT_COUNT] = {"Pa", "°C", "°/s", "°/s", "°/s", "G", "G", "G"};
+run_stats_t stats[STAT_COUNT];
 unsigned long lastSecond = 0;
-unsigned long frameCount = 0;
-float currentFPS = 0;
+
+// 黑匣子：接收任务与主循环写入，导出任务读出，均在 bbMux 内访问
+uint8_t blackboxBuf[BLACKBOX_BYTES];
+blackbox_t blackbox;
+blackbox_highg_t blackboxHighG; // 只在接收上下文中使用
+portMUX_TYPE bbMux = portMUX_INITIALIZER_UNLOCKED;
+uint16_t blackboxFileSeq = 0;
+
+// SD 卡与 LCD 共用 SPI 总线：导出任务与 LCD 刷新各自持锁访问
+SdFat sd;
+bool sdReady = false;
+SemaphoreHandle_t spiBusLock = NULL;
+
+// Flash 环形日志：无 SD 卡时黑匣子快照写入 datalog 分区；导出任务写入、串口命令读出，持 flashLogLock 访问
+const esp_partition_t *flashPart = NULL;
+spi_flash_mmap_handle_t flashMapHandle;
+flash_log_t flashLog;
+bool flashLogReady = false;
+uint32_t flashLogOpenUs = 0;
+SemaphoreHandle_t flashLogLock = NULL;
 
 // 显示控制
 unsigned long lastDisplay = 0;
@@ -48,49 +203,630 @@ const int DPS_READ_INTERVAL = 100; // DPS310采样100ms间隔
 // 数据缓冲区（用于格式化输出）
 char displayBuffer[512];
 
+// 主循环分段剖析（platformio.ini 中 PROF_ENABLE=0 可移除全部探针）；阶段 id 同时用于崩溃日志
+enum ProfProbe
+{
+    PROF_LOOP = 0,
+    PROF_IMU_DECODE,
+    PROF_DPS_READ,
+    PROF_LCD_UPDATE,
+    PROF_SERIAL_OUT,
+    PROF_BUTTONS,
+    PROF_COMMAND,
+    PROF_COUNT
+};
+
+const char *const stageNames[CRASH_JOURNAL_STAGES] = {
+    "loop", "imu_decode", "dps_read", "lcd_update", "serial_out", "buttons", "command"};
+
+prof_t prof;
+unsigned long profWindowStart = 0;
+char profText[1024];
+
+// 崩溃日志：RTC 慢速内存，软件复位 / 看门狗 / panic 后保留（上电时内容随机，由 crash_journal_open() 识别）
+RTC_NOINIT_ATTR crash_journal_t journal;
+const char *const journalValueNames[CRASH_JOURNAL_VALUES] = {"Pa", "°C", "G", "°/s"};
+unsigned long lastJournal = 0;
+uint32_t journalFrameSeq = 0;   // 上一条记录时的 imuLatest.seq
+uint32_t journalCommitMax = 0;  // 提交一条记录的最长周期数
+
+// 按键输入（中断记录边沿，主循环识别手势）
+enum ButtonLine
+{
+    LINE_ROTARY_1 = 0,
+    LINE_ROTARY_2,
+    LINE_ROTARY_SWITCH,
+    LINE_EXT_1,
+    LINE_EXT_2
+};
+
+struct ButtonPin
+{
+    uint8_t pin;
+    uint8_t line;
+};
+
+// 非 const：中断中访问，需位于 DRAM
+ButtonPin buttonPins[] = {
+    {ROTARY_BTN_1_PIN, LINE_ROTARY_1},
+    {ROTARY_BTN_2_PIN, LINE_ROTARY_2},
+    {ROTARY_SWITCH_PIN, LINE_ROTARY_SWITCH},
+    {EXT_BTN_1_PIN, LINE_EXT_1},
+    {EXT_BTN_2_PIN, LINE_EXT_2},
+};
+
+btn_ring_t btnRing;
+btn_engine_t btnEngine;
+uint8_t ledBrightness = LED_BRIGHTNESS;
+
+// ==================== 阶段计时 ====================
+/**
+ * @brief 结束一个主循环阶段：记入分段剖析和崩溃日志
+ * @note PROF_ENABLE=0 时仍读取 CCOUNT，崩溃日志需要各阶段耗时
+ */
+void stageLeave(int id, uint32_t t0)
+{
+    uint32_t ticks = prof_ticks() - t0;
+#if PROF_ENABLE
+    prof_record(&prof, id, ticks);
+#endif
+    crash_journal_leave(&journal, id, ticks);
+}
+
+/**
+ * @brief 作用域阶段：进入时更新崩溃日志的阶段标记，离开时记录耗时
+ */
+struct StageScope
+{
+    int id;
+    uint32_t t0;
+
+    StageScope(int stage) : id(stage), t0(prof_ticks()) { crash_journal_enter(&journal, stage); }
+    ~StageScope() { stageLeave(id, t0); }
+};
+
 // ==================== LED状态指示 ====================
+// WS2812 时序（RMT 时钟 80MHz / 2 = 40MHz，25ns/tick）
+#define WS2812_T0H 16 // 0.40μs
+#define WS2812_T0L 34 // 0.85μs
+#define WS2812_T1H 32 // 0.80μs
+#define WS2812_T1L 18 // 0.45μs
+
+portMUX_TYPE ledMux = portMUX_INITIALIZER_UNLOCKED; // 主循环与定时器任务共享 statusLed
+esp_timer_handle_t ledTimer;
+rmt_item32_t ledItems[24 * NUM_LEDS];
+
+/**
+ * @brief 通过 RMT 异步发送一帧（GRB 顺序），不等待发送完成
+ * @return false 上一帧仍在发送
+ */
+bool ledRmtWrite(uint32_t rgb)
+{
+    if (rmt_wait_tx_done(LED_RMT_CHANNEL, 0) != ESP_OK)
+        return false;
+
+    uint32_t grb = (((rgb >> 8) & 0xFF) << 16) | (((rgb >> 16) & 0xFF) << 8) | (rgb & 0xFF);
+    for (int i = 0; i < 24; i++)
+    {
+        bool one = grb & (1u << (23 - i));
+        ledItems[i].level0 = 1;
+        ledItems[i].duration0 = one ? WS2812_T1H : WS2812_T0H;
+        ledItems[i].level1 = 0;
+        ledItems[i].duration1 = one ? WS2812_T1L : WS2812_T0L;
+    }
+    return rmt_write_items(LED_RMT_CHANNEL, ledItems, 24 * NUM_LEDS, false) == ESP_OK;
+}
+
+/**
+ * @brief 50Hz 定时器回调（esp_timer 任务中运行）：计算图案颜色，变化时才发送
+ */
+void ledTimerCallback(void *arg)
+{
+    uint32_t rgb;
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&ledMux);
+    int changed = status_led_update(&statusLed, now, &rgb);
+    portEXIT_CRITICAL(&ledMux);
+    if (!changed)
+        return;
+
+    bool ok = ledRmtWrite(rgb);
+
+    portENTER_CRITICAL(&ledMux);
+    if (ok)
+        status_led_commit(&statusLed, rgb);
+    else
+        status_led_busy(&statusLed);
+    portEXIT_CRITICAL(&ledMux);
+}
+
+void initStatusLED()
+{
+    rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX((gpio_num_t)WS2812B_PIN, LED_RMT_CHANNEL);
+    cfg.clk_div = 2;
+    rmt_config(&cfg);
+    rmt_driver_install(cfg.channel, 0, 0);
+
+    status_led_init(&statusLed, ledBrightness);
+
+    esp_timer_create_args_t args = {};
+    args.callback = ledTimerCallback;
+    args.name = "status_led";
+    esp_timer_create(&args, &ledTimer);
+    esp_timer_start_periodic(ledTimer, LED_REFRESH_US);
+}
+
+/**
+ * @brief 设置状态（可高频调用：状态不变时不产生任何刷新）
+ */
 void setLEDStatus(uint8_t status)
 {
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&ledMux);
     switch (status)
     {
     case 0:
-        leds[0] = CRGB::Orange;
-        break; // 初始化
+        status_led_set(&statusLed, 0xFFA500, now);
+        break; // 初始化（橙色）
     case 1:
-        leds[0] = CRGB::Blue;
-        break; // 等待数据
+        status_led_fade(&statusLed, 0x0000FF, 2000, now);
+        break; // 等待数据（蓝色呼吸）
     case 2:
-        leds[0] = CRGB::Green;
-        break; // 接收IMU数据
+        status_led_set(&statusLed, 0x008000, now);
+        break; // 接收IMU数据（绿色）
     case 3:
-        leds[0] = CRGB::Cyan;
-        break; // 接收INS数据
+        status_led_set(&statusLed, 0x00FFFF, now);
+        break; // 接收INS数据（青色）
     case 4:
-        leds[0] = CRGB::Red;
-        break; // 错误/无数据
+        status_led_blink(&statusLed, 0xFF0000, 200, 200, now);
+        break; // 错误/无数据（红色闪烁）
     default:
-        leds[0] = CRGB::Purple;
+        status_led_set(&statusLed, 0x800080, now);
         break;
     }
-    FastLED.show();
+    portEXIT_CRITICAL(&ledMux);
 }
 
 // ==================== 蜂鸣器功能 ====================
+// 启动：3 声倒计时 + 上行三音，与初始化并行播放
+const buzzer_note_t NOTES_STARTUP[] = {
+    {1400, 300}, {BUZZER_REST, 700},
+    {1200, 300}, {BUZZER_REST, 700},
+    {1000, 300}, {BUZZER_REST, 700},
+    {1000, 80}, {BUZZER_REST, 40},
+    {1200, 80}, {BUZZER_REST, 40},
+    {1500, 80}, {BUZZER_REST, 40}};
+const buzzer_melody_t MELODY_STARTUP = {NOTES_STARTUP, 12, BUZZER_PRIO_STATUS, 0, 1};
+
+const buzzer_note_t NOTES_BEEP[] = {{2000, 20}};
+const buzzer_melody_t MELODY_BEEP = {NOTES_BEEP, 1, BUZZER_PRIO_CHIRP, 0, 1};
+
+const buzzer_note_t NOTES_CLICK[] = {{2500, 10}};
+const buzzer_melody_t MELODY_CLICK = {NOTES_CLICK, 1, BUZZER_PRIO_CHIRP, 0, 1};
+
+// 数据中断报警：高低音交替 3 次，可打断启动音
+const buzzer_note_t NOTES_ALARM[] = {{1000, 200}, {800, 200}};
+const buzzer_melody_t MELODY_ALARM = {NOTES_ALARM, 2, BUZZER_PRIO_ALARM, 0, 3};
+
+portMUX_TYPE buzzerMux = portMUX_INITIALIZER_UNLOCKED; // 主循环与定时器任务共享 buzzer
+esp_timer_handle_t buzzerTimer;
+bool buzzerRestart = false;      // buzzerPlay 换了旋律、尚未被回调处理（buzzerMux 保护）
+volatile uint32_t buzzerTimerErrors = 0;
+
+/**
+ * @brief 单次定时器回调：推进音序器，在下一个音符边界重新调度自身
+ * @note 所有 LEDC 写操作都在 esp_timer 任务中按顺序执行
+ */
+void buzzerTimerCallback(void *arg)
+{
+    uint16_t freq;
+    uint32_t wait;
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&buzzerMux);
+    buzzerRestart = false; // 本次推进已包含最新的旋律
+    int changed = buzzer_seq_update(&buzzer, now, &freq, &wait);
+    portEXIT_CRITICAL(&buzzerMux);
+
+    if (changed)
+        ledcWriteTone(BUZZER_PWM_CHANNEL, freq);
+    if (!wait)
+        return;
+
+    // 推进之后 buzzerPlay 又换了旋律：由 buzzerPlay 立即重新装载，这里按旧旋律算出的间隔作废
+    portENTER_CRITICAL(&buzzerMux);
+    bool restart = buzzerRestart;
+    portEXIT_CRITICAL(&buzzerMux);
+    if (restart)
+        return;
+
+    // ESP_ERR_INVALID_STATE：buzzerPlay 已抢先装载，下一次回调会处理新旋律
+    esp_err_t err = esp_timer_start_once(buzzerTimer, wait * 1000ULL);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+        buzzerTimerErrors++;
+}
+
+void initBuzzer()
+{
+    ledcSetup(BUZZER_PWM_CHANNEL, 2000, BUZZER_PWM_RESOLUTION);
+    ledcAttachPin(BUZZER_PIN, BUZZER_PWM_CHANNEL);
+    ledcWrite(BUZZER_PWM_CHANNEL, 0);
+
+    buzzer_seq_init(&buzzer);
+
+    esp_timer_create_args_t args = {};
+    args.callback = buzzerTimerCallback;
+    args.name = "buzzer";
+    if (esp_timer_create(&args, &buzzerTimer) != ESP_OK)
+    {
+        buzzerTimer = NULL;
+        Serial.println("[BUZZER] 定时器创建失败，蜂鸣器不可用");
+    }
+}
+
+/**
+ * @brief 播放旋律（立即返回）
+ * @return false 正在播放更高优先级的旋律
+ */
+bool buzzerPlay(const buzzer_melody_t *melody)
+{
+    if (buzzerTimer == NULL)
+        return false;
+
+    portENTER_CRITICAL(&buzzerMux);
+    int ok = buzzer_seq_play(&buzzer, melody, millis());
+    if (ok)
+        buzzerRestart = true;
+    portEXIT_CRITICAL(&buzzerMux);
+    if (!ok)
+        return false;
+
+    // 立即切换到新旋律的第一个音符。回调可能正在另一核上运行并重新装载定时器：
+    // stop 在定时器未运行时返回 ESP_ERR_INVALID_STATE（可忽略）；
+    // start 返回 ESP_ERR_INVALID_STATE 说明回调在 stop 之后抢先装载了按旧旋律计算的间隔，停止后重试
+    esp_err_t err = ESP_OK;
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        esp_timer_stop(buzzerTimer);
+        err = esp_timer_start_once(buzzerTimer, 1);
+        if (err != ESP_ERR_INVALID_STATE)
+            break;
+    }
+    if (err != ESP_OK)
+        buzzerTimerErrors++;
+    return true;
+}
+
 void playStartupSound()
 {
-    int melody[] = {1000, 1200, 1500};
+    buzzerPlay(&MELODY_STARTUP);
+}
+
+void playDataReceivedBeep()
+{
+    buzzerPlay(&MELODY_BEEP); // 短促的嘀声
+}
+
+void playClickSound()
+{
+    buzzerPlay(&MELODY_CLICK);
+}
+
+// ==================== IMU 接收 ====================
+/**
+ * @brief 帧内 IMU 时间戳（us），用于估计交付延迟；HI83 为 us，HI91/HI81 为 ms
+ */
+bool imuSourceTimeUs(const hipnuc_raw_t *raw, uint32_t *us)
+{
+    if (raw->hi83.tag == 0x83 && (raw->hi83.data_bitmap & HI83_BMAP_SYSTEM_TIME))
+        *us = (uint32_t)raw->hi83.system_time_us;
+    else if (raw->hi91.tag == 0x91)
+        *us = raw->hi91.system_time * 1000u;
+    else if (raw->hi81.tag == 0x81)
+        *us = raw->hi81.gpst_tow * 1000u;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief HI83 含原始 acc / gyr 时融合一步；dt 取 IMU 时间戳（未输出 SYSTEM_TIME 时取解码时刻）
+ * @return 本次更新的 CPU 周期数，未更新返回 0
+ */
+uint32_t ahrsStep(const hipnuc_raw_t *raw, uint32_t rxUs)
+{
+    const uint32_t need = HI83_BMAP_ACC_B | HI83_BMAP_GYR_B;
+    const hi83_t *h = &raw->hi83;
+
+    if (ahrsSwitchTo >= 0)
+    {
+        ahrs_init(&ahrs, (ahrs_algo_t)ahrsSwitchTo);
+        ahrsSwitchTo = -1;
+    }
+    if (h->tag != 0x83 || (h->data_bitmap & need) != need)
+        return 0;
+
+    // hi83_t 为紧凑结构，复制到对齐的数组
+    float gyr[3], acc[3], mag[3];
+    bool hasMag = h->data_bitmap & HI83_BMAP_MAG_B;
+    memcpy(gyr, h->gyr_b, sizeof(gyr));
+    memcpy(acc, h->acc_b, sizeof(acc));
+    if (hasMag)
+        memcpy(mag, h->mag_b, sizeof(mag));
+
+    uint32_t t = (h->data_bitmap & HI83_BMAP_SYSTEM_TIME) ? (uint32_t)h->system_time_us : rxUs;
+    uint32_t dtUs = t - ahrsLastUs;
+    ahrsLastUs = t;
+    if (ahrs.updates == 0 || dtUs > AHRS_MAX_DT_US)
+    {
+        ahrs.aligned = 0; // 首帧或长时间中断：按当前加速度/磁场对准，本帧不积分
+        dtUs = 0;
+    }
+
+    uint32_t t0 = prof_ticks();
+    ahrs_update(&ahrs, gyr, acc, hasMag ? mag : NULL, dtUs * 1e-6f);
+    return prof_ticks() - t0;
+}
+
+/**
+ * @brief 取本帧的加速度（G）和角速度（°/s）：HI91，或含 GYR_B | ACC_B 的 HI83
+ */
+bool imuAccGyr(const hipnuc_raw_t *raw, float acc[3], float gyr[3])
+{
+    const uint32_t need = HI83_BMAP_ACC_B | HI83_BMAP_GYR_B;
+
+    // 紧凑结构，复制到对齐的数组
+    if (raw->hi91.tag == 0x91)
+    {
+        memcpy(gyr, raw->hi91.gyr, 3 * sizeof(float));
+        memcpy(acc, raw->hi91.acc, 3 * sizeof(float));
+        return true;
+    }
+    if (raw->hi83.tag == 0x83 && (raw->hi83.data_bitmap & need) == need)
+    {
+        memcpy(gyr, raw->hi83.gyr_b, 3 * sizeof(float));
+        memcpy(acc, raw->hi83.acc_b, 3 * sizeof(float));
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 陀螺 / 加速度各轴计入通道统计（调用者持有 imuMux）
+ */
+void statsImuSample(const hipnuc_raw_t *raw)
+{
+    float gyr[3], acc[3];
+
+    if (!imuAccGyr(raw, acc, gyr))
+        return;
     for (int i = 0; i < 3; i++)
     {
-        tone(BUZZER_PIN, melody[i]);
-        delay(80);
-        noTone(BUZZER_PIN);
-        delay(40);
+        run_stats_add(&stats[STAT_GYR_X + i], gyr[i]);
+        run_stats_add(&stats[STAT_ACC_X + i], acc[i]);
     }
 }
 
-void playDataReceivedBeep()
+/**
+ * @brief 本帧写入黑匣子并做高 g 检测；姿态取 IMU 输出的 RPY，没有时取板载 AHRS
+ */
+void blackboxImuSample(const hipnuc_raw_t *raw, uint32_t t)
+{
+    float acc[3], gyr[3], rpy[3];
+    bool hasRpy = true;
+
+    if (!imuAccGyr(raw, acc, gyr))
+        return;
+    if (raw->hi91.tag == 0x91)
+    {
+        rpy[0] = raw->hi91.roll;
+        rpy[1] = raw->hi91.pitch;
+        rpy[2] = raw->hi91.yaw;
+    }
+    else if (raw->hi83.data_bitmap & HI83_BMAP_RPY)
+        memcpy(rpy, raw->hi83.rpy, sizeof(rpy));
+    else if (ahrs.aligned)
+        ahrs_quat_to_euler(ahrs.q, rpy);
+    else
+        hasRpy = false;
+
+    bool hit = blackbox_highg_update(&blackboxHighG, acc, t);
+    portENTER_CRITICAL(&bbMux);
+    blackbox_put_imu(&blackbox, t, acc, gyr, hasRpy ? rpy : NULL);
+    if (hit)
+        blackbox_trigger(&blackbox, BB_TRIG_HIGH_G, t);
+    portEXIT_CRITICAL(&bbMux);
+}
+
+/**
+ * @brief 解码一批字节，每解出一帧就发布到 imuLatest 并更新统计
+ */
+void imuDecode(const uint8_t *data, int n)
+{
+    uint32_t crcErrors = imuSync.stats.crc_errors;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (hipnuc_sync_input(&imuSync, &imuRx, data[i]) <= 0)
+            continue;
+
+        uint32_t t = micros();
+        uint16_t bytes = imuRx.len + HIPNUC_SYNC_HDR_SIZE;
+        uint32_t src;
+        bool hasSrc = imuSourceTimeUs(&imuRx, &src);
+        uint32_t ahrsCycles = ahrsStep(&imuRx, t);
+        blackboxImuSample(&imuRx, t);
+
+        portENTER_CRITICAL(&imuMux);
+        imuLatest.hi91 = imuRx.hi91;
+        imuLatest.hi81 = imuRx.hi81;
+        imuLatest.hi83 = imuRx.hi83;
+        imuLatest.len = imuRx.len;
+        imuLatest.t_us = t;
+        if (ahrsCycles)
+        {
+            memcpy(imuLatest.ahrsQuat, ahrs.q, sizeof(ahrs.q));
+            imuLatest.ahrsValid = true;
+            ahrsStats.updates++;
+            ahrsStats.cycles += ahrsCycles;
+            if (ahrsCycles > ahrsStats.cyclesMax)
+                ahrsStats.cyclesMax = ahrsCycles;
+        }
+        if (imuLatest.seq++ == 0)
+            imuLatest.first_us = t;
+        rate_est_sample(&rates[RATE_IMU], t, bytes);
+        if (imuRx.hi91.tag == 0x91)
+            rate_est_sample(&rates[RATE_HI91], t, bytes);
+        if (imuRx.hi81.tag == 0x81)
+            rate_est_sample(&rates[RATE_HI81], t, bytes);
+        if (imuRx.hi83.tag == 0x83)
+            rate_est_sample(&rates[RATE_HI83], t, bytes);
+        statsImuSample(&imuRx);
+        if (hasSrc)
+            rx_meter_frame(&imuMeter, t, src);
+        portEXIT_CRITICAL(&imuMux);
+    }
+
+    if (imuSync.stats.crc_errors != crcErrors)
+    {
+        portENTER_CRITICAL(&imuMux);
+        rate_est_error(&rates[RATE_IMU], imuSync.stats.crc_errors - crcErrors);
+        portEXIT_CRITICAL(&imuMux);
+    }
+}
+
+void imuAccount(uint32_t t0, uint32_t bytes)
+{
+    uint32_t ticks = prof_ticks() - t0;
+    portENTER_CRITICAL(&imuMux);
+    rx_meter_busy(&imuMeter, ticks, bytes);
+    portEXIT_CRITICAL(&imuMux);
+}
+
+#if IMU_EVENT_DRIVEN
+/**
+ * @brief IMU 接收任务：阻塞等待 UART 事件，唤醒后一次读完驱动缓冲中的全部字节
+ * @note ESP32 的 UART 模式检测只能匹配连续重复的同一字符（如 "+++"），无法匹配 5A A5，
+ *       这里用 RX 空闲超时（帧尾）和 FIFO 阈值唤醒；帧边界由 hipnuc_sync 负责
+ */
+void imuRxTask(void *arg)
+{
+    uart_event_t ev;
+    uint8_t chunk[256];
+
+    for (;;)
+    {
+        if (xQueueReceive(imuUartQueue, &ev, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        uint32_t t0 = prof_ticks();
+        uint32_t total = 0;
+        if (ev.type == UART_FIFO_OVF || ev.type == UART_BUFFER_FULL)
+        {
+            // 溢出：丢弃积压数据，分帧器自行重新同步；两种原因分别计数，串口命令 s 查看
+            uart_flush_input(IMU_UART_NUM);
+            xQueueReset(imuUartQueue);
+            if (ev.type == UART_FIFO_OVF)
+                imuFifoOverflows++;
+            else
+                imuBufOverflows++;
+        }
+        else if (ev.type == UART_DATA)
+        {
+            size_t avail = 0;
+            uart_get_buffered_data_len(IMU_UART_NUM, &avail);
+            while (avail > 0)
+            {
+                int n = uart_read_bytes(IMU_UART_NUM, chunk, min(avail, sizeof(chunk)), 0);
+                if (n <= 0)
+                    break;
+                imuDecode(chunk, n);
+                total += n;
+                avail -= n;
+            }
+        }
+        imuAccount(t0, total);
+    }
+}
+#else
+/**
+ * @brief loop() 中轮询 Serial2（原接收方式，保留用于对比）
+ */
+void imuPoll()
+{
+    uint32_t t0 = prof_ticks();
+    uint32_t total = 0;
+    uint8_t chunk[128];
+    int n;
+
+    while ((n = Serial2.available()) > 0)
+    {
+        n = Serial2.readBytes(chunk, min(n, (int)sizeof(chunk)));
+        imuDecode(chunk, n);
+        total += n;
+    }
+    imuAccount(t0, total);
+}
+#endif
+
+bool imuBegin()
+{
+    pinMode(RS485_2_DE_PIN, OUTPUT);
+    digitalWrite(RS485_2_DE_PIN, LOW); // 接收模式
+    ahrs_init(&ahrs, AHRS_DEFAULT_ALGO);
+
+#if IMU_EVENT_DRIVEN
+    uart_config_t cfg = {};
+    cfg.baud_rate = IMU_BAUDRATE;
+    cfg.data_bits = UART_DATA_8_BITS;
+    cfg.parity = UART_PARITY_DISABLE;
+    cfg.stop_bits = UART_STOP_BITS_1;
+    cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+
+    if (uart_driver_install(IMU_UART_NUM, IMU_RX_BUF_SIZE, 0, 16, &imuUartQueue, 0) != ESP_OK)
+        return false;
+    uart_param_config(IMU_UART_NUM, &cfg);
+    uart_set_pin(IMU_UART_NUM, RS485_2_TX_PIN, RS485_2_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_set_rx_timeout(IMU_UART_NUM, IMU_RX_TIMEOUT_SYMBOLS);
+    uart_set_rx_full_threshold(IMU_UART_NUM, IMU_RX_FULL_THRESHOLD);
+
+    // 核心 0，高于 loop() 的优先级：唤醒后立即解码
+    return xTaskCreatePinnedToCore(imuRxTask, "imu_rx", 4096, NULL, configMAX_PRIORITIES - 2, NULL, 0) == pdPASS;
+#else
+    Serial2.begin(IMU_BAUDRATE, SERIAL_8N1, RS485_2_RX_PIN, RS485_2_TX_PIN);
+    return true;
+#endif
+}
+
+/**
+ * @brief 把接收上下文发布的最新帧取到 hipnuc_raw（显示、命令使用）
+ * @return 自上次调用以来有新帧
+ */
+bool imuFetch()
+{
+    if (imuLatest.seq == imuFetchedSeq)
+        return false;
+
+    portENTER_CRITICAL(&imuMux);
+    hipnuc_raw.hi91 = imuLatest.hi91;
+    hipnuc_raw.hi81 = imuLatest.hi81;
+    hipnuc_raw.hi83 = imuLatest.hi83;
+    hipnuc_raw.len = imuLatest.len;
+    memcpy(ahrsQuat, imuLatest.ahrsQuat, sizeof(ahrsQuat));
+    ahrsValid = imuLatest.ahrsValid;
+    imuFetchedSeq = imuLatest.seq;
+    portEXIT_CRITICAL(&imuMux);
+    return true;
+}
+
+float imuHz()
 {
-    tone(BUZZER_PIN, 2000, 20); // 短促的嘀声
+    portENTER_CRITICAL(&imuMux);
+    float hz = rate_est_hz(&rates[RATE_IMU], micros());
+    portEXIT_CRITICAL(&imuMux);
+    return hz;
 }
 
 // ==================== LCD屏幕显示功能 ====================
@@ -109,10 +845,8 @@ void initLCD()
 
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.setTextSize(1);
-    tft.drawString("Initializing DPS310...", 10, 100);
+    tft.drawString("Initializing sensors...", 10, 100);
     tft.setTextDatum(TL_DATUM);
-
-    delay(500);
 }
 
 void updateLCDDisplay()
@@ -133,7 +867,7 @@ void updateLCDDisplay()
     tft.setTextSize(1);
     tft.drawString("FPS: ", 10, 40);
     tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.drawFloat(currentFPS, 1, 50, 40, 2);
+    tft.drawFloat(imuHz(), 1, 50, 40, 2);
 
     tft.setTextColor(TFT_YELLOW, TFT_BLACK);
     tft.drawString("Time: ", 150, 40);
@@ -194,33 +928,23 @@ void printSystemInfo()
 }
 
 // ==================== 启动倒计时 ====================
+/**
+ * @brief 启动倒计时：提示音在后台播放，初始化不再等待
+ */
 void startupCountdown()
 {
-    Serial.println("\n启动倒计时:");
-    for (int i = 3; i > 0; i--)
-    {
-        Serial.printf("  %d...\n", i);
-        setLEDStatus(0);
-        tone(BUZZER_PIN, 800 + i * 200);
-        delay(300);
-        noTone(BUZZER_PIN);
-        leds[0] = CRGB::Black;
-        FastLED.show();
-        delay(700);
-    }
+    Serial.println("\n启动倒计时（后台播放，初始化同时进行）");
     playStartupSound();
-    Serial.println("\n✓ 数据采集已启动");
-    Serial.println("========================================\n");
 }
 
 // ==================== DPS310传感器函数 ====================
-void initDPS310()
+bool initDPS310()
 {
     if (!dps.begin_I2C(DPS310_I2C_ADDR, &Wire))
     {
         Serial.println("DPS310 初始化失败!");
         setLEDStatus(4);
-        return;
+        return false;
     }
     Serial.println("DPS310 初始化成功");
 
@@ -228,6 +952,7 @@ void initDPS310()
     dps.configurePressure(DPS310_64HZ, DPS310_64SAMPLES);
     dps.configureTemperature(DPS310_64HZ, DPS310_64SAMPLES);
     setLEDStatus(2);
+    return true;
 }
 
 void readDPS310()
@@ -238,6 +963,7 @@ void readDPS310()
         return;
     }
     lastDPSRead = now;
+    StageScope stage(PROF_DPS_READ);
 
     sensors_event_t temp_event, pressure_event;
 
@@ -247,7 +973,14 @@ void readDPS310()
         dps_pressure = pressure_event.pressure;
         // 计算高度（简单公式，基于海平面气压101325 Pa）
         dps_altitude = 44330.0 * (1.0 - pow(dps_pressure / 101325.0, 1.0 / 5.255));
-        frameCount++;
+        portENTER_CRITICAL(&imuMux);
+        rate_est_sample(&rates[RATE_DPS310], micros(), 0);
+        run_stats_add(&stats[STAT_PRESSURE], dps_pressure);
+        run_stats_add(&stats[STAT_TEMP], dps_temp);
+        portEXIT_CRITICAL(&imuMux);
+        portENTER_CRITICAL(&bbMux);
+        blackbox_put_baro(&blackbox, micros(), dps_pressure, dps_temp);
+        portEXIT_CRITICAL(&bbMux);
     }
 }
 
@@ -255,7 +988,7 @@ void readDPS310()
 void displayCompactData()
 {
     // 显示FPS和运行时间
-    Serial.printf("[%.1f Hz | %.1fs] ", currentFPS, millis() / 1000.0);
+    Serial.printf("[%.1f Hz | %.1fs] ", imuHz(), millis() / 1000.0);
 
     // 显示0x91 IMU数据（紧凑格式）
     if (hipnuc_raw.hi91.tag == 0x91)
@@ -263,8 +996,12 @@ void displayCompactData()
         hi91_t *imu = &hipnuc_raw.hi91;
         Serial.printf("IMU: Roll=%6.2f° Pitch=%6.2f° Yaw=%6.2f° ",
                       imu->roll, imu->pitch, imu->yaw);
-        Serial.printf("| Acc=[%6.2f,%6.2f,%6.2f]m/s² ",
-                      imu->acc[0] * 9.8, imu->acc[1] * 9.8, imu->acc[2] * 9.8);
+        // 结构体为紧凑布局，逐个成员构造而不是 Vec3::load()
+        Vec3 acc = Vec3(imu->acc[0], imu->acc[1], imu->acc[2]) * GRAVITY_MS2;
+        Quat q(imu->quat[0], imu->quat[1], imu->quat[2], imu->quat[3]);
+        Vec3 lin = q.rotate(acc) - Vec3(0.0f, 0.0f, GRAVITY_MS2); // 导航系线加速度（去除重力）
+        Serial.printf("| Acc=[%6.2f,%6.2f,%6.2f]m/s² ", acc.x, acc.y, acc.z);
+        Serial.printf("| Lin=[%6.2f,%6.2f,%6.2f]m/s² ", lin.x, lin.y, lin.z);
         Serial.printf("| Gyr=[%6.1f,%6.1f,%6.1f]°/s",
                       imu->gyr[0], imu->gyr[1], imu->gyr[2]);
         setLEDStatus(2);
@@ -273,12 +1010,13 @@ void displayCompactData()
     else if (hipnuc_raw.hi81.tag == 0x81)
     {
         hi81_t *ins = &hipnuc_raw.hi81;
+        // 经纬度保留 double：1e-7° 分辨率超出 float 的 24 位尾数
         Serial.printf("INS: Lat=%.6f° Lon=%.6f° Alt=%.2fm ",
                       ins->ins_lat * 1e-7, ins->ins_lon * 1e-7, ins->ins_msl * 1e-3);
         Serial.printf("| Sats=%d Quality=%d ",
                       ins->nv_pos, ins->solq_pos);
         Serial.printf("| Roll=%6.2f° Pitch=%6.2f° Yaw=%6.2f°",
-                      ins->roll * 0.01, ins->pitch * 0.01, ins->yaw * 0.01);
+                      ins->roll * 0.01f, ins->pitch * 0.01f, ins->yaw * 0.01f);
         setLEDStatus(3);
     }
     // 显示0x83数据
@@ -293,8 +1031,13 @@ void displayCompactData()
         }
         if (data->data_bitmap & HI83_BMAP_ACC_B)
         {
-            Serial.printf("| Acc=[%.2f,%.2f,%.2f]m/s² ",
-                          data->acc_b[0] * 9.8, data->acc_b[1] * 9.8, data->acc_b[2] * 9.8);
+            Vec3 acc = Vec3(data->acc_b[0], data->acc_b[1], data->acc_b[2]) * GRAVITY_MS2;
+            Serial.printf("| Acc=[%.2f,%.2f,%.2f]m/s² ", acc.x, acc.y, acc.z);
+        }
+        if (ahrsValid)
+        {
+            Vec3 rpy = Quat::load(ahrsQuat).toEuler() * RAD_TO_DEG_F;
+            Serial.printf("| AHRS RPY=[%.2f,%.2f,%.2f]° ", rpy.x, rpy.y, rpy.z);
         }
         setLEDStatus(2);
     }
@@ -325,165 +1068,1241 @@ void displayDetailedData()
     }
 }
 
-// ==================== 串口命令处理 ====================
-void processSerialCommand()
+// ==================== 统计信息 ====================
+void printStatistics()
 {
-    if (Serial.available())
+    Serial.println("\n========== 统计信息 ==========");
+
+    // 在临界区内复制快照，格式化和打印在临界区外；接收路径测量每次打印后重新开始
+    static rate_est_t rateSnap[RATE_COUNT];
+    static rx_meter_t meterSnap;
+    static char line[384];
+    AhrsStats ahrsSnap;
+    uint32_t nowUs = micros();
+    portENTER_CRITICAL(&imuMux);
+    memcpy(rateSnap, rates, sizeof(rates));
+    meterSnap = imuMeter;
+    ahrsSnap = ahrsStats;
+    rx_meter_reset(&imuMeter, nowUs);
+    portEXIT_CRITICAL(&imuMux);
+
+    for (int i = 0; i < RATE_COUNT; i++)
     {
-        char cmd = Serial.read();
-        while (Serial.available())
-            Serial.read(); // 清空缓冲区
-
-        switch (cmd)
-        {
-        case 'd':
-        case 'D':
-            Serial.println("\n执行详细数据输出...");
-            displayDetailedData();
-            break;
-
-        case 'i':
-        case 'I':
-            printSystemInfo();
-            break;
-
-        case 'r':
-        case 'R':
-            Serial.println("正在重启ESP32...");
-            delay(500);
-            ESP.restart();
-            break;
+        rate_est_format(&rateSnap[i], nowUs, line, sizeof(line));
+        Serial.print(line);
+    }
+    Serial.printf("IMU接收（%s，FIFO溢出 %lu，缓冲满 %lu）: ", IMU_EVENT_DRIVEN ? "UART事件任务" : "loop轮询",
+                  imuFifoOverflows, imuBufOverflows);
+    rx_meter_format(&meterSnap, nowUs, line, sizeof(line));
+    Serial.print(line);
+    if (ahrsSnap.updates > 0)
+    {
+        uint32_t avg = (uint32_t)(ahrsSnap.cycles / ahrsSnap.updates);
+        Serial.printf("AHRS（%s）: %lu 次更新，平均 %lu 周期（%.2f us），最大 %lu 周期\n",
+                      ahrs.algo == AHRS_MADGWICK ? "Madgwick" : "Mahony", ahrsSnap.updates, avg,
+                      (float)avg / ESP.getCpuFreqMHz(), ahrsSnap.cyclesMax);
+    }
+    Serial.printf("运行时间: %.1f 秒\n", millis() / 1000.0);
+    Serial.printf("空闲堆: %d bytes\n", ESP.getFreeHeap());
+    Serial.printf("接收到的数据包类型: ");
+    if (hipnuc_raw.hi91.tag == 0x91)
+        Serial.print("0x91(IMU) ");
+    if (hipnuc_raw.hi81.tag == 0x81)
+        Serial.print("0x81(INS) ");
+    if (hipnuc_raw.hi83.tag == 0x83)
+        Serial.print("0x83(Flex) ");
+    Serial.printf("\nIMU分帧: 帧 %lu（找回 %lu），CRC错误 %lu，长度错误 %lu，标签错误 %lu，跳过 %lu 字节",
+                  imuSync.stats.frames, imuSync.stats.recovered, imuSync.stats.crc_errors,
+                  imuSync.stats.len_errors, imuSync.stats.tag_errors, imuSync.stats.skipped);
+    Serial.printf("\nLED刷新: %u 次/秒（请求 %lu，忽略 %lu，推迟 %lu）",
+                  statusLed.stats.pushes_per_s, statusLed.stats.requests,
+                  statusLed.stats.ignored, statusLed.stats.busy);
+    Serial.printf("\n蜂鸣器: 播放 %lu，抢占 %lu，拒绝 %lu，完成 %lu，定时器错误 %lu",
+                  buzzer.stats.started, buzzer.stats.preempted,
+                  buzzer.stats.rejected, buzzer.stats.completed, buzzerTimerErrors);
+    blackbox_t bbSnap;
+    portENTER_CRITICAL(&bbMux);
+    bbSnap = blackbox;
+    portEXIT_CRITICAL(&bbMux);
+    Serial.print("\n");
+    blackbox_format(&bbSnap, line, sizeof(line));
+    Serial.print(line);
+    Serial.printf("SD卡: %s", sdReady ? "就绪" : flashLogReady ? "未就绪（快照写入 Flash 日志）" : "未就绪（快照不保存）");
+    Serial.print("\n");
+    if (flashLogReady)
+    {
+        xSemaphoreTake(flashLogLock, portMAX_DELAY);
+        flash_log_format(&flashLog, line, sizeof(line));
+        xSemaphoreGive(flashLogLock);
+        Serial.print(line);
+    }
+    Serial.printf("崩溃日志: 第 %lu 次启动，%u 条记录，提交最长 %lu 周期（%.2f us）", journal.boots, journal.valid,
+                  journalCommitMax, (float)journalCommitMax / ESP.getCpuFreqMHz());
+    Serial.println("\n==============================\n");
+}
 
-        case 's':
-        case 'S':
-            Serial.println("\n========== 统计信息 ==========");
-            Serial.printf("当前帧率: %.1f Hz\n", currentFPS);
-            Serial.printf("运行时间: %.1f 秒\n", millis() / 1000.0);
-            Serial.printf("空闲堆: %d bytes\n", ESP.getFreeHeap());
-            Serial.printf("接收到的数据包类型: ");
-            if (hipnuc_raw.hi91.tag == 0x91)
-                Serial.print("0x91(IMU) ");
-            if (hipnuc_raw.hi81.tag == 0x81)
-                Serial.print("0x81(INS) ");
-            if (hipnuc_raw.hi83.tag == 0x83)
-                Serial.print("0x83(Flex) ");
-            Serial.println("\n==============================\n");
-            break;
+// ==================== 通道统计 ====================
+void initChannelStats()
+{
+    for (int i = 0; i < STAT_COUNT; i++)
+    {
+        bool dps = i == STAT_PRESSURE || i == STAT_TEMP;
+        run_stats_init(&stats[i], statNames[i], statUnits[i], dps ? STATS_DPS_BLOCK : STATS_IMU_BLOCK,
+                       dps ? STATS_DPS_BLOCKS : STATS_IMU_BLOCKS);
+    }
+}
 
-        case 'h':
-        case 'H':
-            Serial.println("\n========== 命令帮助 ==========");
-            Serial.println("  d - 显示详细数据(JSON格式)");
-            Serial.println("  i - 显示系统信息");
-            Serial.println("  s - 显示统计信息");
-            Serial.println("  r - 重启ESP32");
-            Serial.println("  h - 显示帮助信息");
-            Serial.println("==============================\n");
-            break;
+/**
+ * @brief 逐通道在临界区内复制，格式化和打印在临界区外
+ */
+void printChannelStats()
+{
+    static run_stats_t snap;
+    static char line[256];
 
-        default:
-            Serial.println("未知命令，输入 'h' 查看帮助");
-            break;
-        }
+    Serial.println("\n========== 通道统计（均值 ±标准差 [最小, 最大]）==========");
+    for (int i = 0; i < STAT_COUNT; i++)
+    {
+        portENTER_CRITICAL(&imuMux);
+        snap = stats[i];
+        portEXIT_CRITICAL(&imuMux);
+        run_stats_format(&snap, line, sizeof(line));
+        Serial.print(line);
     }
+    Serial.printf("窗口: IMU %d × %d 样本，DPS310 %d × %d 样本\n", STATS_IMU_BLOCKS, STATS_IMU_BLOCK,
+                  STATS_DPS_BLOCKS, STATS_DPS_BLOCK);
+    Serial.println("==========================================================\n");
 }
 
-// ==================== Setup ====================
-void setup()
+// ==================== 黑匣子 ====================
+void initBlackbox()
 {
-    delay(500);
-
-    // 初始化串口
-    Serial.begin(115200);
-    Serial.println("\n\n");
+    blackbox_init(&blackbox, blackboxBuf, sizeof(blackboxBuf), BLACKBOX_PRE_MS * 1000UL, BLACKBOX_POST_MS * 1000UL);
+    // 一次快照的时长内不重复触发
+    blackbox_highg_init(&blackboxHighG, BLACKBOX_HIGH_G, BLACKBOX_HIGH_G_SAMPLES,
+                        (BLACKBOX_PRE_MS + BLACKBOX_POST_MS) * 1000UL);
+}
 
-    // 初始化I2C（DPS310传感器）
-    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+/**
+ * @brief 主循环中的触发（命令、按键、链路中断）；高 g 在接收上下文中直接触发
+ */
+void blackboxTrigger(blackbox_trig_t reason)
+{
+    portENTER_CRITICAL(&bbMux);
+    int ok = blackbox_trigger(&blackbox, reason, micros());
+    portEXIT_CRITICAL(&bbMux);
+    if (ok)
+        Serial.printf("黑匣子触发: %s，%d ms 后导出\n", blackbox_trig_name(reason), BLACKBOX_POST_MS);
+    else
+        Serial.printf("黑匣子正在记录 / 导出，忽略触发: %s\n", blackbox_trig_name(reason));
+}
 
-    // 初始化IMU串口（Serial2，使用RS485_2引脚）
-    Serial2.begin(IMU_BAUDRATE, SERIAL_8N1, RS485_2_RX_PIN, RS485_2_TX_PIN);
-    pinMode(RS485_2_DE_PIN, OUTPUT);
-    digitalWrite(RS485_2_DE_PIN, LOW); // 接收模式
+/**
+ * @brief 导出任务：快照冻结后逐块取出写入 SD 卡 bb_NNN.bin；没有 SD 卡时写入 Flash 环形日志
+ *        （文件头、数据块各为一条记录），两者都没有时取出丢弃以便重新待命
+ * @note 每块只在临界区内复制，写卡时采集继续写入缓冲的空闲空间；SPI 总线按块加锁，与 LCD 刷新交替。
+ *       Flash 擦除 / 编程期间 Cache 关闭，另一核上不在 IRAM 中的代码（loop()）随之暂停，每个扇区擦除约数十 ms。
+ *       因此待命时每轮预擦除一个扇区，直到够写一个快照，触发后的写入只编程不擦除；
+ *       写入期间的 IMU FIFO 溢出次数随结果输出。
+ *       Arduino 框架预编译的 sdkconfig 未打开 CONFIG_UART_ISR_IN_IRAM，UART 中断不在 IRAM：擦除期间 FIFO
+ *       （128 字节，115200bps 下约 11ms 填满）无人搬运，预擦除的代价是待命采集时每擦一个扇区可能丢一次
+ *       IMU 数据（计入 FIFO 溢出，命令 s 查看），换来触发后的快照写入不再长时间阻塞
+ */
+void blackboxTask(void *arg)
+{
+    static uint8_t chunk[BLACKBOX_CHUNK];
+    uint8_t hdr[BLACKBOX_FILE_HDR_SIZE];
+    char name[16];
+    SdFile file;
 
-    // 初始化LED和蜂鸣器
-    pinMode(BUZZER_PIN, OUTPUT);
-    FastLED.addLeds<WS2812B, WS2812B_PIN, GRB>(leds, NUM_LEDS);
-    FastLED.setBrightness(50);
-    setLEDStatus(0);
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(50));
+
+        portENTER_CRITICAL(&bbMux);
+        blackbox_poll(&blackbox, micros()); // 数据源全部中断时也能结束 POST 阶段
+        bool frozen = blackbox.state == BB_FROZEN;
+        bool armed = blackbox.state == BB_ARMED;
+        if (frozen)
+            blackbox_file_header(&blackbox, hdr);
+        portEXIT_CRITICAL(&bbMux);
+        if (armed && !sdReady && flashLogReady)
+        {
+            // 待命：触发 / 导出窗口之外预擦除
+            xSemaphoreTake(flashLogLock, portMAX_DELAY);
+            flash_log_reserve(&flashLog, FLASHLOG_RESERVE_SECTORS);
+            xSemaphoreGive(flashLogLock);
+        }
+        if (!frozen)
+            continue;
+
+        uint32_t t0 = millis();
+        uint32_t fifoOvf0 = imuFifoOverflows;
+        bool toFlash = !sdReady && flashLogReady; // 没有 SD 卡时写入 Flash 环形日志
+        bool ok = sdReady || toFlash;
+        uint32_t flashSeq = 0;
+        if (sdReady)
+        {
+            snprintf(name, sizeof(name), "bb_%03u.bin", blackboxFileSeq++);
+            xSemaphoreTake(spiBusLock, portMAX_DELAY);
+            ok = file.open(name, O_WRONLY | O_CREAT | O_TRUNC) && file.write(hdr, sizeof(hdr)) == sizeof(hdr);
+            xSemaphoreGive(spiBusLock);
+        }
+        else if (toFlash)
+        {
+            xSemaphoreTake(flashLogLock, portMAX_DELAY);
+            flashSeq = flashLog.rec_seq;
+            ok = flash_log_append(&flashLog, FLASHLOG_REC_BB_HDR, hdr, sizeof(hdr));
+            xSemaphoreGive(flashLogLock);
+        }
 
-    // 初始化解码器
-    memset(&hipnuc_raw, 0, sizeof(hipnuc_raw_t));
+        uint32_t bytes = 0;
+        for (;;)
+        {
+            portENTER_CRITICAL(&bbMux);
+            size_t n = blackbox_drain(&blackbox, chunk, sizeof(chunk));
+            portEXIT_CRITICAL(&bbMux);
+            if (n == 0)
+                break;
+            bytes += n;
+            if (ok && toFlash)
+            {
+                xSemaphoreTake(flashLogLock, portMAX_DELAY);
+                ok = flash_log_append(&flashLog, FLASHLOG_REC_BB_DATA, chunk, (uint16_t)n);
+                xSemaphoreGive(flashLogLock);
+            }
+            else if (ok)
+            {
+                xSemaphoreTake(spiBusLock, portMAX_DELAY);
+                ok = file.write(chunk, n) == n;
+                xSemaphoreGive(spiBusLock);
+            }
+        }
+        if (file.isOpen())
+        {
+            xSemaphoreTake(spiBusLock, portMAX_DELAY);
+            ok = file.close() && ok;
+            xSemaphoreGive(spiBusLock);
+        }
 
-    // 初始化LCD屏幕
+        const char *reason = blackbox_trig_name((blackbox_trig_t)hdr[6]);
+        if (toFlash)
+            Serial.printf("黑匣子: %s 快照 %lu 字节 → Flash 日志 #%lu %s（%lu ms，IMU FIFO 溢出 %lu 次）\n", reason,
+                          bytes, flashSeq, ok ? "已保存" : "写入失败", millis() - t0, imuFifoOverflows - fifoOvf0);
+        else if (!sdReady)
+            Serial.printf("黑匣子: %s 快照 %lu 字节已丢弃（无 SD 卡和 Flash 日志）\n", reason, bytes);
+        else
+            Serial.printf("黑匣子: %s 快照 %lu 字节 → %s %s（%lu ms）\n", reason, bytes, name,
+                          ok ? "已保存" : "写入失败", millis() - t0);
+    }
+}
+
+// ==================== Flash 日志 ====================
+int flashRead(void *ctx, uint32_t addr, void *buf, uint32_t len)
+{
+    return esp_partition_read(flashPart, addr, buf, len) == ESP_OK ? 0 : -1;
+}
+
+int flashWrite(void *ctx, uint32_t addr, const void *buf, uint32_t len)
+{
+    return esp_partition_write(flashPart, addr, buf, len) == ESP_OK ? 0 : -1;
+}
+
+int flashErase(void *ctx, uint32_t addr)
+{
+    return esp_partition_erase_range(flashPart, addr, FLASH_LOG_SECTOR) == ESP_OK ? 0 : -1;
+}
+
+const flash_log_ops_t flashLogOps = {flashRead, flashWrite, flashErase};
+
+/**
+ * @brief 找到 datalog 分区并恢复写入位置（二分查找写入扇区，只读不写）
+ * @note 整个分区映射到数据地址空间，恢复与导出直接读映射区；esp_partition_write/erase 后 IDF 会刷新 Cache
+ */
+bool initFlashLog()
+{
+    flashPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)FLASHLOG_SUBTYPE,
+                                         FLASHLOG_PARTITION);
+    if (flashPart == NULL)
+        return false;
+
+    const void *map = NULL;
+    if (esp_partition_mmap(flashPart, 0, flashPart->size, SPI_FLASH_MMAP_DATA, &map, &flashMapHandle) != ESP_OK)
+        map = NULL; // 映射失败时经 esp_partition_read 读取
+
+    uint32_t t0 = micros();
+    bool ok = flash_log_open(&flashLog, &flashLogOps, NULL, (const uint8_t *)map, flashPart->size) == 0;
+    flashLogOpenUs = micros() - t0;
+    flashLogReady = ok;
+    return ok;
+}
+
+/**
+ * @brief 从 c 起统计一个快照的数据块字节数（到下一个快照文件头或日志末尾），不移动 c
+ */
+uint32_t flashSnapshotBytes(flash_log_cursor_t c, uint8_t *buf)
+{
+    flash_log_rec_t rec;
+    uint32_t bytes = 0;
+
+    while (flash_log_next(&flashLog, &c, &rec, buf) && rec.type == FLASHLOG_REC_BB_DATA)
+        bytes += rec.len;
+    return bytes;
+}
+
+/**
+ * @brief 状态与保留的黑匣子快照列表（文件头已被覆盖的最旧快照不列出）
+ */
+void printFlashLog()
+{
+    static uint8_t buf[FLASH_LOG_MAX_PAYLOAD]; // 无映射时存放 payload
+    char line[256];
+    flash_log_cursor_t c;
+    flash_log_rec_t rec;
+    uint32_t snaps = 0;
+
+    if (!flashLogReady)
+    {
+        Serial.println("Flash 日志未就绪（分区表中没有 datalog 分区）");
+        return;
+    }
+    Serial.println("\n========== Flash 日志 ==========");
+    xSemaphoreTake(flashLogLock, portMAX_DELAY);
+    flash_log_format(&flashLog, line, sizeof(line));
+    Serial.print(line);
+    Serial.printf("启动恢复 %lu us（%s）\n", flashLogOpenUs, flashLog.map ? "内存映射" : "esp_partition_read");
+    flash_log_rewind(&flashLog, &c);
+    while (flash_log_next(&flashLog, &c, &rec, buf))
+    {
+        if (rec.type != FLASHLOG_REC_BB_HDR || rec.len != BLACKBOX_FILE_HDR_SIZE)
+            continue;
+        uint8_t hdr[BLACKBOX_FILE_HDR_SIZE];
+        memcpy(hdr, rec.data, sizeof(hdr));
+        uint32_t total = hdr[12] | (hdr[13] << 8) | ((uint32_t)hdr[14] << 16) | ((uint32_t)hdr[15] << 24);
+        uint32_t bytes = flashSnapshotBytes(c, buf);
+        Serial.printf("  #%lu 黑匣子 %s 快照 %lu/%lu 字节%s\n", rec.seq, blackbox_trig_name((blackbox_trig_t)hdr[6]),
+                      bytes, total, bytes == total ? "" : "（不完整）");
+        snaps++;
+    }
+    xSemaphoreGive(flashLogLock);
+    Serial.printf("共 %lu 个快照，'e' 导出\n", snaps);
+    Serial.println("================================\n");
+}
+
+/**
+ * @brief 以二进制导出全部快照：每个快照为 "FLASHLOG #<记录号> <字节数>\n" 后接 bb_NNN.bin 格式的内容，
+ *        最后一行 "FLASHLOG END"
+ * @note 有映射时直接从映射区发送，不复制；导出期间新的快照等待写入
+ */
+void exportFlashLog()
+{
+    static uint8_t buf[FLASH_LOG_MAX_PAYLOAD];
+    flash_log_cursor_t c, d;
+    flash_log_rec_t rec;
+
+    if (!flashLogReady)
+    {
+        Serial.println("Flash 日志未就绪（分区表中没有 datalog 分区）");
+        return;
+    }
+    xSemaphoreTake(flashLogLock, portMAX_DELAY);
+    flash_log_rewind(&flashLog, &c);
+    while (flash_log_next(&flashLog, &c, &rec, buf))
+    {
+        if (rec.type != FLASHLOG_REC_BB_HDR || rec.len != BLACKBOX_FILE_HDR_SIZE)
+            continue;
+        uint8_t hdr[BLACKBOX_FILE_HDR_SIZE];
+        memcpy(hdr, rec.data, sizeof(hdr));
+        uint32_t left = flashSnapshotBytes(c, buf);
+        Serial.printf("FLASHLOG #%lu %lu\n", rec.seq, (uint32_t)sizeof(hdr) + left);
+        Serial.write(hdr, sizeof(hdr));
+        for (d = c; left > 0 && flash_log_next(&flashLog, &d, &rec, buf); left -= rec.len)
+            Serial.write(rec.data, rec.len);
+    }
+    xSemaphoreGive(flashLogLock);
+    Serial.println("FLASHLOG END");
+}
+
+// ==================== 崩溃日志 ====================
+const char *resetReasonName(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_POWERON:
+        return "上电";
+    case ESP_RST_EXT:
+        return "外部复位引脚";
+    case ESP_RST_SW:
+        return "软件复位（ESP.restart）";
+    case ESP_RST_PANIC:
+        return "异常 / panic";
+    case ESP_RST_INT_WDT:
+        return "中断看门狗";
+    case ESP_RST_TASK_WDT:
+        return "任务看门狗";
+    case ESP_RST_WDT:
+        return "其他看门狗";
+    case ESP_RST_DEEPSLEEP:
+        return "深度睡眠唤醒";
+    case ESP_RST_BROWNOUT:
+        return "欠压";
+    case ESP_RST_SDIO:
+        return "SDIO";
+    default:
+        return "未知";
+    }
+}
+
+void printJournal(const char *title)
+{
+    static char line[256];
+    const crash_journal_entry_t *e;
+    int pos = 0;
+
+    Serial.printf("\n========== %s ==========\n", title);
+    crash_journal_format_summary(&journal, stageNames, line, sizeof(line));
+    Serial.print(line);
+    while ((e = crash_journal_next(&journal, &pos)) != NULL)
+    {
+        crash_journal_format_entry(e, stageNames, journalValueNames, line, sizeof(line));
+        Serial.print(line);
+    }
+    Serial.println("==============================\n");
+}
+
+/**
+ * @brief 启动时导出上次运行留下的记录和复位原因，然后清空开始本次记录
+ * @note 64 条记录在 115200 波特率下约需 1 秒，只在软件 / 看门狗 / panic 复位后出现
+ */
+void initCrashJournal()
+{
+    int n = crash_journal_open(&journal);
+
+    Serial.printf("复位原因: %s\n", resetReasonName(esp_reset_reason()));
+    if (n < 0)
+        Serial.println("崩溃日志: RTC 内存内容无效（上电或布局改变），重新初始化");
+    else
+        printJournal("上次运行的崩溃日志");
+    crash_journal_start(&journal, ESP.getCpuFreqMHz());
+}
+
+/**
+ * @brief 提交本周期：各阶段最长耗时、IMU 帧数、最新气压 / 温度 / |acc| / |gyr|
+ */
+void journalCommit()
+{
+    float acc[3], gyr[3];
+    float v[CRASH_JOURNAL_VALUES] = {dps_pressure, dps_temp, 0.0f, 0.0f};
+
+    if (imuAccGyr(&hipnuc_raw, acc, gyr))
+    {
+        v[2] = Vec3(acc[0], acc[1], acc[2]).norm();
+        v[3] = Vec3(gyr[0], gyr[1], gyr[2]).norm();
+    }
+    portENTER_CRITICAL(&imuMux);
+    uint32_t seq = imuLatest.seq;
+    portEXIT_CRITICAL(&imuMux);
+
+    uint32_t t0 = prof_ticks();
+    crash_journal_commit(&journal, millis(), (uint16_t)(seq - journalFrameSeq), v);
+    uint32_t ticks = prof_ticks() - t0;
+    if (ticks > journalCommitMax)
+        journalCommitMax = ticks;
+    journalFrameSeq = seq;
+}
+
+// ==================== 性能剖析 ====================
+void initProfiler()
+{
+    prof_init(&prof, ESP.getCpuFreqMHz());
+    for (int i = 0; i < PROF_COUNT; i++)
+        prof_add(&prof, stageNames[i]);
+    profWindowStart = millis();
+}
+
+/**
+ * @brief 打印各探针的 min/avg/p99/max 和直方图，然后清零开始新的统计区间
+ */
+void printProfile()
+{
+#if PROF_ENABLE
+    Serial.printf("\n========== 分段耗时（最近 %.1f 秒）==========\n", (millis() - profWindowStart) / 1000.0);
+    prof_format(&prof, profText, sizeof(profText));
+    Serial.print(profText);
+    for (int i = 0; i < prof.count; i++)
+    {
+        if (prof.probes[i].count == 0)
+            continue;
+        prof_format_hist(&prof, i, profText, sizeof(profText));
+        Serial.print(profText);
+    }
+    Serial.println("============================================\n");
+
+    prof_reset(&prof);
+    profWindowStart = millis();
+#else
+    Serial.println("分段剖析未启用（PROF_ENABLE=0）");
+#endif
+}
+
+// ==================== 按键输入 ====================
+/**
+ * @brief 按键边沿中断：只记录线路、电平和时间戳
+ * @note GPIO36/39 在 ADC/WiFi 工作时可能误触发，电平未变的边沿由引擎丢弃
+ */
+void IRAM_ATTR onButtonEdge(void *arg)
+{
+    const ButtonPin *b = (const ButtonPin *)arg;
+    btn_ring_push(&btnRing, b->line, digitalRead(b->pin), micros());
+}
+
+void initButtons()
+{
+    pin_init_buttons();
+
+    btn_engine_init(&btnEngine);
+    // 拨动式波轮：上拨/下拨各一个触点，按下为低电平（正交编码波轮改为每格跳变数，如 4）
+    btn_engine_add_rotary(&btnEngine, LINE_ROTARY_1, LINE_ROTARY_2,
+                          digitalRead(ROTARY_BTN_1_PIN), digitalRead(ROTARY_BTN_2_PIN), BTN_ROTARY_TOGGLE);
+    btn_engine_add_button(&btnEngine, LINE_ROTARY_SWITCH, 1, digitalRead(ROTARY_SWITCH_PIN));
+    btn_engine_add_button(&btnEngine, LINE_EXT_1, 1, digitalRead(EXT_BTN_1_PIN));
+    btn_engine_add_button(&btnEngine, LINE_EXT_2, 1, digitalRead(EXT_BTN_2_PIN));
+
+    for (size_t i = 0; i < sizeof(buttonPins) / sizeof(buttonPins[0]); i++)
+        attachInterruptArg(digitalPinToInterrupt(buttonPins[i].pin), onButtonEdge, &buttonPins[i], CHANGE);
+}
+
+/**
+ * @brief 处理按键事件
+ *
+ * - 波轮上拨/下拨：调节 LED 亮度
+ * - 波轮按键：单击详细数据，双击统计信息，长按系统信息
+ * - 外部按键 1：单击统计信息，长按触发黑匣子
+ * - 外部按键 2：长按重启
+ */
+void handleButtonEvents()
+{
+    btn_event_t ev;
+
+    btn_engine_process(&btnEngine, &btnRing, micros());
+
+    while (btn_engine_pop(&btnEngine, &ev))
+    {
+        if (ev.type == BTN_EV_ROTATE)
+        {
+            int b = ledBrightness + ev.dir * 10;
+            ledBrightness = (uint8_t)constrain(b, 5, 255);
+            portENTER_CRITICAL(&ledMux);
+            status_led_set_brightness(&statusLed, ledBrightness);
+            portEXIT_CRITICAL(&ledMux);
+            Serial.printf("LED亮度: %d\n", ledBrightness);
+            continue;
+        }
+
+        playClickSound(); // 按键音优先级最低，不会打断启动音和报警
+
+        switch (ev.line)
+        {
+        case LINE_ROTARY_SWITCH:
+            if (ev.type == BTN_EV_CLICK)
+                displayDetailedData();
+            else if (ev.type == BTN_EV_DOUBLE_CLICK)
+                printStatistics();
+            else if (ev.type == BTN_EV_LONG_PRESS)
+                printSystemInfo();
+            break;
+
+        case LINE_EXT_1:
+            if (ev.type == BTN_EV_CLICK)
+                printStatistics();
+            else if (ev.type == BTN_EV_LONG_PRESS)
+                blackboxTrigger(BB_TRIG_BUTTON);
+            break;
+
+        case LINE_EXT_2:
+            if (ev.type == BTN_EV_LONG_PRESS)
+            {
+                Serial.println("正在重启ESP32...");
+                delay(500);
+                ESP.restart();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+// ==================== 启动编排 ====================
+// 步骤 id 即注册顺序；IMU 串口最先就绪，阻塞的总线初始化放入独立任务并行执行
+enum BootStepId
+{
+    BOOT_IMU_UART = 0,
+    BOOT_LED_BUZZER,
+    BOOT_STARTUP_SOUND,
+    BOOT_BUTTONS,
+    BOOT_I2C,
+    BOOT_DPS310,
+    BOOT_LCD,
+    BOOT_SYSINFO,
+    BOOT_SDCARD,
+    BOOT_FLASHLOG
+};
+
+struct BootStep
+{
+    const char *name;
+    uint32_t deps;
+    bool (*run)();
+    bool background; // 含阻塞的总线操作，放入独立任务执行
+};
+
+boot_seq_t boot;
+portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED; // setup/loop 与后台初始化任务共享 boot
+bool bootReported = false;
+bool firstFrameLogged = false;
+char bootText[1024];
+
+bool bootImuUart()
+{
+    // 初始化IMU串口（UART2，使用RS485_2引脚）
+    return imuBegin();
+}
+
+bool bootLedBuzzer()
+{
+    initStatusLED();
+    initBuzzer();
+    setLEDStatus(0);
+    return true;
+}
+
+bool bootStartupSound()
+{
+    startupCountdown();
+    return true;
+}
+
+bool bootButtons()
+{
+    initButtons();
+    return true;
+}
+
+bool bootI2C()
+{
+    return Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+}
+
+bool bootLCD()
+{
+    xSemaphoreTake(spiBusLock, portMAX_DELAY);
     initLCD();
+    xSemaphoreGive(spiBusLock);
+    return true;
+}
 
-    // 初始化DPS310传感器
-    initDPS310();
+bool bootSdCard()
+{
+    pin_init_sd();
+    if (!sd_card_detected())
+        return false;
+
+    xSemaphoreTake(spiBusLock, portMAX_DELAY);
+    bool ok = sd.begin(SD_CS_PIN, SD_SCK_MHZ(25));
+    // 文件编号接在卡上已有的 bb_NNN.bin 之后
+    char name[16];
+    while (ok && blackboxFileSeq < 999)
+    {
+        snprintf(name, sizeof(name), "bb_%03u.bin", blackboxFileSeq);
+        if (!sd.exists(name))
+            break;
+        blackboxFileSeq++;
+    }
+    xSemaphoreGive(spiBusLock);
+    sdReady = ok;
+    return ok;
+}
 
-    // 打印系统信息
+bool bootFlashLog()
+{
+    return initFlashLog();
+}
+
+bool bootSysInfo()
+{
     printSystemInfo();
+    return true;
+}
 
-    // 启动倒计时
-    startupCountdown();
+const BootStep bootSteps[] = {
+    {"imu_uart", 0, bootImuUart, false},
+    {"led_buzzer", 0, bootLedBuzzer, false},
+    {"startup_snd", BOOT_DEP(BOOT_LED_BUZZER), bootStartupSound, false},
+    {"buttons", 0, bootButtons, false},
+    {"i2c", 0, bootI2C, false},
+    {"dps310", BOOT_DEP(BOOT_I2C), initDPS310, true},
+    {"lcd", 0, bootLCD, true},
+    {"sysinfo", 0, bootSysInfo, false},
+    {"sdcard", BOOT_DEP(BOOT_LCD), bootSdCard, true}, // LCD 先完成 SPI 总线初始化
+    {"flashlog", 0, bootFlashLog, false},             // 只读 O(log 扇区数) 个扇区头
+};
+
+void bootFinish(int id, bool ok)
+{
+    uint32_t t = micros();
+    portENTER_CRITICAL(&bootMux);
+    boot_seq_finish(&boot, id, ok, t);
+    portEXIT_CRITICAL(&bootMux);
+}
+
+void bootTask(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    bootFinish(id, bootSteps[id].run());
+    vTaskDelete(NULL);
+}
+
+bool bootStepDone(int id)
+{
+    portENTER_CRITICAL(&bootMux);
+    bool done = boot_seq_done(&boot, id);
+    portEXIT_CRITICAL(&bootMux);
+    return done;
+}
+
+void printBootTimeline()
+{
+    boot_seq_t snapshot;
+
+    portENTER_CRITICAL(&bootMux);
+    snapshot = boot;
+    portEXIT_CRITICAL(&bootMux);
+
+    boot_seq_format(&snapshot, bootText, sizeof(bootText));
+    Serial.println("\n========== 启动时间线 ==========");
+    Serial.print(bootText);
+    Serial.println("================================\n");
+}
+
+/**
+ * @brief 启动所有依赖已满足的步骤，全部结束后打印时间线
+ * @note setup() 调用一次，loop() 中持续调用直到后台步骤全部结束
+ */
+void bootPoll()
+{
+    if (bootReported)
+        return;
+
+    for (;;)
+    {
+        uint32_t t = micros();
+
+        portENTER_CRITICAL(&bootMux);
+        int id = boot_seq_next(&boot, t);
+        if (id >= 0)
+            boot_seq_start(&boot, id, t);
+        bool complete = id < 0 && boot_seq_complete(&boot);
+        portEXIT_CRITICAL(&bootMux);
+
+        if (id < 0)
+        {
+            if (complete)
+            {
+                bootReported = true;
+                printBootTimeline();
+            }
+            return;
+        }
+
+        // 后台任务放在核心 0，loop() 在核心 1 上立即开始采集
+        if (bootSteps[id].background &&
+            xTaskCreatePinnedToCore(bootTask, bootSteps[id].name, 4096, (void *)(intptr_t)id, 1, NULL, 0) == pdPASS)
+            continue;
+        bootFinish(id, bootSteps[id].run());
+    }
+}
+
+// ==================== 微基准 ====================
+// 被测数据与解码器实例独立于采集路径；外设未就绪时该项跳过
+struct BenchFrame
+{
+    uint8_t data[HIPNUC_MAX_RAW_SIZE];
+    int len;
+};
+
+BenchFrame benchHi91, benchHi83;
+hipnuc_sync_t benchSync;
+hipnuc_raw_t benchRaw;
+uint8_t benchBuf[BENCH_SD_BYTES];
+char benchText[64];
+SdFile benchFile;
+uint8_t benchPolarity = 0;
+volatile uint32_t benchSink; // 防止结果被优化掉
+
+int benchFrameSetup(void *ctx)
+{
+    hipnuc_sync_init(&benchSync);
+    return ((BenchFrame *)ctx)->len > 0 ? 0 : 1;
+}
+
+/* 按字节送入 hipnuc_sync_input，与 IMU 接收路径相同 */
+uint32_t benchDecode(void *ctx)
+{
+    const BenchFrame *f = (const BenchFrame *)ctx;
+    int r = 0;
+    for (int i = 0; i < f->len; i++)
+        r += hipnuc_sync_input(&benchSync, &benchRaw, f->data[i]);
+    benchSink += r;
+    return f->len;
+}
+
+uint32_t benchCrc16Bitwise(void *ctx)
+{
+    benchSink += hipnuc_synth_crc16(0, benchBuf, BENCH_CRC_BYTES);
+    return BENCH_CRC_BYTES;
+}
+
+/* ROM 查表实现：初值 / 取反约定与 HiPNUC 不同，只比较速度 */
+uint32_t benchCrc16Rom(void *ctx)
+{
+    benchSink += crc16_be(0, benchBuf, BENCH_CRC_BYTES);
+    return BENCH_CRC_BYTES;
+}
+
+uint32_t benchCrc32Rom(void *ctx)
+{
+    benchSink += crc32_le(0, benchBuf, BENCH_CRC_BYTES);
+    return BENCH_CRC_BYTES;
+}
+
+/* 三个浮点字段的格式化（串口输出的常见写法） */
+uint32_t benchSnprintf(void *ctx)
+{
+    benchSink += snprintf(benchText, sizeof(benchText), "%.3f,%.3f,%.3f", dps_temp, dps_pressure, dps_altitude);
+    return 0;
+}
+
+uint32_t benchDtostrf(void *ctx)
+{
+    dtostrf(dps_pressure, 0, 2, benchText);
+    benchSink += benchText[0];
+    return 0;
+}
+
+/* LCD 与 SD 卡：整项运行期间持有 SPI 总线锁，LCD 刷新与黑匣子导出等待 */
+int benchLcdSetup(void *ctx)
+{
+    if (!bootStepDone(BOOT_LCD))
+        return 1;
+    xSemaphoreTake(spiBusLock, portMAX_DELAY);
+    return 0;
+}
+
+void benchSpiTeardown(void *ctx)
+{
+    xSemaphoreGive(spiBusLock);
+}
+
+uint32_t benchTftFill(void *ctx)
+{
+    static uint16_t color = TFT_BLACK;
+    color ^= TFT_DARKGREY; // 内容每次都变化
+    tft.fillScreen(color);
+    return (uint32_t)tft.width() * tft.height() * 2;
+}
+
+/* 与 updateLCDDisplay() 中的一个数值字段相同 */
+uint32_t benchTftText(void *ctx)
+{
+    tft.setTextColor(TFT_CYAN, TFT_BLACK);
+    tft.drawFloat(dps_pressure / 100.0, 1, 100, 115, 2);
+    return 0;
+}
+
+int benchSdSetup(void *ctx)
+{
+    if (!sdReady)
+        return 1;
+    xSemaphoreTake(spiBusLock, portMAX_DELAY);
+    if (!benchFile.open(BENCH_SD_FILE, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        xSemaphoreGive(spiBusLock);
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t benchSdWrite(void *ctx)
+{
+    return benchFile.write(benchBuf, BENCH_SD_BYTES) == BENCH_SD_BYTES ? BENCH_SD_BYTES : 0;
+}
+
+void benchSdTeardown(void *ctx)
+{
+    benchFile.close();
+    sd.remove(BENCH_SD_FILE);
+    xSemaphoreGive(spiBusLock);
+}
+
+int benchDpsSetup(void *ctx)
+{
+    return bootStepDone(BOOT_DPS310) ? 0 : 1;
+}
+
+uint32_t benchDpsRead(void *ctx)
+{
+    sensors_event_t temp_event, pressure_event;
+    benchSink += dps.getEvents(&temp_event, &pressure_event);
+    return 0;
+}
+
+/* 翻转极性反转寄存器（只影响输入读数，不改变输出引脚），总线开销与翻转一个输出端口相同 */
+int benchPcaSetup(void *ctx)
+{
+    if (!bootStepDone(BOOT_I2C))
+        return 1;
+    Wire.beginTransmission(PCA9555_I2C_ADDR);
+    return Wire.endTransmission() == 0 ? 0 : 1;
+}
+
+void benchPcaWrite(uint8_t value)
+{
+    Wire.beginTransmission(PCA9555_I2C_ADDR);
+    Wire.write(4); // 极性反转寄存器 0
+    Wire.write(value);
+    Wire.endTransmission();
+}
+
+uint32_t benchPcaToggle(void *ctx)
+{
+    benchPolarity ^= 0x01;
+    benchPcaWrite(benchPolarity);
+    return 0;
+}
+
+void benchPcaTeardown(void *ctx)
+{
+    benchPolarity = 0;
+    benchPcaWrite(0);
+}
+
+uint32_t benchHeap(void *ctx)
+{
+    void *p = malloc(256);
+    benchSink += (uint32_t)(uintptr_t)p;
+    free(p);
+    return 0;
+}
+
+const microbench_t benches[] = {
+    {"hipnuc_hi91", benchFrameSetup, benchDecode, NULL, &benchHi91, 16},
+    {"hipnuc_hi83", benchFrameSetup, benchDecode, NULL, &benchHi83, 16},
+    {"crc16_bitwise", NULL, benchCrc16Bitwise, NULL, NULL, 16},
+    {"crc16_rom", NULL, benchCrc16Rom, NULL, NULL, 16},
+    {"crc32_rom", NULL, benchCrc32Rom, NULL, NULL, 16},
+    {"snprintf_3f", NULL, benchSnprintf, NULL, NULL, 16},
+    {"dtostrf", NULL, benchDtostrf, NULL, NULL, 16},
+    {"tft_fill", benchLcdSetup, benchTftFill, benchSpiTeardown, NULL, 1},
+    {"tft_text", benchLcdSetup, benchTftText, benchSpiTeardown, NULL, 4},
+    {"sd_write_4k", benchSdSetup, benchSdWrite, benchSdTeardown, NULL, 1},
+    {"dps310_read", benchDpsSetup, benchDpsRead, NULL, NULL, 1},
+    {"pca9555_toggle", benchPcaSetup, benchPcaToggle, benchPcaTeardown, NULL, 4},
+    {"heap_256", NULL, benchHeap, NULL, NULL, 64},
+};
+
+void benchPrint(const char *text)
+{
+    Serial.print(text);
+}
+
+/**
+ * @brief 运行全部微基准并打印表格（在 loop() 中阻塞运行约 1 秒，IMU 接收任务照常工作）
+ */
+void runMicrobench()
+{
+    if (benchHi91.len == 0)
+    {
+        benchHi91.len = hipnuc_synth_hi91(benchHi91.data, sizeof(benchHi91.data), 1);
+        benchHi83.len = hipnuc_synth_hi83(benchHi83.data, sizeof(benchHi83.data), HIPNUC_SYNTH_HI83_TYPICAL, 1);
+        for (size_t i = 0; i < sizeof(benchBuf); i++)
+            benchBuf[i] = (uint8_t)(i * 7);
+    }
+
+    microbench_cfg_t cfg = {prof_ticks, (uint32_t)ESP.getCpuFreqMHz(), BENCH_WARMUP, BENCH_REPS};
+    uint32_t t0 = millis();
+    Serial.printf("\n========== 微基准（%lu MHz，预热 %d 批，计时 %d 批，取中位数）==========\n", cfg.ticks_per_us,
+                  BENCH_WARMUP, BENCH_REPS);
+    int done = microbench_suite(benches, sizeof(benches) / sizeof(benches[0]), &cfg, benchPrint);
+    Serial.printf("完成 %d/%u 项，用时 %lu ms\n", done, (unsigned)(sizeof(benches) / sizeof(benches[0])),
+                  millis() - t0);
+    Serial.println("================================================================\n");
+}
+
+// ==================== 串口命令处理 ====================
+void processSerialCommand()
+{
+    if (Serial.available())
+    {
+        StageScope stage(PROF_COMMAND);
+        char cmd = Serial.read();
+        while (Serial.available())
+            Serial.read(); // 清空缓冲区
+
+        switch (cmd)
+        {
+        case 'd':
+        case 'D':
+            Serial.println("\n执行详细数据输出...");
+            displayDetailedData();
+            break;
+
+        case 'i':
+        case 'I':
+            printSystemInfo();
+            break;
+
+        case 'r':
+        case 'R':
+            Serial.println("正在重启ESP32...");
+            delay(500);
+            ESP.restart();
+            break;
+
+        case 's':
+        case 'S':
+            printStatistics();
+            break;
+
+        case 'b':
+        case 'B':
+            printBootTimeline();
+            break;
+
+        case 'p':
+        case 'P':
+            printProfile();
+            break;
+
+        case 'v':
+        case 'V':
+            printChannelStats();
+            break;
+
+        case 'z':
+        case 'Z':
+            portENTER_CRITICAL(&imuMux);
+            for (int i = 0; i < STAT_COUNT; i++)
+                run_stats_reset(&stats[i]);
+            portEXIT_CRITICAL(&imuMux);
+            Serial.println("通道统计已清零");
+            break;
+
+        case 'j':
+        case 'J':
+            printJournal("崩溃日志（本次运行）");
+            break;
+
+        case 'x':
+        case 'X':
+            blackboxTrigger(BB_TRIG_COMMAND);
+            break;
+
+        case 'f':
+        case 'F':
+            printFlashLog();
+            break;
+
+        case 'm':
+        case 'M':
+            runMicrobench();
+            break;
+
+        case 'e':
+        case 'E':
+            exportFlashLog();
+            break;
+
+        case 'a':
+        case 'A':
+        {
+            ahrs_algo_t next = ahrs.algo == AHRS_MAHONY ? AHRS_MADGWICK : AHRS_MAHONY;
+            portENTER_CRITICAL(&imuMux);
+            memset(&ahrsStats, 0, sizeof(ahrsStats));
+            portEXIT_CRITICAL(&imuMux);
+            ahrsSwitchTo = next; // 下一帧在接收上下文中重新初始化并对准
+            Serial.printf("AHRS 切换为 %s\n", next == AHRS_MADGWICK ? "Madgwick" : "Mahony");
+            break;
+        }
+
+        case 'h':
+        case 'H':
+            Serial.println("\n========== 命令帮助 ==========");
+            Serial.println("  d - 显示详细数据(JSON格式)");
+            Serial.println("  i - 显示系统信息");
+            Serial.println("  s - 显示统计信息");
+            Serial.println("  b - 显示启动时间线");
+            Serial.println("  p - 显示分段耗时统计（并清零）");
+            Serial.println("  v - 显示传感器通道统计（窗口 / 累计）");
+            Serial.println("  z - 清零传感器通道统计");
+            Serial.println("  j - 显示崩溃日志（本次运行最近几秒）");
+            Serial.println("  x - 触发黑匣子（保存触发前后的数据到 SD 卡，无卡时写入 Flash 日志）");
+            Serial.println("  f - 显示 Flash 日志状态和保存的快照");
+            Serial.println("  e - 导出 Flash 日志中的快照（二进制，FLASHLOG 标记分隔）");
+            Serial.println("  a - 切换板载 AHRS 算法（Mahony / Madgwick）");
+            Serial.println("  m - 运行微基准（解码 / CRC / 格式化 / LCD / SD / I2C / 堆，约 1 秒）");
+            Serial.println("  r - 重启ESP32");
+            Serial.println("  h - 显示帮助信息");
+            Serial.println("==============================\n");
+            break;
+
+        default:
+            Serial.println("未知命令，输入 'h' 查看帮助");
+            break;
+        }
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    // 初始化串口
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    // 先导出上次运行的崩溃日志，再开始本次记录
+    initCrashJournal();
+
+    // 时间线零点为应用启动时刻（micros() 从 0 开始计时）
+    boot_seq_init(&boot, 0);
+    for (size_t i = 0; i < sizeof(bootSteps) / sizeof(bootSteps[0]); i++)
+        boot_seq_add(&boot, bootSteps[i].name, bootSteps[i].deps);
+
+    // 初始化解码器
+    memset(&hipnuc_raw, 0, sizeof(hipnuc_raw_t));
+    hipnuc_sync_init(&imuSync);
+    for (int i = 0; i < RATE_COUNT; i++)
+        rate_est_init(&rates[i], rateNames[i]);
+    rx_meter_init(&imuMeter, ESP.getCpuFreqMHz(), micros());
+    initChannelStats();
+    initProfiler();
+    initBlackbox();
+    spiBusLock = xSemaphoreCreateMutex();
+    flashLogLock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(blackboxTask, "blackbox", 4096, NULL, 1, NULL, 0);
+
+    // 按依赖启动外设初始化，LCD / DPS310 / SD 卡在后台任务中继续
+    bootPoll();
+
+    Serial.printf("\n✓ 数据采集已启动（+%lu ms，LCD/DPS310 后台初始化中）\n", millis());
+    Serial.println("========================================\n");
 
     setLEDStatus(1);
     lastSecond = millis();
     lastDisplay = millis();
     lastLCDUpdate = millis();
     lastDPSRead = millis();
+    lastJournal = millis();
 }
 
 // ==================== Loop ====================
 void loop()
 {
     unsigned long now = millis();
+    uint32_t loopStart = prof_ticks();
+    crash_journal_enter(&journal, PROF_LOOP);
+
+    // 推进后台初始化
+    bootPoll();
 
     // 读取DPS310数据
-    readDPS310();
+    if (bootStepDone(BOOT_DPS310))
+        readDPS310();
 
-    // 读取并解码IMU数据
-    while (Serial2.available())
+    // 读取并解码IMU数据（事件驱动时由 imuRxTask 完成，这里只取最新帧）
     {
-        uint8_t data = Serial2.read();
-
-        // 输入解码器
-        if (hipnuc_input(&hipnuc_raw, data) > 0)
+        StageScope stage(PROF_IMU_DECODE);
+#if !IMU_EVENT_DRIVEN
+        imuPoll();
+#endif
+        if (imuFetch())
         {
-            frameCount++;
+            if (!firstFrameLogged)
+            {
+                uint32_t t = imuLatest.first_us;
+                portENTER_CRITICAL(&bootMux);
+                boot_seq_first_frame(&boot, t);
+                portEXIT_CRITICAL(&bootMux);
+                firstFrameLogged = true;
+                Serial.printf("✓ 首帧IMU数据: 启动后 %.1f ms\n", t / 1000.0);
+            }
             // playDataReceivedBeep();  // 可选：每次接收数据时蜂鸣
         }
     }
 
-    // 每秒计算一次FPS
+    // 每秒检查一次IMU数据是否中断
     if (now - lastSecond >= 1000)
     {
-        currentFPS = frameCount;
-        frameCount = 0;
         lastSecond = now;
 
-        // 如果FPS为0，显示警告
-        if (currentFPS == 0)
+        // 超过 1 秒没有IMU帧，显示警告；收到过数据后中断时报警并触发黑匣子一次
+        // （上电后还没有第一帧时只亮警告灯，不抢占开机提示音）
+        static bool dataLost = false;
+        rate_est_snapshot_t imu;
+        portENTER_CRITICAL(&imuMux);
+        rate_est_snapshot(&rates[RATE_IMU], micros(), &imu);
+        portEXIT_CRITICAL(&imuMux);
+        if (imu.samples == 0 || imu.age_us > 1000000)
         {
             setLEDStatus(4);
+            if (!dataLost && imu.samples > 0)
+            {
+                buzzerPlay(&MELODY_ALARM);
+                blackboxTrigger(BB_TRIG_LINK_LOSS);
+            }
+            dataLost = true;
+        }
+        else
+        {
+            dataLost = false;
         }
     }
 
     // 定时显示数据到串口（10Hz）
     if (now - lastDisplay >= DISPLAY_INTERVAL)
     {
+        StageScope stage(PROF_SERIAL_OUT);
         displayCompactData();
         lastDisplay = now;
     }
 
-    // 定时更新LCD显示（20Hz）
-    if (now - lastLCDUpdate >= LCD_UPDATE_INTERVAL)
+    // 定时更新LCD显示（20Hz）；黑匣子正在写 SD 卡时跳过本帧
+    if (now - lastLCDUpdate >= LCD_UPDATE_INTERVAL && bootStepDone(BOOT_LCD) &&
+        xSemaphoreTake(spiBusLock, 0) == pdTRUE)
     {
+        StageScope stage(PROF_LCD_UPDATE);
         updateLCDDisplay();
+        xSemaphoreGive(spiBusLock);
         lastLCDUpdate = now;
     }
 
+    // 处理按键事件
+    {
+        StageScope stage(PROF_BUTTONS);
+        handleButtonEvents();
+    }
+
     // 处理串口命令
     processSerialCommand();
 
+    stageLeave(PROF_LOOP, loopStart);
+
+    // 崩溃日志每 100ms 提交一条
+    if (now - lastJournal >= JOURNAL_PERIOD_MS)
+    {
+        lastJournal = now;
+        journalCommit();
+    }
     delay(1);
 }
@@ -0,0 +1,140 @@
+/**
+ * @file microbench.c
+ * @brief 微基准注册表实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "microbench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TABLE_WIDTH 87 // 各列宽度与分隔空格之和
+
+static const char rule[] = "------------------------------------------------------------------------------------------";
+
+/* 连续两次读取计数器的最小差值 */
+static uint32_t timer_overhead(const microbench_cfg_t *cfg)
+{
+    uint32_t best = 0xFFFFFFFFu;
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        uint32_t t0 = cfg->ticks();
+        uint32_t dt = cfg->ticks() - t0;
+        if (dt < best)
+            best = dt;
+    }
+    return best;
+}
+
+int microbench_run(const microbench_t *b, const microbench_cfg_t *cfg, microbench_result_t *r)
+{
+    uint32_t samples[MICROBENCH_MAX_REPS];
+    uint16_t batch = b->batch > 0 ? b->batch : 1;
+    uint16_t reps = cfg->reps > MICROBENCH_MAX_REPS ? MICROBENCH_MAX_REPS : cfg->reps;
+    uint32_t i, k;
+
+    memset(r, 0, sizeof(microbench_result_t));
+    if (b->setup && b->setup(b->ctx) != 0)
+    {
+        r->skipped = 1;
+        return 1;
+    }
+    if (reps == 0)
+        reps = 1;
+
+    r->overhead = timer_overhead(cfg);
+    for (i = 0; i < cfg->warmup; i++)
+        for (k = 0; k < batch; k++)
+            r->bytes = b->run(b->ctx);
+
+    for (i = 0; i < reps; i++)
+    {
+        uint32_t t0 = cfg->ticks(), dt;
+        for (k = 0; k < batch; k++)
+            r->bytes = b->run(b->ctx);
+        dt = cfg->ticks() - t0;
+        dt = dt > r->overhead ? dt - r->overhead : 0;
+        samples[i] = (dt + batch / 2) / batch;
+    }
+    if (b->teardown)
+        b->teardown(b->ctx);
+
+    // 插入排序（最多 64 个样本）
+    for (i = 1; i < reps; i++)
+    {
+        uint32_t v = samples[i];
+        for (k = i; k > 0 && samples[k - 1] > v; k--)
+            samples[k] = samples[k - 1];
+        samples[k] = v;
+    }
+    r->reps = reps;
+    r->min = samples[0];
+    r->max = samples[reps - 1];
+    r->median = reps % 2 ? samples[reps / 2] : (samples[reps / 2 - 1] + samples[reps / 2] + 1) / 2;
+    return 0;
+}
+
+int microbench_format_header(char *buf, size_t buf_size)
+{
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    ret = snprintf(buf, buf_size, "  %-16s %11s %10s %10s %10s %10s %14s\n  %.*s\n", "name", "batch x rep",
+                   "cyc/op", "cyc_min", "cyc_max", "us/op", "throughput", TABLE_WIDTH, rule);
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)buf_size - 1 : ret;
+}
+
+int microbench_format_row(const microbench_t *b, const microbench_result_t *r, uint32_t ticks_per_us, char *buf,
+                          size_t buf_size)
+{
+    char rate[24], count[16];
+    double us;
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    if (r->skipped)
+    {
+        ret = snprintf(buf, buf_size, "  %-16s 跳过（未就绪）\n", b->name);
+    }
+    else
+    {
+        us = (double)r->median / (ticks_per_us > 0 ? ticks_per_us : 1);
+        if (us <= 0.0)
+            snprintf(rate, sizeof(rate), "-");
+        else if (r->bytes > 0)
+            snprintf(rate, sizeof(rate), "%.2f MB/s", r->bytes / us); // 字节 / us 即 MB/s
+        else
+            snprintf(rate, sizeof(rate), "%.0f op/s", 1e6 / us);
+        snprintf(count, sizeof(count), "%u x %u", b->batch > 0 ? b->batch : 1, r->reps);
+        ret = snprintf(buf, buf_size, "  %-16s %11s %10lu %10lu %10lu %10.2f %14s\n", b->name, count,
+                       (unsigned long)r->median, (unsigned long)r->min, (unsigned long)r->max, us, rate);
+    }
+    if (ret < 0)
+        return 0;
+    return (size_t)ret >= buf_size ? (int)buf_size - 1 : ret;
+}
+
+int microbench_suite(const microbench_t *list, int n, const microbench_cfg_t *cfg, void (*print)(const char *text))
+{
+    char line[256];
+    microbench_result_t r;
+    int i, done = 0;
+
+    microbench_format_header(line, sizeof(line));
+    print(line);
+    for (i = 0; i < n; i++)
+    {
+        if (microbench_run(&list[i], cfg, &r) == 0)
+            done++;
+        microbench_format_row(&list[i], &r, cfg->ticks_per_us, line, sizeof(line));
+        print(line);
+    }
+    return done;
+}
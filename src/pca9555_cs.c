@@ -0,0 +1,97 @@
+/**
+ * @file pca9555_cs.c
+ * @brief PCA9555 影子寄存器片选驱动实现
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#include "pca9555_cs.h"
+
+/* 一次写传输：器件地址 + 寄存器 + 数据 */
+static int bus_write(pca9555_cs_t *cs, uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    cs->stats.writes++;
+    cs->stats.bytes += 2u + len;
+    if (cs->write(cs->ctx, reg, data, len) != 0)
+    {
+        cs->stats.errors++;
+        return -1;
+    }
+    return 0;
+}
+
+int pca9555_cs_init(pca9555_cs_t *cs, uint16_t cs_mask, pca9555_write_fn write, void *ctx)
+{
+    uint8_t cfg[2];
+
+    cs->write = write;
+    cs->ctx = ctx;
+    cs->cs_mask = cs_mask;
+    cs->out[0] = 0xFF;
+    cs->out[1] = 0xFF;
+    cs->stats.writes = 0;
+    cs->stats.bytes = 0;
+    cs->stats.skipped = 0;
+    cs->stats.errors = 0;
+
+    // 先写输出寄存器再切换方向，引脚变为输出时已经是高电平，不会误选中
+    cfg[0] = (uint8_t)~cs_mask;
+    cfg[1] = (uint8_t)(~cs_mask >> 8);
+    if (bus_write(cs, PCA9555_REG_OUTPUT0, cs->out, 2) != 0)
+        return -1;
+    return bus_write(cs, PCA9555_REG_CONFIG0, cfg, 2);
+}
+
+int pca9555_cs_write16(pca9555_cs_t *cs, uint16_t value)
+{
+    uint8_t next[2];
+    int rc;
+
+    next[0] = (uint8_t)value;
+    next[1] = (uint8_t)(value >> 8);
+
+    if (next[0] != cs->out[0] && next[1] != cs->out[1])
+        rc = bus_write(cs, PCA9555_REG_OUTPUT0, next, 2);
+    else if (next[0] != cs->out[0])
+        rc = bus_write(cs, PCA9555_REG_OUTPUT0, &next[0], 1);
+    else if (next[1] != cs->out[1])
+        rc = bus_write(cs, PCA9555_REG_OUTPUT0 + 1, &next[1], 1);
+    else
+    {
+        cs->stats.skipped++;
+        return 0;
+    }
+
+    if (rc != 0)
+        return -1;
+    cs->out[0] = next[0];
+    cs->out[1] = next[1];
+    return 0;
+}
+
+int pca9555_cs_write_pin(pca9555_cs_t *cs, uint8_t pin, uint8_t level)
+{
+    uint16_t v = pca9555_cs_shadow(cs);
+
+    if (pin > 15)
+        return -1;
+    v = level ? (uint16_t)(v | (1u << pin)) : (uint16_t)(v & ~(1u << pin));
+    return pca9555_cs_write16(cs, v);
+}
+
+int pca9555_cs_select(pca9555_cs_t *cs, uint8_t pin)
+{
+    if (pin > 15)
+        return -1;
+    return pca9555_cs_write16(cs, (uint16_t)((pca9555_cs_shadow(cs) | cs->cs_mask) & ~(1u << pin)));
+}
+
+int pca9555_cs_release(pca9555_cs_t *cs)
+{
+    return pca9555_cs_write16(cs, (uint16_t)(pca9555_cs_shadow(cs) | cs->cs_mask));
+}
+
+uint16_t pca9555_cs_shadow(const pca9555_cs_t *cs)
+{
+    return (uint16_t)(cs->out[0] | (cs->out[1] << 8));
+}
@@ -0,0 +1,99 @@
+/**
+ * @file pca9555_input.c
+ * @brief PCA9555 中断驱动输入服务实现
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#include "pca9555_input.h"
+#include <string.h>
+
+static void push_event(pca9555_in_t *in, uint8_t pin, uint8_t level, uint32_t t_us)
+{
+    uint8_t next = (uint8_t)((in->head + 1) & (PCA9555_IN_QUEUE_LEN - 1));
+
+    if (next == in->tail)
+    {
+        in->stats.overflow++;
+        return;
+    }
+    in->queue[in->head].pin = pin;
+    in->queue[in->head].level = level;
+    in->queue[in->head].t_us = t_us;
+    in->head = next;
+    in->stats.events++;
+}
+
+void pca9555_in_init(pca9555_in_t *in, uint16_t mask, uint16_t initial, uint32_t debounce_us)
+{
+    memset(in, 0, sizeof(pca9555_in_t));
+    in->mask = mask;
+    in->raw = initial & mask;
+    in->stable = initial & mask;
+    in->debounce_us = debounce_us;
+}
+
+void pca9555_in_update(pca9555_in_t *in, uint16_t port, uint32_t now_us)
+{
+    uint16_t changed;
+    int pin;
+
+    in->stats.reads++;
+    port &= in->mask;
+    changed = port ^ in->raw;
+    in->raw = port;
+
+    for (pin = 0; changed; pin++, changed >>= 1)
+    {
+        if (!(changed & 1))
+            continue;
+        in->stats.edges++;
+        if (!(in->pending & (1u << pin)))
+        {
+            in->pending |= (uint16_t)(1u << pin);
+            in->first_us[pin] = now_us;
+        }
+        in->last_us[pin] = now_us; // 每次抖动重新计时
+    }
+}
+
+int pca9555_in_poll(pca9555_in_t *in, uint32_t now_us)
+{
+    uint16_t pend = in->pending;
+    int pin, n = 0;
+
+    for (pin = 0; pend; pin++, pend >>= 1)
+    {
+        uint16_t bit = (uint16_t)(1u << pin);
+
+        if (!(pend & 1) || now_us - in->last_us[pin] < in->debounce_us)
+            continue;
+
+        in->pending &= (uint16_t)~bit;
+        if ((in->raw ^ in->stable) & bit)
+        {
+            in->stable ^= bit;
+            push_event(in, (uint8_t)pin, (in->stable & bit) ? 1 : 0, in->first_us[pin]);
+            n++;
+        }
+        else
+        {
+            in->stats.bounces++;
+        }
+    }
+    return n;
+}
+
+int pca9555_in_busy(const pca9555_in_t *in)
+{
+    return in->pending != 0;
+}
+
+int pca9555_in_pop(pca9555_in_t *in, pca9555_in_event_t *ev)
+{
+    if (in->tail == in->head)
+        return 0;
+    *ev = in->queue[in->tail];
+    in->tail = (uint8_t)((in->tail + 1) & (PCA9555_IN_QUEUE_LEN - 1));
+    return 1;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file rate_est.c
+ * @brief 单数据源帧率 / 抖动 / 链路质量估计实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "rate_est.h"
+#include <stdio.h>
+#include <string.h>
+
+// 抖动直方图上界（百分比），最后两个桶为 >50% 和间断
+static const uint8_t hist_edges[RATE_EST_HIST_BINS - 2] = {1, 2, 5, 10, 20, 50};
+
+void rate_est_init(rate_est_t *r, const char *name)
+{
+    memset(r, 0, sizeof(rate_est_t));
+    r->name = name;
+}
+
+void rate_est_reset(rate_est_t *r)
+{
+    rate_est_init(r, r->name);
+}
+
+static void hist_add(rate_est_t *r, float dev)
+{
+    uint8_t i;
+
+    for (i = 0; i < RATE_EST_HIST_BINS - 2; i++)
+    {
+        if (dev * 100.0f <= hist_edges[i] * r->avg_dt_us)
+        {
+            r->hist[i]++;
+            return;
+        }
+    }
+    r->hist[RATE_EST_HIST_BINS - 2]++;
+}
+
+void rate_est_sample(rate_est_t *r, uint32_t t_us, uint16_t bytes)
+{
+    uint32_t dt = t_us - r->last_us;
+
+    r->last_us = t_us;
+    r->bytes += bytes;
+    if (r->samples++ == 0)
+        return;
+
+    if (dt > r->dt_max_us)
+        r->dt_max_us = dt;
+
+    if (r->avg_dt_us <= 0.0f)
+    {
+        r->avg_dt_us = (float)dt;
+        return;
+    }
+
+    if ((float)dt > RATE_EST_GAP_FACTOR * r->avg_dt_us)
+    {
+        r->gaps++;
+        r->missed += (uint32_t)((float)dt / r->avg_dt_us + 0.5f) - 1;
+        r->hist[RATE_EST_HIST_BINS - 1]++;
+        if (++r->gap_run >= RATE_EST_RELOCK)
+        {
+            // 数据源降频：以新间隔重新开始
+            r->avg_dt_us = (float)dt;
+            r->jitter_us = 0.0f;
+            r->gap_run = 0;
+        }
+        return;
+    }
+    r->gap_run = 0;
+
+    {
+        float dev = (float)dt - r->avg_dt_us;
+        if (dev < 0.0f)
+            dev = -dev;
+        hist_add(r, dev);
+        r->jitter_us += (dev - r->jitter_us) / (float)(1 << RATE_EST_ALPHA_SHIFT);
+        r->avg_dt_us += ((float)dt - r->avg_dt_us) / (float)(1 << RATE_EST_ALPHA_SHIFT);
+    }
+}
+
+void rate_est_error(rate_est_t *r, uint32_t count)
+{
+    r->errors += count;
+}
+
+float rate_est_hz(const rate_est_t *r, uint32_t now_us)
+{
+    float dt = r->avg_dt_us;
+    uint32_t age;
+
+    if (r->samples < 2 || dt <= 0.0f)
+        return 0.0f;
+    age = now_us - r->last_us;
+    if ((float)age > dt)
+        dt = (float)age;
+    return 1e6f / dt;
+}
+
+void rate_est_snapshot(const rate_est_t *r, uint32_t now_us, rate_est_snapshot_t *out)
+{
+    out->hz = rate_est_hz(r, now_us);
+    out->avg_dt_us = r->avg_dt_us;
+    out->jitter_us = r->jitter_us;
+    out->bytes_per_frame = r->samples ? (float)r->bytes / (float)r->samples : 0.0f;
+    out->age_us = r->samples ? now_us - r->last_us : 0;
+    out->samples = r->samples;
+    out->errors = r->errors;
+    out->gaps = r->gaps;
+    out->missed = r->missed;
+    out->dt_max_us = r->dt_max_us;
+}
+
+int rate_est_format(const rate_est_t *r, uint32_t now_us, char *buf, size_t buf_size)
+{
+    rate_est_snapshot_t s;
+    size_t written = 0;
+    int ret;
+    uint8_t i;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+    rate_est_snapshot(r, now_us, &s);
+
+    ret = snprintf(buf, buf_size,
+                   "%-8s %7.1f Hz | 间隔 %.2f ms ±%.0f us, 最大 %.2f ms | 样本 %lu, 间断 %lu, 估计漏 %lu, 错误 %lu | %.1f B/帧\n",
+                   r->name ? r->name : "?", s.hz, s.avg_dt_us / 1000.0f, s.jitter_us, s.dt_max_us / 1000.0f,
+                   (unsigned long)s.samples, (unsigned long)s.gaps, (unsigned long)s.missed,
+                   (unsigned long)s.errors, s.bytes_per_frame);
+    written += ret > 0 ? (size_t)ret : 0;
+
+    if (written < buf_size && r->samples > 1)
+    {
+        ret = snprintf(buf + written, buf_size - written, "         抖动:");
+        written += ret > 0 ? (size_t)ret : 0;
+        for (i = 0; i < RATE_EST_HIST_BINS && written < buf_size; i++)
+        {
+            if (i < RATE_EST_HIST_BINS - 2)
+                ret = snprintf(buf + written, buf_size - written, " ≤%u%% %lu", hist_edges[i], (unsigned long)r->hist[i]);
+            else if (i == RATE_EST_HIST_BINS - 2)
+                ret = snprintf(buf + written, buf_size - written, " >50%% %lu", (unsigned long)r->hist[i]);
+            else
+                ret = snprintf(buf + written, buf_size - written, " | 间断 %lu\n", (unsigned long)r->hist[i]);
+            written += ret > 0 ? (size_t)ret : 0;
+        }
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
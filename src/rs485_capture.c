@@ -0,0 +1,88 @@
+/**
+ * @file rs485_capture.c
+ * @brief RCAP 录制格式实现
+ * @version 1.0
+ * @date 2026-02-07
+ */
+
+#include "rs485_capture.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void rcap_encode_header(uint8_t out[RCAP_HEADER_SIZE], uint32_t baud)
+{
+    memcpy(out, "RCAP", 4);
+    put_u16(out + 4, RCAP_VERSION);
+    put_u16(out + 6, 0);
+    put_u32(out + 8, baud);
+}
+
+int rcap_decode_header(const uint8_t in[RCAP_HEADER_SIZE], uint32_t *baud)
+{
+    if (memcmp(in, "RCAP", 4) != 0 || get_u16(in + 4) != RCAP_VERSION)
+        return 0;
+    *baud = get_u32(in + 8);
+    return 1;
+}
+
+void rcap_encode_record_hdr(uint8_t out[RCAP_RECORD_HDR_SIZE], uint32_t t_us, uint16_t len)
+{
+    put_u32(out, t_us);
+    put_u16(out + 4, len);
+}
+
+void rcap_decode_record_hdr(const uint8_t in[RCAP_RECORD_HDR_SIZE], uint32_t *t_us, uint16_t *len)
+{
+    *t_us = get_u32(in);
+    *len = get_u16(in + 4);
+}
+
+int rcap_reader_init(rcap_reader_t *r, const uint8_t *buf, size_t size)
+{
+    memset(r, 0, sizeof(rcap_reader_t));
+    if (size < RCAP_HEADER_SIZE || !rcap_decode_header(buf, &r->baud))
+        return 0;
+    r->buf = buf;
+    r->size = size;
+    r->pos = RCAP_HEADER_SIZE;
+    return 1;
+}
+
+int rcap_reader_next(rcap_reader_t *r, uint32_t *t_us, const uint8_t **data, uint16_t *len)
+{
+    if (r->pos >= r->size)
+        return 0;
+    if (r->size - r->pos < RCAP_RECORD_HDR_SIZE)
+        return -1;
+
+    rcap_decode_record_hdr(r->buf + r->pos, t_us, len);
+    if (r->size - r->pos - RCAP_RECORD_HDR_SIZE < *len)
+        return -1;
+
+    *data = r->buf + r->pos + RCAP_RECORD_HDR_SIZE;
+    r->pos += RCAP_RECORD_HDR_SIZE + *len;
+    return 1;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file run_stats.c
+ * @brief 单通道流式统计实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "run_stats.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+void run_stats_acc_clear(run_stats_acc_t *a)
+{
+    memset(a, 0, sizeof(run_stats_acc_t));
+}
+
+/* d 为参与均值/方差计算的值（已减去偏移），x 为原始样本（最小/最大值保持精确） */
+static void acc_add(run_stats_acc_t *a, float x, float d)
+{
+    float delta;
+
+    if (a->n == 0)
+    {
+        a->n = 1;
+        a->mean = d;
+        a->m2 = 0.0f;
+        a->min = x;
+        a->max = x;
+        return;
+    }
+    a->n++;
+    delta = d - a->mean;
+    a->mean += delta / (float)a->n;
+    a->m2 += delta * (d - a->mean);
+    if (x < a->min)
+        a->min = x;
+    if (x > a->max)
+        a->max = x;
+}
+
+void run_stats_acc_add(run_stats_acc_t *a, float x)
+{
+    acc_add(a, x, x);
+}
+
+void run_stats_acc_merge(run_stats_acc_t *dst, const run_stats_acc_t *src)
+{
+    float na, nb, n, delta;
+
+    if (src->n == 0)
+        return;
+    if (dst->n == 0)
+    {
+        *dst = *src;
+        return;
+    }
+    na = (float)dst->n;
+    nb = (float)src->n;
+    n = na + nb;
+    delta = src->mean - dst->mean;
+    dst->mean += delta * (nb / n);
+    dst->m2 += src->m2 + delta * delta * (na / n) * nb;
+    dst->n += src->n;
+    if (src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+float run_stats_acc_var(const run_stats_acc_t *a)
+{
+    if (a->n < 2)
+        return 0.0f;
+    return a->m2 / (float)(a->n - 1);
+}
+
+float run_stats_acc_std(const run_stats_acc_t *a)
+{
+    return sqrtf(run_stats_acc_var(a));
+}
+
+void run_stats_init(run_stats_t *s, const char *name, const char *unit, uint16_t block_len, uint8_t blocks)
+{
+    memset(s, 0, sizeof(run_stats_t));
+    s->name = name;
+    s->unit = unit;
+    s->block_len = block_len > 0 ? block_len : 1;
+    s->blocks = blocks == 0 ? 1 : (blocks > RUN_STATS_MAX_BLOCKS ? RUN_STATS_MAX_BLOCKS : blocks);
+}
+
+void run_stats_reset(run_stats_t *s)
+{
+    run_stats_init(s, s->name, s->unit, s->block_len, s->blocks);
+}
+
+void run_stats_add(run_stats_t *s, float x)
+{
+    if (!isfinite(x))
+    {
+        s->rejected++;
+        return;
+    }
+    if (s->total.n == 0 && s->cur.n == 0)
+        s->shift = x;
+    acc_add(&s->cur, x, x - s->shift);
+    if (s->cur.n < s->block_len)
+        return;
+
+    // 块满：合并进累计，压入环形队列
+    run_stats_acc_merge(&s->total, &s->cur);
+    s->ring[s->head] = s->cur;
+    s->head = (uint8_t)((s->head + 1) % s->blocks);
+    if (s->filled < s->blocks)
+        s->filled++;
+    run_stats_acc_clear(&s->cur);
+}
+
+void run_stats_window(const run_stats_t *s, run_stats_acc_t *out)
+{
+    uint8_t i;
+
+    // 当前块非空时丢掉最旧的完整块，窗口长度不超过 blocks × block_len
+    uint8_t skip = (s->cur.n > 0 && s->filled == s->blocks) ? 1 : 0;
+    uint8_t idx = (uint8_t)((s->head + s->blocks - s->filled + skip) % s->blocks);
+
+    run_stats_acc_clear(out);
+    for (i = skip; i < s->filled; i++)
+    {
+        run_stats_acc_merge(out, &s->ring[idx]);
+        idx = (uint8_t)((idx + 1) % s->blocks);
+    }
+    run_stats_acc_merge(out, &s->cur);
+    out->mean += s->shift;
+}
+
+void run_stats_total(const run_stats_t *s, run_stats_acc_t *out)
+{
+    *out = s->total;
+    run_stats_acc_merge(out, &s->cur);
+    out->mean += s->shift;
+}
+
+static int format_acc(const run_stats_acc_t *a, char *buf, size_t buf_size)
+{
+    if (a->n == 0)
+        return snprintf(buf, buf_size, "n=0");
+    return snprintf(buf, buf_size, "n=%lu %.6g ±%.3g [%.6g, %.6g]", (unsigned long)a->n, a->mean,
+                    run_stats_acc_std(a), a->min, a->max);
+}
+
+int run_stats_format(const run_stats_t *s, char *buf, size_t buf_size)
+{
+    run_stats_acc_t a;
+    size_t written = 0;
+    int ret;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+
+    ret = snprintf(buf, buf_size, "%-10s %-4s | 窗口 ", s->name ? s->name : "?", s->unit ? s->unit : "");
+    written += ret > 0 ? (size_t)ret : 0;
+    if (written < buf_size)
+    {
+        run_stats_window(s, &a);
+        ret = format_acc(&a, buf + written, buf_size - written);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+    if (written < buf_size)
+    {
+        ret = snprintf(buf + written, buf_size - written, " | 累计 ");
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+    if (written < buf_size)
+    {
+        run_stats_total(s, &a);
+        ret = format_acc(&a, buf + written, buf_size - written);
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+    if (written < buf_size)
+    {
+        ret = s->rejected ? snprintf(buf + written, buf_size - written, " | 无效 %lu\n", (unsigned long)s->rejected)
+                          : snprintf(buf + written, buf_size - written, "\n");
+        written += ret > 0 ? (size_t)ret : 0;
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file rx_meter.c
+ * @brief 接收路径测量实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "rx_meter.h"
+#include <stdio.h>
+#include <string.h>
+
+// 延迟直方图上界（us），最后一个桶为 >20ms
+static const uint32_t lat_edges[RX_METER_LAT_BINS - 1] = {250, 500, 1000, 2000, 5000, 10000, 20000};
+
+void rx_meter_init(rx_meter_t *m, uint32_t ticks_per_us, uint32_t now_us)
+{
+    memset(m, 0, sizeof(rx_meter_t));
+    m->ticks_per_us = ticks_per_us ? ticks_per_us : 1;
+    m->start_us = now_us;
+}
+
+void rx_meter_reset(rx_meter_t *m, uint32_t now_us)
+{
+    rx_meter_init(m, m->ticks_per_us, now_us);
+}
+
+void rx_meter_busy(rx_meter_t *m, uint32_t ticks, uint32_t bytes)
+{
+    m->busy_ticks += ticks;
+    m->calls++;
+    if (bytes == 0)
+        m->idle_calls++;
+    m->bytes += bytes;
+}
+
+void rx_meter_frame(rx_meter_t *m, uint32_t rx_us, uint32_t src_us)
+{
+    uint32_t offset = rx_us - src_us;
+    uint32_t lat;
+    uint8_t i;
+
+    m->frames++;
+    if (!m->offset_valid || (int32_t)(offset - m->offset_min) < 0)
+    {
+        m->offset_min = offset;
+        m->offset_valid = 1;
+    }
+    lat = offset - m->offset_min;
+
+    if (lat > m->lat_max_us)
+        m->lat_max_us = lat;
+    m->lat_sum_us += lat;
+    for (i = 0; i < RX_METER_LAT_BINS - 1 && lat > lat_edges[i]; i++)
+        ;
+    m->lat_hist[i]++;
+}
+
+uint32_t rx_meter_cpu_permille(const rx_meter_t *m, uint32_t now_us)
+{
+    uint32_t span = now_us - m->start_us;
+
+    if (span == 0)
+        return 0;
+    return (uint32_t)(m->busy_ticks * 1000ULL / m->ticks_per_us / span);
+}
+
+int rx_meter_format(const rx_meter_t *m, uint32_t now_us, char *buf, size_t buf_size)
+{
+    uint32_t span = now_us - m->start_us;
+    uint32_t cpu = rx_meter_cpu_permille(m, now_us);
+    size_t written = 0;
+    int ret;
+    uint8_t i;
+
+    if (buf_size == 0)
+        return 0;
+    buf[0] = '\0';
+
+    ret = snprintf(buf, buf_size,
+                   "区间 %.1f s | CPU %lu.%lu%% | 执行 %lu 次（空 %lu），平均 %.1f us | %lu 字节, %lu 帧\n",
+                   span / 1e6, (unsigned long)(cpu / 10), (unsigned long)(cpu % 10),
+                   (unsigned long)m->calls, (unsigned long)m->idle_calls,
+                   m->calls ? (double)m->busy_ticks / m->ticks_per_us / m->calls : 0.0,
+                   (unsigned long)m->bytes, (unsigned long)m->frames);
+    written += ret > 0 ? (size_t)ret : 0;
+
+    if (written < buf_size && m->frames > 0)
+    {
+        ret = snprintf(buf + written, buf_size - written, "交付延迟（相对最快一帧）avg %.2f / max %.2f ms:",
+                       (double)m->lat_sum_us / m->frames / 1000.0, m->lat_max_us / 1000.0);
+        written += ret > 0 ? (size_t)ret : 0;
+        for (i = 0; i < RX_METER_LAT_BINS && written < buf_size; i++)
+        {
+            if (i < RX_METER_LAT_BINS - 1)
+                ret = snprintf(buf + written, buf_size - written, " ≤%g %lu", lat_edges[i] / 1000.0,
+                               (unsigned long)m->lat_hist[i]);
+            else
+                ret = snprintf(buf + written, buf_size - written, " >20 %lu\n", (unsigned long)m->lat_hist[i]);
+            written += ret > 0 ? (size_t)ret : 0;
+        }
+    }
+
+    if (written >= buf_size)
+        written = buf_size - 1;
+    return (int)written;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file spi_txq.c
+ * @brief SPI 事务队列实现
+ * @version 1.0
+ * @date 2026-02-04
+ */
+
+#include "spi_txq.h"
+#include <string.h>
+
+void spi_txq_init(spi_txq_t *q, const spi_txq_ops_t *ops, void *ctx)
+{
+    memset(q, 0, sizeof(spi_txq_t));
+    q->ops = *ops;
+    q->ctx = ctx;
+}
+
+int spi_txq_add_device(spi_txq_t *q, uint8_t cs_pin, uint32_t freq_hz, uint8_t mode)
+{
+    spi_txq_dev_t *d;
+
+    if (q->n_devs >= SPI_TXQ_MAX_DEVICES)
+        return -1;
+    d = &q->devs[q->n_devs];
+    d->cs_pin = cs_pin;
+    d->freq_hz = freq_hz;
+    d->mode = mode;
+    return q->n_devs++;
+}
+
+int spi_txq_submit(spi_txq_t *q, uint8_t dev, const uint8_t *tx, uint8_t *rx, uint16_t len, uint8_t flags)
+{
+    spi_txq_job_t *j;
+
+    if (dev >= q->n_devs)
+        return -1;
+    if (q->n_jobs >= SPI_TXQ_MAX_JOBS)
+    {
+        q->stats.rejected++;
+        return -1;
+    }
+    j = &q->jobs[q->n_jobs];
+    j->dev = dev;
+    j->tx = tx;
+    j->rx = rx;
+    j->len = len;
+    j->flags = flags;
+    return q->n_jobs++;
+}
+
+int spi_txq_flush(spi_txq_t *q)
+{
+    spi_txq_stats_t *st = &q->stats;
+    uint32_t done = 0; // 已执行的设备位图
+    uint32_t cs_ops = 0;
+    int i, k, executed = 0, selected = 0;
+
+    for (i = 0; i < q->n_jobs; i++)
+    {
+        uint8_t dev = q->jobs[i].dev;
+
+        if (done & (1u << dev))
+            continue;
+        done |= 1u << dev;
+
+        // 执行该设备的所有作业（保持提交顺序）；切换设备时由 select 一并释放上一个片选
+        selected = 0;
+        for (k = i; k < q->n_jobs; k++)
+        {
+            const spi_txq_job_t *j = &q->jobs[k];
+
+            if (j->dev != dev)
+                continue;
+
+            if (!selected)
+            {
+                st->selects++;
+                cs_ops++;
+                if (q->ops.select(q->ctx, &q->devs[dev]) != 0)
+                {
+                    st->errors++;
+                    q->ops.release(q->ctx);
+                    q->n_jobs = 0;
+                    return -1;
+                }
+                selected = 1;
+            }
+
+            q->ops.transfer(q->ctx, j->tx, j->rx, j->len);
+            st->jobs++;
+            st->bytes += j->len;
+            if (k > executed)
+                st->reordered++;
+            executed++;
+
+            if (j->flags & SPI_TXQ_CS_BREAK)
+            {
+                st->releases++;
+                cs_ops++;
+                q->ops.release(q->ctx);
+                selected = 0;
+            }
+        }
+    }
+
+    if (selected)
+    {
+        st->releases++;
+        cs_ops++;
+        q->ops.release(q->ctx);
+    }
+
+    // 逐个作业执行需要 2 次片选操作（选中 + 释放）
+    st->cs_saved += 2u * (uint32_t)executed - cs_ops;
+    q->n_jobs = 0;
+    return executed;
+}
+
+int spi_txq_pending(const spi_txq_t *q)
+{
+    return q->n_jobs;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file status_led.c
+ * @brief 状态 LED 逻辑层实现
+ * @version 1.0
+ * @date 2026-02-05
+ */
+
+#include "status_led.h"
+#include <string.h>
+
+/* 每个通道乘以 level/255 */
+static uint32_t scale_rgb(uint32_t rgb, uint32_t level)
+{
+    uint32_t r = ((rgb >> 16) & 0xFF) * level / 255;
+    uint32_t g = ((rgb >> 8) & 0xFF) * level / 255;
+    uint32_t b = (rgb & 0xFF) * level / 255;
+    return (r << 16) | (g << 8) | b;
+}
+
+/* 设置新图案；参数与当前完全相同时返回 0，不重置相位 */
+static int apply(status_led_t *s, uint8_t mode, uint32_t rgb, uint16_t a, uint16_t b, uint32_t now_ms)
+{
+    s->stats.requests++;
+
+    if (s->mode == mode && s->color == rgb &&
+        (mode == STATUS_LED_SOLID ||
+         (mode == STATUS_LED_BLINK && s->on_ms == a && s->off_ms == b) ||
+         (mode == STATUS_LED_FADE && s->period_ms == a)))
+    {
+        s->stats.ignored++;
+        return 0;
+    }
+
+    s->mode = mode;
+    s->color = rgb;
+    s->start_ms = now_ms;
+    if (mode == STATUS_LED_BLINK)
+    {
+        s->on_ms = a;
+        s->off_ms = b;
+    }
+    else if (mode == STATUS_LED_FADE)
+    {
+        s->period_ms = a ? a : 1;
+    }
+    return 1;
+}
+
+void status_led_init(status_led_t *s, uint8_t brightness)
+{
+    memset(s, 0, sizeof(status_led_t));
+    s->mode = STATUS_LED_SOLID;
+    s->brightness = brightness;
+}
+
+void status_led_set(status_led_t *s, uint32_t rgb, uint32_t now_ms)
+{
+    apply(s, STATUS_LED_SOLID, rgb, 0, 0, now_ms);
+}
+
+void status_led_blink(status_led_t *s, uint32_t rgb, uint16_t on_ms, uint16_t off_ms, uint32_t now_ms)
+{
+    apply(s, STATUS_LED_BLINK, rgb, on_ms, off_ms, now_ms);
+}
+
+void status_led_fade(status_led_t *s, uint32_t rgb, uint16_t period_ms, uint32_t now_ms)
+{
+    apply(s, STATUS_LED_FADE, rgb, period_ms, 0, now_ms);
+}
+
+void status_led_set_brightness(status_led_t *s, uint8_t brightness)
+{
+    s->brightness = brightness;
+}
+
+int status_led_update(status_led_t *s, uint32_t now_ms, uint32_t *rgb_out)
+{
+    uint32_t elapsed = now_ms - s->start_ms;
+    uint32_t level = 255;
+    uint32_t rgb;
+
+    // 每秒统计一次实际发送次数
+    if (now_ms - s->window_ms >= 1000)
+    {
+        s->stats.pushes_per_s = (uint16_t)s->window_pushes;
+        s->window_pushes = 0;
+        s->window_ms = now_ms;
+    }
+
+    switch (s->mode)
+    {
+    case STATUS_LED_BLINK:
+    {
+        uint32_t cycle = (uint32_t)s->on_ms + s->off_ms;
+        if (cycle > 0 && elapsed % cycle >= s->on_ms)
+            level = 0;
+        break;
+    }
+    case STATUS_LED_FADE:
+    {
+        // 三角波 0→255→0，再平方近似人眼亮度曲线
+        uint32_t phase = elapsed % s->period_ms;
+        uint32_t half = s->period_ms / 2 ? s->period_ms / 2 : 1;
+        uint32_t tri = phase < half ? phase * 255 / half : (s->period_ms - phase) * 255 / half;
+        if (tri > 255)
+            tri = 255;
+        level = tri * tri / 255;
+        break;
+    }
+    default:
+        break;
+    }
+
+    rgb = scale_rgb(scale_rgb(s->color, level), s->brightness);
+    *rgb_out = rgb;
+
+    if (s->shown_valid && rgb == s->shown)
+    {
+        s->stats.deduped++;
+        return 0;
+    }
+    return 1;
+}
+
+void status_led_commit(status_led_t *s, uint32_t rgb)
+{
+    s->shown = rgb;
+    s->shown_valid = 1;
+    s->stats.pushes++;
+    s->window_pushes++;
+}
+
+void status_led_busy(status_led_t *s)
+{
+    s->stats.busy++;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file swarm_sched.c
+ * @brief ESP-NOW 多机组网调度实现
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#include "swarm_sched.h"
+#include <string.h>
+
+#define BEACON_TIMEOUT_FRAMES 10 // 连续多少个超帧收不到信标视为失联
+
+/* ====================================================================================
+ *  小端读写
+ * ==================================================================================== */
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t slot_mask(uint8_t first, uint8_t count)
+{
+    uint32_t m = (count >= 32) ? 0xFFFFFFFFu : ((1u << count) - 1u);
+    return m << first;
+}
+
+/* ====================================================================================
+ *  基站
+ * ==================================================================================== */
+
+void swarm_base_init(swarm_base_t *b, uint32_t superframe_us, uint8_t n_slots, uint8_t epoch)
+{
+    memset(b, 0, sizeof(swarm_base_t));
+    if (n_slots < 3)
+        n_slots = 3;
+    if (n_slots > SWARM_MAX_SLOTS)
+        n_slots = SWARM_MAX_SLOTS;
+    b->superframe_us = superframe_us;
+    b->n_slots = n_slots;
+    b->slot_us = superframe_us / n_slots;
+    b->max_slots_per_peer = (n_slots - 2) / 4 ? (n_slots - 2) / 4 : 1;
+    b->epoch = epoch;
+}
+
+size_t swarm_base_beacon(swarm_base_t *b, uint32_t now_us, uint8_t *buf)
+{
+    uint32_t members = 0;
+    int i;
+
+    for (i = 0; i < SWARM_MAX_PEERS; i++)
+        if (b->peers[i].in_use)
+            members |= 1u << i;
+
+    b->anchor_us = now_us;
+    buf[0] = SWARM_MAGIC;
+    buf[1] = SWARM_TYPE_BEACON;
+    put_u16(buf + 2, b->beacon_seq++);
+    put_u32(buf + 4, now_us);
+    put_u32(buf + 8, b->superframe_us);
+    buf[12] = b->n_slots;
+    buf[13] = (uint8_t)swarm_base_peer_count(b);
+    buf[14] = b->epoch;
+    put_u32(buf + 15, members);
+    return SWARM_BEACON_SIZE;
+}
+
+/* 在数据时隙中为 count 个时隙寻找连续空闲区间，失败返回 -1 */
+static int alloc_slots(swarm_base_t *b, uint8_t count)
+{
+    int first;
+
+    for (first = 1; first + count <= b->n_slots - 1; first++)
+    {
+        if ((b->slot_map & slot_mask((uint8_t)first, count)) == 0)
+            return first;
+    }
+    return -1;
+}
+
+static int find_peer(const swarm_base_t *b, const uint8_t *mac)
+{
+    int i;
+
+    for (i = 0; i < SWARM_MAX_PEERS; i++)
+    {
+        if (b->peers[i].in_use && memcmp(b->peers[i].mac, mac, 6) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int swarm_base_on_join(swarm_base_t *b, const uint8_t *mac, const uint8_t *msg, size_t len, uint32_t now_ms)
+{
+    swarm_peer_t *p;
+    uint16_t rate;
+    uint32_t want;
+    int idx, first;
+
+    if (len < SWARM_JOIN_SIZE || msg[0] != SWARM_MAGIC || msg[1] != SWARM_TYPE_JOIN)
+        return -1;
+    rate = get_u16(msg + 3);
+
+    // 已在表中：先释放旧时隙，按新速率重新分配
+    idx = find_peer(b, mac);
+    if (idx >= 0)
+    {
+        p = &b->peers[idx];
+        b->slot_map &= ~slot_mask(p->slot_first, p->slot_count);
+    }
+    else
+    {
+        // 从上次分配位置之后轮流查找：刚被移出的表项最后才重用，原节点来得及在信标中发现自己被移出
+        int k;
+        for (k = 0; k < SWARM_MAX_PEERS; k++)
+        {
+            idx = (b->next_idx + k) % SWARM_MAX_PEERS;
+            if (!b->peers[idx].in_use)
+                break;
+        }
+        if (k == SWARM_MAX_PEERS)
+        {
+            b->join_rejected++;
+            return -1;
+        }
+        b->next_idx = (uint8_t)((idx + 1) % SWARM_MAX_PEERS);
+        p = &b->peers[idx];
+        memset(p, 0, sizeof(swarm_peer_t));
+        memcpy(p->mac, mac, 6);
+    }
+
+    // 速率控制：每超帧所需时隙数 = ceil(rate × 超帧长度)，时隙不足时逐步降级
+    want = ((uint32_t)rate * b->superframe_us + 999999u) / 1000000u;
+    if (want == 0)
+        want = 1;
+    if (want > b->max_slots_per_peer)
+        want = b->max_slots_per_peer;
+
+    first = -1;
+    while (want > 0 && (first = alloc_slots(b, (uint8_t)want)) < 0)
+        want--;
+
+    if (first < 0)
+    {
+        p->in_use = 0;
+        b->join_rejected++;
+        return -1;
+    }
+
+    p->in_use = 1;
+    p->node_id = msg[2];
+    p->rate_hz = rate;
+    p->slot_first = (uint8_t)first;
+    p->slot_count = (uint8_t)want;
+    p->last_seen_ms = now_ms;
+    b->slot_map |= slot_mask(p->slot_first, p->slot_count);
+    return idx;
+}
+
+size_t swarm_base_assign(const swarm_base_t *b, int idx, uint8_t *buf)
+{
+    const swarm_peer_t *p = &b->peers[idx];
+
+    buf[0] = SWARM_MAGIC;
+    buf[1] = SWARM_TYPE_ASSIGN;
+    memcpy(buf + 2, p->mac, 6);
+    buf[8] = p->slot_first;
+    buf[9] = p->slot_count;
+    buf[10] = (uint8_t)idx;
+    buf[11] = b->epoch;
+    return SWARM_ASSIGN_SIZE;
+}
+
+int swarm_base_on_data(swarm_base_t *b, const uint8_t *mac, uint32_t seq, size_t len, uint32_t rx_us, uint32_t now_ms)
+{
+    int idx = find_peer(b, mac);
+    swarm_peer_t *p;
+    swarm_peer_stats_t *st;
+    uint32_t slot;
+
+    if (idx < 0)
+        return -1;
+    p = &b->peers[idx];
+    st = &p->stats;
+    p->last_seen_ms = now_ms;
+
+    st->frames++;
+    st->bytes += (uint32_t)len;
+    st->airtime_us += SWARM_AIRTIME_US(len);
+
+    if (st->seq_synced && (int32_t)(seq - st->next_seq) > 0)
+        st->lost += seq - st->next_seq;
+    if (!st->seq_synced || (int32_t)(seq - st->next_seq) >= 0)
+        st->next_seq = seq + 1;
+    st->seq_synced = 1;
+
+    // 接收时刻所在时隙（接收延迟很小，可近似为发送时隙）
+    slot = ((rx_us - b->anchor_us) % b->superframe_us) / b->slot_us;
+    if (slot < p->slot_first || slot >= (uint32_t)(p->slot_first + p->slot_count))
+        st->out_of_slot++;
+
+    return idx;
+}
+
+int swarm_base_expire(swarm_base_t *b, uint32_t now_ms)
+{
+    int i, n = 0;
+
+    for (i = 0; i < SWARM_MAX_PEERS; i++)
+    {
+        swarm_peer_t *p = &b->peers[i];
+        if (p->in_use && now_ms - p->last_seen_ms > SWARM_PEER_TIMEOUT_MS)
+        {
+            b->slot_map &= ~slot_mask(p->slot_first, p->slot_count);
+            p->in_use = 0;
+            n++;
+        }
+    }
+    return n;
+}
+
+int swarm_base_peer_count(const swarm_base_t *b)
+{
+    int i, n = 0;
+
+    for (i = 0; i < SWARM_MAX_PEERS; i++)
+        n += b->peers[i].in_use;
+    return n;
+}
+
+/* ====================================================================================
+ *  机器人
+ * ==================================================================================== */
+
+void swarm_node_init(swarm_node_t *n, uint8_t node_id, const uint8_t *own_mac, uint16_t rate_hz)
+{
+    memset(n, 0, sizeof(swarm_node_t));
+    n->node_id = node_id;
+    memcpy(n->own_mac, own_mac, 6);
+    n->rate_hz = rate_hz;
+    n->state = SWARM_NODE_SCANNING;
+    n->last_tx_slot = 0xFFFFFFFFu;
+}
+
+int swarm_node_on_message(swarm_node_t *n, const uint8_t *mac, const uint8_t *buf, size_t len, uint32_t rx_us)
+{
+    if (len < 2 || buf[0] != SWARM_MAGIC)
+        return 0;
+
+    if (buf[1] == SWARM_TYPE_BEACON && len >= SWARM_BEACON_SIZE)
+    {
+        // 只跟随第一个发现的基站
+        if (n->state != SWARM_NODE_SCANNING && memcmp(mac, n->base_mac, 6) != 0)
+            return 0;
+
+        // 超帧计数接续旧网格：新锚点之后的时隙编号一定大于此前用过的编号
+        if (n->superframe_us)
+            n->anchor_frame += (rx_us - n->anchor_local_us) / n->superframe_us + 1;
+
+        memcpy(n->base_mac, mac, 6);
+        n->anchor_base_us = get_u32(buf + 4);
+        n->anchor_local_us = rx_us;
+        n->last_beacon_us = rx_us;
+        n->superframe_us = get_u32(buf + 8);
+        n->n_slots = buf[12];
+        n->slot_us = n->n_slots ? n->superframe_us / n->n_slots : 0;
+
+        if (n->state == SWARM_NODE_SCANNING)
+        {
+            n->state = SWARM_NODE_JOINING;
+            return 1;
+        }
+        if (n->state == SWARM_NODE_ACTIVE &&
+            (buf[14] != n->epoch || n->peer_idx >= 32 || !(get_u32(buf + 15) & (1u << n->peer_idx))))
+        {
+            // 基站重启或已把本节点移出：停止使用旧时隙，重新申请
+            n->state = SWARM_NODE_JOINING;
+            n->slot_count = 0;
+            n->rejoins++;
+            return 1;
+        }
+        return n->state == SWARM_NODE_JOINING; // 未收到分配则在后续信标后重发 JOIN
+    }
+
+    if (buf[1] == SWARM_TYPE_ASSIGN && len >= SWARM_ASSIGN_SIZE)
+    {
+        if (memcmp(buf + 2, n->own_mac, 6) != 0 || memcmp(mac, n->base_mac, 6) != 0)
+            return 0;
+        n->slot_first = buf[8];
+        n->slot_count = buf[9];
+        n->peer_idx = buf[10];
+        n->epoch = buf[11];
+        n->state = SWARM_NODE_ACTIVE;
+    }
+    return 0;
+}
+
+size_t swarm_node_join(const swarm_node_t *n, uint8_t *buf)
+{
+    buf[0] = SWARM_MAGIC;
+    buf[1] = SWARM_TYPE_JOIN;
+    buf[2] = n->node_id;
+    put_u16(buf + 3, n->rate_hz);
+    return SWARM_JOIN_SIZE;
+}
+
+/* 当前本地时间对应的超帧内偏移（μs），以及自锚点起算的超帧计数 */
+static uint32_t frame_pos(const swarm_node_t *n, uint32_t now_us, uint32_t *frame)
+{
+    uint32_t elapsed = now_us - n->anchor_local_us; // 本地与基站时钟的偏差在锚点处已抵消
+    if (frame)
+        *frame = n->anchor_frame + elapsed / n->superframe_us;
+    return elapsed % n->superframe_us;
+}
+
+int swarm_node_can_send(swarm_node_t *n, uint32_t now_us, size_t len)
+{
+    uint32_t pos, frame, gslot, slot, in_slot;
+
+    if (n->state != SWARM_NODE_ACTIVE || n->slot_us == 0)
+        return 0;
+
+    pos = frame_pos(n, now_us, &frame);
+    slot = pos / n->slot_us;
+    in_slot = pos % n->slot_us;
+    gslot = frame * n->n_slots + slot; // 与时隙判断同一网格，一个本地时隙只对应一个编号
+
+    if (slot < n->slot_first || slot >= (uint32_t)(n->slot_first + n->slot_count) ||
+        in_slot < SWARM_GUARD_US / 2 ||
+        in_slot + SWARM_AIRTIME_US(len) + SWARM_GUARD_US / 2 > n->slot_us ||
+        gslot == n->last_tx_slot)
+    {
+        n->deferred++;
+        return 0;
+    }
+
+    n->last_tx_slot = gslot;
+    return 1;
+}
+
+int swarm_node_can_join(const swarm_node_t *n, uint32_t now_us)
+{
+    if (n->state != SWARM_NODE_JOINING || n->slot_us == 0)
+        return 0;
+    return frame_pos(n, now_us, NULL) / n->slot_us == (uint32_t)(n->n_slots - 1);
+}
+
+void swarm_node_on_sent(swarm_node_t *n, size_t len, int ok)
+{
+    if (ok)
+        n->tx_ok++;
+    else
+        n->tx_fail++;
+    n->airtime_us += SWARM_AIRTIME_US(len);
+}
+
+void swarm_node_check(swarm_node_t *n, uint32_t now_us)
+{
+    if (n->state == SWARM_NODE_SCANNING || n->superframe_us == 0)
+        return;
+    if (now_us - n->last_beacon_us > BEACON_TIMEOUT_FRAMES * n->superframe_us)
+    {
+        n->state = SWARM_NODE_SCANNING;
+        n->slot_count = 0;
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file swuart.c
+ * @brief 软件 UART 接收位解码实现
+ * @version 1.0
+ * @date 2026-02-08
+ */
+
+#include "swuart.h"
+#include <string.h>
+
+#define IDLE_BITS 12          // 结束标记按 12 位空闲处理（足够补齐一个字节）
+#define MAX_RUN_TICKS (1u << 20) // 单段上限，防止定点时间溢出
+
+void swuart_init(swuart_t *u, uint32_t tick_hz, uint32_t baud)
+{
+    memset(u, 0, sizeof(swuart_t));
+    u->bit_q8 = baud ? (uint32_t)(((uint64_t)tick_hz * 256u + baud / 2) / baud) : 256u;
+    u->run_level = 1;
+}
+
+static void emit(swuart_t *u, uint8_t *out, int cap, int *n)
+{
+    u->stats.bytes++;
+    if (*n < cap)
+        out[(*n)++] = (uint8_t)u->shift;
+    else
+        u->stats.overflows++;
+}
+
+int swuart_feed_run(swuart_t *u, uint8_t level, uint32_t ticks, uint8_t *out, int cap)
+{
+    int n = 0;
+    uint32_t end;
+
+    level = level ? 1 : 0;
+    if (ticks == 0)
+    {
+        level = 1;
+        ticks = IDLE_BITS * u->bit_q8 / 256u + 1;
+    }
+    if (ticks > MAX_RUN_TICKS)
+        ticks = MAX_RUN_TICKS;
+
+    if (u->need_high)
+    {
+        if (level)
+            u->need_high = 0;
+        return 0;
+    }
+    if (!u->in_frame)
+    {
+        if (level)
+            return 0;
+        // 下降沿：新字节的起始位
+        u->in_frame = 1;
+        u->t_q8 = 0;
+        u->bit = 0;
+        u->shift = 0;
+    }
+
+    end = u->t_q8 + ticks * 256u;
+    while (u->in_frame)
+    {
+        uint32_t center = u->bit * u->bit_q8 + u->bit_q8 / 2;
+        if (center >= end)
+            break;
+
+        if (u->bit == 0)
+        {
+            if (level)
+            {
+                u->stats.glitches++;
+                u->in_frame = 0;
+                break;
+            }
+        }
+        else if (u->bit <= 8)
+        {
+            if (level)
+                u->shift |= (uint16_t)(1u << (u->bit - 1));
+        }
+        else
+        {
+            u->in_frame = 0;
+            if (level)
+            {
+                emit(u, out, cap, &n);
+            }
+            else
+            {
+                if (u->shift == 0)
+                    u->stats.breaks++;
+                else
+                    u->stats.frame_errors++;
+                u->need_high = 1;
+            }
+            break;
+        }
+        u->bit++;
+    }
+    u->t_q8 = end;
+    return n;
+}
+
+int swuart_feed_rmt(swuart_t *u, const uint32_t *items, size_t n, uint8_t *out, int cap)
+{
+    int got = 0;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        uint32_t v = items[i];
+        uint32_t d0 = v & 0x7FFFu;
+        uint32_t d1 = (v >> 16) & 0x7FFFu;
+
+        if (d0 == 0)
+            return got + swuart_feed_run(u, 1, 0, out + got, cap - got);
+        got += swuart_feed_run(u, (uint8_t)((v >> 15) & 1u), d0, out + got, cap - got);
+        if (d1 == 0)
+            return got + swuart_feed_run(u, 1, 0, out + got, cap - got);
+        got += swuart_feed_run(u, (uint8_t)(v >> 31), d1, out + got, cap - got);
+    }
+    return got;
+}
+
+int swuart_feed_samples(swuart_t *u, const uint16_t *samples, size_t n, uint8_t line, uint8_t *out, int cap)
+{
+    int got = 0;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        uint8_t lv = (uint8_t)((samples[i] >> line) & 1u);
+        if (lv == u->run_level)
+        {
+            u->run_ticks++;
+            continue;
+        }
+        if (u->run_ticks)
+            got += swuart_feed_run(u, u->run_level, u->run_ticks, out + got, cap - got);
+        u->run_level = lv;
+        u->run_ticks = 1;
+    }
+
+    // 当前游程先送入已采到的部分（同电平的相邻段可分开输入），字节不必等到下一个边沿才输出
+    if (u->run_ticks)
+        got += swuart_feed_run(u, u->run_level, u->run_ticks, out + got, cap - got);
+    u->run_ticks = 0;
+    return got;
+}
+
+int swuart_flush(swuart_t *u, uint8_t *out, int cap)
+{
+    int got = 0;
+
+    if (u->run_ticks)
+        got += swuart_feed_run(u, u->run_level, u->run_ticks, out, cap);
+    u->run_ticks = 0;
+    u->run_level = 1;
+    return got + swuart_feed_run(u, 1, 0, out + got, cap - got);
+}
@@ -0,0 +1,292 @@
+/**
+ * @file telemetry_frame.c
+ * @brief ESP-NOW 高速遥测帧打包/解包与链路统计实现
+ * @version 1.0
+ * @date 2026-02-03
+ */
+
+#include "telemetry_frame.h"
+#include <string.h>
+
+/* ====================================================================================
+ *  小端读写
+ * ==================================================================================== */
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* 浮点转 int16 定点（四舍五入 + 饱和） */
+static int16_t to_q16(float v, float scale)
+{
+    float s = v * scale;
+    if (s != s)
+        return 0;
+    if (s > 32767.0f)
+        return 32767;
+    if (s < -32768.0f)
+        return -32768;
+    return (int16_t)(s >= 0.0f ? s + 0.5f : s - 0.5f);
+}
+
+/* ====================================================================================
+ *  发送端
+ * ==================================================================================== */
+
+void telem_tx_init(telem_tx_t *tx, uint8_t node_id)
+{
+    memset(tx, 0, sizeof(telem_tx_t));
+    tx->node_id = node_id;
+    tx->len = TELEM_HDR_SIZE;
+}
+
+/* 预留一条采样的空间并写入公共部分，失败返回 NULL */
+static uint8_t *reserve_sample(telem_tx_t *tx, uint8_t type, size_t size, uint32_t t_us)
+{
+    uint8_t *p;
+
+    if (tx->len + size > TELEM_FRAME_MAX || tx->count == 255)
+        return NULL;
+    if (tx->count == 0)
+        tx->t0_us = t_us;
+    else if (t_us - tx->t0_us > 0xFFFF)
+        return NULL; // 帧内时间跨度超过 65ms，强制发送
+
+    p = tx->buf + tx->len;
+    p[0] = type;
+    put_u16(p + 1, (uint16_t)(t_us - tx->t0_us));
+    tx->len += size;
+    tx->count++;
+    return p + 3;
+}
+
+int telem_tx_add_imu(telem_tx_t *tx, uint32_t t_us, const float quat[4], const float gyr[3], const float acc[3])
+{
+    uint8_t *p = reserve_sample(tx, TELEM_SAMPLE_IMU, TELEM_IMU_SIZE, t_us);
+    int i;
+
+    if (p == NULL)
+        return 0;
+    for (i = 0; i < 4; i++)
+        put_u16(p + i * 2, (uint16_t)to_q16(quat[i], TELEM_SCALE_QUAT));
+    for (i = 0; i < 3; i++)
+    {
+        put_u16(p + 8 + i * 2, (uint16_t)to_q16(gyr[i], TELEM_SCALE_GYR));
+        put_u16(p + 14 + i * 2, (uint16_t)to_q16(acc[i], TELEM_SCALE_ACC));
+    }
+    return 1;
+}
+
+int telem_tx_add_encoder(telem_tx_t *tx, uint32_t t_us, uint8_t id, float angle)
+{
+    uint8_t *p = reserve_sample(tx, TELEM_SAMPLE_ENCODER, TELEM_ENCODER_SIZE, t_us);
+    float s;
+
+    if (p == NULL)
+        return 0;
+    s = angle * TELEM_SCALE_ANGLE;
+    p[0] = id;
+    put_u16(p + 1, (uint16_t)(s <= 0.0f ? 0 : (s >= 65535.0f ? 65535 : (uint32_t)(s + 0.5f))));
+    return 1;
+}
+
+size_t telem_tx_finish(telem_tx_t *tx, uint32_t tx_us)
+{
+    uint8_t *h = tx->buf;
+
+    if (tx->count == 0)
+        return 0;
+    h[0] = TELEM_MAGIC;
+    h[1] = TELEM_VERSION;
+    h[2] = tx->node_id;
+    h[3] = tx->count;
+    put_u32(h + 4, tx->seq);
+    put_u32(h + 8, tx->t0_us);
+    put_u32(h + 12, tx_us);
+    return tx->len;
+}
+
+void telem_tx_reset(telem_tx_t *tx)
+{
+    telem_tx_clear(tx);
+    tx->seq++;
+}
+
+void telem_tx_clear(telem_tx_t *tx)
+{
+    tx->len = TELEM_HDR_SIZE;
+    tx->count = 0;
+}
+
+/* ====================================================================================
+ *  接收端
+ * ==================================================================================== */
+
+int telem_unpack(const uint8_t *buf, size_t len, telem_header_t *hdr, telem_sample_t *out, int max_samples)
+{
+    size_t ofs = TELEM_HDR_SIZE;
+    int n = 0, i;
+
+    if (len < TELEM_HDR_SIZE || len > TELEM_FRAME_MAX)
+        return -1;
+    if (buf[0] != TELEM_MAGIC || buf[1] != TELEM_VERSION)
+        return -1;
+
+    hdr->node_id = buf[2];
+    hdr->count = buf[3];
+    hdr->seq = get_u32(buf + 4);
+    hdr->t0_us = get_u32(buf + 8);
+    hdr->tx_us = get_u32(buf + 12);
+
+    while (ofs < len)
+    {
+        const uint8_t *p = buf + ofs;
+        size_t size = (p[0] == TELEM_SAMPLE_IMU) ? TELEM_IMU_SIZE : (p[0] == TELEM_SAMPLE_ENCODER) ? TELEM_ENCODER_SIZE : 0;
+
+        if (size == 0 || ofs + size > len)
+            return -1;
+
+        if (n < max_samples)
+        {
+            telem_sample_t *s = &out[n];
+            s->type = p[0];
+            s->t_us = hdr->t0_us + get_u16(p + 1);
+            p += 3;
+            if (s->type == TELEM_SAMPLE_IMU)
+            {
+                for (i = 0; i < 4; i++)
+                    s->imu.quat[i] = (int16_t)get_u16(p + i * 2) / TELEM_SCALE_QUAT;
+                for (i = 0; i < 3; i++)
+                {
+                    s->imu.gyr[i] = (int16_t)get_u16(p + 8 + i * 2) / TELEM_SCALE_GYR;
+                    s->imu.acc[i] = (int16_t)get_u16(p + 14 + i * 2) / TELEM_SCALE_ACC;
+                }
+            }
+            else
+            {
+                s->enc.id = p[0];
+                s->enc.angle = get_u16(p + 1) / TELEM_SCALE_ANGLE;
+            }
+        }
+        n++;
+        ofs += size;
+    }
+
+    if (n != hdr->count)
+        return -1;
+    return n < max_samples ? n : max_samples;
+}
+
+void telem_link_init(telem_link_t *link)
+{
+    memset(link, 0, sizeof(telem_link_t));
+}
+
+void telem_link_update(telem_link_t *link, const telem_header_t *hdr, uint32_t rx_us, size_t len)
+{
+    int32_t offset = (int32_t)(rx_us - hdr->tx_us);
+    int32_t gap;
+
+    if (!link->synced)
+    {
+        link->synced = 1;
+        link->next_seq = hdr->seq;
+        link->offset_min = offset;
+        link->first_rx_us = rx_us;
+    }
+
+    // 序号检查：gap > 0 表示中间丢了 gap 帧，gap < 0 表示迟到或重复
+    gap = (int32_t)(hdr->seq - link->next_seq);
+    if (gap < 0)
+    {
+        uint32_t i = (uint32_t)(-(gap + 1)); // 在位图中的位置
+
+        if (i < TELEM_SEEN_WINDOW)
+        {
+            link->behind = 0;
+            if (link->seen & (1u << i))
+            {
+                link->duplicates++;
+                return;
+            }
+            link->seen |= 1u << i;
+            link->reordered++;
+            if (link->lost > 0)
+                link->lost--; // 之前计为丢失的帧迟到了
+        }
+        else if (gap >= -TELEM_RESYNC_GAP && ++link->behind < TELEM_RESYNC_FRAMES)
+        {
+            link->stale++;
+            return;
+        }
+        else
+        {
+            // 发送端重启：以当前帧重新同步，旧时钟的延迟基准不再适用
+            link->resyncs++;
+            link->behind = 0;
+            link->next_seq = hdr->seq + 1;
+            link->seen = 1;
+            link->offset_min = offset;
+        }
+    }
+    else
+    {
+        link->behind = 0;
+        link->lost += (uint32_t)gap;
+        link->next_seq = hdr->seq + 1;
+        link->seen = gap + 1 >= TELEM_SEEN_WINDOW ? 1 : (link->seen << (gap + 1)) | 1;
+    }
+
+    link->frames++;
+    link->samples += hdr->count;
+    link->bytes += (uint32_t)len;
+    link->last_rx_us = rx_us;
+
+    // 相对延迟：以最小偏差为基准（两端时钟不同步，只能得到高于最小值的部分）
+    if (offset < link->offset_min)
+        link->offset_min = offset;
+    link->latency_last = (uint32_t)(offset - link->offset_min);
+    link->latency_sum += link->latency_last;
+    if (link->latency_last > link->latency_max)
+        link->latency_max = link->latency_last;
+
+    if (hdr->tx_us - hdr->t0_us > link->age_max)
+        link->age_max = hdr->tx_us - hdr->t0_us;
+}
+
+float telem_link_loss_rate(const telem_link_t *link)
+{
+    uint32_t total = link->frames + link->lost;
+    return total ? (float)link->lost / (float)total : 0.0f;
+}
+
+float telem_link_latency_avg(const telem_link_t *link)
+{
+    return link->frames ? (float)link->latency_sum / (float)link->frames : 0.0f;
+}
+
+float telem_link_throughput(const telem_link_t *link)
+{
+    uint32_t span = link->last_rx_us - link->first_rx_us;
+    return span ? (float)link->bytes * 1e6f / (float)span : 0.0f;
+}
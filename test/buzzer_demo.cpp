@@ -1,7 +1,8 @@
 /**
  * @file buzzer_demo.cpp
- * @brief ezBuzzer蜂鸣器库演示 - 简单易用的蜂鸣器控制
- * @note 支持单音、旋律播放、非阻塞模式
+ * @brief 非阻塞蜂鸣器演示 - LEDC 输出 + 定时器推进音符表（include/buzzer_seq.h）
+ * @note 所有音效和旋律都在后台播放，串口命令随时响应；
+ *       报警音可打断乐曲，乐曲播放时按键音被忽略
  *
  * 硬件连接：
  * - 蜂鸣器正极 -> ESP32 GPIO 2
@@ -9,13 +10,17 @@
  */
 
 #include <Arduino.h>
-#include <ezBuzzer.h>
+#include <esp_timer.h>
+#include "buzzer_seq.h"
 
 // ==================== 引脚配置 ====================
 #define BUZZER_PIN 2
+#define BUZZER_CHANNEL 0 // LEDC 通道
 
 // ==================== 全局对象 ====================
-ezBuzzer buzzer(BUZZER_PIN);
+buzzer_seq_t buzzer;
+portMUX_TYPE buzzerMux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t buzzerTimer;
 
 // ==================== 音符频率定义 ====================
 // 基于标准音高，频率单位Hz
@@ -35,143 +40,148 @@ ezBuzzer buzzer(BUZZER_PIN);
 #define NOTE_B5 988
 #define NOTE_C6 1047
 
-#define REST 0 // 休止符
+#define REST BUZZER_REST // 休止符
+
+// 音符时值（ms）：全音符 1000ms
+#define N2 500 // 二分音符
+#define N4 250 // 四分音符
+#define N8 125 // 八分音符
+
+#define MELODY(notes, prio, gap, repeat) {notes, sizeof(notes) / sizeof(notes[0]), prio, gap, repeat}
 
 // ==================== 旋律定义 ====================
+// 音符末尾留 10% 左右的间隙，使相同的连续音符可分辨
 
 // 超级玛丽主题曲（简化版）
-int melody_mario[] = {
-    NOTE_E5, NOTE_E5, REST, NOTE_E5, REST, NOTE_C5, NOTE_E5, REST,
-    NOTE_G5, REST, REST, REST, NOTE_G4, REST, REST, REST};
-int noteDurations_mario[] = {
-    8, 8, 8, 8, 8, 8, 8, 8,
-    4, 8, 8, 8, 4, 8, 8, 8};
+const buzzer_note_t notes_mario[] = {
+    {NOTE_E5, N8}, {NOTE_E5, N8}, {REST, N8}, {NOTE_E5, N8}, {REST, N8}, {NOTE_C5, N8}, {NOTE_E5, N8}, {REST, N8},
+    {NOTE_G5, N4}, {REST, N8}, {REST, N8}, {REST, N8}, {NOTE_G4, N4}, {REST, N8}, {REST, N8}, {REST, N8}};
+const buzzer_melody_t melody_mario = MELODY(notes_mario, BUZZER_PRIO_STATUS, 15, 1);
 
 // 生日快乐歌
-int melody_birthday[] = {
-    NOTE_C4, NOTE_C4, NOTE_D4, NOTE_C4, NOTE_F4, NOTE_E4,
-    NOTE_C4, NOTE_C4, NOTE_D4, NOTE_C4, NOTE_G4, NOTE_F4,
-    NOTE_C4, NOTE_C4, NOTE_C5, NOTE_A4, NOTE_F4, NOTE_E4, NOTE_D4,
-    NOTE_B4, NOTE_B4, NOTE_A4, NOTE_F4, NOTE_G4, NOTE_F4};
-int noteDurations_birthday[] = {
-    8, 8, 4, 4, 4, 2,
-    8, 8, 4, 4, 4, 2,
-    8, 8, 4, 4, 4, 4, 4,
-    8, 8, 4, 4, 4, 2};
+const buzzer_note_t notes_birthday[] = {
+    {NOTE_C4, N8}, {NOTE_C4, N8}, {NOTE_D4, N4}, {NOTE_C4, N4}, {NOTE_F4, N4}, {NOTE_E4, N2},
+    {NOTE_C4, N8}, {NOTE_C4, N8}, {NOTE_D4, N4}, {NOTE_C4, N4}, {NOTE_G4, N4}, {NOTE_F4, N2},
+    {NOTE_C4, N8}, {NOTE_C4, N8}, {NOTE_C5, N4}, {NOTE_A4, N4}, {NOTE_F4, N4}, {NOTE_E4, N4}, {NOTE_D4, N4},
+    {NOTE_B4, N8}, {NOTE_B4, N8}, {NOTE_A4, N4}, {NOTE_F4, N4}, {NOTE_G4, N4}, {NOTE_F4, N2}};
+const buzzer_melody_t melody_birthday = MELODY(notes_birthday, BUZZER_PRIO_STATUS, 15, 1);
 
 // 两只老虎
-int melody_tiger[] = {
-    NOTE_C4, NOTE_D4, NOTE_E4, NOTE_C4,
-    NOTE_C4, NOTE_D4, NOTE_E4, NOTE_C4,
-    NOTE_E4, NOTE_F4, NOTE_G4,
-    NOTE_E4, NOTE_F4, NOTE_G4};
-int noteDurations_tiger[] = {
-    4, 4, 4, 4,
-    4, 4, 4, 4,
-    4, 4, 2,
-    4, 4, 2};
+const buzzer_note_t notes_tiger[] = {
+    {NOTE_C4, N4}, {NOTE_D4, N4}, {NOTE_E4, N4}, {NOTE_C4, N4},
+    {NOTE_C4, N4}, {NOTE_D4, N4}, {NOTE_E4, N4}, {NOTE_C4, N4},
+    {NOTE_E4, N4}, {NOTE_F4, N4}, {NOTE_G4, N2},
+    {NOTE_E4, N4}, {NOTE_F4, N4}, {NOTE_G4, N2}};
+const buzzer_melody_t melody_tiger = MELODY(notes_tiger, BUZZER_PRIO_STATUS, 25, 1);
 
 // 小星星
-int melody_twinkle[] = {
-    NOTE_C4, NOTE_C4, NOTE_G4, NOTE_G4, NOTE_A4, NOTE_A4, NOTE_G4,
-    NOTE_F4, NOTE_F4, NOTE_E4, NOTE_E4, NOTE_D4, NOTE_D4, NOTE_C4};
-int noteDurations_twinkle[] = {
-    4, 4, 4, 4, 4, 4, 2,
-    4, 4, 4, 4, 4, 4, 2};
+const buzzer_note_t notes_twinkle[] = {
+    {NOTE_C4, N4}, {NOTE_C4, N4}, {NOTE_G4, N4}, {NOTE_G4, N4}, {NOTE_A4, N4}, {NOTE_A4, N4}, {NOTE_G4, N2},
+    {NOTE_F4, N4}, {NOTE_F4, N4}, {NOTE_E4, N4}, {NOTE_E4, N4}, {NOTE_D4, N4}, {NOTE_D4, N4}, {NOTE_C4, N2}};
+const buzzer_melody_t melody_twinkle = MELODY(notes_twinkle, BUZZER_PRIO_STATUS, 25, 1);
+
+// 音阶 C4-C5
+const buzzer_note_t notes_scale[] = {
+    {NOTE_C4, 400}, {NOTE_D4, 400}, {NOTE_E4, 400}, {NOTE_F4, 400},
+    {NOTE_G4, 400}, {NOTE_A4, 400}, {NOTE_B4, 400}, {NOTE_C5, 400}};
+const buzzer_melody_t melody_scale = MELODY(notes_scale, BUZZER_PRIO_STATUS, 100, 1);
+
+// 频率扫描 100Hz-2000Hz（setup 中生成）
+buzzer_note_t notes_sweep[39];
+const buzzer_melody_t melody_sweep = MELODY(notes_sweep, BUZZER_PRIO_STATUS, 10, 1);
 
 // ==================== 提示音效 ====================
 
 // 开机提示音
-void playStartupSound()
-{
-    int melody[] = {NOTE_C5, NOTE_E5, NOTE_G5};
-    for (int i = 0; i < 3; i++)
-    {
-        buzzer.beep(melody[i], 100);
-        delay(150);
-    }
-}
+const buzzer_note_t notes_startup[] = {{NOTE_C5, 150}, {NOTE_E5, 150}, {NOTE_G5, 150}};
+const buzzer_melody_t sound_startup = MELODY(notes_startup, BUZZER_PRIO_STATUS, 50, 1);
 
 // 成功提示音
-void playSuccessSound()
-{
-    buzzer.beep(NOTE_G5, 100);
-    delay(100);
-    buzzer.beep(NOTE_C6, 200);
-}
+const buzzer_note_t notes_success[] = {{NOTE_G5, 100}, {NOTE_C6, 200}};
+const buzzer_melody_t sound_success = MELODY(notes_success, BUZZER_PRIO_STATUS, 0, 1);
 
 // 错误提示音
-void playErrorSound()
-{
-    buzzer.beep(NOTE_A4, 100);
-    delay(100);
-    buzzer.beep(NOTE_F4, 100);
-    delay(100);
-    buzzer.beep(NOTE_C4, 200);
-}
+const buzzer_note_t notes_error[] = {{NOTE_A4, 100}, {NOTE_F4, 100}, {NOTE_C4, 200}};
+const buzzer_melody_t sound_error = MELODY(notes_error, BUZZER_PRIO_STATUS, 0, 1);
 
 // 按键提示音
-void playClickSound()
+const buzzer_note_t notes_click[] = {{NOTE_C5, 50}};
+const buzzer_melody_t sound_click = MELODY(notes_click, BUZZER_PRIO_CHIRP, 0, 1);
+
+// 警报音（高低音交替 3 次）
+const buzzer_note_t notes_alarm[] = {{1000, 200}, {800, 200}};
+const buzzer_melody_t sound_alarm = MELODY(notes_alarm, BUZZER_PRIO_ALARM, 0, 3);
+
+// SOS求救信号 (摩斯码: ... --- ...)
+const buzzer_note_t notes_sos[] = {
+    {1000, 200}, {1000, 200}, {1000, 200}, {REST, 300}, // S: 三短音
+    {1000, 500}, {1000, 500}, {1000, 500}, {REST, 300}, // O: 三长音
+    {1000, 200}, {1000, 200}, {1000, 200}};             // S: 三短音
+const buzzer_melody_t sound_sos = MELODY(notes_sos, BUZZER_PRIO_ALARM, 100, 1);
+
+// ==================== 播放控制 ====================
+
+/**
+ * @brief 单次定时器回调：推进音序器，在下一个音符边界重新调度自身
+ */
+void buzzerTimerCallback(void *arg)
 {
-    buzzer.beep(NOTE_C5, 50);
+    uint16_t freq;
+    uint32_t wait;
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&buzzerMux);
+    int changed = buzzer_seq_update(&buzzer, now, &freq, &wait);
+    portEXIT_CRITICAL(&buzzerMux);
+
+    if (changed)
+        ledcWriteTone(BUZZER_CHANNEL, freq);
+    if (wait)
+        esp_timer_start_once(buzzerTimer, wait * 1000ULL);
 }
 
-// 警报音
-void playAlarmSound()
+void initBuzzer()
 {
-    for (int i = 0; i < 3; i++)
-    {
-        buzzer.beep(1000, 200);
-        delay(200);
-        buzzer.beep(800, 200);
-        delay(200);
-    }
+    ledcSetup(BUZZER_CHANNEL, 2000, 8);
+    ledcAttachPin(BUZZER_PIN, BUZZER_CHANNEL);
+    ledcWrite(BUZZER_CHANNEL, 0);
+
+    buzzer_seq_init(&buzzer);
+
+    esp_timer_create_args_t args = {};
+    args.callback = buzzerTimerCallback;
+    args.name = "buzzer";
+    esp_timer_create(&args, &buzzerTimer);
 }
 
-// SOS求救信号 (摩斯码: ... --- ...)
-void playSOSSound()
+/**
+ * @brief 播放旋律（立即返回）
+ * @return false 正在播放更高优先级的旋律
+ */
+bool play(const buzzer_melody_t *melody)
 {
-    // S: 三短音
-    for (int i = 0; i < 3; i++)
-    {
-        buzzer.beep(1000, 100);
-        delay(200);
-    }
-    delay(300);
-
-    // O: 三长音
-    for (int i = 0; i < 3; i++)
+    portENTER_CRITICAL(&buzzerMux);
+    int ok = buzzer_seq_play(&buzzer, melody, millis());
+    portEXIT_CRITICAL(&buzzerMux);
+    if (!ok)
     {
-        buzzer.beep(1000, 300);
-        delay(200);
+        Serial.println("⚠️  正在播放更高优先级的声音，请求被忽略");
+        return false;
     }
-    delay(300);
 
-    // S: 三短音
-    for (int i = 0; i < 3; i++)
-    {
-        buzzer.beep(1000, 100);
-        delay(200);
-    }
+    esp_timer_stop(buzzerTimer);
+    esp_timer_start_once(buzzerTimer, 1);
+    return true;
 }
 
-// ==================== 旋律播放函数 ====================
-
-void playMelody(int *melody, int *durations, int length)
+void stop()
 {
-    for (int i = 0; i < length; i++)
-    {
-        if (melody[i] == REST)
-        {
-            delay(1000 / durations[i]);
-        }
-        else
-        {
-            int duration = 1000 / durations[i];
-            buzzer.beep(melody[i], duration * 0.9); // 0.9是为了让音符之间有短暂间隔
-            delay(duration);
-        }
-    }
+    portENTER_CRITICAL(&buzzerMux);
+    buzzer_seq_stop(&buzzer);
+    portEXIT_CRITICAL(&buzzerMux);
+
+    esp_timer_stop(buzzerTimer);
+    esp_timer_start_once(buzzerTimer, 1);
 }
 
 // ==================== 菜单函数 ====================
@@ -179,7 +189,7 @@ void playMelody(int *melody, int *durations, int length)
 void printMenu()
 {
     Serial.println("\n╔════════════════════════════════════════╗");
-    Serial.println("║      ezBuzzer 蜂鸣器演示程序          ║");
+    Serial.println("║     非阻塞蜂鸣器演示程序             ║");
     Serial.println("╚════════════════════════════════════════╝");
     Serial.println("\n【提示音效】");
     Serial.println("  1 - 开机提示音");
@@ -198,31 +208,12 @@ void printMenu()
     Serial.println("  t - 频率扫描 (100Hz-2000Hz)");
     Serial.println("\n【其他】");
     Serial.println("  h - 显示此帮助");
+    Serial.println("  p - 播放状态");
     Serial.println("  x - 停止播放");
+    Serial.println("\n报警音(5/6)可打断正在播放的乐曲，乐曲播放时按键音(4)被忽略");
     Serial.println("========================================");
 }
 
-void playScale()
-{
-    Serial.println("播放音阶: C4 D4 E4 F4 G4 A4 B4 C5");
-    int scale[] = {NOTE_C4, NOTE_D4, NOTE_E4, NOTE_F4, NOTE_G4, NOTE_A4, NOTE_B4, NOTE_C5};
-    for (int i = 0; i < 8; i++)
-    {
-        buzzer.beep(scale[i], 300);
-        delay(400);
-    }
-}
-
-void frequencySweep()
-{
-    Serial.println("频率扫描: 100Hz -> 2000Hz");
-    for (int freq = 100; freq <= 2000; freq += 50)
-    {
-        buzzer.beep(freq, 50);
-        delay(60);
-    }
-}
-
 // ==================== Setup ====================
 void setup()
 {
@@ -230,9 +221,14 @@ void setup()
     Serial.begin(115200);
     Serial.println("\n\n");
 
-    // ezBuzzer库不需要特殊初始化，创建对象时已完成
+    initBuzzer();
+    for (int i = 0; i < 39; i++)
+    {
+        notes_sweep[i].freq_hz = 100 + i * 50;
+        notes_sweep[i].dur_ms = 60;
+    }
 
-    playStartupSound();
+    play(&sound_startup);
 
     Serial.println("✓ 蜂鸣器初始化完成");
     Serial.println("\n提示：输入命令字符后按Enter");
@@ -242,9 +238,6 @@ void setup()
 // ==================== Loop ====================
 void loop()
 {
-    // 必须调用loop()以支持非阻塞播放
-    buzzer.loop();
-
     if (Serial.available())
     {
         char cmd = Serial.read();
@@ -258,76 +251,81 @@ void loop()
         {
         case '1':
             Serial.println("▶ 开机提示音");
-            playStartupSound();
+            play(&sound_startup);
             break;
 
         case '2':
             Serial.println("▶ 成功提示音");
-            playSuccessSound();
+            play(&sound_success);
             break;
 
         case '3':
             Serial.println("▶ 错误提示音");
-            playErrorSound();
+            play(&sound_error);
             break;
 
         case '4':
             Serial.println("▶ 按键提示音");
-            playClickSound();
+            play(&sound_click);
             break;
 
         case '5':
             Serial.println("▶ 警报音");
-            playAlarmSound();
+            play(&sound_alarm);
             break;
 
         case '6':
             Serial.println("▶ SOS求救信号");
-            playSOSSound();
+            play(&sound_sos);
             break;
 
         case 'a':
         case 'A':
             Serial.println("♪ 超级玛丽主题曲");
-            playMelody(melody_mario, noteDurations_mario,
-                       sizeof(melody_mario) / sizeof(melody_mario[0]));
+            play(&melody_mario);
             break;
 
         case 'b':
         case 'B':
             Serial.println("♪ 生日快乐歌");
-            playMelody(melody_birthday, noteDurations_birthday,
-                       sizeof(melody_birthday) / sizeof(melody_birthday[0]));
+            play(&melody_birthday);
             break;
 
         case 'c':
         case 'C':
             Serial.println("♪ 两只老虎");
-            playMelody(melody_tiger, noteDurations_tiger,
-                       sizeof(melody_tiger) / sizeof(melody_tiger[0]));
+            play(&melody_tiger);
             break;
 
         case 'd':
         case 'D':
             Serial.println("♪ 小星星");
-            playMelody(melody_twinkle, noteDurations_twinkle,
-                       sizeof(melody_twinkle) / sizeof(melody_twinkle[0]));
+            play(&melody_twinkle);
             break;
 
         case 's':
         case 'S':
-            playScale();
+            Serial.println("♪ 音阶: C4 D4 E4 F4 G4 A4 B4 C5");
+            play(&melody_scale);
             break;
 
         case 't':
         case 'T':
-            frequencySweep();
+            Serial.println("♪ 频率扫描: 100Hz -> 2000Hz");
+            play(&melody_sweep);
+            break;
+
+        case 'p':
+        case 'P':
+            Serial.printf("优先级: %d | 开始 %lu 抢占 %lu 拒绝 %lu 完成 %lu | 音符 %lu\n",
+                          buzzer_seq_priority(&buzzer), buzzer.stats.started, buzzer.stats.preempted,
+                          buzzer.stats.rejected, buzzer.stats.completed, buzzer.stats.notes);
             break;
 
         case 'x':
         case 'X':
             Serial.println("⏹ 停止播放");
-            buzzer.stop();
+            stop();
             break;
 
         case 'h':
@@ -340,6 +338,6 @@ void loop()
             break;
         }
 
-        Serial.println("✓ 完成\n");
+        Serial.println("✓ 已提交（后台播放）\n");
     }
 }
@@ -0,0 +1,275 @@
+/**
+ * @file espnow_control.cpp
+ * @brief ESP-NOW 远程命令/控制示例 - 基站以 100Hz 下发机器人设定值
+ * @note 协议见 include/control_proto.h：选择重传 ACK、有限重试、重复抑制、RTT 直方图
+ *
+ * 使用方法：
+ * 1. 基站设 CTRL_BASE_STATION 为 1，并在 robotMAC 中填入机器人的 MAC 地址
+ * 2. 机器人设 CTRL_BASE_STATION 为 0，无需配置 MAC：收到第一条命令后自动记住基站地址
+ * 3. 串口命令 's' 查看 RTT 直方图与统计，'e' 急停，'c' 清零统计
+ */
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <WiFi.h>
+#include "control_proto.h"
+
+// ==================== 设备配置 ====================
+#define CTRL_BASE_STATION 1        // 1=基站，0=机器人
+#define SETPOINT_INTERVAL_US 10000 // 设定值下发周期（100Hz）
+#define RX_QUEUE_LEN 16            // 接收队列深度
+
+// 机器人 MAC 地址（仅基站需要）
+uint8_t robotMAC[] = {0x10, 0x97, 0xBD, 0x12, 0xED, 0xCC};
+
+// ==================== 接收队列元素 ====================
+typedef struct
+{
+    uint32_t rx_us;
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[64];
+} RxPacket;
+
+// ==================== 全局变量 ====================
+QueueHandle_t rxQueue;
+ctrl_endpoint_t ctrl;
+uint8_t peerMAC[6];
+bool peerKnown = false;
+
+volatile uint32_t rxQueueDrops = 0;
+uint32_t lastSetpointUs = 0;
+unsigned long lastReport = 0;
+
+// 机器人端当前设定值
+ctrl_setpoint_t currentSetpoint;
+uint32_t setpointCount = 0;
+bool estopActive = false;
+
+// ==================== ESP-NOW回调函数（非阻塞） ====================
+void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    RxPacket pkt;
+    if (len <= 0 || len > (int)sizeof(pkt.data))
+        return;
+
+    pkt.rx_us = micros();
+    memcpy(pkt.mac, mac, 6);
+    pkt.len = (uint8_t)len;
+    memcpy(pkt.data, incomingData, len);
+
+    if (xQueueSend(rxQueue, &pkt, 0) != pdTRUE)
+        rxQueueDrops++;
+}
+
+// ==================== 协议回调 ====================
+int ctrlSend(void *ctx, const uint8_t *buf, size_t len)
+{
+    if (!peerKnown)
+        return -1;
+    return esp_now_send(peerMAC, buf, len) == ESP_OK ? 0 : -1;
+}
+
+void ctrlDeliver(void *ctx, uint8_t cmd_id, const uint8_t *payload, uint8_t len)
+{
+    switch (cmd_id)
+    {
+    case CTRL_CMD_SETPOINT:
+        if (len == sizeof(ctrl_setpoint_t) && !estopActive)
+        {
+            memcpy(&currentSetpoint, payload, sizeof(ctrl_setpoint_t));
+            setpointCount++;
+        }
+        break;
+    case CTRL_CMD_ESTOP:
+        estopActive = true;
+        memset(&currentSetpoint, 0, sizeof(currentSetpoint));
+        break;
+    case CTRL_CMD_SET_MODE:
+        if (len >= 1)
+            estopActive = (payload[0] == 0);
+        break;
+    default:
+        break;
+    }
+}
+
+// ==================== 对等设备管理 ====================
+bool addPeer(const uint8_t *mac)
+{
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, mac, 6);
+    peerInfo.channel = 0;
+    peerInfo.encrypt = false;
+    if (!esp_now_is_peer_exist(mac) && esp_now_add_peer(&peerInfo) != ESP_OK)
+        return false;
+
+    memcpy(peerMAC, mac, 6);
+    peerKnown = true;
+    Serial.printf("✓ 对等设备: %02X:%02X:%02X:%02X:%02X:%02X\n",
+                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return true;
+}
+
+bool initESPNow()
+{
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+
+    Serial.print("本机MAC地址: ");
+    Serial.println(WiFi.macAddress());
+
+    if (esp_now_init() != ESP_OK)
+    {
+        Serial.println("ESP-NOW初始化失败");
+        return false;
+    }
+    esp_now_register_recv_cb(onDataRecv);
+
+#if CTRL_BASE_STATION
+    return addPeer(robotMAC);
+#else
+    return true;
+#endif
+}
+
+// ==================== 统计输出 ====================
+void printStats()
+{
+    const ctrl_stats_t *st = &ctrl.stats;
+
+    Serial.println("\n========== 控制链路统计 ==========");
+    Serial.printf("提交=%lu 发送=%lu 重传=%lu 确认=%lu 失败=%lu 取代=%lu 窗口满=%lu\n",
+                  st->submitted, st->sent, st->retransmits, st->acked,
+                  st->failed, st->superseded, st->window_full);
+    Serial.printf("交付=%lu 重复抑制=%lu 过时=%lu 重新同步=%lu 旧会话=%lu 错误报文=%lu 队列溢出=%lu\n",
+                  st->delivered, st->duplicates, st->stale, st->resyncs, st->old_session, st->bad, rxQueueDrops);
+
+    if (st->rtt_count > 0)
+    {
+        Serial.printf("RTT: 最小=%luμs 平均=%luμs 最大=%luμs P50≤%luμs P99≤%luμs\n",
+                      st->rtt_min, (uint32_t)(st->rtt_sum / st->rtt_count), st->rtt_max,
+                      ctrl_rtt_percentile(st, 50), ctrl_rtt_percentile(st, 99));
+        for (int i = 0; i < CTRL_RTT_BINS; i++)
+        {
+            if (st->rtt_hist[i] == 0)
+                continue;
+            if (i == CTRL_RTT_BINS - 1)
+                Serial.printf("  ≥%5dμs : %lu\n", i * CTRL_RTT_BIN_US, st->rtt_hist[i]);
+            else
+                Serial.printf("  %5d-%5dμs : %lu\n", i * CTRL_RTT_BIN_US, (i + 1) * CTRL_RTT_BIN_US, st->rtt_hist[i]);
+        }
+    }
+    Serial.println("==================================\n");
+}
+
+// ==================== 串口命令 ====================
+void processSerialCommand()
+{
+    if (!Serial.available())
+        return;
+
+    char cmd = Serial.read();
+    while (Serial.available())
+        Serial.read(); // 清空缓冲区
+
+    switch (cmd)
+    {
+    case 's':
+    case 'S':
+        printStats();
+        break;
+
+    case 'e':
+    case 'E':
+        if (ctrl_submit(&ctrl, CTRL_CMD_ESTOP, 0, NULL, 0, micros()) >= 0)
+            Serial.println("⚠ 已发送急停命令");
+        break;
+
+    case 'c':
+    case 'C':
+        ctrl_reset_stats(&ctrl);
+        rxQueueDrops = 0;
+        Serial.println("✓ 统计已清零");
+        break;
+
+    case 'h':
+    case 'H':
+        Serial.println("\n串口命令:");
+        Serial.println("  s - RTT 直方图与链路统计");
+        Serial.println("  e - 发送急停命令");
+        Serial.println("  c - 清零统计");
+        Serial.println("  h - 显示帮助信息");
+        break;
+
+    default:
+        Serial.println("未知命令，输入 'h' 查看帮助");
+        break;
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    rxQueue = xQueueCreate(RX_QUEUE_LEN, sizeof(RxPacket));
+    ctrl_init(&ctrl, ctrlSend, ctrlDeliver, NULL, (uint8_t)esp_random()); // 每次上电换会话号
+
+    if (!initESPNow())
+    {
+        Serial.println("❌ ESP-NOW初始化失败，系统停止");
+        while (1)
+            delay(1000);
+    }
+
+    Serial.printf("✓ 控制通道已启动（%s）\n", CTRL_BASE_STATION ? "基站" : "机器人");
+}
+
+// ==================== Loop ====================
+void loop()
+{
+    RxPacket pkt;
+    uint32_t now = micros();
+
+    // 处理接收队列
+    while (xQueueReceive(rxQueue, &pkt, 0) == pdTRUE)
+    {
+        if (!peerKnown)
+            addPeer(pkt.mac); // 机器人端：记住第一个发来命令的基站
+        ctrl_on_receive(&ctrl, pkt.data, pkt.len, pkt.rx_us);
+    }
+
+    // 超时重传
+    ctrl_poll(&ctrl, now);
+
+#if CTRL_BASE_STATION
+    // 100Hz 下发设定值（新设定值取代未确认的旧设定值）
+    if (now - lastSetpointUs >= SETPOINT_INTERVAL_US)
+    {
+        lastSetpointUs = now;
+        ctrl_setpoint_t sp;
+        float t = millis() / 1000.0f;
+        sp.value[0] = sinf(t);
+        sp.value[1] = cosf(t);
+        sp.value[2] = 0.0f;
+        sp.value[3] = 0.0f;
+        sp.t_ms = millis();
+        ctrl_submit(&ctrl, CTRL_CMD_SETPOINT, CTRL_FLAG_LATEST, &sp, sizeof(sp), now);
+    }
+#else
+    if (millis() - lastReport >= 1000)
+    {
+        lastReport = millis();
+        Serial.printf("[机器人] 设定值=[%.2f, %.2f, %.2f, %.2f] 更新=%lu/s %s\n",
+                      currentSetpoint.value[0], currentSetpoint.value[1],
+                      currentSetpoint.value[2], currentSetpoint.value[3],
+                      setpointCount, estopActive ? "⚠急停" : "");
+        setpointCount = 0;
+    }
+#endif
+
+    processSerialCommand();
+}
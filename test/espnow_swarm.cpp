@@ -0,0 +1,305 @@
+/**
+ * @file espnow_swarm.cpp
+ * @brief ESP-NOW 多机组网示例 - 信标自动配对、时隙调度、每节点空口统计
+ * @note 多台机器人向同一基站上报遥测，无需预先填写任何 MAC 地址
+ *
+ * 工作流程：
+ * 1. 基站每个超帧（40ms）在时隙 0 广播信标
+ * 2. 机器人收到信标后在竞争时隙发送 JOIN（携带申请速率）
+ * 3. 基站分配连续的数据时隙并广播分配消息
+ * 4. 机器人只在自己的时隙内发送遥测帧（telemetry_frame.h 格式），避免相互碰撞
+ *
+ * 使用方法：
+ * - 基站设 SWARM_BASE_STATION 为 1；每台机器人设为 0 并设置不同的 SWARM_NODE_ID
+ * - 基站串口命令 's' 输出节点表与每节点统计
+ */
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <WiFi.h>
+#include "swarm_sched.h"
+#include "telemetry_frame.h"
+
+// ==================== 设备配置 ====================
+#define SWARM_BASE_STATION 1     // 1=基站，0=机器人
+#define SWARM_NODE_ID 1          // 机器人编号
+#define SWARM_RATE_HZ 50         // 机器人申请的遥测帧速率
+#define SUPERFRAME_US 40000      // 超帧长度
+#define SLOTS_PER_FRAME 10       // 每超帧时隙数（4ms/时隙，可容纳一个满载帧）
+#define SAMPLE_INTERVAL_US 2500  // 机器人采样周期（400Hz）
+#define RX_QUEUE_LEN 32
+
+const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// ==================== 接收队列元素 ====================
+typedef struct
+{
+    uint32_t rx_us;
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[TELEM_FRAME_MAX];
+} RxPacket;
+
+// ==================== 全局变量 ====================
+QueueHandle_t rxQueue;
+volatile uint32_t rxQueueDrops = 0;
+unsigned long lastReport = 0;
+
+#if SWARM_BASE_STATION
+swarm_base_t base;
+#else
+swarm_node_t node;
+telem_tx_t telemTx;
+bool joinPending = false;
+uint32_t lastSampleUs = 0;
+uint32_t localDrops = 0;    // 帧满仍未轮到时隙而在本地丢弃的帧（不计入基站的空口丢帧）
+volatile size_t lastSentLen = 0;
+#endif
+
+// ==================== ESP-NOW回调函数（非阻塞） ====================
+void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    RxPacket pkt;
+    if (len <= 0 || len > TELEM_FRAME_MAX)
+        return;
+
+    pkt.rx_us = micros();
+    memcpy(pkt.mac, mac, 6);
+    pkt.len = (uint8_t)len;
+    memcpy(pkt.data, incomingData, len);
+
+    if (xQueueSend(rxQueue, &pkt, 0) != pdTRUE)
+        rxQueueDrops++;
+}
+
+#if !SWARM_BASE_STATION
+/**
+ * @brief 发送完成回调：只更新 tx_ok/tx_fail/airtime，主循环不写这些字段
+ */
+void onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status)
+{
+    swarm_node_on_sent(&node, lastSentLen, status == ESP_NOW_SEND_SUCCESS);
+}
+#endif
+
+// ==================== 对等设备管理 ====================
+bool ensurePeer(const uint8_t *mac)
+{
+    if (esp_now_is_peer_exist(mac))
+        return true;
+
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, mac, 6);
+    peerInfo.channel = 0;
+    peerInfo.encrypt = false;
+    return esp_now_add_peer(&peerInfo) == ESP_OK;
+}
+
+bool initESPNow()
+{
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+
+    Serial.print("本机MAC地址: ");
+    Serial.println(WiFi.macAddress());
+
+    if (esp_now_init() != ESP_OK)
+    {
+        Serial.println("ESP-NOW初始化失败");
+        return false;
+    }
+    esp_now_register_recv_cb(onDataRecv);
+#if !SWARM_BASE_STATION
+    esp_now_register_send_cb(onDataSent);
+#endif
+
+    // 信标与分配消息均为广播
+    return ensurePeer(BROADCAST_MAC);
+}
+
+// ==================== 基站 ====================
+#if SWARM_BASE_STATION
+void printPeerTable()
+{
+    Serial.println("\n========== 节点表 ==========");
+    Serial.printf("节点数: %d/%d  已用时隙位图: 0x%08lX  拒绝加入: %lu  队列溢出: %lu\n",
+                  swarm_base_peer_count(&base), SWARM_MAX_PEERS,
+                  base.slot_map, base.join_rejected, rxQueueDrops);
+    Serial.println("ID  MAC                时隙    申请Hz  帧数    丢帧   越界   空口占用");
+    for (int i = 0; i < SWARM_MAX_PEERS; i++)
+    {
+        const swarm_peer_t *p = &base.peers[i];
+        if (!p->in_use)
+            continue;
+        Serial.printf("%-3d %02X:%02X:%02X:%02X:%02X:%02X  %2d+%-2d   %-6u  %-7lu %-6lu %-6lu %lums\n",
+                      p->node_id, p->mac[0], p->mac[1], p->mac[2], p->mac[3], p->mac[4], p->mac[5],
+                      p->slot_first, p->slot_count, p->rate_hz,
+                      p->stats.frames, p->stats.lost, p->stats.out_of_slot,
+                      p->stats.airtime_us / 1000);
+    }
+    Serial.println("============================\n");
+}
+
+void baseLoop()
+{
+    RxPacket pkt;
+    uint8_t msg[SWARM_MSG_MAX];
+    uint32_t now = micros();
+
+    // 时隙 0：广播信标
+    if (now - base.anchor_us >= base.superframe_us)
+    {
+        size_t len = swarm_base_beacon(&base, now, msg);
+        esp_now_send(BROADCAST_MAC, msg, len);
+    }
+
+    while (xQueueReceive(rxQueue, &pkt, 0) == pdTRUE)
+    {
+        if (pkt.data[0] == SWARM_MAGIC)
+        {
+            int idx = swarm_base_on_join(&base, pkt.mac, pkt.data, pkt.len, millis());
+            if (idx >= 0)
+            {
+                size_t len = swarm_base_assign(&base, idx, msg);
+                esp_now_send(BROADCAST_MAC, msg, len);
+            }
+        }
+        else if (pkt.data[0] == TELEM_MAGIC && pkt.len >= TELEM_HDR_SIZE)
+        {
+            telem_header_t hdr;
+            if (telem_unpack(pkt.data, pkt.len, &hdr, NULL, 0) >= 0)
+                swarm_base_on_data(&base, pkt.mac, hdr.seq, pkt.len, pkt.rx_us, millis());
+        }
+    }
+
+    swarm_base_expire(&base, millis());
+}
+#endif
+
+// ==================== 机器人 ====================
+#if !SWARM_BASE_STATION
+void nodeLoop()
+{
+    RxPacket pkt;
+    uint32_t now = micros();
+
+    while (xQueueReceive(rxQueue, &pkt, 0) == pdTRUE)
+    {
+        if (swarm_node_on_message(&node, pkt.mac, pkt.data, pkt.len, pkt.rx_us))
+            joinPending = true;
+    }
+    swarm_node_check(&node, now);
+
+    // 入网：只在竞争时隙发送 JOIN
+    if (joinPending && swarm_node_can_join(&node, now) && ensurePeer(node.base_mac))
+    {
+        uint8_t msg[SWARM_MSG_MAX];
+        size_t len = swarm_node_join(&node, msg);
+        lastSentLen = len;
+        esp_now_send(node.base_mac, msg, len);
+        joinPending = false;
+    }
+
+    // 采样（此处以模拟编码器角度代替实际传感器）
+    if (now - lastSampleUs >= SAMPLE_INTERVAL_US)
+    {
+        lastSampleUs = now;
+        float angle = fmodf(now / 10000.0f, 360.0f);
+        if (!telem_tx_add_encoder(&telemTx, now, SWARM_NODE_ID, angle))
+        {
+            telem_tx_clear(&telemTx); // 帧满仍未轮到时隙：丢弃整帧，序号不变，基站不会计为丢帧
+            localDrops++;
+            telem_tx_add_encoder(&telemTx, now, SWARM_NODE_ID, angle);
+        }
+    }
+
+    // 只在自己的时隙发送
+    if (telemTx.count > 0 && swarm_node_can_send(&node, now, telemTx.len))
+    {
+        size_t len = telem_tx_finish(&telemTx, now);
+        lastSentLen = len;
+        esp_now_send(node.base_mac, telemTx.buf, len);
+        telem_tx_reset(&telemTx);
+    }
+
+    if (millis() - lastReport >= 1000)
+    {
+        lastReport = millis();
+        const char *state = node.state == SWARM_NODE_ACTIVE ? "已入网" : node.state == SWARM_NODE_JOINING ? "加入中" : "扫描中";
+        Serial.printf("[节点%d] %s 时隙=%d+%d 成功=%lu 失败=%lu 推迟=%lu 本地丢弃=%lu 重新加入=%lu 空口=%lums\n",
+                      SWARM_NODE_ID, state, node.slot_first, node.slot_count,
+                      node.tx_ok, node.tx_fail, node.deferred, localDrops, node.rejoins, node.airtime_us / 1000);
+    }
+}
+#endif
+
+// ==================== 串口命令 ====================
+void processSerialCommand()
+{
+    if (!Serial.available())
+        return;
+
+    char cmd = Serial.read();
+    while (Serial.available())
+        Serial.read(); // 清空缓冲区
+
+    switch (cmd)
+    {
+#if SWARM_BASE_STATION
+    case 's':
+    case 'S':
+        printPeerTable();
+        break;
+#endif
+
+    case 'h':
+    case 'H':
+        Serial.println("\n串口命令:");
+        Serial.println("  s - 显示节点表与每节点统计（基站）");
+        Serial.println("  h - 显示帮助信息");
+        break;
+
+    default:
+        Serial.println("未知命令，输入 'h' 查看帮助");
+        break;
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    rxQueue = xQueueCreate(RX_QUEUE_LEN, sizeof(RxPacket));
+
+    if (!initESPNow())
+    {
+        Serial.println("❌ ESP-NOW初始化失败，系统停止");
+        while (1)
+            delay(1000);
+    }
+
+#if SWARM_BASE_STATION
+    swarm_base_init(&base, SUPERFRAME_US, SLOTS_PER_FRAME, (uint8_t)esp_random()); // epoch：每次上电不同
+    Serial.println("✓ 基站已启动，开始广播信标");
+#else
+    uint8_t ownMac[6];
+    WiFi.macAddress(ownMac);
+    swarm_node_init(&node, SWARM_NODE_ID, ownMac, SWARM_RATE_HZ);
+    telem_tx_init(&telemTx, SWARM_NODE_ID);
+    Serial.println("✓ 机器人已启动，等待基站信标");
+#endif
+}
+
+// ==================== Loop ====================
+void loop()
+{
+#if SWARM_BASE_STATION
+    baseLoop();
+#else
+    nodeLoop();
+#endif
+    processSerialCommand();
+}
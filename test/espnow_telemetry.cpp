@@ -0,0 +1,280 @@
+/**
+ * @file espnow_telemetry.cpp
+ * @brief ESP-NOW 高速遥测示例 - 批量打包 IMU 采样、序号/时间戳、丢包统计
+ * @note 发送端将多条 IMU 采样打包进一个 250 字节帧；接收端统计丢包率、延迟和吞吐量
+ *
+ * 与 espnow_communication.cpp 的区别：
+ * - 回调函数中不打印、不调用 tone()/delay()，只把数据交给队列
+ * - 帧格式见 include/telemetry_frame.h，可在主机上单独验证打包/解包
+ *
+ * 使用方法：
+ * 1. 发送端（机器人）设 TELEM_SENDER 为 1，接收端（基站）设为 0
+ * 2. 在 peerMAC 中填入对方的 MAC 地址
+ * 3. 发送端 IMU 接 RS485_2（GPIO26 RX、GPIO27 TX、GPIO14 DE）
+ */
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <WiFi.h>
+#include "hipnuc_dec.h"
+#include "telemetry_frame.h"
+#include "pin_config.h"
+
+// ==================== 设备配置 ====================
+#define TELEM_SENDER 1           // 1=发送端（机器人），0=接收端（基站）
+#define TELEM_NODE_ID 1          // 发送节点编号
+#define TELEM_MAX_AGE_US 20000   // 帧内最早采样最多等待 20ms 即发送
+#define RX_QUEUE_LEN 16          // 接收队列深度（帧）
+#define REPORT_INTERVAL 1000     // 统计输出间隔（毫秒）
+
+// 对方设备的MAC地址（需要根据实际情况修改）
+uint8_t peerMAC[] = {0x10, 0x97, 0xBD, 0x12, 0xED, 0xCC};
+
+// ==================== 接收队列元素 ====================
+typedef struct
+{
+    uint32_t rx_us;
+    uint8_t len;
+    uint8_t data[TELEM_FRAME_MAX];
+} RxFrame;
+
+// ==================== 全局变量 ====================
+QueueHandle_t rxQueue;
+telem_tx_t telemTx;
+telem_link_t telemLink;
+hipnuc_raw_t hipnuc_raw;
+
+// 回调中只更新计数器
+volatile uint32_t sendOk = 0;
+volatile uint32_t sendFail = 0;
+volatile uint32_t rxQueueDrops = 0;
+
+uint32_t framesSent = 0;
+uint32_t sendStartFail = 0;
+unsigned long lastReport = 0;
+
+// ==================== ESP-NOW回调函数（非阻塞） ====================
+
+/**
+ * @brief 数据发送完成回调（WiFi 任务上下文，只计数）
+ */
+void onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status)
+{
+    if (status == ESP_NOW_SEND_SUCCESS)
+        sendOk++;
+    else
+        sendFail++;
+}
+
+/**
+ * @brief 数据接收回调（WiFi 任务上下文，拷贝后交给队列）
+ */
+void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    RxFrame frame;
+    if (len <= 0 || len > TELEM_FRAME_MAX)
+        return;
+
+    frame.rx_us = micros();
+    frame.len = (uint8_t)len;
+    memcpy(frame.data, incomingData, len);
+
+    if (xQueueSend(rxQueue, &frame, 0) != pdTRUE)
+    {
+        rxQueueDrops++; // 队列满，主循环处理不过来
+    }
+}
+
+// ==================== 初始化ESP-NOW ====================
+bool initESPNow()
+{
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+
+    Serial.print("本机MAC地址: ");
+    Serial.println(WiFi.macAddress());
+
+    if (esp_now_init() != ESP_OK)
+    {
+        Serial.println("ESP-NOW初始化失败");
+        return false;
+    }
+
+    esp_now_register_send_cb(onDataSent);
+    esp_now_register_recv_cb(onDataRecv);
+
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, peerMAC, 6);
+    peerInfo.channel = 0;
+    peerInfo.encrypt = false;
+    if (esp_now_add_peer(&peerInfo) != ESP_OK)
+    {
+        Serial.println("添加对等设备失败");
+        return false;
+    }
+
+    Serial.println("ESP-NOW初始化成功");
+    return true;
+}
+
+// ==================== 发送端 ====================
+void sendTelemetryFrame()
+{
+    size_t len = telem_tx_finish(&telemTx, micros());
+    if (len == 0)
+        return;
+
+    if (esp_now_send(peerMAC, telemTx.buf, len) == ESP_OK)
+        framesSent++;
+    else
+        sendStartFail++;
+
+    telem_tx_reset(&telemTx);
+}
+
+void pushImuSample(const hi91_t *imu)
+{
+    // hi91_t 为紧凑结构体，先拷贝到对齐的局部数组
+    float quat[4], gyr[3], acc[3];
+    memcpy(quat, imu->quat, sizeof(quat));
+    memcpy(gyr, imu->gyr, sizeof(gyr));
+    memcpy(acc, imu->acc, sizeof(acc));
+
+    uint32_t now = micros();
+    if (!telem_tx_add_imu(&telemTx, now, quat, gyr, acc))
+    {
+        // 帧已满：先发送再放入新帧
+        sendTelemetryFrame();
+        telem_tx_add_imu(&telemTx, now, quat, gyr, acc);
+    }
+}
+
+void senderLoop()
+{
+    while (Serial2.available())
+    {
+        if (hipnuc_input(&hipnuc_raw, Serial2.read()) > 0 && hipnuc_raw.hi91.tag == 0x91)
+        {
+            pushImuSample(&hipnuc_raw.hi91);
+        }
+    }
+
+    // 限制批量等待时间，保证端到端延迟有上界
+    if (telemTx.count > 0 && micros() - telemTx.t0_us >= TELEM_MAX_AGE_US)
+    {
+        sendTelemetryFrame();
+    }
+
+    if (millis() - lastReport >= REPORT_INTERVAL)
+    {
+        lastReport = millis();
+        Serial.printf("[TX] 帧=%lu 成功=%lu 失败=%lu 启动失败=%lu\n",
+                      framesSent, sendOk, sendFail, sendStartFail);
+    }
+}
+
+// ==================== 接收端 ====================
+void receiverLoop()
+{
+    static telem_sample_t samples[TELEM_FRAME_MAX / TELEM_ENCODER_SIZE];
+    RxFrame frame;
+
+    while (xQueueReceive(rxQueue, &frame, 0) == pdTRUE)
+    {
+        telem_header_t hdr;
+        int n = telem_unpack(frame.data, frame.len, &hdr, samples,
+                             sizeof(samples) / sizeof(samples[0]));
+        if (n < 0)
+        {
+            telemLink.bad++;
+            continue;
+        }
+        telem_link_update(&telemLink, &hdr, frame.rx_us, frame.len);
+        // 此处可将 samples[0..n) 交给控制/记录模块
+    }
+
+    if (millis() - lastReport >= REPORT_INTERVAL)
+    {
+        lastReport = millis();
+        Serial.printf("[RX] 帧=%lu 采样=%lu 丢包率=%.2f%% 重复=%lu 乱序=%lu 过旧=%lu 重新同步=%lu 错误=%lu 队列溢出=%lu\n",
+                      telemLink.frames, telemLink.samples,
+                      telem_link_loss_rate(&telemLink) * 100.0f,
+                      telemLink.duplicates, telemLink.reordered, telemLink.stale, telemLink.resyncs,
+                      telemLink.bad, rxQueueDrops);
+        Serial.printf("     延迟(相对) 当前=%luμs 平均=%.0fμs 最大=%luμs 批量等待最大=%luμs 吞吐=%.1f KB/s\n",
+                      telemLink.latency_last, telem_link_latency_avg(&telemLink),
+                      telemLink.latency_max, telemLink.age_max,
+                      telem_link_throughput(&telemLink) / 1024.0f);
+    }
+}
+
+// ==================== 串口命令 ====================
+void processSerialCommand()
+{
+    if (!Serial.available())
+        return;
+
+    char cmd = Serial.read();
+    while (Serial.available())
+        Serial.read(); // 清空缓冲区
+
+    switch (cmd)
+    {
+    case 'c':
+    case 'C':
+        telem_link_init(&telemLink);
+        rxQueueDrops = 0;
+        Serial.println("✓ 统计已清零");
+        break;
+
+    case 'h':
+    case 'H':
+        Serial.println("\n串口命令:");
+        Serial.println("  c - 清零链路统计");
+        Serial.println("  h - 显示帮助信息");
+        break;
+
+    default:
+        Serial.println("未知命令，输入 'h' 查看帮助");
+        break;
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    rxQueue = xQueueCreate(RX_QUEUE_LEN, sizeof(RxFrame));
+    telem_tx_init(&telemTx, TELEM_NODE_ID);
+    telem_link_init(&telemLink);
+    memset(&hipnuc_raw, 0, sizeof(hipnuc_raw_t));
+
+#if TELEM_SENDER
+    Serial2.begin(IMU_BAUDRATE, SERIAL_8N1, RS485_2_RX_PIN, RS485_2_TX_PIN);
+    pinMode(RS485_2_DE_PIN, OUTPUT);
+    digitalWrite(RS485_2_DE_PIN, LOW); // 接收模式
+#endif
+
+    if (!initESPNow())
+    {
+        Serial.println("❌ ESP-NOW初始化失败，系统停止");
+        while (1)
+            delay(1000);
+    }
+
+    Serial.printf("✓ 遥测%s已启动\n", TELEM_SENDER ? "发送端" : "接收端");
+}
+
+// ==================== Loop ====================
+void loop()
+{
+#if TELEM_SENDER
+    senderLoop();
+#else
+    receiverLoop();
+#endif
+    processSerialCommand();
+}
@@ -0,0 +1,353 @@
+/**
+ * @file imu_sd_logger.cpp
+ * @brief IMU 数据压缩记录到 SD 卡示例（量化 + 差分 + varint 编码）
+ * @note 使用 imu_codec 将 HI91/HI81 记录压缩后写入 SD 卡，并提供离线压缩率/耗时评估
+ *
+ * 硬件连接：
+ * - IMU(HiPNUC) 链接到 RS485_2（GPIO26 RX、GPIO27 TX、GPIO14 DE）
+ * - SD 卡使用共享 SPI 总线（CS=GPIO10）
+ *
+ * 文件说明：
+ * - imu_log.bin  压缩后的记录流（每 4KB 一个块写入）
+ * - imu_raw.rcap 带时间戳的原始 RS485 字节流录制（RCAP 格式，'c' 命令开关），
+ *                用于离线评估，也可拷到电脑上用 bench/rs485_replay.c 重放
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <SdFat.h>
+#include "hipnuc_dec.h"
+#include "imu_codec.h"
+#include "rs485_capture.h"
+#include "pin_config.h"
+
+// ==================== 配置常量 ====================
+#define SPI_SPEED SD_SCK_MHZ(25) // 25MHz SPI速度
+#define LOG_BLOCK_SIZE 4096      // SD 写入块大小（与簇对齐，减少写放大）
+#define KEY_INTERVAL 400         // 关键帧间隔（400Hz 下 1 秒）
+
+const char *LOG_FILE = "imu_log.bin";
+const char *RAW_FILE = "imu_raw.rcap";
+
+// ==================== 全局对象 ====================
+SdFat sd;
+SdFile logFile;
+SdFile rawFile;
+hipnuc_raw_t hipnuc_raw;
+imu_codec_t encoder;
+
+uint8_t logBlock[LOG_BLOCK_SIZE];
+size_t logFill = 0;
+
+bool logging = false;
+bool capturing = false;
+
+// 统计
+uint32_t encodeCycles = 0;
+uint32_t encodedRecords = 0;
+unsigned long lastReport = 0;
+
+// ==================== 日志块写入 ====================
+void flushLogBlock()
+{
+    if (logFill == 0)
+        return;
+    logFile.write(logBlock, logFill);
+    logFill = 0;
+}
+
+void appendRecord(const uint8_t *rec, int len)
+{
+    if (logFill + len > LOG_BLOCK_SIZE)
+    {
+        flushLogBlock();
+    }
+    memcpy(logBlock + logFill, rec, len);
+    logFill += len;
+}
+
+// ==================== 编码一帧 ====================
+void encodeFrame(hipnuc_raw_t *raw)
+{
+    uint8_t rec[IMU_CODEC_MAX_RECORD_SIZE];
+    int len = 0;
+
+    uint32_t start = ESP.getCycleCount();
+    if (raw->hi91.tag == 0x91)
+    {
+        len = imu_codec_encode_hi91(&encoder, &raw->hi91, rec, sizeof(rec));
+    }
+    else if (raw->hi81.tag == 0x81)
+    {
+        len = imu_codec_encode_hi81(&encoder, &raw->hi81, rec, sizeof(rec));
+    }
+    uint32_t elapsed = ESP.getCycleCount() - start;
+
+    // 只统计实际编码的帧（HI83 等不编码的帧不计入），与 encodedRecords 对应
+    if (len > 0)
+    {
+        encodeCycles += elapsed;
+        encodedRecords++;
+        appendRecord(rec, len);
+    }
+}
+
+// ==================== 开始/停止记录 ====================
+void startLogging()
+{
+    if (!logFile.open(LOG_FILE, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        Serial.println("❌ 无法创建日志文件");
+        return;
+    }
+    imu_codec_init(&encoder, KEY_INTERVAL);
+    encodeCycles = 0;
+    encodedRecords = 0;
+    logFill = 0;
+    logging = true;
+    Serial.println("✓ 开始压缩记录");
+}
+
+void stopLogging()
+{
+    flushLogBlock();
+    logFile.close();
+    logging = false;
+    Serial.printf("✓ 停止记录: %lu 条, 压缩率 %.2f:1\n",
+                  encoder.records, imu_codec_ratio(&encoder));
+}
+
+void toggleCapture()
+{
+    if (capturing)
+    {
+        rawFile.close();
+        capturing = false;
+        Serial.println("✓ 原始字节录制已停止");
+        return;
+    }
+    if (!rawFile.open(RAW_FILE, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        Serial.println("❌ 无法创建录制文件");
+        return;
+    }
+    uint8_t hdr[RCAP_HEADER_SIZE];
+    rcap_encode_header(hdr, IMU_BAUDRATE);
+    rawFile.write(hdr, sizeof(hdr));
+    capturing = true;
+    Serial.println("✓ 开始录制原始字节流");
+}
+
+// ==================== 离线评估 ====================
+/**
+ * @brief 对录制的原始字节流做解帧 + 压缩 + 解压校验
+ * @note 报告压缩率、每条记录的编码周期数，并逐位比较往返结果
+ */
+void benchmarkTrace()
+{
+    SdFile trace;
+    if (!trace.open(RAW_FILE, O_RDONLY))
+    {
+        Serial.println("❌ 未找到录制文件，请先用 'c' 命令录制");
+        return;
+    }
+
+    static hipnuc_raw_t raw;
+    imu_codec_t enc, dec;
+    memset(&raw, 0, sizeof(raw));
+    imu_codec_init(&enc, KEY_INTERVAL);
+    imu_codec_init(&dec, KEY_INTERVAL);
+
+    uint8_t hdr[RCAP_HEADER_SIZE];
+    uint32_t baud;
+    if (trace.read(hdr, sizeof(hdr)) != sizeof(hdr) || !rcap_decode_header(hdr, &baud))
+    {
+        trace.close();
+        Serial.println("❌ 录制文件格式无效，请重新录制");
+        return;
+    }
+
+    uint8_t chunk[512];
+    uint8_t rec[IMU_CODEC_MAX_RECORD_SIZE];
+    uint8_t recHdr[RCAP_RECORD_HDR_SIZE];
+    uint32_t cycles = 0, maxCycles = 0, mismatches = 0, frames = 0;
+    int n;
+
+    // 逐条记录读取；离线评估只关心字节内容，时间戳留给主机重放工具
+    while (trace.read(recHdr, sizeof(recHdr)) == sizeof(recHdr))
+    {
+        uint32_t t_us;
+        uint16_t recLen;
+        rcap_decode_record_hdr(recHdr, &t_us, &recLen);
+        n = trace.read(chunk, min((int)recLen, (int)sizeof(chunk)));
+        if (n <= 0)
+            break;
+        for (int i = 0; i < n; i++)
+        {
+            if (hipnuc_input(&raw, chunk[i]) <= 0)
+                continue;
+
+            int len = 0;
+            uint32_t start = ESP.getCycleCount();
+            if (raw.hi91.tag == 0x91)
+                len = imu_codec_encode_hi91(&enc, &raw.hi91, rec, sizeof(rec));
+            else if (raw.hi81.tag == 0x81)
+                len = imu_codec_encode_hi81(&enc, &raw.hi81, rec, sizeof(rec));
+            uint32_t c = ESP.getCycleCount() - start;
+            if (len <= 0)
+                continue;
+
+            frames++;
+            cycles += c;
+            if (c > maxCycles)
+                maxCycles = c;
+
+            // 往返校验：HI91 与量化结果比较，HI81 与原始结构体比较
+            hi91_t o91, q91;
+            hi81_t o81;
+            if (imu_codec_decode(&dec, rec, len, &o91, &o81) != len)
+            {
+                mismatches++;
+            }
+            else if (rec[0] == IMU_CODEC_REC_HI91_DELTA || rec[0] == IMU_CODEC_REC_HI91_KEY)
+            {
+                imu_codec_quantize_hi91(&raw.hi91, &q91);
+                if (memcmp(&o91, &q91, sizeof(hi91_t)) != 0)
+                    mismatches++;
+            }
+            else if (memcmp(&o81, &raw.hi81, sizeof(hi81_t)) != 0)
+            {
+                mismatches++;
+            }
+        }
+    }
+    trace.close();
+
+    Serial.println("\n========== 压缩评估 ==========");
+    Serial.printf("记录数: %lu (关键帧 %lu)\n", frames, enc.keyframes);
+    Serial.printf("原始字节: %lu\n", enc.raw_bytes);
+    Serial.printf("压缩字节: %lu\n", enc.coded_bytes);
+    Serial.printf("压缩率: %.2f:1\n", imu_codec_ratio(&enc));
+    if (frames > 0)
+    {
+        Serial.printf("编码耗时: 平均 %lu 周期/条 (%.2f μs), 最大 %lu 周期\n",
+                      cycles / frames, (float)cycles / frames / ESP.getCpuFreqMHz(), maxCycles);
+    }
+    Serial.printf("往返校验: %s (%lu 处不一致)\n", mismatches == 0 ? "逐位一致" : "失败", mismatches);
+    Serial.println("==============================\n");
+}
+
+// ==================== 菜单 ====================
+void printMenu()
+{
+    Serial.println("\n╔════════════════════════════════════════╗");
+    Serial.println("║      IMU 压缩记录 SD 卡演示           ║");
+    Serial.println("╚════════════════════════════════════════╝");
+    Serial.println("  l - 开始/停止压缩记录");
+    Serial.println("  c - 开始/停止原始字节录制");
+    Serial.println("  b - 对录制文件做压缩评估");
+    Serial.println("  h - 显示帮助信息");
+    Serial.println();
+}
+
+void processSerialCommand()
+{
+    if (!Serial.available())
+        return;
+
+    char cmd = Serial.read();
+    while (Serial.available())
+        Serial.read(); // 清空缓冲区
+
+    switch (cmd)
+    {
+    case 'l':
+    case 'L':
+        logging ? stopLogging() : startLogging();
+        break;
+    case 'c':
+    case 'C':
+        toggleCapture();
+        break;
+    case 'b':
+    case 'B':
+        if (logging || capturing)
+        {
+            Serial.println("⚠ 请先停止记录/录制");
+            break;
+        }
+        benchmarkTrace();
+        break;
+    case 'h':
+    case 'H':
+        printMenu();
+        break;
+    default:
+        Serial.println("未知命令，输入 'h' 查看帮助");
+        break;
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    Serial2.begin(IMU_BAUDRATE, SERIAL_8N1, RS485_2_RX_PIN, RS485_2_TX_PIN);
+    pinMode(RS485_2_DE_PIN, OUTPUT);
+    digitalWrite(RS485_2_DE_PIN, LOW); // 接收模式
+
+    memset(&hipnuc_raw, 0, sizeof(hipnuc_raw_t));
+
+    if (!sd.begin(SD_CS_PIN, SPI_SPEED))
+    {
+        Serial.println("❌ SD卡初始化失败！");
+    }
+    else
+    {
+        Serial.println("✓ SD卡初始化成功");
+    }
+
+    printMenu();
+}
+
+// ==================== Loop ====================
+void loop()
+{
+    uint8_t chunk[128];
+
+    // 批量读取IMU数据
+    int n = Serial2.available();
+    if (n > 0)
+    {
+        n = Serial2.readBytes(chunk, min(n, (int)sizeof(chunk)));
+        if (capturing)
+        {
+            uint8_t recHdr[RCAP_RECORD_HDR_SIZE];
+            rcap_encode_record_hdr(recHdr, micros(), (uint16_t)n);
+            rawFile.write(recHdr, sizeof(recHdr));
+            rawFile.write(chunk, n);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            if (hipnuc_input(&hipnuc_raw, chunk[i]) > 0 && logging)
+            {
+                encodeFrame(&hipnuc_raw);
+            }
+        }
+    }
+
+    // 每秒报告一次
+    unsigned long now = millis();
+    if (logging && now - lastReport >= 1000)
+    {
+        lastReport = now;
+        Serial.printf("[记录] %lu 条 | 压缩率 %.2f:1 | %lu 周期/条\n",
+                      encodedRecords, imu_codec_ratio(&encoder),
+                      encodedRecords ? encodeCycles / encodedRecords : 0);
+    }
+
+    processSerialCommand();
+}
@@ -0,0 +1,206 @@
+/**
+ * @file pca9555_input_demo.cpp
+ * @brief PCA9555 中断驱动输入示例 - INT 触发读取、软件消抖、事件队列
+ * @note 取代轮询 readGpioStatus()：空闲时 I2C 总线零访问，输入延迟由消抖时间决定
+ *
+ * 硬件连接：
+ * - PCA9555 SDA -> ESP32 GPIO 21
+ * - PCA9555 SCL -> ESP32 GPIO 22
+ * - PCA9555 INT -> ESP32 GPIO 4（开漏输出，需上拉；按实际接线修改 PCA9555_INT_PIN）
+ * - Port 0 (P0.0-P0.7): 片选输出 CS0-CS7
+ * - Port 1 (P1.0-P1.7): 输入（按键/限位开关/设备 BUSY 信号），按下接地
+ *
+ * 串口命令：
+ * - s: 统计（INT 次数、I2C 读取次数、抖动次数、事件数）
+ * - p: 打印当前消抖后的输入状态
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "pca9555_cs.h"
+#include "pca9555_input.h"
+
+// ==================== 引脚配置 ====================
+#define I2C_SDA_PIN 21
+#define I2C_SCL_PIN 22
+#define I2C_FREQ 400000
+#define PCA9555_ADDR 0x20
+#define PCA9555_INT_PIN 4
+
+#define CS_MASK 0x00FF    // Port 0：片选输出
+#define INPUT_MASK 0xFF00 // Port 1：输入
+#define DEBOUNCE_US 10000 // 消抖时间 10ms
+
+// ==================== 全局变量 ====================
+pca9555_cs_t csDriver;
+pca9555_in_t inputs;
+
+volatile bool intPending = false;
+volatile uint32_t intTimeUs = 0;
+volatile uint32_t intCount = 0;
+
+// ==================== I2C 访问 ====================
+int pcaWrite(void *ctx, uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    Wire.beginTransmission(PCA9555_ADDR);
+    Wire.write(reg);
+    Wire.write(data, len);
+    return Wire.endTransmission();
+}
+
+/**
+ * @brief 一次传输读取两个输入端口（寄存器 0、1 自动递增），同时清除 INT
+ */
+bool readInputPorts(uint16_t *value)
+{
+    Wire.beginTransmission(PCA9555_ADDR);
+    Wire.write(PCA9555_REG_INPUT0);
+    if (Wire.endTransmission(false) != 0)
+        return false;
+    if (Wire.requestFrom((uint8_t)PCA9555_ADDR, (uint8_t)2) != 2)
+        return false;
+    uint8_t lo = Wire.read();
+    uint8_t hi = Wire.read();
+    *value = (uint16_t)(lo | (hi << 8));
+    return true;
+}
+
+// ==================== INT 中断（只记录时间） ====================
+void IRAM_ATTR onExpanderInt()
+{
+    if (!intPending)
+        intTimeUs = micros();
+    intPending = true;
+    intCount++;
+}
+
+// ==================== 输入服务 ====================
+/**
+ * @brief 主循环调用：有 INT 时读一次端口，消抖中时检查到期，空闲时不访问总线
+ */
+void serviceInputs()
+{
+    // INT 为电平信号：读取期间又有变化时 INT 保持低电平，需要再读一次
+    while (intPending || digitalRead(PCA9555_INT_PIN) == LOW)
+    {
+        uint16_t port;
+        uint32_t t;
+
+        noInterrupts();
+        t = intPending ? intTimeUs : micros();
+        intPending = false;
+        interrupts();
+
+        if (!readInputPorts(&port))
+            break;
+        pca9555_in_update(&inputs, port, t);
+    }
+
+    if (pca9555_in_busy(&inputs))
+        pca9555_in_poll(&inputs, micros());
+}
+
+void printInputState()
+{
+    Serial.print("Port 1 (消抖后): ");
+    for (int i = 15; i >= 8; i--)
+    {
+        Serial.print((inputs.stable & (1 << i)) ? "1" : "0");
+        if (i == 12)
+            Serial.print(" ");
+    }
+    Serial.println();
+}
+
+void printStats()
+{
+    const pca9555_in_stats_t *st = &inputs.stats;
+
+    Serial.println("\n========== 输入服务统计 ==========");
+    Serial.printf("INT中断: %lu  端口读取: %lu（%lu 字节）\n", intCount, st->reads, st->reads * 2);
+    Serial.printf("原始边沿: %lu  抖动丢弃: %lu  事件: %lu  队列溢出: %lu\n",
+                  st->edges, st->bounces, st->events, st->overflow);
+    Serial.println("==================================\n");
+}
+
+// ==================== 串口命令 ====================
+void processSerialCommand()
+{
+    if (!Serial.available())
+        return;
+
+    char cmd = Serial.read();
+    while (Serial.available())
+        Serial.read(); // 清空缓冲区
+
+    switch (cmd)
+    {
+    case 's':
+    case 'S':
+        printStats();
+        break;
+
+    case 'p':
+    case 'P':
+        printInputState();
+        break;
+
+    case 'h':
+    case 'H':
+        Serial.println("\n串口命令:");
+        Serial.println("  s - 输入服务统计");
+        Serial.println("  p - 当前输入状态");
+        Serial.println("  h - 显示帮助信息");
+        break;
+
+    default:
+        Serial.println("未知命令，输入 'h' 查看帮助");
+        break;
+    }
+}
+
+// ==================== Setup ====================
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+    Serial.println("\n\n");
+
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+    Wire.setClock(I2C_FREQ);
+
+    // Port 0 为片选输出，Port 1 保持输入
+    if (pca9555_cs_init(&csDriver, CS_MASK, pcaWrite, NULL) != 0)
+    {
+        Serial.println("❌ PCA9555初始化失败！检查I2C连接和地址");
+        while (1)
+            delay(1000);
+    }
+
+    // 读一次初始状态（同时清除上电时可能挂起的 INT）
+    uint16_t port = 0xFFFF;
+    readInputPorts(&port);
+    pca9555_in_init(&inputs, INPUT_MASK, port, DEBOUNCE_US);
+
+    pinMode(PCA9555_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(PCA9555_INT_PIN), onExpanderInt, FALLING);
+
+    Serial.println("✓ PCA9555输入服务已启动（INT触发，10ms消抖）");
+    printInputState();
+}
+
+// ==================== Loop ====================
+void loop()
+{
+    pca9555_in_event_t ev;
+
+    serviceInputs();
+
+    while (pca9555_in_pop(&inputs, &ev))
+    {
+        Serial.printf("[%10lu μs] P1.%d %s  (确认延迟 %lu μs)\n",
+                      ev.t_us, ev.pin - 8, ev.level ? "释放" : "按下", micros() - ev.t_us);
+    }
+
+    processSerialCommand();
+}
@@ -19,12 +19,19 @@
  * - SDA   -> GPIO 21
  * - SCL   -> GPIO 22
  * - CS0-CS15 从PCA9555的P0.0-P1.7输出
+ *
+ * 片选通过 pca9555_cs 影子寄存器驱动（include/pca9555_cs.h）：不回读、只写变化的端口字节，
+ * 切换到 SPI 设置相同的设备时"释放旧片选 + 选中新片选"合并为一次 I2C 写入；
+ * 设置不同时先释放旧片选，再切换 SPI 模式 / 时钟
  */
 
 #include <Arduino.h>
 #include <Wire.h>
 #include <TCA9555.h>
 #include <SPI.h>
+#include "pca9555_cs.h"
+#include "spi_txq.h"
+#include "microbench.h"
 
 // ==================== 引脚定义 ====================
 // I2C
@@ -39,34 +46,49 @@
 // PCA9555地址
 #define PCA9555_ADDR 0x20
 
+// 用作片选的引脚（CS0-CS15）
+#define CS_PIN_MASK 0xFFFF
+
 // ==================== 全局对象 ====================
-TCA9555 csExpander(PCA9555_ADDR);
-SPIClass spi(VSPI); // 使用VSPI
+TCA9555 csExpander(PCA9555_ADDR); // 仅用于探测器件与性能对比
+pca9555_cs_t csDriver;            // 影子寄存器片选驱动
+SPIClass spi(VSPI);               // 使用VSPI
+
+/**
+ * @brief pca9555_cs 的 I2C 写回调：寄存器地址 + 连续数据，一次传输
+ */
+int pcaWrite(void *ctx, uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    Wire.beginTransmission(PCA9555_ADDR);
+    Wire.write(reg);
+    Wire.write(data, len);
+    return Wire.endTransmission();
+}
 
 // ==================== SPI设备类封装 ====================
 class SPIDevice
 {
 private:
-    uint8_t cs_pin;         // PCA9555上的CS引脚编号
-    uint32_t spi_freq;      // SPI频率
-    uint8_t spi_mode;       // SPI模式
-    TCA9555 *gpio_expander; // GPIO扩展器指针
+    uint8_t cs_pin;          // PCA9555上的CS引脚编号
+    uint32_t spi_freq;       // SPI频率
+    uint8_t spi_mode;        // SPI模式
+    pca9555_cs_t *cs_driver; // 片选驱动指针
 
 public:
     SPIDevice(uint8_t cs, uint32_t freq = 1000000, uint8_t mode = SPI_MODE0)
         : cs_pin(cs), spi_freq(freq), spi_mode(mode)
     {
-        gpio_expander = &csExpander;
+        cs_driver = &csDriver;
     }
 
     /**
      * @brief 开始SPI传输（选中设备）
+     * @note I2C 写入本身耗时数十微秒，远超 CS 建立时间，不再额外延时
      */
     void begin()
     {
         spi.beginTransaction(SPISettings(spi_freq, MSBFIRST, spi_mode));
-        gpio_expander->digitalWrite(cs_pin, LOW);
-        delayMicroseconds(1); // CS建立时间
+        pca9555_cs_select(cs_driver, cs_pin);
     }
 
     /**
@@ -75,10 +97,22 @@ public:
     void end()
     {
         delayMicroseconds(1); // CS保持时间
-        gpio_expander->digitalWrite(cs_pin, HIGH);
+        pca9555_cs_write_pin(cs_driver, cs_pin, HIGH);
         spi.endTransaction();
     }
 
+    /**
+     * @brief 完整事务：选中 -> 全双工传输 -> 释放
+     * @param tx 发送数据
+     * @param rx 接收缓冲（可为 NULL）
+     */
+    void transaction(const uint8_t *tx, uint8_t *rx, size_t len)
+    {
+        begin();
+        spi.transferBytes(tx, rx, len);
+        end();
+    }
+
     /**
      * @brief 发送单字节数据
      */
@@ -118,6 +152,10 @@ public:
     {
         spi.write32(data);
     }
+
+    uint8_t csPin() const { return cs_pin; }
+    uint32_t freq() const { return spi_freq; }
+    uint8_t mode() const { return spi_mode; }
 };
 
 // ==================== 示例：多个SPI设备实例 ====================
@@ -129,6 +167,55 @@ SPIDevice display2(4, 40000000);  // CS4: LCD Display #2, 40MHz
 SPIDevice sensor1(5, 1000000);    // CS5: 传感器 #1, 1MHz
 SPIDevice sensor2(6, 1000000);    // CS6: 传感器 #2, 1MHz
 
+SPIDevice *allDevices[] = {&flash_chip, &adc_chip, &dac_chip, &display1, &display2, &sensor1, &sensor2};
+#define NUM_DEVICES (sizeof(allDevices) / sizeof(allDevices[0]))
+
+// ==================== SPI事务队列 ====================
+// 同一设备的连续作业只选中一次；切换到 SPI 设置相同的设备时释放与选中合并为一次 I2C 写
+spi_txq_t txq;
+int txqDevId[NUM_DEVICES]; // allDevices 下标 -> 队列设备编号
+bool txqInTransaction = false;
+uint8_t txqMode;  // 当前事务的 SPI 模式
+uint32_t txqFreq; // 当前事务的 SPI 时钟
+
+int txqSelect(void *ctx, const spi_txq_dev_t *dev)
+{
+    // 上一个设备的 CS 仍有效：模式或时钟不同时先释放，再重新配置总线，
+    // 否则 SCK 空闲电平变化会被旧设备当作时钟沿
+    if (txqInTransaction && (dev->mode != txqMode || dev->freq_hz != txqFreq))
+    {
+        int rc = pca9555_cs_release(&csDriver);
+        spi.endTransaction();
+        txqInTransaction = false;
+        if (rc != 0)
+            return rc;
+    }
+    if (!txqInTransaction)
+    {
+        spi.beginTransaction(SPISettings(dev->freq_hz, MSBFIRST, dev->mode));
+        txqMode = dev->mode;
+        txqFreq = dev->freq_hz;
+        txqInTransaction = true;
+    }
+    return pca9555_cs_select(&csDriver, dev->cs_pin);
+}
+
+int txqRelease(void *ctx)
+{
+    int rc = pca9555_cs_release(&csDriver);
+    if (txqInTransaction)
+        spi.endTransaction();
+    txqInTransaction = false;
+    return rc;
+}
+
+void txqTransfer(void *ctx, const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+    spi.transferBytes(tx, rx, len);
+}
+
+const spi_txq_ops_t txqOps = {txqSelect, txqRelease, txqTransfer};
+
 // ==================== 初始化函数 ====================
 bool initSystem()
 {
@@ -144,11 +231,11 @@ bool initSystem()
     }
     Serial.println("✓ PCA9555初始化成功");
 
-    // 配置所有CS引脚为输出并置高
-    for (int i = 0; i < 16; i++)
+    // 配置所有CS引脚为输出并置高（先写输出寄存器再切方向，避免毛刺）
+    if (pca9555_cs_init(&csDriver, CS_PIN_MASK, pcaWrite, NULL) != 0)
     {
-        csExpander.pinMode(i, OUTPUT);
-        csExpander.digitalWrite(i, HIGH);
+        Serial.println("❌ 片选引脚初始化失败！");
+        return false;
     }
     Serial.println("✓ 片选引脚初始化完成");
 
@@ -156,6 +243,11 @@ bool initSystem()
     spi.begin(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN, -1);
     Serial.println("✓ SPI总线初始化完成");
 
+    // 注册事务队列设备
+    spi_txq_init(&txq, &txqOps, NULL);
+    for (size_t i = 0; i < NUM_DEVICES; i++)
+        txqDevId[i] = spi_txq_add_device(&txq, allDevices[i]->csPin(), allDevices[i]->freq(), allDevices[i]->mode());
+
     return true;
 }
 
@@ -168,16 +260,13 @@ void readFlashID()
 {
     Serial.println("\n【读取Flash芯片ID】");
 
-    flash_chip.begin();
-    flash_chip.write(0x9F); // Read JEDEC ID命令
-    uint8_t mfg = flash_chip.transfer(0x00);
-    uint8_t type = flash_chip.transfer(0x00);
-    uint8_t capacity = flash_chip.transfer(0x00);
-    flash_chip.end();
+    const uint8_t tx[4] = {0x9F, 0x00, 0x00, 0x00}; // Read JEDEC ID命令
+    uint8_t rx[4];
+    flash_chip.transaction(tx, rx, sizeof(tx));
 
-    Serial.printf("制造商ID: 0x%02X\n", mfg);
-    Serial.printf("类型ID: 0x%02X\n", type);
-    Serial.printf("容量ID: 0x%02X\n", capacity);
+    Serial.printf("制造商ID: 0x%02X\n", rx[1]);
+    Serial.printf("类型ID: 0x%02X\n", rx[2]);
+    Serial.printf("容量ID: 0x%02X\n", rx[3]);
 }
 
 /**
@@ -244,24 +333,121 @@ void setDacOutput(uint16_t value)
     Serial.printf("DAC输出设置为: %d\n", value);
 }
 
+// ==================== 性能测试 ====================
+// 每次操作为一次完整翻转（选中 + 释放），由微基准注册表预热、多次计时并取中位数
+uint32_t perfTicks()
+{
+    return ESP.getCycleCount();
+}
+
+void perfPrint(const char *text)
+{
+    Serial.print(text);
+}
+
+/* 优化前：TCA9555::digitalWrite() 每次先读输出寄存器再写回 */
+uint32_t perfLibToggle(void *ctx)
+{
+    csExpander.digitalWrite(0, LOW);
+    csExpander.digitalWrite(0, HIGH);
+    return 0;
+}
+
+/* 优化后：影子寄存器，只写变化的端口字节 */
+uint32_t perfShadowToggle(void *ctx)
+{
+    pca9555_cs_write_pin(&csDriver, 0, LOW);
+    pca9555_cs_write_pin(&csDriver, 0, HIGH);
+    return 0;
+}
+
+/* 跨端口切换设备（CS0 <-> CS8）：释放 + 选中合并为一次 2 字节写入 */
+uint32_t perfSwitch(void *ctx)
+{
+    pca9555_cs_select(&csDriver, 0);
+    pca9555_cs_select(&csDriver, 8);
+    return 0;
+}
+
+void perfRelease(void *ctx)
+{
+    pca9555_cs_release(&csDriver);
+}
+
+const microbench_t perfBenches[] = {
+    {"cs_lib_toggle", NULL, perfLibToggle, NULL, NULL, 8},
+    {"cs_shadow_toggle", NULL, perfShadowToggle, NULL, NULL, 8},
+    {"cs_switch_port", NULL, perfSwitch, perfRelease, NULL, 8},
+};
+
 /**
- * @brief 性能测试：快速切换片选
+ * @brief 性能测试：快速切换片选（库函数读-改-写 vs 影子寄存器）
  */
 void performanceTest()
 {
+    microbench_cfg_t cfg = {perfTicks, (uint32_t)ESP.getCpuFreqMHz(), 3, 21};
+    uint32_t bytesBefore = csDriver.stats.bytes, writesBefore = csDriver.stats.writes;
+
     Serial.println("\n【性能测试：片选切换速度】");
+    microbench_suite(perfBenches, sizeof(perfBenches) / sizeof(perfBenches[0]), &cfg, perfPrint);
+    uint32_t writes = csDriver.stats.writes - writesBefore;
+    Serial.printf("影子寄存器总线字节: %.1f/次写入  省略写入: %lu  写失败: %lu\n",
+                  writes ? (float)(csDriver.stats.bytes - bytesBefore) / writes : 0.0f, csDriver.stats.skipped,
+                  csDriver.stats.errors);
+}
 
-    unsigned long start = micros();
-    for (int i = 0; i < 1000; i++)
+/**
+ * @brief 吞吐量测试：7 个设备轮询读写，逐个事务 vs 事务队列
+ * @note 作业按设备轮流提交（与实际轮询顺序一致）；Flash 作业置 SPI_TXQ_CS_BREAK 保持命令分帧
+ */
+void throughputTest()
+{
+    const int ROUNDS = 20;
+    const int JOBS_PER_DEV = 4;
+    const uint16_t JOB_LEN = 16;
+    static uint8_t txBuf[JOB_LEN];
+    static uint8_t rxBuf[NUM_DEVICES][JOBS_PER_DEV][JOB_LEN];
+    const uint32_t totalJobs = ROUNDS * JOBS_PER_DEV * NUM_DEVICES;
+    unsigned long start, tDirect, tQueue;
+    uint32_t writesBefore, writesDirect, writesQueue;
+
+    Serial.println("\n【吞吐量测试：7设备事务分组】");
+    memset(txBuf, 0x00, sizeof(txBuf));
+
+    // 逐个事务：每个作业都要选中 + 释放
+    writesBefore = csDriver.stats.writes;
+    start = micros();
+    for (int r = 0; r < ROUNDS; r++)
+        for (int j = 0; j < JOBS_PER_DEV; j++)
+            for (size_t d = 0; d < NUM_DEVICES; d++)
+                allDevices[d]->transaction(txBuf, rxBuf[d][j], JOB_LEN);
+    tDirect = micros() - start;
+    writesDirect = csDriver.stats.writes - writesBefore;
+
+    // 事务队列：按设备分组，每组只选中一次
+    spi_txq_stats_t before = txq.stats;
+    writesBefore = csDriver.stats.writes;
+    start = micros();
+    for (int r = 0; r < ROUNDS; r++)
     {
-        csExpander.digitalWrite(0, LOW);
-        csExpander.digitalWrite(0, HIGH);
+        for (int j = 0; j < JOBS_PER_DEV; j++)
+            for (size_t d = 0; d < NUM_DEVICES; d++)
+                spi_txq_submit(&txq, txqDevId[d], txBuf, rxBuf[d][j], JOB_LEN, d == 0 ? SPI_TXQ_CS_BREAK : 0);
+        spi_txq_flush(&txq);
     }
-    unsigned long elapsed = micros() - start;
-
-    Serial.printf("1000次片选切换耗时: %lu μs\n", elapsed);
-    Serial.printf("单次切换平均耗时: %.2f μs\n", elapsed / 1000.0);
-    Serial.printf("理论最大切换频率: %.1f kHz\n", 1000000.0 / (elapsed / 1000.0));
+    tQueue = micros() - start;
+    writesQueue = csDriver.stats.writes - writesBefore;
+
+    Serial.println("方式        作业/秒   吞吐量      I2C写/作业");
+    Serial.printf("逐个事务   %8.0f  %6.1f KB/s  %.2f\n",
+                  totalJobs * 1e6 / tDirect, totalJobs * JOB_LEN * 1e6 / 1024.0 / tDirect,
+                  (float)writesDirect / totalJobs);
+    Serial.printf("事务队列   %8.0f  %6.1f KB/s  %.2f\n",
+                  totalJobs * 1e6 / tQueue, totalJobs * JOB_LEN * 1e6 / 1024.0 / tQueue,
+                  (float)writesQueue / totalJobs);
+    Serial.printf("加速比: %.2fx  节省片选操作: %lu  重排作业: %lu\n",
+                  (float)tDirect / tQueue, txq.stats.cs_saved - before.cs_saved,
+                  txq.stats.reordered - before.reordered);
 }
 
 /**
@@ -274,11 +460,11 @@ void demoBulkOperation()
     // 一次性设置Port 0的CS0,CS2,CS4,CS6为低电平
     // 位掩码: 0b10101010 = 0xAA (奇数位为高，偶数位为低)
     Serial.println("同时选中CS1,CS3,CS5,CS7...");
-    csExpander.write8(0, 0xAA);
+    pca9555_cs_write16(&csDriver, 0xFFAA);
     delay(500);
 
     // 恢复
-    csExpander.write8(0, 0xFF);
+    pca9555_cs_release(&csDriver);
     Serial.println("释放所有片选");
 }
 
@@ -340,6 +526,10 @@ void loop()
 
     // 演示6: 性能测试
     performanceTest();
+    delay(1000);
+
+    // 演示7: 事务队列吞吐量
+    throughputTest();
 
     Serial.println("\n========== 演示结束 ==========");
     Serial.println("等待10秒后重复...\n");
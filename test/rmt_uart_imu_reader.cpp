@@ -0,0 +1,173 @@
+/**
+ * @file rmt_uart_imu_reader.cpp
+ * @brief 用 RMT 接收多路 UART（HiPNUC IMU）示例：硬件记录电平游程，CPU 按帧批量解码
+ * @note 位解码见 include/swuart.h，可在主机上用 bench/swuart_test.c 验证
+ *
+ * 硬件连接（两路 RS485 收发器的 RX 输出，DE 拉低保持接收）：
+ * - 通道 A：RS485_2 RX -> GPIO26（IMU，DE=GPIO14）
+ * - 通道 B：RS485_1 RX -> GPIO32（第二个 IMU 或其它 HiPNUC 设备，DE=GPIO25）
+ *
+ * 工作方式：
+ * - RMT 通道以 80MHz 计数记录 RX 线的每段电平，线路空闲超过 IDLE_BITS 位后结束本次采集，
+ *   整段条目通过驱动的环形缓冲交给 loop()，一次采集（一帧数据）只唤醒 CPU 一次
+ * - 经典 ESP32 的 RMT 接收没有乒乓模式，一次采集必须放得下所有条目：
+ *   每个内存块 64 条目，随机数据平均约 2.75 条目/字节，最坏（0x55）5 条目/字节，
+ *   每路分配 4 块（256 条目）约可容纳 90 字节的连续数据，需要 IMU 帧之间有空闲间隔
+ * - 条目数达到上限（没有结束标记）的采集计为“截断”，说明帧太长或帧间没有空闲
+ * - 与 main.cpp 合用时 RMT_CHANNEL_0 已用于 WS2812B（1 块），可改用通道 1（3 块）+ 通道 4（4 块）
+ */
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include <freertos/ringbuf.h>
+#include "hipnuc_dec.h"
+#include "hipnuc_sync.h"
+#include "rate_est.h"
+#include "swuart.h"
+#include "pin_config.h"
+
+// ==================== 配置常量 ====================
+#define RMT_CLK_DIV 1           // 80MHz 计数，12.5ns 分辨率
+#define RMT_TICK_HZ 80000000u
+#define RMT_MEM_BLOCKS 4        // 每路 4 块 = 256 条目
+#define RMT_RINGBUF_SIZE 4096   // 驱动环形缓冲（可暂存多次采集）
+#define RMT_FILTER_TICKS 100    // 滤除 <1.25us 的毛刺（寄存器 8 位，按 APB 时钟计）
+#define IDLE_BITS 12            // 空闲超过 12 位结束一次采集（须 <32767 tick）
+#define UART_BAUD IMU_BAUDRATE
+#define PRINT_INTERVAL_MS 1000
+
+struct RxChannel
+{
+    const char *name;
+    rmt_channel_t ch;
+    int rxPin;
+    int dePin;
+
+    RingbufHandle_t rb;
+    swuart_t uart;
+    hipnuc_sync_t sync;
+    hipnuc_raw_t raw;
+    rate_est_t rate;
+    uint32_t captures;   // 采集次数（= CPU 唤醒次数）
+    uint32_t truncated;  // 没有结束标记的采集
+    uint32_t busyUs;     // 解码累计耗时
+};
+
+static RxChannel channels[] = {
+    {"RS485_2", RMT_CHANNEL_0, RS485_2_RX_PIN, RS485_2_DE_PIN},
+    {"RS485_1", RMT_CHANNEL_4, RS485_1_RX_PIN, RS485_1_DE_PIN},
+};
+static const int NUM_CHANNELS = sizeof(channels) / sizeof(channels[0]);
+
+char textBuffer[512];
+unsigned long lastPrint = 0;
+
+// ==================== RMT 接收 ====================
+bool beginChannel(RxChannel &c)
+{
+    uint32_t idleTicks = (uint32_t)((uint64_t)RMT_TICK_HZ * IDLE_BITS / UART_BAUD);
+
+    pinMode(c.dePin, OUTPUT);
+    digitalWrite(c.dePin, LOW); // 接收模式
+
+    rmt_config_t cfg = RMT_DEFAULT_CONFIG_RX((gpio_num_t)c.rxPin, c.ch);
+    cfg.clk_div = RMT_CLK_DIV;
+    cfg.mem_block_num = RMT_MEM_BLOCKS;
+    cfg.rx_config.filter_en = true;
+    cfg.rx_config.filter_ticks_thresh = RMT_FILTER_TICKS;
+    cfg.rx_config.idle_threshold = (uint16_t)idleTicks;
+    if (rmt_config(&cfg) != ESP_OK || rmt_driver_install(c.ch, RMT_RINGBUF_SIZE, 0) != ESP_OK)
+        return false;
+    if (rmt_get_ringbuf_handle(c.ch, &c.rb) != ESP_OK || c.rb == NULL)
+        return false;
+
+    swuart_init(&c.uart, RMT_TICK_HZ, UART_BAUD);
+    hipnuc_sync_init(&c.sync);
+    memset(&c.raw, 0, sizeof(c.raw));
+    rate_est_init(&c.rate, c.name);
+    return rmt_rx_start(c.ch, true) == ESP_OK;
+}
+
+/**
+ * @brief 取出并解码一路已完成的采集（不等待）
+ */
+void serviceChannel(RxChannel &c)
+{
+    size_t size = 0;
+    rmt_item32_t *items;
+    uint8_t bytes[128];
+
+    while ((items = (rmt_item32_t *)xRingbufferReceive(c.rb, &size, 0)) != NULL)
+    {
+        uint32_t t0 = micros();
+        size_t n = size / sizeof(rmt_item32_t);
+        int got;
+
+        c.captures++;
+        if (n >= RMT_MEM_BLOCKS * 64 && items[n - 1].duration0 != 0 && items[n - 1].duration1 != 0)
+            c.truncated++;
+
+        // 每次采集以空闲结束：未带结束标记（截断）时也按空闲补齐，避免半个字节留到下一次
+        got = swuart_feed_rmt(&c.uart, (const uint32_t *)items, n, bytes, sizeof(bytes));
+        got += swuart_flush(&c.uart, bytes + got, sizeof(bytes) - got);
+        vRingbufferReturnItem(c.rb, items);
+
+        for (int i = 0; i < got; i++)
+        {
+            int ret = hipnuc_sync_input(&c.sync, &c.raw, bytes[i]);
+            if (ret > 0)
+                rate_est_sample(&c.rate, t0, (uint16_t)(c.raw.len + HIPNUC_SYNC_HDR_SIZE));
+            else if (ret < 0)
+                rate_est_error(&c.rate, 1);
+        }
+        c.busyUs += micros() - t0;
+    }
+}
+
+void printChannel(RxChannel &c, uint32_t now)
+{
+    Serial.printf("[%s] GPIO%d, 采集 %lu 次（截断 %lu），解码 %lu us\n", c.name, c.rxPin,
+                  (unsigned long)c.captures, (unsigned long)c.truncated, (unsigned long)c.busyUs);
+    Serial.printf("  位解码: %lu 字节, 帧错误 %lu, break %lu, 毛刺 %lu, 溢出 %lu\n",
+                  (unsigned long)c.uart.stats.bytes, (unsigned long)c.uart.stats.frame_errors,
+                  (unsigned long)c.uart.stats.breaks, (unsigned long)c.uart.stats.glitches,
+                  (unsigned long)c.uart.stats.overflows);
+    hipnuc_sync_format(&c.sync, textBuffer, sizeof(textBuffer));
+    Serial.printf("  %s", textBuffer);
+    rate_est_format(&c.rate, now, textBuffer, sizeof(textBuffer));
+    Serial.print(textBuffer);
+    if (c.raw.hi91.tag == 0x91)
+        Serial.printf("  HI91 roll %.2f pitch %.2f yaw %.2f\n", c.raw.hi91.roll, c.raw.hi91.pitch, c.raw.hi91.yaw);
+    c.busyUs = 0;
+}
+
+// ==================== 主程序 ====================
+void setup()
+{
+    Serial.begin(115200);
+    delay(500);
+    Serial.println("\nRMT 多路 UART 接收示例");
+
+    for (int i = 0; i < NUM_CHANNELS; i++)
+    {
+        bool ok = beginChannel(channels[i]);
+        Serial.printf("[%s] RMT 通道 %d, GPIO%d, %d 块: %s\n", channels[i].name, channels[i].ch,
+                      channels[i].rxPin, RMT_MEM_BLOCKS, ok ? "OK" : "失败");
+    }
+}
+
+void loop()
+{
+    for (int i = 0; i < NUM_CHANNELS; i++)
+        serviceChannel(channels[i]);
+
+    if (millis() - lastPrint >= PRINT_INTERVAL_MS)
+    {
+        uint32_t now = micros();
+        lastPrint = millis();
+        for (int i = 0; i < NUM_CHANNELS; i++)
+            printChannel(channels[i], now);
+        Serial.println();
+    }
+    delay(1);
+}
@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <SdFat.h>
+#include "microbench.h"
 
 // ==================== SD卡配置 ====================
 #define SD_CS_PIN 5
@@ -364,54 +365,85 @@ void demoBinaryData()
     }
 }
 
-// 10. 性能测试
-void performanceTest()
+// 10. 性能测试（微基准注册表：预热后多次计时，输出周期数、耗时与吞吐量）
+#define PERF_FILE "perf.dat"
+#define PERF_BLOCK 512
+#define PERF_BLOCKS 1000 // 读测试的文件大小：PERF_BLOCKS × PERF_BLOCK
+
+uint8_t perfBuf[PERF_BLOCK];
+
+uint32_t perfTicks()
 {
-    Serial.println("\n【性能测试】");
+    return ESP.getCycleCount();
+}
 
-    const char *perfFile = "perf.dat";
-    const size_t bufSize = 512;
-    uint8_t buf[bufSize];
+void perfPrint(const char *text)
+{
+    Serial.print(text);
+}
 
-    // 填充测试数据
-    for (size_t i = 0; i < bufSize; i++)
-    {
-        buf[i] = i & 0xFF;
-    }
+int perfWriteSetup(void *ctx)
+{
+    for (size_t i = 0; i < PERF_BLOCK; i++)
+        perfBuf[i] = i & 0xFF;
+    return file.open(PERF_FILE, O_WRONLY | O_CREAT | O_TRUNC) ? 0 : 1;
+}
 
-    // 写入测试
-    if (file.open(perfFile, O_WRONLY | O_CREAT | O_TRUNC))
-    {
-        unsigned long start = millis();
-        for (int i = 0; i < 1000; i++)
-        {
-            file.write(buf, bufSize);
-        }
-        file.sync();
-        unsigned long elapsed = millis() - start;
-        file.close();
+uint32_t perfWrite(void *ctx)
+{
+    return file.write(perfBuf, PERF_BLOCK) == PERF_BLOCK ? PERF_BLOCK : 0;
+}
 
-        float speed = (1000.0 * bufSize) / (elapsed / 1000.0) / 1024.0;
-        Serial.printf("写入速度: %.2f KB/s\n", speed);
-    }
+/* 每批写入后 sync，计入 FAT / 目录项更新 */
+uint32_t perfWriteSync(void *ctx)
+{
+    uint32_t n = perfWrite(ctx);
+    file.sync();
+    return n;
+}
 
-    // 读取测试
-    if (file.open(perfFile, O_RDONLY))
-    {
-        unsigned long start = millis();
-        while (file.read(buf, bufSize) > 0)
-        {
-            // 读取数据
-        }
-        unsigned long elapsed = millis() - start;
-        file.close();
+void perfClose(void *ctx)
+{
+    file.close();
+}
 
-        float speed = (1000.0 * bufSize) / (elapsed / 1000.0) / 1024.0;
-        Serial.printf("读取速度: %.2f KB/s\n", speed);
+/* 读测试先写好 PERF_BLOCKS 块，读到文件末尾时回到开头 */
+int perfReadSetup(void *ctx)
+{
+    if (perfWriteSetup(ctx) != 0)
+        return 1;
+    for (int i = 0; i < PERF_BLOCKS; i++)
+        file.write(perfBuf, PERF_BLOCK);
+    file.close();
+    return file.open(PERF_FILE, O_RDONLY) ? 0 : 1;
+}
+
+uint32_t perfRead(void *ctx)
+{
+    int n = file.read(perfBuf, PERF_BLOCK);
+    if (n < PERF_BLOCK)
+    {
+        file.seekSet(0);
+        n = file.read(perfBuf, PERF_BLOCK);
     }
+    return n > 0 ? n : 0;
+}
+
+const microbench_t perfBenches[] = {
+    {"sd_write_512", perfWriteSetup, perfWrite, perfClose, NULL, 16},
+    {"sd_write_sync", perfWriteSetup, perfWriteSync, perfClose, NULL, 1},
+    {"sd_read_512", perfReadSetup, perfRead, perfClose, NULL, 16},
+};
+
+void performanceTest()
+{
+    Serial.println("\n【性能测试】");
+
+    microbench_cfg_t cfg = {perfTicks, (uint32_t)ESP.getCpuFreqMHz(), 3, 21};
+    microbench_suite(perfBenches, sizeof(perfBenches) / sizeof(perfBenches[0]), &cfg, perfPrint);
 
     // 清理
-    sd.remove(perfFile);
+    sd.remove(PERF_FILE);
 }
 
 // ==================== 菜单函数 ====================